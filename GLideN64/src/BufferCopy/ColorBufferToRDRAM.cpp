@@ -2,6 +2,7 @@
 #include <algorithm>
 
 #include "ColorBufferToRDRAM.h"
+#include "ReadbackWorker.h"
 #include "WriteToRDRAM.h"
 
 #include <FrameBuffer.h>
@@ -11,6 +12,7 @@
 #include <VI.h>
 #include "Log.h"
 #include "MemoryStatus.h"
+#include "ColorConverters.h"
 
 /*
 #include "ColorBufferToRDRAM_GL.h"
@@ -53,6 +55,7 @@ void ColorBufferToRDRAM::init()
 }
 
 void ColorBufferToRDRAM::destroy() {
+	ReadbackWorker::get().stop();
 	_destroyFBTexure();
 
 	if (m_FBO.isNotNull()) {
@@ -272,42 +275,77 @@ void ColorBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress, bool _sync)
 	if (pPixels == nullptr)
 		return;
 
-	if (m_pCurFrameBuffer->m_size == G_IM_SIZ_32b) {
-		u32 *ptr_src = (u32*)pPixels;
-		u32 *ptr_dst = (u32*)(RDRAM + _startAddress);
-
-		if (!FBInfo::fbInfo.isSupported() && config.frameBufferEmulation.copyFromRDRAM != 0) {
-			memset(ptr_dst, 0, numPixels * 4);
-		}
-
-		writeToRdram<u32, u32>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA32, 0, 0, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
-	} else if (m_pCurFrameBuffer->m_size == G_IM_SIZ_16b) {
-		u32 *ptr_src = (u32*)pPixels;
-		u16 *ptr_dst = (u16*)(RDRAM + _startAddress);
-
-		if (!FBInfo::fbInfo.isSupported() && config.frameBufferEmulation.copyFromRDRAM != 0) {
-			memset(ptr_dst, 0, numPixels * 2);
-		}
+	// The reader returns its own copy of the pixels, so the buffer can be released right away.
+	m_bufferReader->cleanUp();
 
-		writeToRdram<u32, u16>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA16, 0, 1, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
-	} else if (m_pCurFrameBuffer->m_size == G_IM_SIZ_8b) {
-		u8 *ptr_src = (u8*)pPixels;
-		u8 *ptr_dst = RDRAM + _startAddress;
+	m_pCurFrameBuffer->m_copiedToRdram = true;
+	m_pCurFrameBuffer->m_cleared = false;
+	gDP.changed |= CHANGED_SCISSOR;
 
-		if (!FBInfo::fbInfo.isSupported() && config.frameBufferEmulation.copyFromRDRAM != 0) {
-			memset(ptr_dst, 0, numPixels);
-		}
+	const u32 bufferAddress = m_pCurFrameBuffer->m_startAddress;
+	const u32 size = m_pCurFrameBuffer->m_size;
+	const bool clear = !FBInfo::fbInfo.isSupported() && config.frameBufferEmulation.copyFromRDRAM != 0;
 
-		writeToRdram<u8, u8>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoR8, 0, 3, width, height, numPixels, _startAddress, m_pCurFrameBuffer->m_startAddress, m_pCurFrameBuffer->m_size);
+	if (_sync || config.frameBufferEmulation.readbackLatency == 0) {
+		_writeToRdram(pPixels, RDRAM + _startAddress, false, clear, _startAddress, bufferAddress, size, width, height, numPixels);
+		m_pCurFrameBuffer->copyRdram();
+		return;
 	}
 
-	m_pCurFrameBuffer->m_copiedToRdram = true;
-	m_pCurFrameBuffer->copyRdram();
-	m_pCurFrameBuffer->m_cleared = false;
-
-	m_bufferReader->cleanUp();
+	// The worker converts into a private copy, which is merged into RDRAM on the render thread.
+	m_staging.init(_startAddress, numPixels << size >> 1, RDRAMSize + 1);
+	RdramStaging * pStaging = &m_staging;
+	FrameBuffer * pBuffer = m_pCurFrameBuffer;
+	ReadbackWorker::get().post([=]() {
+		_writeToRdram(pPixels, pStaging->getData(_startAddress), false, clear, _startAddress, bufferAddress, size, width, height, numPixels);
+		_writeToRdram(pPixels, pStaging->getMask(_startAddress), true, clear, _startAddress, bufferAddress, size, width, height, numPixels);
+	}, [=]() {
+		pStaging->commit(RDRAM);
+		if (frameBufferList().findBuffer(bufferAddress) == pBuffer)
+			pBuffer->copyRdram();
+	});
+}
 
-	gDP.changed |= CHANGED_SCISSOR;
+void ColorBufferToRDRAM::_writeToRdram(const u8 * _pPixels, u8 * _pDst, bool _mask, bool _clear,
+	u32 _startAddress, u32 _bufferAddress, u32 _size, u32 _width, u32 _height, u32 _numPixels)
+{
+	const int clearValue = _mask ? 0xFF : 0;
+	if (_size == G_IM_SIZ_32b) {
+		u32 *ptr_src = (u32*)_pPixels;
+		u32 *ptr_dst = (u32*)_pDst;
+
+		if (_clear)
+			memset(ptr_dst, clearValue, _numPixels * 4);
+
+		if (_mask)
+			writeToRdram<u32, u32>(ptr_src, ptr_dst, &writeMask<u32, u32>, 0, 0, _width, _height, _numPixels, _startAddress, _bufferAddress, _size);
+		else
+			writeToRdram<u32, u32>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA32, 0, 0, _width, _height, _numPixels, _startAddress, _bufferAddress, _size,
+				&RGBAtoRGBA32Run);
+	} else if (_size == G_IM_SIZ_16b) {
+		u32 *ptr_src = (u32*)_pPixels;
+		u16 *ptr_dst = (u16*)_pDst;
+
+		if (_clear)
+			memset(ptr_dst, clearValue, _numPixels * 2);
+
+		if (_mask)
+			writeToRdram<u32, u16>(ptr_src, ptr_dst, &writeMask<u32, u16>, 0, 1, _width, _height, _numPixels, _startAddress, _bufferAddress, _size);
+		else
+			writeToRdram<u32, u16>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoRGBA16, 0, 1, _width, _height, _numPixels, _startAddress, _bufferAddress, _size,
+				&RGBAtoRGBA16Run);
+	} else if (_size == G_IM_SIZ_8b) {
+		u8 *ptr_src = (u8*)_pPixels;
+		u8 *ptr_dst = _pDst;
+
+		if (_clear)
+			memset(ptr_dst, clearValue, _numPixels);
+
+		if (_mask)
+			writeToRdram<u8, u8>(ptr_src, ptr_dst, &writeMask<u8, u8>, 0, 3, _width, _height, _numPixels, _startAddress, _bufferAddress, _size);
+		else
+			writeToRdram<u8, u8>(ptr_src, ptr_dst, &ColorBufferToRDRAM::_RGBAtoR8, 0, 3, _width, _height, _numPixels, _startAddress, _bufferAddress, _size);
+	}
 }
 
 u32 ColorBufferToRDRAM::_getRealWidth(u32 _viWidth)
@@ -324,6 +362,8 @@ u32 ColorBufferToRDRAM::_getRealWidth(u32 _viWidth)
 
 void ColorBufferToRDRAM::copyToRDRAM(u32 _address, bool _sync)
 {
+	// The pixels of the previous asynchronous copy must be written before the reader is reused.
+	ReadbackWorker::get().finish();
 	if (!isMemoryWritable(RDRAM + _address, gDP.colorImage.width << gDP.colorImage.size >> 1))
 		return;
 	if (!_prepareCopy(_address))
@@ -341,6 +381,7 @@ void ColorBufferToRDRAM::copyChunkToRDRAM(u32 _startAddress)
 
 	if (!isMemoryWritable(RDRAM + _startAddress, endAddress - _startAddress))
 		return;
+	ReadbackWorker::get().finish();
 	if (!_prepareCopy(_startAddress))
 		return;
 	_copy(_startAddress, endAddress, true);
@@ -5,6 +5,7 @@
 #include <array>
 #include <vector>
 #include <Graphics/ObjectHandle.h>
+#include "WriteToRDRAM.h"
 
 namespace graphics {
 	class ColorBufferReader;
@@ -46,6 +47,11 @@ private:
 
 	void _copy(u32 _startAddress, u32 _endAddress, bool _sync);
 
+	// Converts pixels to _pDst, which maps to _startAddress. With _mask set, marks the converted bytes instead.
+	// Runs on the readback worker for asynchronous copies.
+	static void _writeToRdram(const u8 * _pPixels, u8 * _pDst, bool _mask, bool _clear,
+		u32 _startAddress, u32 _bufferAddress, u32 _size, u32 _width, u32 _height, u32 _numPixels);
+
 	u32 _getRealWidth(u32 _viWidth);
 
 	// Convert pixel from video memory to N64 buffer format.
@@ -62,6 +68,7 @@ private:
 
 	std::array<u32, 3> m_allowedRealWidths;
 	std::unique_ptr<graphics::ColorBufferReader> m_bufferReader;
+	RdramStaging m_staging;
 };
 
 void copyWhiteToRDRAM(FrameBuffer * _pBuffer);
@@ -0,0 +1,243 @@
+#ifndef ColorConverters_H
+#define ColorConverters_H
+
+#include <algorithm>
+#include "../Types.h"
+#include "../N64.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Conversions of RDRAM color buffers to ABGR32 textures.
+// The Run versions convert as many pixels of a run as their vector loop covers and return that number.
+
+inline
+u32 RGBA16ToABGR32(u16 col, bool _fullAlpha)
+{
+	u32 r, g, b, a;
+	r = ((col >> 11) & 31) << 3;
+	g = ((col >> 6) & 31) << 3;
+	b = ((col >> 1) & 31) << 3;
+	if (_fullAlpha)
+		a = 0xFF;
+	else
+		a = (col & 1) > 0 ? 0xFF : 0U;
+	return ((a << 24) | (b << 16) | (g << 8) | r);
+}
+
+inline
+u32 RGBA32ToABGR32(u32 col, bool _fullAlpha)
+{
+	u32 r, g, b, a;
+	r = (col >> 24) & 0xff;
+	g = (col >> 16) & 0xff;
+	b = (col >> 8) & 0xff;
+	if (_fullAlpha)
+		a = 0xFF;
+	else
+		a = col & 0xFF;
+	return ((a << 24) | (b << 16) | (g << 8) | r);
+}
+
+inline
+u32 RGBA16ToABGR32Run(const u16 * _src, u32 * _dst, u32 _count, bool _fullAlpha, u32 & _summ)
+{
+	u32 i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i mask5 = _mm_set1_epi16(0xF8);
+	const __m128i alpha = _fullAlpha ? _mm_set1_epi16(0xFF) : zero;
+	__m128i any = zero;
+	for (; i + 8 <= _count; i += 8) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i));
+		// RDRAM halfwords are swapped in pairs.
+		c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		any = _mm_or_si128(any, c);
+		const __m128i r = _mm_slli_epi16(_mm_srli_epi16(c, 11), 3);
+		const __m128i g = _mm_and_si128(_mm_srli_epi16(c, 3), mask5);
+		const __m128i b = _mm_and_si128(_mm_slli_epi16(c, 2), mask5);
+		const __m128i a = _mm_or_si128(alpha, _mm_srli_epi16(_mm_sub_epi16(zero, _mm_and_si128(c, one)), 8));
+		const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+		const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+	}
+	_summ |= _mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF ? 1 : 0;
+#elif defined(__ARM_NEON)
+	const uint16x8_t mask5 = vdupq_n_u16(0xF8);
+	const uint16x8_t alpha = vdupq_n_u16(_fullAlpha ? 0xFF : 0);
+	uint16x8_t any = vdupq_n_u16(0);
+	for (; i + 8 <= _count; i += 8) {
+		// RDRAM halfwords are swapped in pairs.
+		const uint16x8_t c = vrev32q_u16(vld1q_u16(_src + i));
+		any = vorrq_u16(any, c);
+		const uint16x8_t r = vshlq_n_u16(vshrq_n_u16(c, 11), 3);
+		const uint16x8_t g = vandq_u16(vshrq_n_u16(c, 3), mask5);
+		const uint16x8_t b = vandq_u16(vshlq_n_u16(c, 2), mask5);
+		const uint16x8_t a = vorrq_u16(alpha, vmulq_n_u16(vandq_u16(c, vdupq_n_u16(1)), 0xFF));
+		uint16x8x2_t abgr;
+		abgr.val[0] = vorrq_u16(r, vshlq_n_u16(g, 8));
+		abgr.val[1] = vorrq_u16(b, vshlq_n_u16(a, 8));
+		vst2q_u16(reinterpret_cast<uint16_t*>(_dst + i), abgr);
+	}
+	const uint64x2_t any64 = vreinterpretq_u64_u16(any);
+	_summ |= (vgetq_lane_u64(any64, 0) | vgetq_lane_u64(any64, 1)) != 0 ? 1 : 0;
+#endif
+	return i;
+}
+
+inline
+u32 RGBA32ToABGR32Run(const u32 * _src, u32 * _dst, u32 _count, bool _fullAlpha, u32 & _summ)
+{
+	u32 i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32(_fullAlpha ? 0xFF000000 : 0);
+	__m128i any = zero;
+	for (; i + 4 <= _count; i += 4) {
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i));
+		any = _mm_or_si128(any, c);
+		// Byte swap: swap halfwords, then bytes inside halfwords.
+		__m128i abgr = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		abgr = _mm_or_si128(_mm_slli_epi16(abgr, 8), _mm_srli_epi16(abgr, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), _mm_or_si128(abgr, alpha));
+	}
+	_summ |= _mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xFFFF ? 1 : 0;
+#elif defined(__ARM_NEON)
+	const uint32x4_t alpha = vdupq_n_u32(_fullAlpha ? 0xFF000000 : 0);
+	uint32x4_t any = vdupq_n_u32(0);
+	for (; i + 4 <= _count; i += 4) {
+		const uint32x4_t c = vld1q_u32(_src + i);
+		any = vorrq_u32(any, c);
+		const uint32x4_t abgr = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(c)));
+		vst1q_u32(_dst + i, vorrq_u32(abgr, alpha));
+	}
+	const uint64x2_t any64 = vreinterpretq_u64_u32(any);
+	_summ |= (vgetq_lane_u64(any64, 0) | vgetq_lane_u64(any64, 1)) != 0 ? 1 : 0;
+#endif
+	return i;
+}
+
+// Write the whole buffer
+// runConverter converts the beginning of the buffer as one run and returns the number of pixels written.
+template <typename TSrc>
+bool _copyBufferFromRdram(u32 _address, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB),
+						  u32(*runConverter)(const TSrc * _src, u32 * _dst, u32 _count, bool _fullAlpha, u32 & _summ),
+						  u32 _xor, u32 _x0, u32 _y0, u32 _width, u32 _height, bool _fullAlpha)
+{
+	TSrc * src = reinterpret_cast<TSrc*>(RDRAM + _address);
+	const u32 bound = (RDRAMSize + 1 - _address) >> (sizeof(TSrc) / 2);
+	TSrc col;
+	u32 idx;
+	u32 summ = 0;
+	u32 y = _y0;
+	u32 x0 = _x0;
+	if (_x0 == 0 && _y0 == 0 && _width != 0) {
+		// Rows are contiguous in both buffers. Pixels below the aligned bound can't be cut by it.
+		const u32 runLength = runConverter(src, _dst, std::min(_width * _height, bound & ~7U), _fullAlpha, summ);
+		y = runLength / _width;
+		x0 = runLength % _width;
+	}
+	u32 dsty = y - _y0;
+	const u32 y1 = _y0 + _height;
+	for (; y < y1; ++y) {
+		for (u32 x = x0; x < _width; ++x) {
+			idx = (x + y *_width) ^ _xor;
+			if (idx >= bound)
+				break;
+			col = src[idx];
+			summ |= col;
+			_dst[x + dsty*_width] = converter(col, _fullAlpha);
+		}
+		x0 = _x0;
+		++dsty;
+	}
+
+	return summ != 0;
+}
+
+// Conversions of ABGR32 pixels to RDRAM color buffers, used as writeToRdram run converters.
+
+// Pixels equal to zero are skipped, as writeToRdram does with its test value.
+inline
+u32 RGBAtoRGBA16Run(const u32 * _src, u16 * _dst, u32 _count)
+{
+	u32 i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+	for (; i + 8 <= _count; i += 8) {
+		__m128i c[2], v[2], skip[2];
+		c[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i));
+		c[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i + 4));
+		for (u32 j = 0; j < 2; ++j) {
+			const __m128i r = _mm_slli_epi32(_mm_and_si128(c[j], _mm_set1_epi32(0xF8)), 8);
+			const __m128i g = _mm_and_si128(_mm_srli_epi32(c[j], 5), _mm_set1_epi32(0x7C0));
+			const __m128i b = _mm_and_si128(_mm_srli_epi32(c[j], 18), _mm_set1_epi32(0x3E));
+			const __m128i a = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_srli_epi32(c[j], 24), zero), one);
+			v[j] = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+			// Sign extend, so the signed saturating pack keeps all 16 bits.
+			v[j] = _mm_srai_epi32(_mm_slli_epi32(v[j], 16), 16);
+			skip[j] = _mm_cmpeq_epi32(c[j], zero);
+		}
+		// RDRAM halfwords are swapped in pairs.
+		__m128i color = _mm_packs_epi32(v[0], v[1]);
+		color = _mm_shufflehi_epi16(_mm_shufflelo_epi16(color, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		__m128i mask = _mm_packs_epi32(skip[0], skip[1]);
+		mask = _mm_shufflehi_epi16(_mm_shufflelo_epi16(mask, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_dst + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), _mm_or_si128(_mm_and_si128(mask, old), _mm_andnot_si128(mask, color)));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 8 <= _count; i += 8) {
+		uint32x4_t c[2];
+		uint16x4_t v[2], skip[2];
+		c[0] = vld1q_u32(_src + i);
+		c[1] = vld1q_u32(_src + i + 4);
+		for (u32 j = 0; j < 2; ++j) {
+			const uint32x4_t r = vshlq_n_u32(vandq_u32(c[j], vdupq_n_u32(0xF8)), 8);
+			const uint32x4_t g = vandq_u32(vshrq_n_u32(c[j], 5), vdupq_n_u32(0x7C0));
+			const uint32x4_t b = vandq_u32(vshrq_n_u32(c[j], 18), vdupq_n_u32(0x3E));
+			const uint32x4_t a = vminq_u32(vshrq_n_u32(c[j], 24), vdupq_n_u32(1));
+			v[j] = vmovn_u32(vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, a)));
+			skip[j] = vmovn_u32(vceqq_u32(c[j], vdupq_n_u32(0)));
+		}
+		// RDRAM halfwords are swapped in pairs.
+		const uint16x8_t color = vrev32q_u16(vcombine_u16(v[0], v[1]));
+		const uint16x8_t mask = vrev32q_u16(vcombine_u16(skip[0], skip[1]));
+		vst1q_u16(_dst + i, vbslq_u16(mask, vld1q_u16(_dst + i), color));
+	}
+#endif
+	return i;
+}
+
+inline
+u32 RGBAtoRGBA32Run(const u32 * _src, u32 * _dst, u32 _count)
+{
+	u32 i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= _count; i += 4) {
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_src + i));
+		// Byte swap: swap halfwords, then bytes inside halfwords.
+		__m128i color = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		color = _mm_or_si128(_mm_slli_epi16(color, 8), _mm_srli_epi16(color, 8));
+		const __m128i mask = _mm_cmpeq_epi32(c, zero);
+		const __m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_dst + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(_dst + i), _mm_or_si128(_mm_and_si128(mask, old), _mm_andnot_si128(mask, color)));
+	}
+#elif defined(__ARM_NEON)
+	for (; i + 4 <= _count; i += 4) {
+		const uint32x4_t c = vld1q_u32(_src + i);
+		const uint32x4_t color = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(c)));
+		vst1q_u32(_dst + i, vbslq_u32(vceqq_u32(c, vdupq_n_u32(0)), vld1q_u32(_dst + i), color));
+	}
+#endif
+	return i;
+}
+
+#endif // ColorConverters_H
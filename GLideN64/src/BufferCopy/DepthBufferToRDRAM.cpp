@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "DepthBufferToRDRAM.h"
+#include "ReadbackWorker.h"
 #include "WriteToRDRAM.h"
 #include "MemoryStatus.h"
 
@@ -29,6 +30,7 @@ DepthBufferToRDRAM::DepthBufferToRDRAM()
 	, m_pColorTexture(nullptr)
 	, m_pDepthTexture(nullptr)
 	, m_pCurFrameBuffer(nullptr)
+	, m_curReadback(0)
 {
 }
 
@@ -49,6 +51,20 @@ void DepthBufferToRDRAM::init()
 	if (!m_pbuf)
 		return;
 
+	const u32 numReadbacks = config.getDepthReadbackBuffers();
+	if (numReadbacks > 1) {
+		for (u32 i = 0; i < numReadbacks; ++i) {
+			std::unique_ptr<PixelReadBuffer> pbuf(gfxContext.createPixelReadBuffer(DEPTH_TEX_WIDTH * DEPTH_TEX_HEIGHT * sizeof(float)));
+			if (!pbuf) {
+				m_readbackBufs.clear();
+				break;
+			}
+			m_readbackBufs.push_back(std::move(pbuf));
+		}
+		m_readbacks.resize(m_readbackBufs.size());
+		m_curReadback = 0;
+	}
+
 	m_pColorTexture = textureCache().addFrameBufferTexture(textureTarget::TEXTURE_2D);
 	m_pColorTexture->format = G_IM_FMT_I;
 	m_pColorTexture->size = 2;
@@ -140,6 +156,9 @@ void DepthBufferToRDRAM::destroy() {
 		textureCache().removeFrameBufferTexture(m_pDepthTexture);
 		m_pDepthTexture = nullptr;
 	}
+	ReadbackWorker::get().finish();
+	m_readbackBufs.clear();
+	m_readbacks.clear();
 	m_pbuf.reset();
 }
 
@@ -220,6 +239,22 @@ u16 DepthBufferToRDRAM::_FloatToUInt16(f32 _z)
 	return zLUT[idx];
 }
 
+void DepthBufferToRDRAM::_writeToRdram(f32 * _pSrc, u8 * _pDst, bool _mask, u32 _startAddress, u32 _bufferAddress,
+	u32 _width, u32 _height, u32 _numPixels)
+{
+	writeToRdram<f32, u16>(_pSrc,
+						   (u16*)_pDst,
+						   _mask ? &writeMask<f32, u16> : &DepthBufferToRDRAM::_FloatToUInt16,
+						   2.0f,
+						   1,
+						   _width,
+						   _height,
+						   _numPixels,
+						   _startAddress,
+						   _bufferAddress,
+						   G_IM_SIZ_16b);
+}
+
 bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 {
 	DepthBuffer * pDepthBuffer = m_pCurFrameBuffer->m_pDepthBuffer;
@@ -247,22 +282,9 @@ bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 	if (pixelData == nullptr)
 		return false;
 
-	f32 * ptr_src = (f32*)pixelData;
-	u16 *ptr_dst = (u16*)(RDRAM + _startAddress);
-
 	std::vector<f32> srcBuf(width * height);
-	memcpy(srcBuf.data(), ptr_src, width * height * sizeof(f32));
-	writeToRdram<f32, u16>(srcBuf.data(),
-						   ptr_dst,
-						   &DepthBufferToRDRAM::_FloatToUInt16,
-						   2.0f,
-						   1,
-						   width,
-						   height,
-						   numPixels,
-						   _startAddress,
-						   pDepthBuffer->m_address,
-						   G_IM_SIZ_16b);
+	memcpy(srcBuf.data(), pixelData, width * height * sizeof(f32));
+	_writeToRdram(srcBuf.data(), RDRAM + _startAddress, false, _startAddress, pDepthBuffer->m_address, width, height, numPixels);
 
 	pDepthBuffer->m_cleared = false;
 	FrameBuffer * pBuffer = frameBufferList().findBuffer(pDepthBuffer->m_address);
@@ -275,6 +297,71 @@ bool DepthBufferToRDRAM::_copy(u32 _startAddress, u32 _endAddress)
 	return true;
 }
 
+bool DepthBufferToRDRAM::_copyAsync(u32 _startAddress, u32 _endAddress)
+{
+	DepthBuffer * pDepthBuffer = m_pCurFrameBuffer->m_pDepthBuffer;
+	const u32 width = m_pCurFrameBuffer->m_width;
+	const u32 height = cutHeight(_startAddress, m_pCurFrameBuffer->m_height, width << 1);
+
+	gfxContext.bindFramebuffer(bufferTarget::READ_FRAMEBUFFER, m_FBO);
+	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
+
+	{
+		PixelReadBuffer * pbuf = m_readbackBufs[m_curReadback].get();
+		PixelBufferBinder<PixelReadBuffer> binder(pbuf);
+		pbuf->readPixels(0, 0, width, height, fbTexFormats.depthFormat, fbTexFormats.depthType);
+
+		Readback & readback = m_readbacks[m_curReadback];
+		readback.startAddress = _startAddress;
+		readback.bufferAddress = pDepthBuffer->m_address;
+		readback.width = width;
+		readback.height = height;
+		readback.numPixels = std::min((_endAddress - _startAddress) >> 1, width * height);
+		readback.valid = true;
+	}
+
+	pDepthBuffer->m_cleared = false;
+	FrameBuffer * pBuffer = frameBufferList().findBuffer(pDepthBuffer->m_address);
+	if (pBuffer != nullptr)
+		pBuffer->m_cleared = false;
+	gDP.changed |= CHANGED_SCISSOR;
+
+	m_curReadback = (m_curReadback + 1) % m_readbackBufs.size();
+
+	// The oldest read is complete by now, so mapping it does not stall.
+	Readback & readback = m_readbacks[m_curReadback];
+	if (!readback.valid)
+		return true;
+	readback.valid = false;
+
+	PixelReadBuffer * pbuf = m_readbackBufs[m_curReadback].get();
+	PixelBufferBinder<PixelReadBuffer> binder(pbuf);
+	const u32 numValues = readback.width * readback.height;
+	f32 * pixelData = (f32*)pbuf->getDataRange(0, numValues * fbTexFormats.depthFormatBytes);
+	if (pixelData == nullptr)
+		return true;
+
+	std::shared_ptr<std::vector<f32>> srcBuf = std::make_shared<std::vector<f32>>(pixelData, pixelData + numValues);
+	pbuf->closeReadBuffer();
+
+	// The worker converts into a private copy, which is merged into RDRAM on the render thread.
+	// The copy is dropped if the depth buffer has gone away since it was read.
+	const Readback params = readback;
+	m_staging.init(params.startAddress, params.numPixels * 2, RDRAMSize + 1);
+	RdramStaging * pStaging = &m_staging;
+	ReadbackWorker::get().post([=]() {
+		_writeToRdram(srcBuf->data(), pStaging->getData(params.startAddress), false, params.startAddress,
+			params.bufferAddress, params.width, params.height, params.numPixels);
+		_writeToRdram(srcBuf->data(), pStaging->getMask(params.startAddress), true, params.startAddress,
+			params.bufferAddress, params.width, params.height, params.numPixels);
+	}, [=]() {
+		DepthBuffer * pDepthBuffer = depthBufferList().findBuffer(params.bufferAddress);
+		if (pDepthBuffer != nullptr && pDepthBuffer->m_width == params.width)
+			pStaging->commit(RDRAM);
+	});
+	return true;
+}
+
 bool DepthBufferToRDRAM::copyToRDRAM(u32 _address)
 {
 	if (config.frameBufferEmulation.copyDepthToRDRAM == Config::cdSoftwareRender)
@@ -283,6 +370,8 @@ bool DepthBufferToRDRAM::copyToRDRAM(u32 _address)
 	if (!m_pbuf)
 		return false;
 
+	ReadbackWorker::get().finish();
+
 	if (!isMemoryWritable(RDRAM + _address, gDP.colorImage.width * 2))
 		return false;
 
@@ -292,6 +381,9 @@ bool DepthBufferToRDRAM::copyToRDRAM(u32 _address)
 	const u32 endAddress = m_pCurFrameBuffer->m_pDepthBuffer->m_address +
 			m_pCurFrameBuffer->m_width * m_pCurFrameBuffer->m_height * 2;
 
+	if (!m_readbackBufs.empty())
+		return _copyAsync(m_pCurFrameBuffer->m_pDepthBuffer->m_address, endAddress);
+
 	return _copy(m_pCurFrameBuffer->m_pDepthBuffer->m_address, endAddress);
 }
 
@@ -308,6 +400,8 @@ bool DepthBufferToRDRAM::copyChunkToRDRAM(u32 _startAddress)
 	if (!isMemoryWritable(RDRAM + _startAddress, endAddress - _startAddress))
 		return false;
 
+	ReadbackWorker::get().finish();
+
 	if (!_prepareCopy(_startAddress, true))
 		return false;
 
@@ -2,7 +2,9 @@
 #define DepthBufferToRDRAM_H
 
 #include <memory>
+#include <vector>
 #include <Graphics/ObjectHandle.h>
+#include "WriteToRDRAM.h"
 
 namespace graphics {
 	class PixelReadBuffer;
@@ -28,6 +30,10 @@ private:
 
 	bool _prepareCopy(u32& _startAddress, bool _copyChunk);
 	bool _copy(u32 _startAddress, u32 _endAddress);
+	bool _copyAsync(u32 _startAddress, u32 _endAddress);
+	// Converts depth values to _pDst, which maps to _startAddress. With _mask set, marks the converted bytes instead.
+	static void _writeToRdram(f32 * _pSrc, u8 * _pDst, bool _mask, u32 _startAddress, u32 _bufferAddress,
+		u32 _width, u32 _height, u32 _numPixels);
 
 	// Convert pixel from video memory to N64 depth buffer format.
 	static u16 _FloatToUInt16(f32 _z);
@@ -38,6 +44,21 @@ private:
 	CachedTexture * m_pColorTexture;
 	CachedTexture * m_pDepthTexture;
 	FrameBuffer * m_pCurFrameBuffer;
+
+	// Ring of buffers for asynchronous full copies.
+	// Each copy maps the oldest buffer, so RDRAM lags rendering by size - 1 copies.
+	struct Readback {
+		u32 startAddress = 0;
+		u32 bufferAddress = 0;
+		u32 width = 0;
+		u32 height = 0;
+		u32 numPixels = 0;
+		bool valid = false;
+	};
+	std::vector<std::unique_ptr<graphics::PixelReadBuffer>> m_readbackBufs;
+	std::vector<Readback> m_readbacks;
+	u32 m_curReadback;
+	RdramStaging m_staging;
 };
 
 #endif // DepthBufferToRDRAM_H
@@ -1,4 +1,5 @@
 #include "RDRAMtoColorBuffer.h"
+#include "ReadbackWorker.h"
 
 #include <FrameBufferInfo.h>
 #include <FrameBuffer.h>
@@ -13,6 +14,8 @@
 #include <DisplayWindow.h>
 #include <algorithm>
 
+#include "ColorConverters.h"
+
 using namespace graphics;
 
 RDRAMtoColorBuffer::RDRAMtoColorBuffer()
@@ -89,32 +92,6 @@ void RDRAMtoColorBuffer::addAddress(u32 _address, u32 _size)
 	gDP.colorImage.changed = TRUE;
 }
 
-// Write the whole buffer
-template <typename TSrc>
-bool _copyBufferFromRdram(u32 _address, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _x0, u32 _y0, u32 _width, u32 _height, bool _fullAlpha)
-{
-	TSrc * src = reinterpret_cast<TSrc*>(RDRAM + _address);
-	const u32 bound = (RDRAMSize + 1 - _address) >> (sizeof(TSrc) / 2);
-	TSrc col;
-	u32 idx;
-	u32 summ = 0;
-	u32 dsty = 0;
-	const u32 y1 = _y0 + _height;
-	for (u32 y = _y0; y < y1; ++y) {
-		for (u32 x = _x0; x < _width; ++x) {
-			idx = (x + y *_width) ^ _xor;
-			if (idx >= bound)
-				break;
-			col = src[idx];
-			summ += col;
-			_dst[x + dsty*_width] = converter(col, _fullAlpha);
-		}
-		++dsty;
-	}
-
-	return summ != 0;
-}
-
 // Write only pixels provided with FBWrite
 template <typename TSrc>
 bool _copyPixelsFromRdram(u32 _address, const std::vector<u32> & _vecAddress, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _width, u32 _height, bool _fullAlpha)
@@ -135,43 +112,16 @@ bool _copyPixelsFromRdram(u32 _address, const std::vector<u32> & _vecAddress, u3
 		if (h > _height)
 			return false;
 		col = src[idx];
-		summ += col;
+		summ |= col;
 		_dst[(w + h * _width) ^ _xor] = converter(col, _fullAlpha);
 	}
 
 	return summ != 0;
 }
 
-static
-u32 RGBA16ToABGR32(u16 col, bool _fullAlpha)
-{
-	u32 r, g, b, a;
-	r = ((col >> 11) & 31) << 3;
-	g = ((col >> 6) & 31) << 3;
-	b = ((col >> 1) & 31) << 3;
-	if (_fullAlpha)
-		a = 0xFF;
-	else
-		a = (col & 1) > 0 ? 0xFF : 0U;
-	return ((a << 24) | (b << 16) | (g << 8) | r);
-}
-
-static
-u32 RGBA32ToABGR32(u32 col, bool _fullAlpha)
-{
-	u32 r, g, b, a;
-	r = (col >> 24) & 0xff;
-	g = (col >> 16) & 0xff;
-	b = (col >> 8) & 0xff;
-	if (_fullAlpha)
-		a = 0xFF;
-	else
-		a = col & 0xFF;
-	return ((a << 24) | (b << 16) | (g << 8) | r);
-}
-
 void RDRAMtoColorBuffer::_copyFromRDRAM(u32 _height, bool _fullAlpha)
 {
+	ReadbackWorker::get().finish();
 	Cleaner cleaner(this);
 	const u32 address = m_pCurBuffer->m_startAddress;
 	const u32 width = m_pCurBuffer->m_width;
@@ -200,9 +150,9 @@ void RDRAMtoColorBuffer::_copyFromRDRAM(u32 _height, bool _fullAlpha)
 	bool bCopy;
 	if (m_vecAddress.empty()) {
 		if (m_pCurBuffer->m_size == G_IM_SIZ_16b)
-			bCopy = _copyBufferFromRdram<u16>(address, pDst, RGBA16ToABGR32, 1, x0, y0, width, height, _fullAlpha);
+			bCopy = _copyBufferFromRdram<u16>(address, pDst, RGBA16ToABGR32, RGBA16ToABGR32Run, 1, x0, y0, width, height, _fullAlpha);
 		else
-			bCopy = _copyBufferFromRdram<u32>(address, pDst, RGBA32ToABGR32, 0, x0, y0, width, height, _fullAlpha);
+			bCopy = _copyBufferFromRdram<u32>(address, pDst, RGBA32ToABGR32, RGBA32ToABGR32Run, 0, x0, y0, width, height, _fullAlpha);
 	} else {
 		if (m_pCurBuffer->m_size == G_IM_SIZ_16b)
 			bCopy = _copyPixelsFromRdram<u16>(address, m_vecAddress, pDst, RGBA16ToABGR32, 1, width, height, _fullAlpha);
@@ -0,0 +1,78 @@
+#include "ReadbackWorker.h"
+
+ReadbackWorker & ReadbackWorker::get()
+{
+	static ReadbackWorker worker;
+	return worker;
+}
+
+void ReadbackWorker::post(Job _convert, Job _finish)
+{
+	finish();
+
+	if (!m_worker.joinable()) {
+		m_stop = false;
+		m_worker = std::thread(&ReadbackWorker::_workerLoop, this);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_convert = std::move(_convert);
+		m_busy = true;
+	}
+	m_finish = std::move(_finish);
+	m_pending = true;
+	m_condition.notify_one();
+}
+
+void ReadbackWorker::finish()
+{
+	if (!m_pending)
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return !m_busy; });
+	}
+	m_pending = false;
+
+	Job finishJob;
+	finishJob.swap(m_finish);
+	if (finishJob)
+		finishJob();
+}
+
+void ReadbackWorker::stop()
+{
+	finish();
+	if (!m_worker.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_one();
+	m_worker.join();
+}
+
+void ReadbackWorker::_workerLoop()
+{
+	while (true) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_stop || m_convert; });
+			if (m_stop)
+				return;
+			job.swap(m_convert);
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busy = false;
+		}
+		m_done.notify_all();
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef ReadbackWorker_H
+#define ReadbackWorker_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Writes asynchronous frame buffer readbacks to RDRAM off the render thread.
+// One job is in flight at a time. Its finishing step runs on the render thread
+// when the next job is posted or when finish() is called. The RSP, RDP and VI
+// entry points call finish() before they return to the CPU core.
+class ReadbackWorker
+{
+public:
+	typedef std::function<void()> Job;
+
+	void post(Job _convert, Job _finish);
+	// Wait for the job in flight, then run its finishing step.
+	void finish();
+	void stop();
+
+	static ReadbackWorker & get();
+
+private:
+	ReadbackWorker() : m_pending(false), m_busy(false), m_stop(false) {}
+	ReadbackWorker(const ReadbackWorker &) = delete;
+	~ReadbackWorker() { stop(); }
+
+	void _workerLoop();
+
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::condition_variable m_done;
+	Job m_convert;
+	Job m_finish;
+	bool m_pending; // render thread only
+	bool m_busy;
+	bool m_stop;
+};
+
+#endif // ReadbackWorker_H
@@ -2,10 +2,15 @@
 #define WriteToRDRAM_H
 
 
+#include <algorithm>
+#include <vector>
 #include "../Types.h"
 
+// runConverter, if provided, converts a run of pixels at the start of each row which begins on an _xor boundary.
+// It must give the same result as converter and _testValue, and returns the number of pixels it has written.
 template <typename TSrc, typename TDst>
-void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testValue, u32 _xor, u32 _width, u32 _height, u32 _numPixels, u32 _startAddress, u32 _bufferAddress, u32 _bufferSize)
+void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testValue, u32 _xor, u32 _width, u32 _height, u32 _numPixels, u32 _startAddress, u32 _bufferAddress, u32 _bufferSize,
+				  u32(*runConverter)(const TSrc * _src, TDst * _dst, u32 _count) = nullptr)
 {
 	u32 chunkStart = ((_startAddress - _bufferAddress) >> (_bufferSize - 1)) % _width;
 	if (chunkStart % 2 != 0) {
@@ -30,7 +35,12 @@ void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testV
 
 	u32 dsty = 0;
 	for (; y < _height; ++y) {
-		for (u32 x = 0; x < _width && numStored < _numPixels; ++x) {
+		u32 x = 0;
+		if (runConverter != nullptr && ((dsty * _width) & _xor) == 0 && numStored < _numPixels) {
+			x = runConverter(_src + y * _width, _dst + dsty * _width, std::min(_width, _numPixels - numStored));
+			numStored += x;
+		}
+		for (; x < _width && numStored < _numPixels; ++x) {
 			c = _src[x + y *_width];
 			if (c != _testValue)
 				_dst[(x + dsty*_width) ^ _xor] = converter(c);
@@ -40,4 +50,40 @@ void writeToRdram(TSrc* _src, TDst* _dst, TDst(*converter)(TSrc _c), TSrc _testV
 	}
 }
 
+// Converter for writeToRdram which marks the written elements in a mask.
+template <typename TSrc, typename TDst>
+TDst writeMask(TSrc)
+{
+	return static_cast<TDst>(~TDst(0));
+}
+
+// Private copy of an RDRAM range, written off the render thread.
+// commit() merges the bytes set in the mask into RDRAM.
+struct RdramStaging
+{
+	u32 address = 0;
+	std::vector<u8> data;
+	std::vector<u8> mask;
+
+	// Covers _size bytes at _address and the words around them, which writeToRdram may touch.
+	void init(u32 _address, u32 _size, u32 _rdramSize)
+	{
+		address = (_address >= 4 ? _address - 4 : 0) & ~3U;
+		const u32 end = std::min((_address + _size + 7) & ~3U, _rdramSize);
+		data.assign(end - address, 0);
+		mask.assign(end - address, 0);
+	}
+
+	u8 * getData(u32 _address) { return data.data() + (_address - address); }
+	u8 * getMask(u32 _address) { return mask.data() + (_address - address); }
+
+	void commit(u8 * _rdram) const
+	{
+		u8 * dst = _rdram + address;
+		const size_t size = data.size();
+		for (size_t i = 0; i < size; ++i)
+			dst[i] = (dst[i] & ~mask[i]) | (data[i] & mask[i]);
+	}
+};
+
 #endif // WriteToRDRAM_H
@@ -9,6 +9,8 @@
 #include "PluginAPI.h"
 #include "RSP.h"
 #include "Graphics/Context.h"
+#include "DisplayListCapture.h"
+#include <main/trace.h>
 
 using namespace graphics;
 
@@ -190,6 +192,7 @@ void SimplifyCycle( CombineCycle *cc, CombinerStage *stage )
 
 graphics::CombinerProgram * Combiner_Compile(CombinerKey key)
 {
+	TRACE_SCOPE("Combiner_Compile");
 	gDPCombine combine;
 
 	combine.mux = key.getMux();
@@ -270,6 +273,7 @@ graphics::CombinerProgram * Combiner_Compile(CombinerKey key)
 
 void CombinerInfo::update()
 {
+	DLC_PROFILE(stCombiner);
 	// TODO: find, why gDP.changed & CHANGED_COMBINE not always works (e.g. Mario Tennis).
 //	if (gDP.changed & CHANGED_COMBINE) {
 		if (gDP.otherMode.cycleType == G_CYC_COPY)
@@ -20,6 +20,7 @@ void Config::resetToDefaults()
 	texture.maxAnisotropy = 0;
 	texture.bilinearMode = BILINEAR_STANDARD;
 	texture.enableHalosRemoval = 0;
+	texture.enableShaderTMEM = 0;
 
 	generalEmulation.enableLOD = 1;
 	generalEmulation.enableNoise = 1;
@@ -27,6 +28,8 @@ void Config::resetToDefaults()
 	generalEmulation.enableShadersStorage = 1;
 	generalEmulation.enableLegacyBlending = 0;
 	generalEmulation.enableHybridFilter = 1;
+	generalEmulation.enableDrawMerging = 0;
+	generalEmulation.enableTexrectBatching = 0;
 	generalEmulation.hacks = 0;
 #if defined(OS_ANDROID) || defined(OS_IOS)
 	generalEmulation.enableFragmentDepthWrite = 0;
@@ -47,6 +50,7 @@ void Config::resetToDefaults()
 	frameBufferEmulation.copyFromRDRAM = 0;
 	frameBufferEmulation.copyAuxToRDRAM = 0;
 	frameBufferEmulation.copyToRDRAM = ctDoubleBuffer;
+	frameBufferEmulation.readbackLatency = 0;
 	frameBufferEmulation.N64DepthCompare = dcDisable;
 	frameBufferEmulation.forceDepthBufferClear = 0;
 	frameBufferEmulation.aspect = a43;
@@ -65,6 +69,7 @@ void Config::resetToDefaults()
 	textureFilter.txEnhancementMode = 0;
 	textureFilter.txDeposterize = 0;
 	textureFilter.txFilterIgnoreBG = 0;
+	textureFilter.txDeferredEnhancement = 0;
 	textureFilter.txCacheSize = 100 * gc_uMegabyte;
 
 	textureFilter.txHiresEnable = 0;
@@ -81,6 +86,8 @@ void Config::resetToDefaults()
 	gammaCorrection.level = 2.0f;
 
 	debug.dumpMode = 0;
+	debug.dlistCapturePath.clear();
+	debug.dlistReplayPath.clear();
 }
 
 bool isHWLightingAllowed()
@@ -90,6 +97,18 @@ bool isHWLightingAllowed()
 	return GBI.isHWLSupported();
 }
 
+u32 Config::getColorReadbackBuffers() const
+{
+	if (frameBufferEmulation.copyToRDRAM >= ctDoubleBuffer && frameBufferEmulation.readbackLatency != 0)
+		return frameBufferEmulation.readbackLatency + 1;
+	return frameBufferEmulation.copyToRDRAM;
+}
+
+u32 Config::getDepthReadbackBuffers() const
+{
+	return frameBufferEmulation.readbackLatency + 1;
+}
+
 void Config::validate()
 {
 	if (frameBufferEmulation.enable != 0 && frameBufferEmulation.N64DepthCompare != dcDisable)
@@ -33,6 +33,7 @@ struct Config
 		f32 maxAnisotropyF;
 		u32 bilinearMode;
 		u32 enableHalosRemoval;
+		u32 enableShaderTMEM;
 	} texture;
 
 	enum TexrectCorrectionMode {
@@ -50,6 +51,8 @@ struct Config
 		u32 enableHybridFilter;
 		u32 enableFragmentDepthWrite;
 		u32 enableBlitScreenWorkaround;
+		u32 enableDrawMerging;
+		u32 enableTexrectBatching;
 		u32 hacks;
 #if defined(OS_ANDROID) || defined(OS_IOS)
 		u32 forcePolygonOffset;
@@ -123,6 +126,7 @@ struct Config
 		u8 copyToRDRAM : 2;
 		u8 copyDepthToRDRAM : 2;
 		u8 copyFromRDRAM : 2;
+		u8 readbackLatency : 2; // Frames asynchronous copies to RDRAM may lag behind rendering. 0: color per copyToRDRAM, depth synchronous
 
 		// Depth buffer copy. For Reshade.
 		u8 copyDepthToMainDepthBuffer : 1;
@@ -135,6 +139,7 @@ struct Config
 		/* FIXME: Remove unused option. */
 		u8 txDeposterize : 1;			// Deposterize texture before enhancement
 		u8 txFilterIgnoreBG : 1;		// Do not apply filtering to backgrounds textures
+		u8 txDeferredEnhancement : 1;	// Show unfiltered texture until worker thread finishes enhancement
 		u32 txCacheSize;			// Cache size in Mbytes
 
 		u8 txHiresEnable : 1;			// Use high-resolution texture packs
@@ -164,10 +169,16 @@ struct Config
 
 	struct {
 		u32 dumpMode;
+		std::string dlistCapturePath;	// Record display lists to this file if not empty
+		std::string dlistReplayPath;	// Replay this capture when a ROM is opened if not empty
 	} debug;
 
 	void resetToDefaults();
 	void validate();
+
+	// Number of buffers in the readback rings. 1 means synchronous copy.
+	u32 getColorReadbackBuffers() const;
+	u32 getDepthReadbackBuffers() const;
 };
 
 #define hack_Ogre64					(1<<0)  //Ogre Battle 64 background copy
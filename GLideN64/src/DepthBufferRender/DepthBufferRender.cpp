@@ -50,6 +50,13 @@ __inline int iceil(int x)
 	return (x >> 16);
 }
 
+// z is stepped with wrap-around, negative values clamp to the first LUT entry
+__inline u16 encodeZ(u32 z, const u16 * zLUT)
+{
+	const int trueZ = static_cast<int>(z);
+	return zLUT[trueZ < 0 ? 0 : trueZ >> 13];
+}
+
 static
 void RightSection(void)
 {
@@ -217,18 +224,13 @@ void Rasterize(vertexi * vtx, int vertices, int dzdx)
 
 			shift = x1 + y1*depthBufferWidth;
 			//draw to depth buffer
-			int trueZ;
-			int idx;
-			u16 encodedZ;
+			u32 uz = static_cast<u32>(z);
 			for (int x = 0; x < width; x++)	{
-				trueZ = z / 8192;
-				if (trueZ < 0)
-					trueZ = 0;
-				encodedZ = zLUT[trueZ];
-				idx = (shift + x) ^ 1;
+				const u16 encodedZ = encodeZ(uz, zLUT);
+				const int idx = (shift + x) ^ 1;
 				if (encodedZ < destptr[idx])
 					destptr[idx] = encodedZ;
-				z = std::min(z + dzdx, 0x7fffffff);
+				uz += static_cast<u32>(dzdx);
 			}
 		}
 
@@ -0,0 +1,24 @@
+// Test stand-in for the plugin's DepthBuffer.h, only what DepthBufferRender.cpp uses
+#ifndef DEPTHBUFFER_H
+#define DEPTHBUFFER_H
+
+#include "Types.h"
+
+struct DepthBuffer
+{
+	u32 m_address, m_width;
+};
+
+class DepthBufferList
+{
+public:
+	DepthBuffer * getCurrent() const { return m_pCurrent; }
+	const u16 * const getZLUT() const { return m_pzLUT; }
+
+	DepthBuffer * m_pCurrent;
+	u16 * m_pzLUT;
+};
+
+DepthBufferList & depthBufferList();
+
+#endif
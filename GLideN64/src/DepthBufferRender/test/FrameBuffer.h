@@ -0,0 +1,5 @@
+// Test stand-in for the plugin's FrameBuffer.h, DepthBufferRender.cpp needs nothing from it
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#endif
@@ -0,0 +1,9 @@
+// Test stand-in for the plugin's N64.h, only what DepthBufferRender.cpp uses
+#ifndef N64_H
+#define N64_H
+
+#include "Types.h"
+
+extern u8 *RDRAM;
+
+#endif
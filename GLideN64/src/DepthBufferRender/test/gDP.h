@@ -0,0 +1,20 @@
+// Test stand-in for the plugin's gDP.h, only what DepthBufferRender.cpp uses
+#ifndef GDP_H
+#define GDP_H
+
+#include "Types.h"
+
+struct gDPScissor
+{
+	f32 ulx, uly, lrx, lry;
+};
+
+struct gDPInfo
+{
+	gDPScissor scissor;
+	u32 depthImageAddress;
+};
+
+extern gDPInfo gDP;
+
+#endif
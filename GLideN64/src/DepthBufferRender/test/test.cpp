@@ -0,0 +1,198 @@
+// Software depth render test
+//
+// Rasterizes a fixed pseudo-random triangle stream with the per-pixel writer
+// in reference.cpp and with the span writer in DepthBufferRender.cpp,
+// then compares the two depth images after every batch.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "N64.h"
+#include "gDP.h"
+#include "DepthBuffer.h"
+#include "DepthBufferRender.h"
+
+namespace reference {
+void Rasterize(vertexi * vtx, int vertices, int dzdx);
+}
+
+u8 *RDRAM = nullptr;
+gDPInfo gDP;
+
+static DepthBuffer depthBuffer;
+static DepthBufferList depthList;
+
+DepthBufferList & depthBufferList()
+{
+	return depthList;
+}
+
+static const u32 WIDTH = 320;
+static const u32 HEIGHT = 240;
+static const u32 NUM_BATCHES = 2000;
+static const u16 CLEAR_DEPTH = 0xFFFC;
+
+// Same table as DepthBufferList::DepthBufferList()
+static
+void initZLUT(std::vector<u16> & _zLUT)
+{
+	_zLUT.resize(0x40000);
+	for (int i = 0; i < 0x40000; i++) {
+		u32 exponent = 0;
+		u32 testbit = 1 << 17;
+		while ((i & testbit) && (exponent < 7)) {
+			exponent++;
+			testbit = 1 << (17 - exponent);
+		}
+
+		const u32 mantissa = (i >> (6 - (6 < exponent ? 6 : exponent))) & 0x7ff;
+		_zLUT[i] = (u16)(((exponent << 11) | mantissa) << 2);
+	}
+}
+
+static u32 seed = 0x12345678;
+
+static
+u32 nextRandom()
+{
+	seed = seed * 1664525U + 1013904223U;
+	return seed >> 8;
+}
+
+static
+f32 randomRange(f32 _min, f32 _max)
+{
+	return _min + (_max - _min) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+static
+int toFixed16(f32 _v)
+{
+	return (int)(_v * 65536.0f);
+}
+
+struct Polygon
+{
+	vertexi vtx[3];
+	int numVertex;
+	int dzdx;
+};
+
+static
+Polygon makePolygon(f32 _maxSize)
+{
+	Polygon poly;
+	const f32 cx = randomRange(-32.0f, WIDTH + 32.0f);
+	const f32 cy = randomRange(-32.0f, HEIGHT + 32.0f);
+	f32 x[3], y[3], z[3];
+	for (int k = 0; k < 3; ++k) {
+		x[k] = cx + randomRange(-_maxSize, _maxSize);
+		y[k] = cy + randomRange(-_maxSize, _maxSize);
+		// Slightly below zero to cover the clamp to the first LUT entry
+		z[k] = randomRange(-500.0f, 30000.0f);
+	}
+
+	// Depth plane gradient along x, bounded so z stays in range over a whole span
+	const f32 det = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	f32 dzdx = det == 0.0f ? 0.0f : ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / det;
+	dzdx = dzdx < -5.0f ? -5.0f : (dzdx > 5.0f ? 5.0f : dzdx);
+	poly.dzdx = toFixed16(dzdx);
+
+	// Rasterize() draws clockwise polygons, keep a few of the others too
+	const bool flip = (det < 0.0f) != ((nextRandom() & 15) == 0);
+	for (int k = 0; k < 3; ++k) {
+		const int idx = flip ? 2 - k : k;
+		poly.vtx[k].x = toFixed16(x[idx]);
+		poly.vtx[k].y = toFixed16(y[idx]);
+		poly.vtx[k].z = toFixed16(z[idx]);
+	}
+	poly.numVertex = 3;
+	return poly;
+}
+
+static
+void setScissor()
+{
+	if ((nextRandom() & 3) != 0) {
+		gDP.scissor.ulx = 0.0f;
+		gDP.scissor.uly = 0.0f;
+		gDP.scissor.lrx = (f32)WIDTH;
+		gDP.scissor.lry = (f32)HEIGHT;
+		return;
+	}
+	gDP.scissor.ulx = (f32)(nextRandom() % (WIDTH / 2));
+	gDP.scissor.uly = (f32)(nextRandom() % (HEIGHT / 2));
+	gDP.scissor.lrx = gDP.scissor.ulx + 1.0f + (f32)(nextRandom() % (WIDTH - (u32)gDP.scissor.ulx));
+	gDP.scissor.lry = gDP.scissor.uly + 1.0f + (f32)(nextRandom() % (HEIGHT - (u32)gDP.scissor.uly));
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<u16> zLUT;
+	initZLUT(zLUT);
+	depthBuffer.m_address = 0;
+	depthBuffer.m_width = WIDTH;
+	depthList.m_pCurrent = &depthBuffer;
+	depthList.m_pzLUT = zLUT.data();
+	gDP.depthImageAddress = 0;
+
+	// Spans may touch the pixel after the last one through the halfword swap
+	const size_t bufferSize = WIDTH * HEIGHT + 2;
+	std::vector<u16> refDepth(bufferSize, CLEAR_DEPTH);
+	std::vector<u16> newDepth(bufferSize, CLEAR_DEPTH);
+	std::vector<Polygon> polygons;
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::duration refTime(0), newTime(0);
+	u64 written = 0;
+
+	for (u32 batch = 0; batch < NUM_BATCHES; ++batch) {
+		if (batch % 16 == 0) {
+			std::fill(refDepth.begin(), refDepth.end(), CLEAR_DEPTH);
+			std::fill(newDepth.begin(), newDepth.end(), CLEAR_DEPTH);
+		}
+		setScissor();
+
+		// Mostly small triangles, every eighth batch with large ones
+		const bool large = batch % 8 == 7;
+		const u32 count = large ? 8 + nextRandom() % 32 : 1 + nextRandom() % 200;
+		polygons.clear();
+		for (u32 i = 0; i < count; ++i)
+			polygons.push_back(makePolygon(large ? 300.0f : randomRange(1.0f, 40.0f)));
+
+		Clock::time_point start = Clock::now();
+		RDRAM = reinterpret_cast<u8*>(refDepth.data());
+		for (Polygon & poly : polygons)
+			reference::Rasterize(poly.vtx, poly.numVertex, poly.dzdx);
+		refTime += Clock::now() - start;
+
+		start = Clock::now();
+		RDRAM = reinterpret_cast<u8*>(newDepth.data());
+		for (Polygon & poly : polygons)
+			Rasterize(poly.vtx, poly.numVertex, poly.dzdx);
+		newTime += Clock::now() - start;
+
+		for (size_t i = 0; i < bufferSize; ++i) {
+			if (refDepth[i] != newDepth[i]) {
+				printf("batch %u: depth differs at pixel %u: reference %04x, new %04x\n",
+					batch, (u32)i, refDepth[i], newDepth[i]);
+				return 1;
+			}
+			if (refDepth[i] != CLEAR_DEPTH)
+				++written;
+		}
+	}
+
+	if (written == 0) {
+		printf("no depth was written, the test stream is broken\n");
+		return 1;
+	}
+
+	printf("%u batches identical, %llu written pixels compared\n", NUM_BATCHES, (unsigned long long)written);
+	printf("reference %lld us, new %lld us\n",
+		(long long)std::chrono::duration_cast<std::chrono::microseconds>(refTime).count(),
+		(long long)std::chrono::duration_cast<std::chrono::microseconds>(newTime).count());
+	return 0;
+}
@@ -0,0 +1,299 @@
+#include <cstring>
+#include "DisplayListCapture.h"
+#include "N64.h"
+#include "RSP.h"
+#include "VI.h"
+#include "Config.h"
+#include "Log.h"
+
+#define DLC_MAGIC 0x43444C47	// "GLDC"
+#define DLC_VERSION 1U
+#define DLC_PAGE_SIZE 0x1000U
+#define DLC_DMEM_SIZE 0x1000U
+#define DLC_HEADER_SIZE 64U
+#define DLC_NUM_VI_REGS 14U
+
+enum DisplayListCaptureRecord {
+	dlcPages = 1,
+	dlcDList = 2,
+	dlcScreen = 3
+};
+
+static
+u32 ** _viRegs(u32 ** _regs)
+{
+	_regs[0] = REG.VI_STATUS;
+	_regs[1] = REG.VI_ORIGIN;
+	_regs[2] = REG.VI_WIDTH;
+	_regs[3] = REG.VI_INTR;
+	_regs[4] = REG.VI_V_CURRENT_LINE;
+	_regs[5] = REG.VI_TIMING;
+	_regs[6] = REG.VI_V_SYNC;
+	_regs[7] = REG.VI_H_SYNC;
+	_regs[8] = REG.VI_LEAP;
+	_regs[9] = REG.VI_H_START;
+	_regs[10] = REG.VI_V_START;
+	_regs[11] = REG.VI_V_BURST;
+	_regs[12] = REG.VI_X_SCALE;
+	_regs[13] = REG.VI_Y_SCALE;
+	return _regs;
+}
+
+DisplayListCapture & DisplayListCapture::get()
+{
+	static DisplayListCapture capture;
+	return capture;
+}
+
+void DisplayListCapture::start()
+{
+	if (isCapturing() || config.debug.dlistCapturePath.empty())
+		return;
+
+	m_file.open(config.debug.dlistCapturePath, std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open()) {
+		LOG(LOG_ERROR, "Can't open display list capture file %s\n", config.debug.dlistCapturePath.c_str());
+		return;
+	}
+
+	const u32 header[3] = { DLC_MAGIC, DLC_VERSION, RDRAMSize + 1 };
+	m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	m_file.write(reinterpret_cast<const char*>(HEADER), DLC_HEADER_SIZE);
+
+	// The first record holds every non-zero page of RDRAM.
+	m_shadow.assign(RDRAMSize + 1, 0);
+	LOG(LOG_VERBOSE, "Capturing display lists to %s\n", config.debug.dlistCapturePath.c_str());
+}
+
+void DisplayListCapture::stop()
+{
+	if (!isCapturing())
+		return;
+	m_file.close();
+	m_shadow.clear();
+	m_shadow.shrink_to_fit();
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+}
+
+void DisplayListCapture::_writeRecord(u32 _type, const void * _pData, u32 _size)
+{
+	const u32 recordHeader[2] = { _type, _size };
+	m_file.write(reinterpret_cast<const char*>(recordHeader), sizeof(recordHeader));
+	m_file.write(reinterpret_cast<const char*>(_pData), _size);
+}
+
+void DisplayListCapture::_writePages()
+{
+	m_buffer.resize(sizeof(u32));
+	u32 count = 0;
+	for (u32 addr = 0; addr + DLC_PAGE_SIZE <= m_shadow.size(); addr += DLC_PAGE_SIZE) {
+		if (memcmp(RDRAM + addr, m_shadow.data() + addr, DLC_PAGE_SIZE) == 0)
+			continue;
+		memcpy(m_shadow.data() + addr, RDRAM + addr, DLC_PAGE_SIZE);
+		const size_t offset = m_buffer.size();
+		m_buffer.resize(offset + sizeof(u32) + DLC_PAGE_SIZE);
+		memcpy(m_buffer.data() + offset, &addr, sizeof(u32));
+		memcpy(m_buffer.data() + offset + sizeof(u32), RDRAM + addr, DLC_PAGE_SIZE);
+		++count;
+	}
+	if (count == 0)
+		return;
+	memcpy(m_buffer.data(), &count, sizeof(u32));
+	_writeRecord(dlcPages, m_buffer.data(), static_cast<u32>(m_buffer.size()));
+}
+
+void DisplayListCapture::onProcessDList()
+{
+	if (!isCapturing())
+		return;
+	_writePages();
+	_writeRecord(dlcDList, DMEM, DLC_DMEM_SIZE);
+}
+
+void DisplayListCapture::onUpdateScreen()
+{
+	if (!isCapturing())
+		return;
+	u32 * regs[DLC_NUM_VI_REGS];
+	u32 values[DLC_NUM_VI_REGS];
+	_viRegs(regs);
+	for (u32 i = 0; i < DLC_NUM_VI_REGS; ++i)
+		values[i] = *regs[i];
+	_writePages();
+	_writeRecord(dlcScreen, values, sizeof(values));
+}
+
+DisplayListCapture::Scope::Scope(Stage _stage)
+	: m_prev(stCommands)
+	, m_active(dlCapture().isProfiling())
+{
+	if (!m_active)
+		return;
+	m_prev = dlCapture().m_stage;
+	dlCapture()._enterStage(_stage);
+}
+
+DisplayListCapture::Scope::~Scope()
+{
+	if (m_active)
+		dlCapture()._enterStage(m_prev);
+}
+
+void DisplayListCapture::_enterStage(Stage _stage)
+{
+	const Clock::time_point now = Clock::now();
+	m_frameTime[m_stage] += std::chrono::duration_cast<std::chrono::microseconds>(now - m_stageStart).count();
+	m_stageStart = now;
+	m_stage = _stage;
+}
+
+void DisplayListCapture::_printFrame(FILE * _report, u32 _frame)
+{
+	u64 total = 0;
+	for (u32 i = 0; i < stCount; ++i) {
+		total += m_frameTime[i];
+		m_totalTime[i] += m_frameTime[i];
+	}
+	fprintf(_report, "frame %u: %llu us (commands %llu, textures %llu, combiner %llu, draw %llu, screen %llu)\n",
+		_frame, (unsigned long long)total,
+		(unsigned long long)m_frameTime[stCommands], (unsigned long long)m_frameTime[stTextures],
+		(unsigned long long)m_frameTime[stCombiner], (unsigned long long)m_frameTime[stDraw],
+		(unsigned long long)m_frameTime[stScreen]);
+	memset(m_frameTime, 0, sizeof(m_frameTime));
+}
+
+bool DisplayListCapture::replay(const char * _fileName, FILE * _report)
+{
+	std::ifstream fin(_fileName, std::ios::binary);
+	if (!fin.is_open())
+		return false;
+
+	// RDRAMSize holds the last valid RDRAM address.
+	const u32 rdramSize = RDRAMSize + 1;
+	u32 header[3];
+	u8 romHeader[DLC_HEADER_SIZE];
+	fin.read(reinterpret_cast<char*>(header), sizeof(header));
+	fin.read(reinterpret_cast<char*>(romHeader), DLC_HEADER_SIZE);
+	if (!fin || header[0] != DLC_MAGIC || header[1] != DLC_VERSION || header[2] > rdramSize) {
+		LOG(LOG_ERROR, "%s is not a usable display list capture\n", _fileName);
+		return false;
+	}
+	if (memcmp(romHeader, HEADER, DLC_HEADER_SIZE) != 0) {
+		LOG(LOG_ERROR, "%s was captured from a different ROM\n", _fileName);
+		return false;
+	}
+
+	// Replay overwrites emulator memory. Put it back afterwards.
+	u32 * regs[DLC_NUM_VI_REGS];
+	u32 savedRegs[DLC_NUM_VI_REGS];
+	_viRegs(regs);
+	for (u32 i = 0; i < DLC_NUM_VI_REGS; ++i)
+		savedRegs[i] = *regs[i];
+	const std::vector<u8> savedRdram(RDRAM, RDRAM + rdramSize);
+	const std::vector<u8> savedDmem(DMEM, DMEM + DLC_DMEM_SIZE);
+
+	memset(m_frameTime, 0, sizeof(m_frameTime));
+	memset(m_totalTime, 0, sizeof(m_totalTime));
+	u32 frame = 0;
+	bool valid = true;
+
+	const u64 pageRecordSize = sizeof(u32) + DLC_PAGE_SIZE;
+	const u64 maxRecordSize = sizeof(u32) + (rdramSize / DLC_PAGE_SIZE) * pageRecordSize;
+	std::vector<u8> payload;
+	u32 recordHeader[2];
+	while (valid && fin.read(reinterpret_cast<char*>(recordHeader), sizeof(recordHeader))) {
+		if (recordHeader[1] > maxRecordSize) {
+			valid = false;
+			break;
+		}
+		payload.resize(recordHeader[1]);
+		if (!fin.read(reinterpret_cast<char*>(payload.data()), recordHeader[1])) {
+			valid = false;
+			break;
+		}
+
+		switch (recordHeader[0]) {
+		case dlcPages:
+		{
+			u32 count = 0;
+			if (recordHeader[1] >= sizeof(u32))
+				memcpy(&count, payload.data(), sizeof(u32));
+			if (recordHeader[1] < sizeof(u32) || sizeof(u32) + count * pageRecordSize > recordHeader[1]) {
+				valid = false;
+				break;
+			}
+			const u8 * pPage = payload.data() + sizeof(u32);
+			for (u32 i = 0; i < count; ++i, pPage += pageRecordSize) {
+				u32 addr;
+				memcpy(&addr, pPage, sizeof(u32));
+				if (addr <= rdramSize - DLC_PAGE_SIZE)
+					memcpy(RDRAM + addr, pPage + sizeof(u32), DLC_PAGE_SIZE);
+			}
+		}
+		break;
+		case dlcDList:
+			if (recordHeader[1] < DLC_DMEM_SIZE) {
+				valid = false;
+				break;
+			}
+			memcpy(DMEM, payload.data(), DLC_DMEM_SIZE);
+			m_profiling = true;
+			m_stage = stCommands;
+			m_stageStart = Clock::now();
+			RSP_ProcessDList();
+			_enterStage(stCommands);
+			m_profiling = false;
+		break;
+		case dlcScreen:
+			if (recordHeader[1] < DLC_NUM_VI_REGS * sizeof(u32)) {
+				valid = false;
+				break;
+			}
+			for (u32 i = 0; i < DLC_NUM_VI_REGS; ++i)
+				memcpy(regs[i], payload.data() + i * sizeof(u32), sizeof(u32));
+			m_profiling = true;
+			m_stage = stScreen;
+			m_stageStart = Clock::now();
+			VI_UpdateScreen();
+			_enterStage(stScreen);
+			m_profiling = false;
+			_printFrame(_report, frame++);
+		break;
+		}
+	}
+	if (!valid)
+		LOG(LOG_ERROR, "%s is truncated or corrupt after frame %u\n", _fileName, frame);
+
+	memcpy(RDRAM, savedRdram.data(), rdramSize);
+	memcpy(DMEM, savedDmem.data(), DLC_DMEM_SIZE);
+	for (u32 i = 0; i < DLC_NUM_VI_REGS; ++i)
+		*regs[i] = savedRegs[i];
+
+	u64 total = 0;
+	for (u32 i = 0; i < stCount; ++i)
+		total += m_totalTime[i];
+	fprintf(_report, "%u frames: %llu us (commands %llu, textures %llu, combiner %llu, draw %llu, screen %llu)\n",
+		frame, (unsigned long long)total,
+		(unsigned long long)m_totalTime[stCommands], (unsigned long long)m_totalTime[stTextures],
+		(unsigned long long)m_totalTime[stCombiner], (unsigned long long)m_totalTime[stDraw],
+		(unsigned long long)m_totalTime[stScreen]);
+	return valid;
+}
+
+bool DisplayListCapture::replayConfigured()
+{
+	if (config.debug.dlistReplayPath.empty())
+		return false;
+
+	const std::string reportPath = config.debug.dlistReplayPath + ".txt";
+	FILE * report = fopen(reportPath.c_str(), "w");
+	if (report == nullptr) {
+		LOG(LOG_ERROR, "Can't open display list replay report %s\n", reportPath.c_str());
+		return false;
+	}
+	LOG(LOG_VERBOSE, "Replaying display lists from %s\n", config.debug.dlistReplayPath.c_str());
+	replay(config.debug.dlistReplayPath.c_str(), report);
+	fclose(report);
+	return true;
+}
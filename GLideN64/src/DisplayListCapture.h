@@ -0,0 +1,95 @@
+#ifndef DISPLAYLISTCAPTURE_H
+#define DISPLAYLISTCAPTURE_H
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+// Records everything RSP_ProcessDList() and VI_UpdateScreen() read from the
+// emulator, so the plugin can be benchmarked without CPU emulation.
+//
+// File layout, all values in host byte order:
+//   header: magic, version, RDRAM size, ROM header (64 bytes)
+//   records: type, payload size, payload
+//     dlcPages  - count, then count x (RDRAM address, 4 KB page) changed since the previous record
+//     dlcDList  - DMEM (4 KB), then RSP_ProcessDList() is called
+//     dlcScreen - VI registers, then VI_UpdateScreen() is called
+class DisplayListCapture
+{
+public:
+	enum Stage {
+		stCommands = 0,	// gSP/gDP command processing
+		stTextures,		// texture cache lookups and loads
+		stCombiner,		// combiner selection and compilation
+		stDraw,			// vertex upload and draw calls
+		stScreen,		// VI_UpdateScreen
+		stCount
+	};
+
+	void start();
+	void stop();
+	bool isCapturing() const { return m_file.is_open(); }
+
+	void onProcessDList();
+	void onUpdateScreen();
+
+	// Feed a capture back through the plugin. The caller must have initialized
+	// the plugin with a GFX_INFO whose RDRAM is at least as large as the captured one.
+	// Writes per-frame timings to _report. Emulator RDRAM, DMEM and VI registers
+	// are restored afterwards.
+	bool replay(const char * _fileName, FILE * _report);
+
+	// Replay config.debug.dlistReplayPath, if set, with the report written next to it.
+	// Returns true if a replay ran and the plugin state needs to be reset.
+	bool replayConfigured();
+
+	bool isProfiling() const { return m_profiling; }
+
+	// Charge time spent until the end of the scope to _stage, excluding nested scopes.
+	class Scope
+	{
+	public:
+		Scope(Stage _stage);
+		~Scope();
+
+	private:
+		Stage m_prev;
+		bool m_active;
+	};
+
+	static DisplayListCapture & get();
+
+private:
+	DisplayListCapture() : m_profiling(false), m_stage(stCommands) {}
+	DisplayListCapture(const DisplayListCapture &) = delete;
+
+	void _writePages();
+	void _writeRecord(u32 _type, const void * _pData, u32 _size);
+	void _enterStage(Stage _stage);
+	void _printFrame(FILE * _report, u32 _frame);
+
+	typedef std::chrono::steady_clock Clock;
+
+	std::ofstream m_file;
+	std::vector<u8> m_shadow;	// RDRAM as of the previous record
+	std::vector<u8> m_buffer;
+
+	bool m_profiling;
+	Stage m_stage;
+	Clock::time_point m_stageStart;
+	u64 m_frameTime[stCount];
+	u64 m_totalTime[stCount];
+};
+
+inline
+DisplayListCapture & dlCapture()
+{
+	return DisplayListCapture::get();
+}
+
+#define DLC_PROFILE(_stage) DisplayListCapture::Scope dlcScope(DisplayListCapture::_stage)
+
+#endif // DISPLAYLISTCAPTURE_H
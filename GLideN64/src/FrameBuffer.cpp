@@ -22,14 +22,65 @@
 #include "BufferCopy/ColorBufferToRDRAM.h"
 #include "BufferCopy/DepthBufferToRDRAM.h"
 #include "BufferCopy/RDRAMtoColorBuffer.h"
+#include "BufferCopy/ReadbackWorker.h"
 
 #include <Graphics/Context.h>
 #include <Graphics/Parameters.h>
 #include "DisplayWindow.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 using namespace std;
 using namespace graphics;
 
+// Mask which ignores the coverage bits of RDRAM color pixels.
+static const u32 validityMask = 0xFFFEFFFE;
+
+// Count dwords of _pData which differ from _pRef after validityMask is applied.
+// _pRef is either array of _count dwords or, if _refStride is 0, a single dword.
+static
+u32 _countWrongDwords(const u32 * _pData, const u32 * _pRef, u32 _refStride, u32 _count)
+{
+	u32 i = 0;
+	u32 wrong = 0;
+#if defined(__SSE2__)
+	const __m128i mask = _mm_set1_epi32(validityMask);
+	const __m128i ref = _mm_and_si128(_mm_set1_epi32(*_pRef), mask);
+	__m128i equal = _mm_setzero_si128();
+	for (; i + 4 <= _count; i += 4) {
+		const __m128i data = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pData + i)), mask);
+		const __m128i test = _refStride == 0 ? ref :
+			_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_pRef + i)), mask);
+		// Equal lanes are -1, so subtraction counts them.
+		equal = _mm_sub_epi32(equal, _mm_cmpeq_epi32(data, test));
+	}
+	u32 lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), equal);
+	wrong = i - (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#elif defined(__ARM_NEON)
+	const uint32x4_t mask = vdupq_n_u32(validityMask);
+	const uint32x4_t ref = vandq_u32(vdupq_n_u32(*_pRef), mask);
+	uint32x4_t equal = vdupq_n_u32(0);
+	for (; i + 4 <= _count; i += 4) {
+		const uint32x4_t data = vandq_u32(vld1q_u32(_pData + i), mask);
+		const uint32x4_t test = _refStride == 0 ? ref : vandq_u32(vld1q_u32(_pRef + i), mask);
+		equal = vsubq_u32(equal, vceqq_u32(data, test));
+	}
+	u32 lanes[4];
+	vst1q_u32(lanes, equal);
+	wrong = i - (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+#endif
+	for (; i < _count; ++i) {
+		if ((_pData[i] & validityMask) != (_pRef[i * _refStride] & validityMask))
+			++wrong;
+	}
+	return wrong;
+}
+
 FrameBuffer::FrameBuffer()
 	: m_startAddress(0)
 	, m_endAddress(0)
@@ -279,10 +330,13 @@ bool FrameBuffer::isValid(bool _forceCheck) const
 		m_validityChecked = dwnd().getBuffersSwapCount();
 	}
 
+	// RDRAM must hold the last asynchronous copy before it is compared with the snapshot.
+	ReadbackWorker::get().finish();
+
 	const u32 * const pData = (const u32*)RDRAM;
 
 	if (m_cleared) {
-		const u32 testColor = m_clearParams.fillcolor & 0xFFFEFFFE;
+		const u32 testColor = m_clearParams.fillcolor;
 		const u32 stride = m_width << m_size >> 1;
 		const s32 lry = (s32)_cutHeight(m_startAddress, m_clearParams.lry, stride);
 		if (lry == 0)
@@ -292,31 +346,26 @@ bool FrameBuffer::isValid(bool _forceCheck) const
 		const u32 start = (m_startAddress >> 2) + m_clearParams.uly * ci_width_in_dwords;
 		const u32 * dst = pData + start;
 		u32 wrongPixels = 0;
-		for (s32 y = m_clearParams.uly; y < lry; ++y) {
-			for (s32 x = m_clearParams.ulx; x < m_clearParams.lrx; ++x) {
-				if ((dst[x] & 0xFFFEFFFE) != testColor)
-					++wrongPixels;
+		if (m_clearParams.lrx > m_clearParams.ulx) {
+			const u32 rowDwords = m_clearParams.lrx - m_clearParams.ulx;
+			for (s32 y = m_clearParams.uly; y < lry; ++y) {
+				wrongPixels += _countWrongDwords(dst + m_clearParams.ulx, &testColor, 0, rowDwords);
+				dst += ci_width_in_dwords;
 			}
-			dst += ci_width_in_dwords;
 		}
 		return wrongPixels < (m_endAddress - m_startAddress) / 400; // threshold level 1% of dwords
 	} else if (m_fingerprint) {
 			//check if our fingerprint is still there
 			u32 start = m_startAddress >> 2;
 			for (u32 i = 0; i < 4; ++i)
-				if ((pData[start++] & 0xFFFEFFFE) != (fingerprint[i] & 0xFFFEFFFE))
+				if ((pData[start++] & validityMask) != (fingerprint[i] & validityMask))
 					return false;
 			return true;
 	} else if (!m_RdramCopy.empty()) {
 		const u32 * const pCopy = reinterpret_cast<const u32* >(m_RdramCopy.data());
 		const u32 size = static_cast<u32>(m_RdramCopy.size());
 		const u32 size_dwords = size >> 2;
-		u32 start = m_startAddress >> 2;
-		u32 wrongPixels = 0;
-		for (u32 i = 0; i < size_dwords; ++i) {
-			if ((pData[start++] & 0xFFFEFFFE) != (pCopy[i] & 0xFFFEFFFE))
-				++wrongPixels;
-		}
+		const u32 wrongPixels = _countWrongDwords(pData + (m_startAddress >> 2), pCopy, 1, size_dwords);
 		return wrongPixels < size / 400; // threshold level 1% of dwords
 	}
 	return true; // No data to decide
@@ -348,15 +348,37 @@ void GBIInfo::loadMicrocode(u32 uc_start, u32 uc_dstart, u16 uc_dsize)
 	if (_makeExistingMicrocodeCurrent(uc_start, uc_dstart, uc_dsize))
 		return;
 
+	const u32 uc_crc = CRC_Calculate_Strict( 0xFFFFFFFF, &RDRAM[uc_start & 0x1FFFFFFF], 4096 );
+
+	// Detection reads the first 2 KB of the data segment, see the text search below
+	char uc_data[2048];
+	UnswapCopyWrap(RDRAM, uc_dstart & 0x1FFFFFFF, (u8*)uc_data, 0, 0x7FF, 2048);
+	const u32 uc_dcrc = CRC_Calculate_Strict( 0xFFFFFFFF, uc_data, 2048 );
+
+	// Same ucode already identified at another address: reuse its detection results
+	auto known = std::find_if(m_list.begin(), m_list.end(), [=](const MicrocodeInfo& info) {
+		return info.crc == uc_crc && info.dataCrc == uc_dcrc && info.dataSize == uc_dsize && info.type != NONE;
+	});
+	if (known != m_list.end()) {
+		MicrocodeInfo info = *known;
+		info.address = uc_start;
+		info.dataAddress = uc_dstart;
+		m_list.push_front(info);
+		LOG(LOG_VERBOSE, "Load known microcode type: %d crc: 0x%08x romname: %s", info.type, uc_crc, RSP.romname);
+		_makeCurrent(&m_list.front());
+		return;
+	}
+
 	m_list.emplace_front();
 	MicrocodeInfo & current = m_list.front();
 	current.address = uc_start;
 	current.dataAddress = uc_dstart;
 	current.dataSize = uc_dsize;
+	current.crc = uc_crc;
+	current.dataCrc = uc_dcrc;
 	current.type = NONE;
 
 	// See if we can identify it by CRC
-	const u32 uc_crc = CRC_Calculate_Strict( 0xFFFFFFFF, &RDRAM[uc_start & 0x1FFFFFFF], 4096 );
 	SpecialMicrocodeInfo infoToSearch;
 	infoToSearch.crc = uc_crc;
 	auto it = std::lower_bound(specialMicrocodes.begin(), specialMicrocodes.end(), infoToSearch,
@@ -373,8 +395,6 @@ void GBIInfo::loadMicrocode(u32 uc_start, u32 uc_dstart, u16 uc_dsize)
 	}
 
 	// See if we can identify it by text
-	char uc_data[2048];
-	UnswapCopyWrap(RDRAM, uc_dstart & 0x1FFFFFFF, (u8*)uc_data, 0, 0x7FF, 2048);
 	char uc_str[256];
 	strcpy(uc_str, "Not Found");
 
@@ -481,6 +481,8 @@ struct MicrocodeInfo
 	u32 address = 0;
 	u32 dataAddress = 0;;
 	u16 dataSize = 0;
+	u32 crc = 0;
+	u32 dataCrc = 0;
 	u32 type = NONE;
 	bool NoN = false;
 	bool Rej = false;
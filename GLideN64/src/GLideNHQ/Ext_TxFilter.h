@@ -165,6 +165,13 @@ txfilter_reloadhirestex();
 TAPI void TAPIENTRY
 txfilter_dumpcache(void);
 
+/* Hold the filter lock while reading GHQTexInfo::data from another thread. */
+TAPI void TAPIENTRY
+txfilter_lock(void);
+
+TAPI void TAPIENTRY
+txfilter_unlock(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,14 +25,13 @@
 #pragma warning(disable: 4786)
 #endif
 
-#include <functional>
-#include <thread>
 #include <stdlib.h>
 #include <assert.h>
 
 #include "TxFilter.h"
 #include "TextureFilters.h"
 #include "TxDbg.h"
+#include "TxThreadPool.h"
 #include "bldno.h"
 
 void TxFilter::clear()
@@ -43,6 +42,9 @@ void TxFilter::clear()
 	/* clear texture cache */
 	delete _txTexCache;
 
+	/* stop filter workers */
+	TxThreadPool::getInstance()->shutdown();
+
 	/* free memory */
 	TxMemBuf::getInstance()->shutdown();
 
@@ -104,6 +106,9 @@ TxFilter::TxFilter(int maxwidth,
 	/* get number of CPU cores. */
 	_numcore = TxUtil::getNumberofProcessors();
 
+	/* spawn filter workers once, they are reused by every filter pass */
+	TxThreadPool::getInstance()->init(_numcore);
+
 	_initialized = 0;
 
 	_tex1 = nullptr;
@@ -297,38 +302,27 @@ TxFilter::filter(uint8 *src, int srcwidth, int srcheight, ColorFormat srcformat,
 
 				unsigned int numcore = _numcore;
 				unsigned int blkrow = 0;
-				while (numcore > 1 && blkrow == 0) {
+				while (numcore > 1) {
 					blkrow = (srcheight >> 2) / numcore;
+					if (blkrow > 0)
+						break;
 					numcore--;
 				}
 				if (blkrow > 0 && numcore > 1) {
-					//std::thread *thrd[MAX_NUMCORE];
-					unsigned int i;
-					int blkheight = blkrow << 2;
-					unsigned int srcStride = (srcwidth * blkheight) << 2;
-					unsigned int destStride = srcStride * scale * scale;
-					for (i = 0; i < numcore - 1; i++) {/*
-						thrd[i] = new std::thread(std::bind(filter_8888,
-																(uint32*)_texture,
-																srcwidth,
-																blkheight,
-																(uint32*)_tmptex,
-																filter,
-																i));*/
-						_texture += srcStride;
-						_tmptex  += destStride;
-					}/*
-					thrd[i] = new std::thread(std::bind(filter_8888,
-															(uint32*)_texture,
-															srcwidth,
-															srcheight - blkheight * i,
-															(uint32*)_tmptex,
-															filter,
-															i));*/
-					for (i = 0; i < numcore; i++) {
-						//thrd[i]->join();
-						//delete thrd[i];
-					}
+					const int blkheight = blkrow << 2;
+					const unsigned int srcStride = (srcwidth * blkheight) << 2;
+					const unsigned int destStride = srcStride * scale * scale;
+					const unsigned int lastBlk = numcore - 1;
+					const int width = srcwidth;
+					const int height = srcheight;
+					TxThreadPool::getInstance()->run(numcore, [=](uint32 i) {
+						filter_8888((uint32*)(_texture + srcStride * i),
+									width,
+									i == lastBlk ? height - blkheight * i : blkheight,
+									(uint32*)(_tmptex + destStride * i),
+									filter,
+									i);
+					});
 				} else {
 					filter_8888((uint32*)_texture, srcwidth, srcheight, (uint32*)_tmptex, filter, 0);
 				}
@@ -25,10 +25,14 @@
 #pragma warning(disable: 4786)
 #endif
 
+#include <mutex>
 #include "TxFilter.h"
 
 TxFilter *txFilter = nullptr;
 
+/* Serializes access to the filter when textures are enhanced off the render thread. */
+static std::recursive_mutex txFilterMutex;
+
 #ifdef __cplusplus
 extern "C"{
 #endif
@@ -37,6 +41,7 @@ TAPI boolean TAPIENTRY
 txfilter_init(int maxwidth, int maxheight, int maxbpp, int options, int cachesize,
 	const wchar_t * txCachePath, const wchar_t * texPackPath, const wchar_t * ident)
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter) return 0;
 
   txFilter = new TxFilter(maxwidth, maxheight, maxbpp, options, cachesize,
@@ -48,6 +53,7 @@ txfilter_init(int maxwidth, int maxheight, int maxbpp, int options, int cachesiz
 TAPI void TAPIENTRY
 txfilter_shutdown(void)
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter) delete txFilter;
 
   txFilter = nullptr;
@@ -57,6 +63,7 @@ TAPI boolean TAPIENTRY
 txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
 		 uint64 g64crc, GHQTexInfo *info)
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter)
 	return txFilter->filter(src, srcwidth, srcheight, ColorFormat(u32(srcformat)),
 							   g64crc, info);
@@ -67,6 +74,7 @@ txfilter_filter(uint8 *src, int srcwidth, int srcheight, uint16 srcformat,
 TAPI boolean TAPIENTRY
 txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *info)
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter)
 	return txFilter->hirestex(g64crc, r_crc64, palette, info);
 
@@ -76,6 +84,7 @@ txfilter_hirestex(uint64 g64crc, uint64 r_crc64, uint16 *palette, GHQTexInfo *in
 TAPI uint64 TAPIENTRY
 txfilter_checksum(uint8 *src, int width, int height, int size, int rowStride, uint8 *palette)
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter)
 	return txFilter->checksum64(src, width, height, size, rowStride, palette);
 
@@ -85,12 +94,25 @@ txfilter_checksum(uint8 *src, int width, int height, int size, int rowStride, ui
 TAPI boolean TAPIENTRY
 txfilter_reloadhirestex()
 {
+  std::lock_guard<std::recursive_mutex> lock(txFilterMutex);
   if (txFilter)
 	return txFilter->reloadhirestex();
 
   return 0;
 }
 
+TAPI void TAPIENTRY
+txfilter_lock(void)
+{
+  txFilterMutex.lock();
+}
+
+TAPI void TAPIENTRY
+txfilter_unlock(void)
+{
+  txFilterMutex.unlock();
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include "TxQuantize.h"
+#include "TxThreadPool.h"
 
 static const unsigned char One2Eight[2] =
 {
@@ -855,36 +856,23 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 
 		unsigned int numcore = _numcore;
 		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
+		while (numcore > 1) {
 			blkrow = (height >> 2) / numcore;
+			if (blkrow > 0)
+				break;
 			numcore--;
 		}
 		if (blkrow > 0 && numcore > 1) {
-		//	std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
-			unsigned int destStride = srcStride << bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				/*thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));*/
-				src  += srcStride;
-				dest += destStride;
-			}
-			/*thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));*/
-			for (i = 0; i < numcore; i++) {
-			//	thrd[i]->join();
-			//	delete thrd[i];
-			}
+			const int blkheight = blkrow << 2;
+			const unsigned int srcStride = (width * blkheight) << (2 - bpp_shift);
+			const unsigned int destStride = srcStride << bpp_shift;
+			const unsigned int lastBlk = numcore - 1;
+			TxThreadPool::getInstance()->run(numcore, [=](uint32 i) {
+				(*this.*quantizer)((uint32*)(src + srcStride * i),
+								   (uint32*)(dest + destStride * i),
+								   width,
+								   i == lastBlk ? height - blkheight * i : blkheight);
+			});
 		} else {
 			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
 		}
@@ -904,36 +892,23 @@ TxQuantize::quantize(uint8* src, uint8* dest, int width, int height, ColorFormat
 
 		unsigned int numcore = _numcore;
 		unsigned int blkrow = 0;
-		while (numcore > 1 && blkrow == 0) {
+		while (numcore > 1) {
 			blkrow = (height >> 2) / numcore;
+			if (blkrow > 0)
+				break;
 			numcore--;
 		}
 		if (blkrow > 0 && numcore > 1) {
-			//std::thread *thrd[MAX_NUMCORE];
-			unsigned int i;
-			int blkheight = blkrow << 2;
-			unsigned int srcStride = (width * blkheight) << 2;
-			unsigned int destStride = srcStride >> bpp_shift;
-			for (i = 0; i < numcore - 1; i++) {
-				/*thrd[i] = new std::thread(std::bind(quantizer,
-														this,
-														(uint32*)src,
-														(uint32*)dest,
-														width,
-														blkheight));*/
-				src  += srcStride;
-				dest += destStride;
-			}
-			/*thrd[i] = new std::thread(std::bind(quantizer,
-													this,
-													(uint32*)src,
-													(uint32*)dest,
-													width,
-													height - blkheight * i));*/
-			for (i = 0; i < numcore; i++) {
-			//	thrd[i]->join();
-			//	delete thrd[i];
-			}
+			const int blkheight = blkrow << 2;
+			const unsigned int srcStride = (width * blkheight) << 2;
+			const unsigned int destStride = srcStride >> bpp_shift;
+			const unsigned int lastBlk = numcore - 1;
+			TxThreadPool::getInstance()->run(numcore, [=](uint32 i) {
+				(*this.*quantizer)((uint32*)(src + srcStride * i),
+								   (uint32*)(dest + destStride * i),
+								   width,
+								   i == lastBlk ? height - blkheight * i : blkheight);
+			});
 		} else {
 			(*this.*quantizer)((uint32*)src, (uint32*)dest, width, height);
 		}
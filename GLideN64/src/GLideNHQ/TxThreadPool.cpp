@@ -0,0 +1,107 @@
+#include <system_error>
+#include "TxThreadPool.h"
+
+TxThreadPool::TxThreadPool()
+	: _task(nullptr)
+	, _numThreads(1)
+	, _numTasks(0)
+	, _pending(0)
+	, _generation(0)
+	, _stop(false)
+{
+}
+
+TxThreadPool::~TxThreadPool()
+{
+	shutdown();
+}
+
+void
+TxThreadPool::init(uint32 numThreads)
+{
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	if (!_workers.empty() || numThreads < 2)
+		return;
+
+	_stop = false;
+	_numThreads = numThreads;
+	try {
+		for (uint32 i = 1; i < numThreads; ++i)
+			_workers.emplace_back(&TxThreadPool::_workerLoop, this, i, _generation);
+	} catch (const std::system_error &) {
+		/* could not spawn all threads, run with the ones we have */
+		_numThreads = static_cast<uint32>(_workers.size()) + 1;
+	}
+}
+
+void
+TxThreadPool::shutdown()
+{
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_startCv.notify_all();
+	for (auto & worker : _workers)
+		worker.join();
+	_workers.clear();
+	_numThreads = 1;
+}
+
+void
+TxThreadPool::run(uint32 numTasks, const Task & task)
+{
+	std::lock_guard<std::mutex> runLock(_runMutex);
+	if (numTasks > _numThreads)
+		numTasks = _numThreads;
+
+	if (numTasks < 2) {
+		if (numTasks == 1)
+			task(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_task = &task;
+		_numTasks = numTasks;
+		_pending = numTasks - 1;
+		++_generation;
+	}
+	_startCv.notify_all();
+
+	task(0);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_doneCv.wait(lock, [this] { return _pending == 0; });
+	_task = nullptr;
+}
+
+void
+TxThreadPool::_workerLoop(uint32 threadIdx, uint32 generation)
+{
+	while (true) {
+		const Task * task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_startCv.wait(lock, [this, generation] { return _stop || _generation != generation; });
+			if (_stop)
+				return;
+			generation = _generation;
+			if (threadIdx >= _numTasks)
+				continue;
+			task = _task;
+		}
+
+		(*task)(threadIdx);
+
+		bool done;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			done = --_pending == 0;
+		}
+		if (done)
+			_doneCv.notify_one();
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef __TXTHREADPOOL_H__
+#define __TXTHREADPOOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TxInternal.h"
+
+/* Persistent fork-join pool for texture filters and quantizers.
+ * Worker threads are created once and sleep between jobs, so splitting a
+ * texture by row blocks costs two condition variable round trips instead of
+ * a thread creation per block. The calling thread always runs block 0. */
+class TxThreadPool
+{
+public:
+	typedef std::function<void(uint32 threadIdx)> Task;
+
+	static TxThreadPool* getInstance() {
+		static TxThreadPool txThreadPool;
+		return &txThreadPool;
+	}
+	~TxThreadPool();
+
+	void init(uint32 numThreads);
+	void shutdown();
+	uint32 getNumThreads() const { return _numThreads; }
+
+	/* Run task(i) for every i in [0, numTasks) and wait for completion.
+	 * numTasks is clamped to the number of threads in the pool. */
+	void run(uint32 numTasks, const Task & task);
+
+private:
+	TxThreadPool();
+	TxThreadPool(const TxThreadPool &) = delete;
+	void _workerLoop(uint32 threadIdx, uint32 generation);
+
+	std::vector<std::thread> _workers;
+	std::mutex _runMutex;
+	std::mutex _mutex;
+	std::condition_variable _startCv;
+	std::condition_variable _doneCv;
+	const Task * _task;
+	uint32 _numThreads;
+	uint32 _numTasks;
+	uint32 _pending;
+	uint32 _generation;
+	bool _stop;
+};
+
+#endif /* __TXTHREADPOOL_H__ */
@@ -488,7 +488,12 @@ findmax0:
 
 uint32 TxUtil::getNumberofProcessors()
 {
-	return 1;
+	uint32 numcore = std::thread::hardware_concurrency();
+	if (numcore < 1)
+		numcore = 1;
+	else if (numcore > MAX_NUMCORE)
+		numcore = MAX_NUMCORE;
+	return numcore;
 }
 
 /*
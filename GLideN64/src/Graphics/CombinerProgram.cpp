@@ -18,6 +18,8 @@ namespace graphics {
 		vecOptions.push_back(config.frameBufferEmulation.N64DepthCompare == Config::dcCompatible ? 1 : 0);
 		vecOptions.push_back(config.generalEmulation.enableLegacyBlending);
 		vecOptions.push_back(config.generalEmulation.enableFragmentDepthWrite);
+		vecOptions.push_back(config.generalEmulation.enableDrawMerging);
+		vecOptions.push_back(config.texture.enableShaderTMEM);
 		u32 optionsSet = 0;
 		for (u32 i = 0; i < vecOptions.size(); ++i)
 			optionsSet |= vecOptions[i] << i;
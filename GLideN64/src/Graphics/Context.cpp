@@ -17,6 +17,8 @@ bool Context::FramebufferFetch = false;
 bool Context::TextureBarrier = false;
 bool Context::EglImage = false;
 bool Context::EglImageFramebuffer = false;
+bool Context::DrawMerging = false;
+bool Context::ShaderTMEM = false;
 
 Context::Context() {}
 
@@ -42,6 +44,8 @@ void Context::init()
 	TextureBarrier = m_impl->isSupported(SpecialFeatures::TextureBarrier);
 	EglImage = m_impl->isSupported(SpecialFeatures::EglImage);
 	EglImageFramebuffer =  m_impl->isSupported(SpecialFeatures::EglImageFramebuffer);
+	DrawMerging = m_impl->isSupported(SpecialFeatures::DrawMerging);
+	ShaderTMEM = m_impl->isSupported(SpecialFeatures::ShaderTMEM);
 }
 
 void Context::destroy()
@@ -232,6 +236,11 @@ PixelReadBuffer * Context::createPixelReadBuffer(size_t _sizeInBytes)
 	return m_impl->createPixelReadBuffer(_sizeInBytes);
 }
 
+PixelWriteBuffer * Context::createPixelWriteBuffer(size_t _sizeInBytes)
+{
+	return m_impl->createPixelWriteBuffer(_sizeInBytes);
+}
+
 ColorBufferReader * Context::createColorBufferReader(CachedTexture * _pTexture)
 {
 	return m_impl->createColorBufferReader(_pTexture);
@@ -27,7 +27,9 @@ namespace graphics {
 		FramebufferFetch,
 		TextureBarrier,
 		EglImage,
-		EglImageFramebuffer
+		EglImageFramebuffer,
+		DrawMerging,
+		ShaderTMEM
 	};
 
 	enum class ClampMode {
@@ -213,6 +215,8 @@ namespace graphics {
 
 		PixelReadBuffer * createPixelReadBuffer(size_t _sizeInBytes);
 
+		PixelWriteBuffer * createPixelWriteBuffer(size_t _sizeInBytes);
+
 		ColorBufferReader * createColorBufferReader(CachedTexture * _pTexture);
 
 		/*---------------Shaders-------------*/
@@ -257,6 +261,7 @@ namespace graphics {
 			SPVertex * vertices = nullptr;
 			void * elements = nullptr;
 			const CombinerProgram * combiner = nullptr;
+			const u8 * drawIds = nullptr;	// per vertex index into the merged draw parameters
 		};
 
 		void drawTriangles(const DrawTriangleParameters & _params);
@@ -294,6 +299,8 @@ namespace graphics {
 		static bool TextureBarrier;
 		static bool EglImage;
 		static bool EglImageFramebuffer;
+		static bool DrawMerging;
+		static bool ShaderTMEM;
 
 	private:
 		std::unique_ptr<ContextImpl> m_impl;
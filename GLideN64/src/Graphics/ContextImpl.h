@@ -48,6 +48,7 @@ namespace graphics {
 		virtual bool blitFramebuffers(const Context::BlitFramebuffersParams & _params) = 0;
 		virtual void setDrawBuffers(u32 _num) = 0;
 		virtual PixelReadBuffer * createPixelReadBuffer(size_t _sizeInBytes) = 0;
+		virtual PixelWriteBuffer * createPixelWriteBuffer(size_t _sizeInBytes) = 0;
 		virtual ColorBufferReader * createColorBufferReader(CachedTexture * _pTexture) = 0;
 		virtual bool isCombinerProgramBuilderObsolete() = 0;
 		virtual void resetCombinerProgramBuilder() = 0;
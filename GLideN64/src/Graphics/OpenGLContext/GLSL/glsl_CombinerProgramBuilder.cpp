@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <Log.h>
 #include <Config.h>
+#include <GraphicsDrawer.h>
 #include "glsl_Utils.h"
 #include "glsl_ShaderPart.h"
 #include "glsl_CombinerInputs.h"
@@ -342,6 +343,15 @@ public:
 			"      vShadeColor.rgb = vec3(fp);								\n"
 			"  }															\n"
 			;
+		if (_glinfo.drawMerging) {
+			m_part.insert(0,
+				"IN highp float aDrawId;				\n"
+				"flat OUT highp int vDrawId;			\n"
+			);
+			m_part +=
+				"  vDrawId = int(aDrawId);										\n"
+				;
+		}
 	}
 };
 
@@ -392,6 +402,15 @@ public:
 			"      vShadeColor.rgb = vec3(fp);								\n"
 			"  }															\n"
 			;
+		if (_glinfo.drawMerging) {
+			m_part.insert(0,
+				"IN highp float aDrawId;				\n"
+				"flat OUT highp int vDrawId;			\n"
+			);
+			m_part +=
+				"  vDrawId = int(aDrawId);										\n"
+				;
+		}
 	}
 };
 
@@ -735,22 +754,14 @@ public:
 		m_part =
 			"uniform sampler2D uTex0;		\n"
 			"uniform sampler2D uTex1;		\n"
-			"uniform lowp vec4 uFogColor;	\n"
 			"uniform lowp vec4 uCenterColor;\n"
 			"uniform lowp vec4 uScaleColor;	\n"
-			"uniform lowp vec4 uBlendColor;	\n"
-			"uniform lowp vec4 uEnvColor;	\n"
-			"uniform lowp vec4 uPrimColor;	\n"
-			"uniform lowp float uPrimLod;	\n"
-			"uniform lowp float uK4;		\n"
-			"uniform lowp float uK5;		\n"
 			"uniform lowp int uAlphaCompareMode;	\n"
 			"uniform lowp ivec2 uFbMonochrome;		\n"
 			"uniform lowp ivec2 uFbFixedAlpha;		\n"
 			"uniform lowp int uEnableAlphaTest;		\n"
 			"uniform lowp int uCvgXAlpha;			\n"
 			"uniform lowp int uAlphaCvgSel;			\n"
-			"uniform lowp float uAlphaTestValue;	\n"
 			"uniform lowp int uDepthSource;			\n"
 			"uniform highp float uPrimDepth;		\n"
 			"uniform mediump vec2 uScreenScale;		\n"
@@ -801,6 +812,17 @@ public:
 			;
 		}
 
+		if (_glinfo.shaderTMEM) {
+			m_part +=
+				"uniform highp usampler2D uTmem;	\n"
+				"uniform lowp ivec2 uTmemEnabled;	\n"
+				"uniform highp ivec4 uTmemTile[2];	\n"
+				"uniform highp ivec4 uTmemClamp[2];	\n"
+				"uniform highp ivec4 uTmemSize[2];	\n"
+				"lowp vec4 readTmem(in lowp int t, in highp vec2 texCoord, in lowp int filterMode);	\n"
+			;
+		}
+
 		m_part +=
 			"IN lowp vec4 vShadeColor;	\n"
 			"IN highp vec2 vTexCoord0;\n"
@@ -829,22 +851,14 @@ public:
 	ShaderFragmentGlobalVariablesNotex(const opengl::GLInfo & _glinfo)
 	{
 		m_part =
-			"uniform lowp vec4 uFogColor;	\n"
 			"uniform lowp vec4 uCenterColor;\n"
 			"uniform lowp vec4 uScaleColor;	\n"
-			"uniform lowp vec4 uBlendColor;	\n"
-			"uniform lowp vec4 uEnvColor;	\n"
-			"uniform lowp vec4 uPrimColor;	\n"
-			"uniform lowp float uPrimLod;	\n"
-			"uniform lowp float uK4;		\n"
-			"uniform lowp float uK5;		\n"
 			"uniform lowp int uAlphaCompareMode;	\n"
 			"uniform lowp ivec2 uFbMonochrome;		\n"
 			"uniform lowp ivec2 uFbFixedAlpha;		\n"
 			"uniform lowp int uEnableAlphaTest;		\n"
 			"uniform lowp int uCvgXAlpha;			\n"
 			"uniform lowp int uAlphaCvgSel;			\n"
-			"uniform lowp float uAlphaTestValue;	\n"
 			"uniform lowp int uDepthSource;			\n"
 			"uniform highp float uPrimDepth;		\n"
 			"uniform mediump vec2 uScreenScale;		\n"
@@ -899,6 +913,49 @@ public:
 	}
 };
 
+class ShaderFragmentDrawParams : public ShaderPart
+{
+public:
+	ShaderFragmentDrawParams(const opengl::GLInfo & _glinfo)
+	{
+		m_part =
+			"uniform lowp vec4 uFogColor;	\n"
+			"uniform lowp vec4 uBlendColor;	\n"
+			"uniform lowp vec4 uEnvColor;	\n"
+			"uniform lowp vec4 uPrimColor;	\n"
+			"uniform lowp float uPrimLod;	\n"
+			"uniform lowp float uK4;		\n"
+			"uniform lowp float uK5;		\n"
+			"uniform lowp float uAlphaTestValue;	\n"
+			;
+	}
+};
+
+// Parameters of merged triangle draws, indexed by the draw id of the vertices.
+// The layout must match GraphicsDrawer::DrawParams.
+class ShaderFragmentMergedDrawParams : public ShaderPart
+{
+public:
+	ShaderFragmentMergedDrawParams(const opengl::GLInfo & _glinfo)
+	{
+		std::stringstream ss;
+		ss << "uniform lowp vec4 uDrawParams[" << MAX_MERGED_DRAWS * DRAW_PARAMS_VEC4 << "];" << std::endl
+			<< "flat IN highp int vDrawId;" << std::endl
+			<< "#define DRAW_PARAM(i) uDrawParams[vDrawId * " << DRAW_PARAMS_VEC4 << " + i]" << std::endl;
+		m_part = ss.str();
+		m_part +=
+			"#define uPrimColor DRAW_PARAM(0)			\n"
+			"#define uEnvColor DRAW_PARAM(1)			\n"
+			"#define uFogColor DRAW_PARAM(2)			\n"
+			"#define uBlendColor DRAW_PARAM(3)			\n"
+			"#define uPrimLod DRAW_PARAM(4).x			\n"
+			"#define uK4 DRAW_PARAM(4).y				\n"
+			"#define uK5 DRAW_PARAM(4).z				\n"
+			"#define uAlphaTestValue DRAW_PARAM(4).w	\n"
+			;
+	}
+};
+
 class ShaderFragmentHeaderNoise : public ShaderPart
 {
 public:
@@ -1366,6 +1423,19 @@ public:
 	}
 };
 
+static
+std::string readTmemPrefix(const opengl::GLInfo & _glinfo, u32 _t, bool _bFilter)
+{
+	// Tiles decoded from TMEM by the shader bypass the texture units.
+	if (!_glinfo.shaderTMEM)
+		return std::string();
+	std::stringstream ss;
+	ss << "  if (uTmemEnabled[" << _t << "] != 0) readtex" << _t
+	   << " = readTmem(" << _t << ", texCoord" << _t << ", " << (_bFilter ? "uTextureFilterMode" : "0") << ");\n"
+	   << "  else ";
+	return ss.str();
+}
+
 class ShaderFragmentReadTexCopyMode : public ShaderPart
 {
 public:
@@ -1380,6 +1450,7 @@ public:
 			if (config.video.multisampling > 0) {
 				m_part =
 					"  lowp vec4 readtex0;																	\n"
+					+ readTmemPrefix(_glinfo, 0, false) +
 					"  if (uMSTexEnabled[0] == 0) {															\n"
 					"      READ_TEX(readtex0, uTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0])		\n"
 					"  } else readtex0 = readTexMS(uMSTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0]);\n"
@@ -1387,6 +1458,7 @@ public:
 			} else {
 				m_part =
 					"  lowp vec4 readtex0;																	\n"
+					+ readTmemPrefix(_glinfo, 0, false) +
 					"  READ_TEX(readtex0, uTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0])			\n"
 					;
 			}
@@ -1424,11 +1496,13 @@ public:
 				if (config.video.multisampling > 0) {
 					shaderPart =
 						"  lowp vec4 readtex0;																				\n"
+						+ readTmemPrefix(m_glinfo, 0, g_textureConvert.useTextureFiltering()) +
 						"  if (uMSTexEnabled[0] == 0) {																		\n"
 						"    READ_TEX(readtex0, uTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0])						\n"
 						"  } else readtex0 = readTexMS(uMSTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0]);			\n";
 				} else {
 					shaderPart = "  lowp vec4 readtex0;																		\n"
+								 + readTmemPrefix(m_glinfo, 0, g_textureConvert.useTextureFiltering()) +
 								 "  READ_TEX(readtex0, uTex0, texCoord0, uFbMonochrome[0], uFbFixedAlpha[0])				\n";
 				}
 			}
@@ -1473,11 +1547,13 @@ public:
 				if (config.video.multisampling > 0) {
 					shaderPart =
 						"  lowp vec4 readtex1;																						\n"
+						+ readTmemPrefix(m_glinfo, 1, g_textureConvert.useTextureFiltering()) +
 						"  if (uMSTexEnabled[1] == 0) {																				\n"
 						"    READ_TEX(readtex1, uTex1, texCoord1, uFbMonochrome[1], uFbFixedAlpha[1])								\n"
 						"  } else readtex1 = readTexMS(uMSTex1, texCoord1, uFbMonochrome[1], uFbFixedAlpha[1]);					\n";
 				} else {
 					shaderPart = "  lowp vec4 readtex1;																				\n"
+								 + readTmemPrefix(m_glinfo, 1, g_textureConvert.useTextureFiltering()) +
 								 "  READ_TEX(readtex1, uTex1, texCoord1, uFbMonochrome[1], uFbFixedAlpha[1])						\n";
 				}
 			}
@@ -1589,12 +1665,20 @@ public:
 					"}														\n"
 				;
 			} else {
+				// Integer hash of the N64 pixel position and a per frame seed,
+				// quantized to 8 bits like the noise textures of GLES2.
 				m_part =
-					"uniform sampler2D uTexNoise;		\n"
+					"uniform highp int uNoiseSeed;							\n"
 					"lowp float snoise()									\n"
 					"{														\n"
-					"  ivec2 coord = ivec2(gl_FragCoord.xy/uScreenScale);	\n"
-					"  return texelFetch(uTexNoise, coord, 0).r;			\n"
+					"  highp uvec2 coord = uvec2(gl_FragCoord.xy/uScreenScale);	\n"
+					"  highp uint h = (coord.x * 0x8da6b343u) ^ (coord.y * 0xd8163841u) ^ uint(uNoiseSeed);	\n"
+					"  h ^= h >> 16u;										\n"
+					"  h *= 0x7feb352du;									\n"
+					"  h ^= h >> 15u;										\n"
+					"  h *= 0x846ca68bu;									\n"
+					"  h ^= h >> 16u;										\n"
+					"  return float(h & 255u) / 255.0;						\n"
 					"}														\n"
 					;
 			}
@@ -2115,6 +2199,174 @@ public:
 	}
 };
 
+class ShaderReadTmem : public ShaderPart
+{
+public:
+	ShaderReadTmem(const opengl::GLInfo & _glinfo) : m_glinfo(_glinfo)
+	{
+	}
+
+	void write(std::stringstream & shader) const override
+	{
+		if (!m_glinfo.shaderTMEM)
+			return;
+
+		// Mirrors the CPU texel decoders of TextureCache, see TMEMDecoder.
+		std::string shaderPart =
+			"highp uint tmemByte(in highp int addr)										\n"
+			"{																			\n"
+			"  highp int word = (addr >> 2) & 0x3FF;									\n"
+			"  highp uint w = texelFetch(uTmem, ivec2(word & 0xFF, word >> 8), 0).r;	\n"
+			"  return (w >> uint((addr & 3) << 3)) & 0xFFu;								\n"
+			"}																			\n"
+			// addr is in 16-bit words, the value is byte swapped like swapword() does.
+			"highp uint tmemWord(in highp int addr)										\n"
+			"{																			\n"
+			"  highp int word = (addr >> 1) & 0x3FF;									\n"
+			"  highp uint w = texelFetch(uTmem, ivec2(word & 0xFF, word >> 8), 0).r >> uint((addr & 1) << 4);	\n"
+			"  return ((w & 0xFFu) << 8) | ((w >> 8) & 0xFFu);							\n"
+			"}																			\n"
+			// Texture wrap: 0 - repeat, 1 - mirrored repeat, 2 - clamp to edge.
+			"highp int tmemWrap(in highp int x, in highp int size, in highp int mode)	\n"
+			"{																			\n"
+			"  if (mode == 2) return clamp(x, 0, size - 1);								\n"
+			"  highp int period = mode == 1 ? size * 2 : size;							\n"
+			"  highp int m = x - period * int(floor(float(x) / float(period)));		\n"
+			"  if (m < 0) m += period;													\n"
+			"  else if (m >= period) m -= period;										\n"
+			"  return m < size ? m : period - 1 - m;									\n"
+			"}																			\n"
+			"lowp vec4 tmemTexel(in lowp int t, in highp vec2 coord)					\n"
+			"{																			\n"
+			"  highp ivec4 tile = uTmemTile[t];											\n"
+			"  highp ivec4 clampMask = uTmemClamp[t];									\n"
+			"  highp ivec4 size = uTmemSize[t];											\n"
+			"  highp int x = tmemWrap(int(floor(coord.x)), size.x, size.z);				\n"
+			"  highp int y = tmemWrap(int(floor(coord.y)), size.y, size.w);				\n"
+			"  x = min(x, clampMask.x) & clampMask.z;									\n"
+			"  y = min(y, clampMask.y) & clampMask.w;									\n"
+			"  highp int siz = tile.x >> 4;												\n"
+			"  highp int fmt = tile.x & 15;												\n"
+			"  if (siz == 3) {															\n"
+			"    highp int taddr = (((tile.y << 2) + tile.z * y + x) ^ ((y & 1) != 0 ? 3 : 1)) & 0x3FF;	\n"
+			"    highp uint gr = tmemWord(taddr);										\n"
+			"    highp uint ab = tmemWord(taddr | 0x400);								\n"
+			"    return vec4(float(gr & 0xFFu), float(gr >> 8), float(ab & 0xFFu), float(ab >> 8)) / 255.0;	\n"
+			"  }																		\n"
+			// Palettes are in the upper half of TMEM.
+			"  highp int row = ((tile.y + tile.z * y) & (fmt >= 4 ? 0xFF : 0x1FF)) << 3;	\n"
+			"  highp int odd = (y & 1) << 2;											\n"
+			"  highp uint texel;														\n"
+			"  if (siz == 0) {															\n"
+			"    texel = tmemByte(row + ((x >> 1) ^ odd));								\n"
+			"    texel = (x & 1) != 0 ? (texel & 0xFu) : (texel >> 4);					\n"
+			"  } else if (siz == 1)														\n"
+			"    texel = tmemByte(row + (x ^ odd));										\n"
+			"  else																		\n"
+			"    texel = tmemWord((row >> 1) + (x ^ (odd >> 1)));						\n"
+			"  if (fmt >= 4) {															\n"
+			"    if (siz == 0) texel |= uint(tile.w) << 4;								\n"
+			"    texel = tmemWord((256 + int(texel)) << 2);								\n"
+			"    siz = 2;																\n"
+			"    fmt = fmt == 4 ? 3 : 2;												\n"
+			"  }																		\n"
+			"  if (siz == 0) {															\n"
+			"    if (fmt == 2) return vec4(vec3(float(texel >> 1) / 7.0), float(texel & 1u));	\n"
+			"    return vec4(float(texel) / 15.0);										\n"
+			"  }																		\n"
+			"  if (siz == 1) {															\n"
+			"    if (fmt == 2) return vec4(vec3(float(texel >> 4)), float(texel & 0xFu)) / 15.0;	\n"
+			"    return vec4(float(texel) / 255.0);										\n"
+			"  }																		\n"
+			"  if (fmt == 2) return vec4(vec3(float(texel >> 8)), float(texel & 0xFFu)) / 255.0;	\n"
+			"  return vec4(float(texel >> 11), float((texel >> 6) & 31u), float((texel >> 1) & 31u), float(texel & 1u) * 31.0) / 31.0;	\n"
+			"}																			\n"
+			"#define TMEM_OFFSET(off) tmemTexel(t, texCoord * texSize - (off))			\n"
+			"lowp vec4 readTmem(in lowp int t, in highp vec2 texCoord, in lowp int filterMode)	\n"
+			"{																			\n"
+			"  highp vec2 texSize = vec2(uTmemSize[t].xy);								\n"
+			"  if (filterMode == 0) return TMEM_OFFSET(vec2(0.0));						\n"
+			"  mediump vec2 offset = fract(texCoord*texSize - vec2(0.5));				\n"
+			"  offset -= step(1.0, offset.x + offset.y);								\n"
+			;
+
+		// Same filters as TEX_FILTER.
+		switch (config.texture.bilinearMode + config.texture.enableHalosRemoval * 2) {
+		case BILINEAR_3POINT:
+			shaderPart +=
+				"  lowp vec4 c0 = TMEM_OFFSET(offset);										\n"
+				"  lowp vec4 c1 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 c2 = TMEM_OFFSET(vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  return c0 + abs(offset.x)*(c1-c0) + abs(offset.y)*(c2-c0);				\n"
+				;
+			break;
+		case BILINEAR_3POINT_WITH_COLOR_BLEEDING:
+			shaderPart +=
+				"  lowp vec4 c0 = TMEM_OFFSET(offset);										\n"
+				"  lowp vec4 c1 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 c2 = TMEM_OFFSET(vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  if (uEnableAlphaTest == 1) {												\n"
+				"    c0.rgb *= c0.a;														\n"
+				"    c1.rgb *= c1.a;														\n"
+				"    c2.rgb *= c2.a;														\n"
+				"    lowp vec4 color = c0 + abs(offset.x)*(c1-c0) + abs(offset.y)*(c2-c0);	\n"
+				"    color.rgb /= color.a;													\n"
+				"    return color;															\n"
+				"  }																		\n"
+				"  return c0 + abs(offset.x)*(c1-c0) + abs(offset.y)*(c2-c0);				\n"
+				;
+			break;
+		case BILINEAR_STANDARD:
+			shaderPart +=
+				"  lowp vec4 p0q0 = TMEM_OFFSET(offset);										\n"
+				"  lowp vec4 p1q0 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 p0q1 = TMEM_OFFSET(vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  lowp vec4 p1q1 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y - sign(offset.y)));	\n"
+				"  mediump vec2 interpolationFactor = abs(offset);								\n"
+				"  return mix(mix(p0q0, p1q0, interpolationFactor.x), mix(p0q1, p1q1, interpolationFactor.x), interpolationFactor.y);	\n"
+				;
+			break;
+		case BILINEAR_STANDARD_WITH_COLOR_BLEEDING_AND_PREMULTIPLIED_ALPHA:
+			shaderPart +=
+				"  lowp vec4 p0q0 = TMEM_OFFSET(offset);										\n"
+				"  lowp vec4 p1q0 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y));	\n"
+				"  lowp vec4 p0q1 = TMEM_OFFSET(vec2(offset.x, offset.y - sign(offset.y)));	\n"
+				"  lowp vec4 p1q1 = TMEM_OFFSET(vec2(offset.x - sign(offset.x), offset.y - sign(offset.y)));	\n"
+				"  mediump vec2 interpolationFactor = abs(offset);								\n"
+				"  if (uEnableAlphaTest == 1) {													\n"
+				"    p0q0.rgb *= p0q0.a;														\n"
+				"    p1q0.rgb *= p1q0.a;														\n"
+				"    p0q1.rgb *= p0q1.a;														\n"
+				"    p1q1.rgb *= p1q1.a;														\n"
+				"    lowp vec4 color = mix(mix(p0q0, p1q0, interpolationFactor.x), mix(p0q1, p1q1, interpolationFactor.x), interpolationFactor.y);	\n"
+				"    color.rgb /= color.a;														\n"
+				"    return color;																\n"
+				"  }																			\n"
+				"  if (uCvgXAlpha == 1) {														\n"
+				"    if (p0q0.a > p1q0.a) p1q0.rgb = p0q0.rgb;									\n"
+				"    if (p1q0.a > p0q0.a) p0q0.rgb = p1q0.rgb;									\n"
+				"    if (p0q1.a > p1q1.a) p1q1.rgb = p0q1.rgb;									\n"
+				"    if (p1q1.a > p0q1.a) p0q1.rgb = p1q1.rgb;									\n"
+				"    if (p0q0.a > p0q1.a) p0q1.rgb = p0q0.rgb;									\n"
+				"    if (p0q1.a > p0q0.a) p0q0.rgb = p0q1.rgb;									\n"
+				"    if (p1q0.a > p1q1.a) p1q1.rgb = p1q0.rgb;									\n"
+				"    if (p1q1.a > p1q0.a) p1q0.rgb = p1q1.rgb;									\n"
+				"  }																			\n"
+				"  return mix(mix(p0q0, p1q0, interpolationFactor.x), mix(p0q1, p1q1, interpolationFactor.x), interpolationFactor.y);	\n"
+				;
+			break;
+		}
+		shaderPart +=
+			"}																			\n"
+			;
+
+		shader << shaderPart;
+	}
+
+private:
+	const opengl::GLInfo& m_glinfo;
+};
+
 class ShaderN64DepthCompare : public ShaderPart
 {
 public:
@@ -2418,6 +2670,10 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 
 	if (bUseTextures) {
 		m_fragmentGlobalVariablesTex->write(ssShader);
+		if (m_drawMerging && !bIsRect)
+			m_fragmentMergedDrawParams->write(ssShader);
+		else
+			m_fragmentDrawParams->write(ssShader);
 
 		if (g_cycleType == G_CYC_2CYCLE && config.generalEmulation.enableLegacyBlending == 0)
 			ssShader << "uniform lowp ivec4 uBlendMux2;" << std::endl << "uniform lowp int uForceBlendCycle2;" << std::endl;
@@ -2437,6 +2693,10 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 			m_fragmentHeaderReadTexCopyMode->write(ssShader);
 	} else {
 		m_fragmentGlobalVariablesNotex->write(ssShader);
+		if (m_drawMerging && !bIsRect)
+			m_fragmentMergedDrawParams->write(ssShader);
+		else
+			m_fragmentDrawParams->write(ssShader);
 
 		if (g_cycleType == G_CYC_2CYCLE && config.generalEmulation.enableLegacyBlending == 0)
 			ssShader << "uniform lowp ivec4 uBlendMux2;" << std::endl << "uniform lowp int uForceBlendCycle2;" << std::endl;
@@ -2511,6 +2771,7 @@ graphics::CombinerProgram * CombinerProgramBuilder::buildCombinerProgram(Combine
 				m_shaderReadtex->write(ssShader);
 			else
 				m_shaderReadtexCopyMode->write(ssShader);
+			m_shaderReadTmem->write(ssShader);
 		}
 	}
 
@@ -2610,6 +2871,8 @@ CombinerProgramBuilder::CombinerProgramBuilder(const opengl::GLInfo & _glinfo, o
 , m_fragmentHeader(new FragmentShaderHeader(_glinfo))
 , m_fragmentGlobalVariablesTex(new ShaderFragmentGlobalVariablesTex(_glinfo))
 , m_fragmentGlobalVariablesNotex(new ShaderFragmentGlobalVariablesNotex(_glinfo))
+, m_fragmentDrawParams(new ShaderFragmentDrawParams(_glinfo))
+, m_fragmentMergedDrawParams(new ShaderFragmentMergedDrawParams(_glinfo))
 , m_fragmentHeaderNoise(new ShaderFragmentHeaderNoise(_glinfo))
 , m_fragmentHeaderWriteDepth(new ShaderFragmentHeaderWriteDepth(_glinfo))
 , m_fragmentHeaderCalcLight(new ShaderFragmentHeaderCalcLight(_glinfo))
@@ -2639,11 +2902,13 @@ CombinerProgramBuilder::CombinerProgramBuilder(const opengl::GLInfo & _glinfo, o
 , m_shaderCalcLight(new ShaderCalcLight(_glinfo))
 , m_shaderReadtex(new ShaderReadtex(_glinfo))
 , m_shaderReadtexCopyMode(new ShaderReadtexCopyMode(_glinfo))
+, m_shaderReadTmem(new ShaderReadTmem(_glinfo))
 , m_shaderN64DepthCompare(new ShaderN64DepthCompare(_glinfo))
 , m_shaderN64DepthRender(new ShaderN64DepthRender(_glinfo))
 , m_shaderClampWrapMirror(new ShaderClampWrapMirror(_glinfo))
 , m_useProgram(_useProgram)
 , m_combinerOptionsBits(graphics::CombinerProgram::getShaderCombinerOptionsBits())
+, m_drawMerging(_glinfo.drawMerging)
 {
 	m_vertexShaderRect = _createVertexShader(m_vertexHeader.get(), m_vertexRect.get(), m_vertexEnd.get());
 	m_vertexShaderTriangle = _createVertexShader(m_vertexHeader.get(), m_vertexTriangle.get(), m_vertexEnd.get());
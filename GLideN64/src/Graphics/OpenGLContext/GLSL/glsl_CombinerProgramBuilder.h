@@ -58,6 +58,8 @@ namespace glsl {
 		ShaderPartPtr m_fragmentHeader;
 		ShaderPartPtr m_fragmentGlobalVariablesTex;
 		ShaderPartPtr m_fragmentGlobalVariablesNotex;
+		ShaderPartPtr m_fragmentDrawParams;
+		ShaderPartPtr m_fragmentMergedDrawParams;
 		ShaderPartPtr m_fragmentHeaderNoise;
 		ShaderPartPtr m_fragmentHeaderWriteDepth;
 		ShaderPartPtr m_fragmentHeaderCalcLight;
@@ -88,6 +90,7 @@ namespace glsl {
 		ShaderPartPtr m_shaderCalcLight;
 		ShaderPartPtr m_shaderReadtex;
 		ShaderPartPtr m_shaderReadtexCopyMode;
+		ShaderPartPtr m_shaderReadTmem;
 		ShaderPartPtr m_shaderN64DepthCompare;
 		ShaderPartPtr m_shaderN64DepthRender;
 		ShaderPartPtr m_shaderClampWrapMirror;
@@ -100,6 +103,7 @@ namespace glsl {
 		GLuint  m_vertexShaderTexturedTriangle;
 		opengl::CachedUseProgram * m_useProgram;
 		u32 m_combinerOptionsBits;
+		bool m_drawMerging;
 	};
 
 }
@@ -7,6 +7,7 @@
 #include <NoiseTexture.h>
 #include <FrameBuffer.h>
 #include <DisplayWindow.h>
+#include <GraphicsDrawer.h>
 #include <GBI.h>
 #include <RSP.h>
 #include <gSP.h>
@@ -114,15 +115,21 @@ class UNoiseTex : public UniformGroup
 public:
 	UNoiseTex(GLuint _program) {
 		LocateUniform(uTexNoise);
+		LocateUniform(uNoiseSeed);
 	}
 
 	void update(bool _force) override
 	{
 		uTexNoise.set(int(graphics::textureIndices::NoiseTex), _force);
+		if (uNoiseSeed.loc >= 0) {
+			g_noiseTexture.update();
+			uNoiseSeed.set(int(g_noiseTexture.getSeed() & 0x7FFFFFFF), _force);
+		}
 	}
 
 private:
 	iUniform uTexNoise;
+	iUniform uNoiseSeed;
 };
 
 class UDepthTex : public UniformGroup
@@ -253,6 +260,61 @@ private:
 	iv2Uniform uMSTexEnabled;
 };
 
+class UShaderTMEM : public UniformGroup
+{
+public:
+	UShaderTMEM(GLuint _program)
+	{
+		LocateUniform(uTmem);
+		LocateUniform(uTmemEnabled);
+		char buf[32];
+		for (u32 t = 0; t < 2; ++t) {
+			sprintf(buf, "uTmemTile[%u]", t);
+			uTmemTile[t].loc = glGetUniformLocation(_program, buf);
+			sprintf(buf, "uTmemClamp[%u]", t);
+			uTmemClamp[t].loc = glGetUniformLocation(_program, buf);
+			sprintf(buf, "uTmemSize[%u]", t);
+			uTmemSize[t].loc = glGetUniformLocation(_program, buf);
+		}
+	}
+
+	void update(bool _force) override
+	{
+		uTmem.set(int(graphics::textureIndices::TMEMTex), _force);
+
+		int enabled[2] = { 0, 0 };
+		TextureCache & cache = textureCache();
+		for (u32 t = 0; t < 2; ++t) {
+			const CachedTexture * pTexture = cache.current[t];
+			if (pTexture == nullptr || pTexture->tmemDecoder == 0)
+				continue;
+
+			enabled[t] = 1;
+			// Same clamp and mask as the CPU texture loader applies.
+			const int clampS = pTexture->clampS ? pTexture->clampWidth - 1 :
+				(pTexture->maskS != 0 && pTexture->mirrorS != 0 ? pTexture->width * 2 - 1 : pTexture->width - 1);
+			const int clampT = pTexture->clampT ? pTexture->clampHeight - 1 :
+				(pTexture->maskT != 0 && pTexture->mirrorT != 0 ? pTexture->height * 2 - 1 : pTexture->height - 1);
+			const int maskS = pTexture->maskS != 0 ? (1 << pTexture->maskS) - 1 : 0xFFFF;
+			const int maskT = pTexture->maskT != 0 ? (1 << pTexture->maskT) - 1 : 0xFFFF;
+			// Texture wrap: 0 - repeat, 1 - mirrored repeat, 2 - clamp to edge.
+			const int wrapS = pTexture->clampS ? 2 : (pTexture->mirrorS ? 1 : 0);
+			const int wrapT = pTexture->clampT ? 2 : (pTexture->mirrorT ? 1 : 0);
+			uTmemTile[t].set(pTexture->tmemDecoder, pTexture->tMem, pTexture->tmemLine, pTexture->palette, _force);
+			uTmemClamp[t].set(clampS, clampT, maskS, maskT, _force);
+			uTmemSize[t].set(pTexture->width, pTexture->height, wrapS, wrapT, _force);
+		}
+		uTmemEnabled.set(enabled[0], enabled[1], _force);
+	}
+
+private:
+	iUniform uTmem;
+	iv2Uniform uTmemEnabled;
+	i4Uniform uTmemTile[2];
+	i4Uniform uTmemClamp[2];
+	i4Uniform uTmemSize[2];
+};
+
 
 class UFog : public UniformGroup
 {
@@ -784,6 +846,35 @@ private:
 	fUniform uK5;
 };
 
+class UDrawParams : public UniformGroup
+{
+public:
+	UDrawParams(GLuint _program) {
+		LocateUniform(uDrawParams);
+	}
+
+	void update(bool _force) override
+	{
+		if (uDrawParams.loc < 0)
+			return;
+		u32 count;
+		const GraphicsDrawer::DrawParams * pParams = dwnd().getDrawer().getDrawParams(count);
+		const size_t szData = sizeof(GraphicsDrawer::DrawParams) * count;
+		if (!_force && count == m_count && memcmp(m_params, pParams, szData) == 0)
+			return;
+		memcpy(m_params, pParams, szData);
+		m_count = count;
+		glUniform4fv(uDrawParams.loc, count * DRAW_PARAMS_VEC4, pParams->primColor);
+	}
+
+private:
+	struct {
+		GLint loc = -1;
+	} uDrawParams;
+	u32 m_count = 0;
+	GraphicsDrawer::DrawParams m_params[MAX_MERGED_DRAWS];
+};
+
 class URectColor : public UniformGroup
 {
 public:
@@ -1058,6 +1149,9 @@ void CombinerProgramUniformFactory::buildUniforms(GLuint _program,
 
 		_uniforms.emplace_back(new UFrameBufferInfo(_program));
 
+		if (m_glInfo.shaderTMEM && !_inputs.usesLOD())
+			_uniforms.emplace_back(new UShaderTMEM(_program));
+
 		if (_inputs.usesLOD()) {
 			_uniforms.emplace_back(new UMipmap1(_program));
 			if (config.generalEmulation.enableLOD != 0)
@@ -1117,6 +1211,9 @@ void CombinerProgramUniformFactory::buildUniforms(GLuint _program,
 
 	_uniforms.emplace_back(new UColors(_program));
 
+	if (m_glInfo.drawMerging && !_key.isRectKey())
+		_uniforms.emplace_back(new UDrawParams(_program));
+
 	if (_key.isRectKey())
 		_uniforms.emplace_back(new URectColor(_program));
 
@@ -20,6 +20,7 @@ void Utils::locateAttributes(GLuint _program, bool _rect, bool _textures)
 	glBindAttribLocation(_program, opengl::triangleAttrib::color, "aColor");
 	glBindAttribLocation(_program, opengl::triangleAttrib::numlights, "aNumLights");
 	glBindAttribLocation(_program, opengl::triangleAttrib::modify, "aModify");
+	glBindAttribLocation(_program, opengl::triangleAttrib::drawId, "aDrawId");
 	if (_textures)
 		glBindAttribLocation(_program, opengl::triangleAttrib::texcoord, "aTexCoord");
 }
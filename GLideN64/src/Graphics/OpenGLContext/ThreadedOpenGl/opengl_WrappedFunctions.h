@@ -3823,30 +3823,32 @@ public:
 	{
 	}
 
-	static std::shared_ptr<OpenGlCommand> get(GLsync sync, GLbitfield flags, GLuint64 timeout)
+	static std::shared_ptr<OpenGlCommand> get(GLsync sync, GLbitfield flags, GLuint64 timeout, GLenum& returnValue)
 	{
 		static int poolId = OpenGlCommandPool::get().getNextAvailablePool();
 		auto ptr = getFromPool<GlClientWaitSyncCommand>(poolId);
-		ptr->set(sync, flags, timeout);
+		ptr->set(sync, flags, timeout, returnValue);
 		return ptr;
 	}
 
 	void commandToExecute() override
 	{
-		ptrClientWaitSync(m_sync, m_flags, m_timeout);
+		*m_returnValue = ptrClientWaitSync(m_sync, m_flags, m_timeout);
 	}
 
 private:
-	void set(GLsync sync, GLbitfield flags, GLuint64 timeout)
+	void set(GLsync sync, GLbitfield flags, GLuint64 timeout, GLenum& returnValue)
 	{
 		m_sync = sync;
 		m_flags = flags;
 		m_timeout = timeout;
+		m_returnValue = &returnValue;
 	}
 
 	GLsync m_sync;
 	GLbitfield m_flags;
 	GLuint64 m_timeout;
+	GLenum* m_returnValue;
 };
 
 class GlDeleteSyncCommand : public OpenGlCommand
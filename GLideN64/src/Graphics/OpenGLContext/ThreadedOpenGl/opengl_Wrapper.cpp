@@ -1140,12 +1140,16 @@ namespace opengl {
 		return returnValue;
 	}
 
-	void FunctionWrapper::wrClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+	GLenum FunctionWrapper::wrClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
 	{
+		GLenum returnValue;
+
 		if (m_threaded_wrapper)
-			executePriorityCommand(GlClientWaitSyncCommand::get(sync, flags, timeout));
+			executePriorityCommand(GlClientWaitSyncCommand::get(sync, flags, timeout, returnValue));
 		else
-			ptrClientWaitSync(sync, flags, timeout);
+			returnValue = ptrClientWaitSync(sync, flags, timeout);
+
+		return returnValue;
 	}
 
 	void FunctionWrapper::wrDeleteSync(GLsync sync)
@@ -163,7 +163,7 @@ namespace opengl {
 		static void wrInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments);
 		static void wrBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
 		static GLsync wrFenceSync(GLenum condition, GLbitfield flags);
-		static void wrClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+		static GLenum wrClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
 		static void wrDeleteSync(GLsync sync);
 
 		static GLuint wrGetUniformBlockIndex(GLuint program, GLchar *uniformBlockName);
@@ -8,6 +8,7 @@ namespace opengl {
 		const GLuint texcoord = 2U;
 		const GLuint numlights = 3U;
 		const GLuint modify = 4U;
+		const GLuint drawId = 8U;
 	}
 
 	// Rect attributes
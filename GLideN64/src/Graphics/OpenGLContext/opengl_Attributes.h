@@ -10,6 +10,7 @@ namespace opengl {
 		extern const GLuint texcoord;
 		extern const GLuint numlights;
 		extern const GLuint modify;
+		extern const GLuint drawId;
 	}
 
 	// Rect attributes
@@ -19,5 +20,5 @@ namespace opengl {
 		extern const GLuint texcoord1;
 	}
 
-#define MaxAttribIndex 8
+#define MaxAttribIndex 9
 }
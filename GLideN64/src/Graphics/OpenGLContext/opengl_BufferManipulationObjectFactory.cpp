@@ -1,4 +1,6 @@
 #include <assert.h>
+#include <array>
+#include <Config.h>
 #include <Graphics/Parameters.h>
 #include "opengl_GLInfo.h"
 #include "opengl_CachedFunctions.h"
@@ -192,6 +194,120 @@ private:
 	CachedBindBuffer * m_bind;
 };
 
+/*---------------CreatePixelWriteBuffer-------------*/
+
+// Ring of pixel unpack memory, persistently mapped for the lifetime of the buffer.
+// The ring is split into segments. A fence is placed when writing leaves a segment,
+// and writing waits for that fence only when it comes back to the segment.
+class PersistentWriteBuffer : public graphics::PixelWriteBuffer
+{
+public:
+	static bool Check(const GLInfo & _glinfo) {
+		// Threaded wrapper copies pixel data by pointer, so it can't take buffer offsets.
+		return _glinfo.bufferStorage && config.video.threadedVideo == 0;
+	}
+
+	PersistentWriteBuffer(CachedBindBuffer * _bind, size_t _size)
+		: m_bind(_bind)
+		, m_size(_size)
+		, m_segmentSize(_size / _numSegments)
+	{
+		m_fences.fill(nullptr);
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &m_PBO);
+		m_bind->bind(graphics::Parameter(GL_PIXEL_UNPACK_BUFFER), graphics::ObjectHandle(m_PBO));
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_size, nullptr, flags);
+		m_data = reinterpret_cast<u8*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_size, flags));
+		m_bind->bind(graphics::Parameter(GL_PIXEL_UNPACK_BUFFER), graphics::ObjectHandle::null);
+	}
+
+	~PersistentWriteBuffer() {
+		for (GLsync & fence : m_fences) {
+			if (fence != nullptr)
+				glDeleteSync(fence);
+			fence = nullptr;
+		}
+		glDeleteBuffers(1, &m_PBO);
+		m_PBO = 0;
+	}
+
+	void * getWriteBuffer(size_t _size) override
+	{
+		if (m_data == nullptr || _size > m_segmentSize)
+			return nullptr;
+
+		const size_t segmentEnd = (m_segment + 1) * m_segmentSize;
+		if (m_offset + _size > segmentEnd) {
+			if (m_segmentUsed) {
+				m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				m_segmentUsed = false;
+			}
+			m_segment = (m_segment + 1) % _numSegments;
+			m_offset = m_segment * m_segmentSize;
+		}
+
+		// The fence stays in place until a wait succeeds. Until then the caller
+		// uploads from system memory instead.
+		GLsync & fence = m_fences[m_segment];
+		if (fence != nullptr) {
+			if (!Utils::waitForSync(fence))
+				return nullptr;
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		m_writeOffset = m_offset;
+		// Keep each write 16-byte aligned for SIMD decoders and unpack alignment.
+		m_offset += (_size + 15) & ~size_t(15);
+		return m_data + m_writeOffset;
+	}
+
+	const void * closeWriteBuffer() override
+	{
+		m_segmentUsed = true;
+		return reinterpret_cast<const void*>(m_writeOffset);
+	}
+
+	void bind() override {
+		m_bind->bind(graphics::Parameter(GL_PIXEL_UNPACK_BUFFER), graphics::ObjectHandle(m_PBO));
+	}
+
+	void unbind() override {
+		m_bind->bind(graphics::Parameter(GL_PIXEL_UNPACK_BUFFER), graphics::ObjectHandle::null);
+	}
+
+private:
+	static const u32 _numSegments = 4;
+
+	CachedBindBuffer * m_bind;
+	size_t m_size;
+	size_t m_segmentSize;
+	size_t m_offset = 0;
+	size_t m_writeOffset = 0;
+	u32 m_segment = 0;
+	bool m_segmentUsed = false;
+	GLuint m_PBO;
+	u8 * m_data = nullptr;
+	std::array<GLsync, _numSegments> m_fences;
+};
+
+template<typename T>
+class CreatePixelWriteBufferT : public CreatePixelWriteBuffer
+{
+public:
+	CreatePixelWriteBufferT(CachedBindBuffer * _bind)
+		: m_bind(_bind) {
+	}
+
+	graphics::PixelWriteBuffer * createPixelWriteBuffer(size_t _sizeInBytes) override
+	{
+		return new T(m_bind, _sizeInBytes);
+	}
+
+private:
+	CachedBindBuffer * m_bind;
+};
+
 /*---------------BlitFramebuffers-------------*/
 
 class BlitFramebuffersImpl : public BlitFramebuffers
@@ -216,7 +332,9 @@ public:
 
 		const s32 adrenoCoordFix = (m_renderer == Renderer::Adreno) ? 1 : 0;
 
+		// Blits only depend on the scissor test of the pipeline state.
 		m_enableScissor->enable(false);
+		m_enableScissor->apply();
 
 		glBlitFramebuffer(
 			adrenoCoordFix + _params.srcX0, _params.srcY0, _params.srcX1, _params.srcY1,
@@ -469,6 +587,14 @@ CreatePixelReadBuffer * BufferManipulationObjectFactory::createPixelReadBuffer()
 	return new CreatePixelReadBufferT<PBOReadBuffer>(m_cachedFunctions.getCachedBindBuffer());
 }
 
+CreatePixelWriteBuffer * BufferManipulationObjectFactory::createPixelWriteBuffer() const
+{
+	if (PersistentWriteBuffer::Check(m_glInfo))
+		return new CreatePixelWriteBufferT<PersistentWriteBuffer>(m_cachedFunctions.getCachedBindBuffer());
+
+	return nullptr;
+}
+
 graphics::FramebufferTextureFormats * BufferManipulationObjectFactory::getFramebufferTextureFormats() const
 {
 	if (FramebufferTextureFormatsOpenGL::Check(m_glInfo))
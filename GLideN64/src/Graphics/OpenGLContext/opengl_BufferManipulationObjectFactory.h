@@ -45,6 +45,13 @@ namespace opengl {
 		virtual graphics::PixelReadBuffer * createPixelReadBuffer(size_t _sizeInBytes) = 0;
 	};
 
+	class CreatePixelWriteBuffer
+	{
+	public:
+		virtual ~CreatePixelWriteBuffer() {}
+		virtual graphics::PixelWriteBuffer * createPixelWriteBuffer(size_t _sizeInBytes) = 0;
+	};
+
 	class BlitFramebuffers
 	{
 	public:
@@ -68,6 +75,8 @@ namespace opengl {
 
 		CreatePixelReadBuffer * createPixelReadBuffer() const;
 
+		CreatePixelWriteBuffer * createPixelWriteBuffer() const;
+
 		BlitFramebuffers * getBlitFramebuffers() const;
 
 		graphics::FramebufferTextureFormats * getFramebufferTextureFormats() const;
@@ -2,6 +2,7 @@
 #include <CRC.h>
 #include "GLFunctions.h"
 #include "opengl_Attributes.h"
+#include "opengl_Utils.h"
 #include "opengl_BufferedDrawer.h"
 
 using namespace graphics;
@@ -21,7 +22,6 @@ BufferedDrawer::BufferedDrawer(const GLInfo & _glinfo, CachedVertexAttribArray *
 , m_cachedAttribArray(_cachedAttribArray)
 , m_bindBuffer(_bindBuffer)
 {
-	m_vertices.resize(VERTBUFF_SIZE);
 	/* Init buffers for rects */
 	glGenVertexArrays(1, &m_rectsBuffers.vao);
 	glBindVertexArray(m_rectsBuffers.vao);
@@ -43,15 +43,13 @@ BufferedDrawer::BufferedDrawer(const GLInfo & _glinfo, CachedVertexAttribArray *
 	m_cachedAttribArray->enableVertexAttribArray(triangleAttrib::texcoord, true);
 	m_cachedAttribArray->enableVertexAttribArray(triangleAttrib::modify, true);
 	m_cachedAttribArray->enableVertexAttribArray(triangleAttrib::numlights, false);
-	glVertexAttribPointer(triangleAttrib::position, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, x)));
-	glVertexAttribPointer(triangleAttrib::color, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, r)));
-	glVertexAttribPointer(triangleAttrib::texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, s)));
-	glVertexAttribPointer(triangleAttrib::modify, 4, GL_BYTE, GL_TRUE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, modify)));
+	_setTrianglesLayout(VertexLayout::full);
 }
 
 void BufferedDrawer::_initBuffer(Buffer & _buffer, GLuint _bufSize)
 {
 	_buffer.size = _bufSize;
+	_buffer.segmentSize = _bufSize / m_numSegments;
 	glGenBuffers(1, &_buffer.handle);
 	m_bindBuffer->bind(Parameter(_buffer.type), ObjectHandle(_buffer.handle));
 	if (m_glInfo.bufferStorage) {
@@ -62,35 +60,94 @@ void BufferedDrawer::_initBuffer(Buffer & _buffer, GLuint _bufSize)
 	}
 }
 
+void BufferedDrawer::_destroyBuffer(Buffer & _buffer)
+{
+	for (GLsync & fence : _buffer.fences) {
+		if (fence != nullptr)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+	glDeleteBuffers(1, &_buffer.handle);
+	_buffer.handle = 0;
+}
+
 BufferedDrawer::~BufferedDrawer()
 {
 	m_bindBuffer->bind(Parameter(GL_ARRAY_BUFFER), ObjectHandle::null);
 	m_bindBuffer->bind(Parameter(GL_ELEMENT_ARRAY_BUFFER), ObjectHandle::null);
-	GLuint buffers[3] = { m_rectsBuffers.vbo.handle, m_trisBuffers.vbo.handle, m_trisBuffers.ebo.handle };
-	glDeleteBuffers(3, buffers);
+	_destroyBuffer(m_rectsBuffers.vbo);
+	_destroyBuffer(m_trisBuffers.vbo);
+	_destroyBuffer(m_trisBuffers.ebo);
 	glBindVertexArray(0);
 	GLuint arrays[2] = { m_rectsBuffers.vao, m_trisBuffers.vao };
 	glDeleteVertexArrays(2, arrays);
 }
 
-void BufferedDrawer::_updateBuffer(Buffer & _buffer, u32 _count, u32 _dataSize, const void * _data)
+void BufferedDrawer::_nextSegment(Buffer & _buffer)
 {
-	if (_buffer.offset + _dataSize >= _buffer.size) {
-		_buffer.offset = 0;
-		_buffer.pos = 0;
+	if (_buffer.segmentUsed) {
+		_buffer.fences[_buffer.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		_buffer.segmentUsed = false;
+	}
+	_buffer.segment = (_buffer.segment + 1) % m_numSegments;
+	_buffer.offset = _buffer.segment * _buffer.segmentSize;
+	GLsync & fence = _buffer.fences[_buffer.segment];
+	if (fence == nullptr)
+		return;
+	if (Utils::waitForSync(fence)) {
+		glDeleteSync(fence);
+		fence = nullptr;
+		return;
 	}
 
+	// The GPU may still read this segment. Take fresh storage if the buffer
+	// can be orphaned, otherwise wait for all pending commands.
 	if (m_glInfo.bufferStorage) {
-		memcpy(&_buffer.data[_buffer.offset], _data, _dataSize);
+		glFinish();
 	} else {
 		m_bindBuffer->bind(Parameter(_buffer.type), ObjectHandle(_buffer.handle));
-		void* buffer_pointer = glMapBufferRange(_buffer.type, _buffer.offset, _dataSize, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
-		memcpy(buffer_pointer, _data, _dataSize);
-		glUnmapBuffer(_buffer.type);
+		glBufferData(_buffer.type, _buffer.size, nullptr, GL_DYNAMIC_DRAW);
+	}
+	for (GLsync & segmentFence : _buffer.fences) {
+		if (segmentFence != nullptr)
+			glDeleteSync(segmentFence);
+		segmentFence = nullptr;
+	}
+}
+
+GLubyte * BufferedDrawer::_beginWrite(Buffer & _buffer, u32 _count, u32 _stride)
+{
+	const GLintptr dataSize = _count * _stride;
+	// Draws address the data by element index, so it must start at a multiple of the stride.
+	GLintptr offset = (_buffer.offset + _stride - 1) / _stride * _stride;
+	if (offset + dataSize > GLintptr(_buffer.segment + 1) * _buffer.segmentSize) {
+		_nextSegment(_buffer);
+		offset = (_buffer.offset + _stride - 1) / _stride * _stride;
 	}
 
-	_buffer.offset += _dataSize;
-	_buffer.pos += _count;
+	_buffer.offset = offset + dataSize;
+	_buffer.pos = static_cast<GLint>(offset / _stride) + _count;
+	_buffer.segmentUsed = true;
+
+	if (m_glInfo.bufferStorage)
+		return &_buffer.data[offset];
+
+	// The segment fences make unsynchronized mapping safe.
+	m_bindBuffer->bind(Parameter(_buffer.type), ObjectHandle(_buffer.handle));
+	return (GLubyte*)glMapBufferRange(_buffer.type, offset, dataSize, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void BufferedDrawer::_endWrite(Buffer & _buffer)
+{
+	if (!m_glInfo.bufferStorage)
+		glUnmapBuffer(_buffer.type);
+}
+
+void BufferedDrawer::_updateBuffer(Buffer & _buffer, u32 _count, u32 _stride, const void * _data)
+{
+	GLubyte * dst = _beginWrite(_buffer, _count, _stride);
+	memcpy(dst, _data, _count * _stride);
+	_endWrite(_buffer);
 }
 
 void BufferedDrawer::_updateRectBuffer(const graphics::Context::DrawRectParameters & _params)
@@ -102,26 +159,26 @@ void BufferedDrawer::_updateRectBuffer(const graphics::Context::DrawRectParamete
 	}
 
 	Buffer & buffer = m_rectsBuffers.vbo;
-	const u32 dataSize = _params.verticesCount * static_cast<u32>(sizeof(RectVertex));
+	const u32 stride = static_cast<u32>(sizeof(RectVertex));
 
 	if (m_glInfo.bufferStorage) {
-		_updateBuffer(buffer, _params.verticesCount, dataSize, _params.vertices);
+		_updateBuffer(buffer, _params.verticesCount, stride, _params.vertices);
 		return;
 	}
 
-	const u32 crc = CRC_Calculate(0xFFFFFFFF, _params.vertices, dataSize);
+	const u32 crc = CRC_Calculate(0xFFFFFFFF, _params.vertices, _params.verticesCount * stride);
 	auto iter = m_rectBufferOffsets.find(crc);
 	if (iter != m_rectBufferOffsets.end()) {
 		buffer.pos = iter->second;
 		return;
 	}
 
-	const GLintptr prevOffset = buffer.offset;
-	_updateBuffer(buffer, _params.verticesCount, dataSize, _params.vertices);
-	if (buffer.offset < prevOffset)
+	// Only reuse rects of the current segment, older ones are not covered by its fence.
+	const u32 prevSegment = buffer.segment;
+	_updateBuffer(buffer, _params.verticesCount, stride, _params.vertices);
+	if (buffer.segment != prevSegment)
 		m_rectBufferOffsets.clear();
 
-	buffer.pos = static_cast<GLint>(buffer.offset / sizeof(RectVertex));
 	m_rectBufferOffsets[crc] = buffer.pos;
 }
 
@@ -136,55 +193,130 @@ void BufferedDrawer::drawRects(const graphics::Context::DrawRectParameters & _pa
 	glDrawArrays(GLenum(_params.mode), m_rectsBuffers.vbo.pos - _params.verticesCount, _params.verticesCount);
 }
 
-void BufferedDrawer::_convertFromSPVertex(bool _flatColors, u32 _count, const SPVertex * _data)
+void BufferedDrawer::_setTrianglesLayout(VertexLayout _layout)
 {
-	if (_count > m_vertices.size())
-		m_vertices.resize(_count);
+	m_layout = _layout;
+	m_bindBuffer->bind(Parameter(GL_ARRAY_BUFFER), ObjectHandle(m_trisBuffers.vbo.handle));
+	switch (_layout) {
+	case VertexLayout::full:
+		glVertexAttribPointer(triangleAttrib::position, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, x)));
+		glVertexAttribPointer(triangleAttrib::color, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, r)));
+		glVertexAttribPointer(triangleAttrib::texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, s)));
+		glVertexAttribPointer(triangleAttrib::modify, 4, GL_BYTE, GL_TRUE, sizeof(Vertex), (const GLvoid *)(offsetof(Vertex, modify)));
+		break;
+	case VertexLayout::compact:
+		glVertexAttribPointer(triangleAttrib::position, 4, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), (const GLvoid *)(offsetof(CompactVertex, x)));
+		glVertexAttribPointer(triangleAttrib::color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CompactVertex), (const GLvoid *)(offsetof(CompactVertex, r)));
+		glVertexAttribPointer(triangleAttrib::texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), (const GLvoid *)(offsetof(CompactVertex, s)));
+		glVertexAttribPointer(triangleAttrib::modify, 4, GL_BYTE, GL_TRUE, sizeof(CompactVertex), (const GLvoid *)(offsetof(CompactVertex, modify)));
+		break;
+	case VertexLayout::merged:
+		glVertexAttribPointer(triangleAttrib::position, 4, GL_FLOAT, GL_FALSE, sizeof(MergedVertex), (const GLvoid *)(offsetof(MergedVertex, x)));
+		glVertexAttribPointer(triangleAttrib::color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MergedVertex), (const GLvoid *)(offsetof(MergedVertex, r)));
+		glVertexAttribPointer(triangleAttrib::texcoord, 2, GL_FLOAT, GL_FALSE, sizeof(MergedVertex), (const GLvoid *)(offsetof(MergedVertex, s)));
+		glVertexAttribPointer(triangleAttrib::modify, 4, GL_BYTE, GL_TRUE, sizeof(MergedVertex), (const GLvoid *)(offsetof(MergedVertex, modify)));
+		glVertexAttribPointer(triangleAttrib::drawId, 1, GL_FLOAT, GL_FALSE, sizeof(MergedVertex), (const GLvoid *)(offsetof(MergedVertex, drawId)));
+		break;
+	}
+	m_cachedAttribArray->enableVertexAttribArray(triangleAttrib::drawId, _layout == VertexLayout::merged);
+}
 
+static
+u8 _colorToByte(f32 _c)
+{
+	if (!(_c > 0.0f))
+		return 0;
+	if (_c >= 1.0f)
+		return 255;
+	return static_cast<u8>(_c * 255.0f + 0.5f);
+}
+
+template <class CompactVertexType>
+static
+CompactVertexType * _writeCompactVertices(CompactVertexType * _dst, bool _flatColors, u32 _count, const SPVertex * _data)
+{
 	for (u32 i = 0; i < _count; ++i) {
 		const SPVertex & src = _data[i];
-		Vertex & dst = m_vertices[i];
+		const f32 * color = _flatColors ? &src.flat_r : &src.r;
+		CompactVertexType & dst = _dst[i];
 		dst.x = src.x;
 		dst.y = src.y;
 		dst.z = src.z;
 		dst.w = src.w;
-		if (_flatColors) {
-			dst.r = src.flat_r;
-			dst.g = src.flat_g;
-			dst.b = src.flat_b;
-			dst.a = src.flat_a;
-		} else {
-			dst.r = src.r;
-			dst.g = src.g;
-			dst.b = src.b;
-			dst.a = src.a;
-		}
+		dst.r = _colorToByte(color[0]);
+		dst.g = _colorToByte(color[1]);
+		dst.b = _colorToByte(color[2]);
+		dst.a = _colorToByte(color[3]);
 		dst.s = src.s;
 		dst.t = src.t;
 		dst.modify = src.modify;
 	}
+	return _dst;
 }
 
-void BufferedDrawer::_updateTrianglesBuffers(const graphics::Context::DrawTriangleParameters & _params)
+void BufferedDrawer::_writeVertices(bool _flatColors, u32 _count, const SPVertex * _data, const u8 * _drawIds)
 {
 	const BuffersType type = BuffersType::triangles;
-
 	if (m_type != type) {
 		glBindVertexArray(m_trisBuffers.vao);
 		m_type = type;
 	}
 
-	_convertFromSPVertex(_params.flatColors, _params.verticesCount, _params.vertices);
-	const u32 vboDataSize = _params.verticesCount * static_cast<u32>(sizeof(Vertex));
+	// Hardware lighting needs the full precision normal.
+	VertexLayout layout = VertexLayout::full;
+	if (!isHWLightingAllowed())
+		layout = m_glInfo.drawMerging ? VertexLayout::merged : VertexLayout::compact;
+	if (layout != m_layout)
+		_setTrianglesLayout(layout);
+
+	// Vertices go straight from gSP output to the mapped buffer.
 	Buffer & vboBuffer = m_trisBuffers.vbo;
-	_updateBuffer(vboBuffer, _params.verticesCount, vboDataSize, m_vertices.data());
+	switch (layout) {
+	case VertexLayout::full:
+	{
+		Vertex * dst = reinterpret_cast<Vertex*>(_beginWrite(vboBuffer, _count, sizeof(Vertex)));
+		for (u32 i = 0; i < _count; ++i, ++dst) {
+			const SPVertex & src = _data[i];
+			const f32 * color = _flatColors ? &src.flat_r : &src.r;
+			dst->x = src.x;
+			dst->y = src.y;
+			dst->z = src.z;
+			dst->w = src.w;
+			dst->r = color[0];
+			dst->g = color[1];
+			dst->b = color[2];
+			dst->a = color[3];
+			dst->s = src.s;
+			dst->t = src.t;
+			dst->modify = src.modify;
+		}
+	}
+	break;
+	case VertexLayout::compact:
+		_writeCompactVertices(reinterpret_cast<CompactVertex*>(_beginWrite(vboBuffer, _count, sizeof(CompactVertex))),
+			_flatColors, _count, _data);
+	break;
+	case VertexLayout::merged:
+	{
+		MergedVertex * dst = _writeCompactVertices(reinterpret_cast<MergedVertex*>(_beginWrite(vboBuffer, _count, sizeof(MergedVertex))),
+			_flatColors, _count, _data);
+		for (u32 i = 0; i < _count; ++i)
+			dst[i].drawId = _drawIds != nullptr ? f32(_drawIds[i]) : 0.0f;
+	}
+	break;
+	}
+	_endWrite(vboBuffer);
+}
+
+void BufferedDrawer::_updateTrianglesBuffers(const graphics::Context::DrawTriangleParameters & _params)
+{
+	_writeVertices(_params.flatColors, _params.verticesCount, _params.vertices, _params.drawIds);
 
 	if (_params.elements == nullptr)
 		return;
 
-	const u32 eboDataSize = static_cast<u32>(sizeof(GLushort)) * _params.elementsCount;
 	Buffer & eboBuffer = m_trisBuffers.ebo;
-	_updateBuffer(eboBuffer, _params.elementsCount, eboDataSize, _params.elements);
+	_updateBuffer(eboBuffer, _params.elementsCount, static_cast<u32>(sizeof(GLushort)), _params.elements);
 }
 
 void BufferedDrawer::drawTriangles(const graphics::Context::DrawTriangleParameters & _params)
@@ -233,17 +365,7 @@ void BufferedDrawer::drawTriangles(const graphics::Context::DrawTriangleParamete
 
 void BufferedDrawer::drawLine(f32 _width, SPVertex * _vertices)
 {
-	const BuffersType type = BuffersType::triangles;
-
-	if (m_type != type) {
-		glBindVertexArray(m_trisBuffers.vao);
-		m_type = type;
-	}
-
-	_convertFromSPVertex(false, 2, _vertices);
-	const GLsizeiptr vboDataSize = 2 * sizeof(Vertex);
-	Buffer & vboBuffer = m_trisBuffers.vbo;
-	_updateBuffer(vboBuffer, 2, vboDataSize, m_vertices.data());
+	_writeVertices(false, 2, _vertices, nullptr);
 
 	glLineWidth(_width);
 	glDrawArrays(GL_LINES, m_trisBuffers.vbo.pos - 2, 2);
@@ -1,5 +1,5 @@
 #pragma once
-#include <vector>
+#include <array>
 #include <unordered_map>
 #include "opengl_GLInfo.h"
 #include "opengl_GraphicsDrawer.h"
@@ -30,15 +30,23 @@ namespace opengl {
 			triangles
 		};
 
+		static const u32 m_numSegments = 4;
+
+		// Ring split into segments. A fence is placed when writing leaves a segment,
+		// and writing waits for that fence only when it comes back to the segment.
 		struct Buffer {
-			Buffer(GLenum _type) : type(_type) {}
+			Buffer(GLenum _type) : type(_type) { fences.fill(nullptr); }
 
 			GLenum type;
 			GLuint handle = 0;
 			GLintptr offset = 0;
 			GLint pos = 0;
 			GLuint size = 0;
+			GLuint segmentSize = 0;
+			u32 segment = 0;
+			bool segmentUsed = false;
 			GLubyte * data = nullptr;
+			std::array<GLsync, m_numSegments> fences;
 		};
 
 		struct RectBuffers {
@@ -52,6 +60,7 @@ namespace opengl {
 			Buffer ebo = Buffer(GL_ELEMENT_ARRAY_BUFFER);
 		};
 
+		// Used with hardware lighting, which passes the normal in r, g, b
 		struct Vertex
 		{
 			f32 x, y, z, w;
@@ -60,9 +69,39 @@ namespace opengl {
 			u32 modify;
 		};
 
+		// Shade colors are 8 bits per component on the N64
+		struct CompactVertex
+		{
+			f32 x, y, z, w;
+			u8 r, g, b, a;
+			f32 s, t;
+			u32 modify;
+		};
+
+		// Compact vertex with the index of its draw in a merged batch
+		struct MergedVertex
+		{
+			f32 x, y, z, w;
+			u8 r, g, b, a;
+			f32 s, t;
+			u32 modify;
+			f32 drawId;
+		};
+
+		enum class VertexLayout {
+			full,
+			compact,
+			merged
+		};
+
 		void _initBuffer(Buffer & _buffer, GLuint _bufSize);
-		void _updateBuffer(Buffer & _buffer, u32 _count, u32 _dataSize, const void * _data);
-		void _convertFromSPVertex(bool _flatColors, u32 _count, const SPVertex * _data);
+		void _destroyBuffer(Buffer & _buffer);
+		void _nextSegment(Buffer & _buffer);
+		GLubyte * _beginWrite(Buffer & _buffer, u32 _count, u32 _stride);
+		void _endWrite(Buffer & _buffer);
+		void _updateBuffer(Buffer & _buffer, u32 _count, u32 _stride, const void * _data);
+		void _setTrianglesLayout(VertexLayout _layout);
+		void _writeVertices(bool _flatColors, u32 _count, const SPVertex * _data, const u8 * _drawIds);
 
 		const GLInfo & m_glInfo;
 		CachedVertexAttribArray * m_cachedAttribArray;
@@ -71,8 +110,7 @@ namespace opengl {
 		RectBuffers m_rectsBuffers;
 		TrisBuffers m_trisBuffers;
 		BuffersType m_type = BuffersType::none;
-
-		std::vector<Vertex> m_vertices;
+		VertexLayout m_layout = VertexLayout::full;
 
 		typedef std::unordered_map<u32, u32> BufferOffsets;
 		BufferOffsets m_rectBufferOffsets;
@@ -1,3 +1,6 @@
+#include <tuple>
+#include <Log.h>
+#include <DisplayWindow.h>
 #include <Graphics/Parameters.h>
 
 #include "GLFunctions.h"
@@ -20,8 +23,9 @@ extern "C" void rglDisable(GLenum cap);
 
 /*---------------CachedEnable-------------*/
 
-CachedEnable::CachedEnable(Parameter _parameter)
-: m_parameter(_parameter)
+CachedEnable::CachedEnable(Parameter _parameter, PipelineState & _state)
+: DeferredState(_state, psEnables)
+, m_parameter(_parameter)
 {
 }
 
@@ -30,10 +34,25 @@ void CachedEnable::enable(bool _enable)
 	if (!m_parameter.isValid())
 		return;
 
-	if (!update(u32(_enable)))
+	const Parameter enable = Parameter(u32(_enable));
+	if (enable == m_pending)
 		return;
 
-	if (_enable) {
+	m_pending = enable;
+	setDirty();
+}
+
+void CachedEnable::apply()
+{
+	if (!m_parameter.isValid())
+		return;
+
+	if (!update(m_pending))
+		return;
+
+	++m_state.glCalls;
+
+	if (u32(m_pending) != 0) {
 		switch(GLenum(m_parameter)) {
 			case GL_BLEND:
 				if(IS_GL_FUNCTION_VALID(Enablei))
@@ -98,7 +117,7 @@ void CachedEnable::enable(bool _enable)
 
 u32 CachedEnable::get()
 {
-	return u32(m_cached);
+	return u32(m_pending);
 }
 
 /*---------------CachedBindFramebuffer-------------*/
@@ -136,56 +155,146 @@ void CachedBindTexture::bind(Parameter _tmuIndex, Parameter _target, ObjectHandl
 
 void CachedCullFace::setCullFace(Parameter _mode)
 {
-	if (update(_mode))
-		glCullFace(GLenum(_mode));
+	if (_mode == m_pending)
+		return;
+	m_pending = _mode;
+	setDirty();
+}
+
+void CachedCullFace::apply()
+{
+	if (!update(m_pending))
+		return;
+	glCullFace(GLenum(m_pending));
+	++m_state.glCalls;
 }
 
 /*---------------CachedDepthMask-------------*/
 
 void CachedDepthMask::setDepthMask(bool _enable)
 {
-	if (update(Parameter(u32(_enable))))
-		glDepthMask(GLboolean(_enable));
+	const Parameter enable = Parameter(u32(_enable));
+	if (enable == m_pending)
+		return;
+	m_pending = enable;
+	setDirty();
 }
 
-/*---------------CachedDepthMask-------------*/
+void CachedDepthMask::apply()
+{
+	if (!update(m_pending))
+		return;
+	glDepthMask(GLboolean(u32(m_pending)));
+	++m_state.glCalls;
+}
+
+/*---------------CachedDepthCompare-------------*/
 
 void CachedDepthCompare::setDepthCompare(Parameter _mode)
 {
-	if (update(_mode))
-		glDepthFunc(GLenum(_mode));
+	if (_mode == m_pending)
+		return;
+	m_pending = _mode;
+	setDirty();
+}
+
+void CachedDepthCompare::apply()
+{
+	if (!update(m_pending))
+		return;
+	glDepthFunc(GLenum(m_pending));
+	++m_state.glCalls;
 }
 
 /*---------------CachedViewport-------------*/
 
 void CachedViewport::setViewport(s32 _x, s32 _y, s32 _width, s32 _height)
 {
-	if (update(Parameter(_x), Parameter(_y), Parameter(_width), Parameter(_height)))
-		glViewport(_x, _y, _width, _height);
+	if (m_pending[0] == Parameter(_x) &&
+		m_pending[1] == Parameter(_y) &&
+		m_pending[2] == Parameter(_width) &&
+		m_pending[3] == Parameter(_height))
+		return;
+	m_pending[0] = Parameter(_x);
+	m_pending[1] = Parameter(_y);
+	m_pending[2] = Parameter(_width);
+	m_pending[3] = Parameter(_height);
+	setDirty();
+}
+
+void CachedViewport::apply()
+{
+	if (!update(m_pending[0], m_pending[1], m_pending[2], m_pending[3]))
+		return;
+	glViewport(s32(m_pending[0]), s32(m_pending[1]), s32(m_pending[2]), s32(m_pending[3]));
+	++m_state.glCalls;
 }
 
 /*---------------CachedScissor-------------*/
 
 void CachedScissor::setScissor(s32 _x, s32 _y, s32 _width, s32 _height)
 {
-	if (update(Parameter(_x), Parameter(_y), Parameter(_width), Parameter(_height)))
-		glScissor(_x, _y, _width, _height);
+	if (m_pending[0] == Parameter(_x) &&
+		m_pending[1] == Parameter(_y) &&
+		m_pending[2] == Parameter(_width) &&
+		m_pending[3] == Parameter(_height))
+		return;
+	m_pending[0] = Parameter(_x);
+	m_pending[1] = Parameter(_y);
+	m_pending[2] = Parameter(_width);
+	m_pending[3] = Parameter(_height);
+	setDirty();
+}
+
+void CachedScissor::apply()
+{
+	if (!update(m_pending[0], m_pending[1], m_pending[2], m_pending[3]))
+		return;
+	glScissor(s32(m_pending[0]), s32(m_pending[1]), s32(m_pending[2]), s32(m_pending[3]));
+	++m_state.glCalls;
 }
 
 /*---------------CachedBlending-------------*/
 
 void CachedBlending::setBlending(Parameter _sfactor, Parameter _dfactor)
 {
-	if (update(_sfactor, _dfactor))
-		glBlendFunc(GLenum(_sfactor), GLenum(_dfactor));
+	if (m_pending[0] == _sfactor && m_pending[1] == _dfactor)
+		return;
+	m_pending[0] = _sfactor;
+	m_pending[1] = _dfactor;
+	setDirty();
+}
+
+void CachedBlending::apply()
+{
+	if (!update(m_pending[0], m_pending[1]))
+		return;
+	glBlendFunc(GLenum(m_pending[0]), GLenum(m_pending[1]));
+	++m_state.glCalls;
 }
 
 /*---------------CachedBlendColor-------------*/
 
 void CachedBlendColor::setBlendColor(f32 _red, f32 _green, f32 _blue, f32 _alpha)
 {
-	if (update(Parameter(_red), Parameter(_green), Parameter(_blue), Parameter(_alpha)))
-		glBlendColor(_red, _green, _blue, _alpha);
+	if (m_pending[0] == Parameter(_red) &&
+		m_pending[1] == Parameter(_green) &&
+		m_pending[2] == Parameter(_blue) &&
+		m_pending[3] == Parameter(_alpha))
+		return;
+	m_pending[0] = Parameter(_red);
+	m_pending[1] = Parameter(_green);
+	m_pending[2] = Parameter(_blue);
+	m_pending[3] = Parameter(_alpha);
+	setDirty();
+}
+
+void CachedBlendColor::apply()
+{
+	if (!update(m_pending[0], m_pending[1], m_pending[2], m_pending[3]))
+		return;
+	glBlendColor(f32(m_pending[0]), f32(m_pending[1]), f32(m_pending[2]), f32(m_pending[3]));
+	++m_state.glCalls;
 }
 
 /*---------------CachedClearColor-------------*/
@@ -234,10 +343,18 @@ void CachedTextureUnpackAlignment::setTextureUnpackAlignment(s32 _param)
 /*---------------CachedFunctions-------------*/
 
 CachedFunctions::CachedFunctions(const GLInfo & _glinfo)
+: m_cullFace(m_pipelineState)
+, m_depthMask(m_pipelineState)
+, m_depthCompare(m_pipelineState)
+, m_viewport(m_pipelineState)
+, m_scissor(m_pipelineState)
+, m_blending(m_pipelineState)
+, m_blendColor(m_pipelineState)
 {
 	if (_glinfo.isGLESX) {
 		// Disable parameters, not avalible for GLESX
-		m_enables.emplace(GL_DEPTH_CLAMP, Parameter());
+		m_enables.emplace(std::piecewise_construct, std::forward_as_tuple(GL_DEPTH_CLAMP),
+			std::forward_as_tuple(Parameter(), m_pipelineState));
 	}
 }
 
@@ -247,7 +364,7 @@ CachedFunctions::~CachedFunctions()
 
 void CachedFunctions::reset()
 {
-	for (auto it : m_enables)
+	for (auto & it : m_enables)
 		it.second.reset();
 
 	m_texparams.clear();
@@ -265,6 +382,66 @@ void CachedFunctions::reset()
 	m_clearColor.reset();
 	m_attribArray.reset();
 	m_useProgram.reset();
+	// Requested state is kept and has to be issued again.
+	m_pipelineState.dirty = psAll;
+}
+
+// Statistics are sampled and reset by the first apply after a buffer swap,
+// so state requested for the new frame before it is counted in the previous one.
+void CachedFunctions::_sampleFrameStatistics()
+{
+	PipelineState & state = m_pipelineState;
+	const u32 frame = dwnd().getBuffersSwapCount();
+	if (frame == state.frame)
+		return;
+
+	if (state.applies != 0) {
+		LOG(LOG_DEBUG, "Pipeline state, frame %u: %u changes requested, %u GL calls issued over %u draws\n",
+			state.frame, state.requests, state.glCalls, state.applies);
+		++state.frames;
+		state.totalRequests += state.requests;
+		state.totalGLCalls += state.glCalls;
+		state.totalApplies += state.applies;
+	}
+
+	state.requests = 0;
+	state.glCalls = 0;
+	state.applies = 0;
+	state.frame = frame;
+}
+
+void CachedFunctions::applyPipelineState()
+{
+	_sampleFrameStatistics();
+	++m_pipelineState.applies;
+	const u32 dirty = m_pipelineState.dirty;
+	if (dirty == 0)
+		return;
+	m_pipelineState.dirty = 0;
+
+	if ((dirty & psEnables) != 0) {
+		for (auto & it : m_enables)
+			it.second.apply();
+	}
+	if ((dirty & psCullFace) != 0)
+		m_cullFace.apply();
+	if ((dirty & psDepthMask) != 0)
+		m_depthMask.apply();
+	if ((dirty & psDepthCompare) != 0)
+		m_depthCompare.apply();
+	if ((dirty & psViewport) != 0)
+		m_viewport.apply();
+	if ((dirty & psScissor) != 0)
+		m_scissor.apply();
+	if ((dirty & psBlending) != 0)
+		m_blending.apply();
+	if ((dirty & psBlendColor) != 0)
+		m_blendColor.apply();
+}
+
+const PipelineState & CachedFunctions::getPipelineState() const
+{
+	return m_pipelineState;
 }
 
 CachedEnable * CachedFunctions::getCachedEnable(Parameter _parameter)
@@ -272,7 +449,8 @@ CachedEnable * CachedFunctions::getCachedEnable(Parameter _parameter)
 	const u32 key(_parameter);
 	auto it = m_enables.find(key);
 	if (it == m_enables.end()) {
-		auto res = m_enables.emplace(key, _parameter);
+		auto res = m_enables.emplace(std::piecewise_construct, std::forward_as_tuple(key),
+			std::forward_as_tuple(_parameter, m_pipelineState));
 		if (res.second)
 			return &(res.first->second);
 		return nullptr;
@@ -96,17 +96,66 @@ namespace opengl {
 		graphics::Parameter m_p1, m_p2, m_p3, m_p4;
 	};
 
-	class CachedEnable : public Cached1<graphics::Parameter>
+	// Pipeline state which the drawer changes freely between draws.
+	// Setters only record the requested value and mark it dirty.
+	// CachedFunctions::applyPipelineState() issues GL calls for the dirty values which differ from GL state.
+	enum PipelineStateBits {
+		psEnables = 1 << 0,
+		psCullFace = 1 << 1,
+		psDepthMask = 1 << 2,
+		psDepthCompare = 1 << 3,
+		psViewport = 1 << 4,
+		psScissor = 1 << 5,
+		psBlending = 1 << 6,
+		psBlendColor = 1 << 7,
+		psAll = (1 << 8) - 1
+	};
+
+	struct PipelineState
+	{
+		u32 dirty = 0;
+		// Statistics of the current frame: state changes requested, GL calls issued for them and number of applies (draws, clears, blits).
+		u32 requests = 0;
+		u32 glCalls = 0;
+		u32 applies = 0;
+		// Buffer swap count of the current frame, and the statistics of the frames before it.
+		u32 frame = 0;
+		u32 frames = 0;
+		u64 totalRequests = 0;
+		u64 totalGLCalls = 0;
+		u64 totalApplies = 0;
+	};
+
+	class DeferredState
+	{
+	public:
+		DeferredState(PipelineState & _state, u32 _bit)
+			: m_state(_state), m_bit(_bit) {}
+
+	protected:
+		void setDirty()
+		{
+			m_state.dirty |= m_bit;
+			++m_state.requests;
+		}
+
+		PipelineState & m_state;
+		const u32 m_bit;
+	};
+
+	class CachedEnable : public Cached1<graphics::Parameter>, public DeferredState
 	{
 	public:
-		CachedEnable(graphics::Parameter _parameter);
+		CachedEnable(graphics::Parameter _parameter, PipelineState & _state);
 
 		void enable(bool _enable);
+		void apply();
 
 		u32 get();
 
 	private:
 		const graphics::Parameter m_parameter;
+		graphics::Parameter m_pending;
 	};
 
 
@@ -134,46 +183,81 @@ namespace opengl {
 		void bind(graphics::Parameter _tmuIndex, graphics::Parameter _target, graphics::ObjectHandle _name);
 	};
 
-	class CachedCullFace : public Cached1<graphics::Parameter>
+	class CachedCullFace : public Cached1<graphics::Parameter>, public DeferredState
 	{
 	public:
+		CachedCullFace(PipelineState & _state) : DeferredState(_state, psCullFace) {}
 		void setCullFace(graphics::Parameter _mode);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending;
 	};
 
-	class CachedDepthMask : public Cached1<graphics::Parameter>
+	class CachedDepthMask : public Cached1<graphics::Parameter>, public DeferredState
 	{
 	public:
+		CachedDepthMask(PipelineState & _state) : DeferredState(_state, psDepthMask) {}
 		void setDepthMask(bool _enable);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending;
 	};
 
-	class CachedDepthCompare : public Cached1<graphics::Parameter>
+	class CachedDepthCompare : public Cached1<graphics::Parameter>, public DeferredState
 	{
 	public:
+		CachedDepthCompare(PipelineState & _state) : DeferredState(_state, psDepthCompare) {}
 		void setDepthCompare(graphics::Parameter m_mode);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending;
 	};
 
-	class CachedViewport : public Cached4
+	class CachedViewport : public Cached4, public DeferredState
 	{
 	public:
+		CachedViewport(PipelineState & _state) : DeferredState(_state, psViewport) {}
 		void setViewport(s32 _x, s32 _y, s32 _width, s32 _height);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending[4];
 	};
 
-	class CachedScissor : public Cached4
+	class CachedScissor : public Cached4, public DeferredState
 	{
 	public:
+		CachedScissor(PipelineState & _state) : DeferredState(_state, psScissor) {}
 		void setScissor(s32 _x, s32 _y, s32 _width, s32 _height);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending[4];
 	};
 
-	class CachedBlending : public Cached2<graphics::Parameter, graphics::Parameter>
+	class CachedBlending : public Cached2<graphics::Parameter, graphics::Parameter>, public DeferredState
 	{
 	public:
+		CachedBlending(PipelineState & _state) : DeferredState(_state, psBlending) {}
 		void setBlending(graphics::Parameter _sfactor, graphics::Parameter _dfactor);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending[2];
 	};
 
-	class CachedBlendColor : public Cached4
+	class CachedBlendColor : public Cached4, public DeferredState
 	{
 	public:
+		CachedBlendColor(PipelineState & _state) : DeferredState(_state, psBlendColor) {}
 		void setBlendColor(f32 _red, f32 _green, f32 _blue, f32 _alpha);
+		void apply();
+
+	private:
+		graphics::Parameter m_pending[4];
 	};
 
 	class CachedClearColor : public Cached4
@@ -225,6 +309,12 @@ namespace opengl {
 
 		void reset();
 
+		// Issue GL calls for pipeline state changed since the last apply.
+		// Must be called before anything which depends on that state: draws, clears and blits.
+		void applyPipelineState();
+
+		const PipelineState & getPipelineState() const;
+
 		CachedEnable * getCachedEnable(graphics::Parameter _parameter);
 
 		CachedBindTexture * getCachedBindTexture();
@@ -260,8 +350,11 @@ namespace opengl {
 		TextureParams * getTexParams();
 
 	private:
+		void _sampleFrameStatistics();
+
 		typedef std::unordered_map<u32, CachedEnable> EnableParameters;
 
+		PipelineState m_pipelineState;
 		TextureParams m_texparams;
 		EnableParameters m_enables;
 		CachedBindTexture m_bindTexture;
@@ -19,7 +19,7 @@ ColorBufferReaderWithBufferStorage::~ColorBufferReaderWithBufferStorage()
 
 void ColorBufferReaderWithBufferStorage::_initBuffers()
 {
-	m_numPBO = config.frameBufferEmulation.copyToRDRAM;
+	m_numPBO = config.getColorReadbackBuffers();
 	if (m_numPBO > _maxPBO)
 		m_numPBO = _maxPBO;
 
@@ -63,6 +63,7 @@ void ContextImpl::init()
 		m_initRenderbuffer.reset(bufferObjectFactory.getInitRenderbuffer());
 		m_addFramebufferRenderTarget.reset(bufferObjectFactory.getAddFramebufferRenderTarget());
 		m_createPixelReadBuffer.reset(bufferObjectFactory.createPixelReadBuffer());
+		m_createPixelWriteBuffer.reset(bufferObjectFactory.createPixelWriteBuffer());
 		m_blitFramebuffers.reset(bufferObjectFactory.getBlitFramebuffers());
 	}
 
@@ -89,6 +90,17 @@ void ContextImpl::destroy()
 	m_graphicsDrawer.reset();
 	m_combinerProgramBuilder.reset();
 
+	// The current frame was not sampled yet
+	const PipelineState & state = m_cachedFunctions->getPipelineState();
+	const u32 frames = state.frames + (state.applies != 0 ? 1 : 0);
+	if (frames != 0) {
+		LOG(LOG_VERBOSE, "Pipeline state over %u frames: per frame %.1f changes requested, %.1f GL calls issued over %.1f draws\n",
+			frames,
+			(state.totalRequests + state.requests) / (double)frames,
+			(state.totalGLCalls + state.glCalls) / (double)frames,
+			(state.totalApplies + state.applies) / (double)frames);
+	}
+
 	m_cachedFunctions.reset();
 }
 
@@ -168,6 +180,8 @@ void ContextImpl::clearColorBuffer(f32 _red, f32 _green, f32 _blue, f32 _alpha)
 	CachedEnable * enableScissor = m_cachedFunctions->getCachedEnable(graphics::enable::SCISSOR_TEST);
 	enableScissor->enable(false);
 
+	m_cachedFunctions->applyPipelineState();
+
 	if (m_glInfo.isGLES2) {
 		m_cachedFunctions->getCachedClearColor()->setClearColor(_red, _green, _blue, _alpha);
 		glClear(GL_COLOR_BUFFER_BIT);
@@ -187,10 +201,12 @@ void ContextImpl::clearDepthBuffer()
 
 	if (m_glInfo.renderer == Renderer::PowerVR) {
 		depthMask->setDepthMask(false);
+		m_cachedFunctions->applyPipelineState();
 		glClear(GL_DEPTH_BUFFER_BIT);
 	}
 
 	depthMask->setDepthMask(true);
+	m_cachedFunctions->applyPipelineState();
 	glClear(GL_DEPTH_BUFFER_BIT);
 
 	enableScissor->enable(true);
@@ -311,6 +327,7 @@ void ContextImpl::bindFramebuffer(graphics::BufferTargetParam _target, graphics:
 	if (m_glInfo.renderer == Renderer::VideoCore) {
 		CachedDepthMask * depthMask = m_cachedFunctions->getCachedDepthMask();
 		depthMask->setDepthMask(true);
+		m_cachedFunctions->applyPipelineState();
 		glClear(GL_DEPTH_BUFFER_BIT);
 	}
 	m_cachedFunctions->getCachedBindFramebuffer()->bind(_target, _name);
@@ -349,6 +366,13 @@ graphics::PixelReadBuffer * ContextImpl::createPixelReadBuffer(size_t _sizeInByt
 	return nullptr;
 }
 
+graphics::PixelWriteBuffer * ContextImpl::createPixelWriteBuffer(size_t _sizeInBytes)
+{
+	if (m_createPixelWriteBuffer)
+		return m_createPixelWriteBuffer->createPixelWriteBuffer(_sizeInBytes);
+	return nullptr;
+}
+
 graphics::ColorBufferReader * ContextImpl::createColorBufferReader(CachedTexture * _pTexture)
 {
 #if defined(EGL) && defined(OS_ANDROID)
@@ -450,16 +474,19 @@ void ContextImpl::resetShaderProgram()
 
 void ContextImpl::drawTriangles(const graphics::Context::DrawTriangleParameters & _params)
 {
+	m_cachedFunctions->applyPipelineState();
 	m_graphicsDrawer->drawTriangles(_params);
 }
 
 void ContextImpl::drawRects(const graphics::Context::DrawRectParameters & _params)
 {
+	m_cachedFunctions->applyPipelineState();
 	m_graphicsDrawer->drawRects(_params);
 }
 
 void ContextImpl::drawLine(f32 _width, SPVertex * _vertices)
 {
+	m_cachedFunctions->applyPipelineState();
 	m_graphicsDrawer->drawLine(_width, _vertices);
 }
 
@@ -498,6 +525,10 @@ bool ContextImpl::isSupported(graphics::SpecialFeatures _feature) const
 		return m_glInfo.eglImage;
 	case graphics::SpecialFeatures::EglImageFramebuffer:
 		return m_glInfo.eglImageFramebuffer;
+	case graphics::SpecialFeatures::DrawMerging:
+		return m_glInfo.drawMerging;
+	case graphics::SpecialFeatures::ShaderTMEM:
+		return m_glInfo.shaderTMEM;
 	}
 	return false;
 }
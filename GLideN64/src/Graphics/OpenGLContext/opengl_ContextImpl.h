@@ -102,6 +102,8 @@ namespace opengl {
 
 		graphics::PixelReadBuffer * createPixelReadBuffer(size_t _sizeInBytes) override;
 
+		graphics::PixelWriteBuffer * createPixelWriteBuffer(size_t _sizeInBytes) override;
+
 		graphics::ColorBufferReader * createColorBufferReader(CachedTexture * _pTexture) override;
 
 		/*---------------Shaders-------------*/
@@ -160,6 +162,7 @@ namespace opengl {
 		std::unique_ptr<InitRenderbuffer> m_initRenderbuffer;
 		std::unique_ptr<AddFramebufferRenderTarget> m_addFramebufferRenderTarget;
 		std::unique_ptr<CreatePixelReadBuffer> m_createPixelReadBuffer;
+		std::unique_ptr<CreatePixelWriteBuffer> m_createPixelWriteBuffer;
 		std::unique_ptr<BlitFramebuffers> m_blitFramebuffers;
 		std::unique_ptr<graphics::FramebufferTextureFormats> m_fbTexFormats;
 
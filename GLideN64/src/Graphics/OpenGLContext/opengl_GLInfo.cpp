@@ -192,6 +192,14 @@ void GLInfo::init() {
 		}
 	}
 
+	// Merged draws need the buffered drawer and one draw call per batch.
+	drawMerging = config.generalEmulation.enableDrawMerging != 0 && !isGLES2 &&
+		(!isGLESX || (bufferStorage && numericVersion >= 32)) &&
+		config.frameBufferEmulation.N64DepthCompare != Config::dcCompatible;
+
+	// TMEM is read with texelFetch from an unsigned integer texture.
+	shaderTMEM = config.texture.enableShaderTMEM != 0 && !isGLES2;
+
 #ifdef EGL
 	if (isGLESX)
 	{
@@ -35,6 +35,8 @@ struct GLInfo {
 	bool ext_fetch = false;
 	bool eglImage = false;
 	bool eglImageFramebuffer = false;
+	bool drawMerging = false;
+	bool shaderTMEM = false;
 	Renderer renderer = Renderer::Other;
 
 	void init();
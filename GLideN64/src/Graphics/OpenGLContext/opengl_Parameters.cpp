@@ -74,6 +74,7 @@ namespace graphics {
 		TextureUnitParam ZLUTTex(4U);
 		TextureUnitParam PaletteTex(5U);
 		TextureUnitParam MSTex[2] = { 6U, 7U };
+		TextureUnitParam TMEMTex(8U);
 	}
 
 	namespace textureImageUnits {
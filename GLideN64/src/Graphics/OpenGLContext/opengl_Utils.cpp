@@ -115,6 +115,22 @@ const char* GLErrorString(GLenum errorCode)
 	return nullptr;
 }
 
+bool Utils::waitForSync(GLsync _fence)
+{
+	// Commands only need to be flushed once, later waits can't be blocked by them.
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		const GLenum result = glClientWaitSync(_fence, flags, 100000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			return true;
+		if (result != GL_TIMEOUT_EXPIRED) {
+			LOG(LOG_ERROR, "glClientWaitSync failed (%x)", result);
+			return false;
+		}
+		flags = 0;
+	}
+}
+
 bool Utils::isGLError()
 {
 #ifdef GL_DEBUG
@@ -10,6 +10,8 @@ namespace opengl {
 		static bool isEGLExtensionSupported(const char * extension);
 		static bool isGLError();
 		static bool isFramebufferError();
+		// Wait until _fence is signaled. Returns false if the wait failed.
+		static bool waitForSync(GLsync _fence);
 	};
 
 }
@@ -74,6 +74,7 @@ namespace graphics {
 		extern TextureUnitParam ZLUTTex;
 		extern TextureUnitParam PaletteTex;
 		extern TextureUnitParam MSTex[2];
+		extern TextureUnitParam TMEMTex;
 	}
 
 	namespace textureImageUnits {
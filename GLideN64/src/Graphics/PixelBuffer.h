@@ -14,6 +14,18 @@ namespace graphics {
 		virtual void unbind() = 0;
 	};
 
+	class PixelWriteBuffer
+	{
+	public:
+		virtual ~PixelWriteBuffer() {}
+		// Returns memory for _size bytes of pixel data or nullptr if the buffer can't provide it.
+		virtual void * getWriteBuffer(size_t _size) = 0;
+		// Finishes the last write. Returns pointer to pass as texture data while the buffer is bound.
+		virtual const void * closeWriteBuffer() = 0;
+		virtual void bind() = 0;
+		virtual void unbind() = 0;
+	};
+
 	template<class T>
 	class PixelBufferBinder
 	{
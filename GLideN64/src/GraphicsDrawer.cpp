@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <iterator>
 #include <string>
 #include <thread>
 #include <assert.h>
@@ -13,11 +14,14 @@
 #include "NoiseTexture.h"
 #include "ZlutTexture.h"
 #include "PaletteTexture.h"
+#include "TMEMTexture.h"
 #include "FrameBuffer.h"
 #include "DepthBuffer.h"
 #include "FrameBufferInfo.h"
 #include "Config.h"
 #include "Debugger.h"
+#include "DisplayListCapture.h"
+#include "Log.h"
 #include "RSP.h"
 #include "RDP.h"
 #include "VI.h"
@@ -31,6 +35,9 @@ GraphicsDrawer::GraphicsDrawer()
 , m_maxLineWidth(1.0f)
 , m_bFlatColors(false)
 , m_bBGMode(false)
+, m_bDrawMerging(false)
+, m_bMergeTriangles(false)
+, m_bBatchTexrects(false)
 {
 	memset(m_rect, 0, sizeof(m_rect));
 }
@@ -622,6 +629,8 @@ void GraphicsDrawer::_updateTextures() const
 	//For some reason updating the texture cache on the first frame of LOZ:OOT causes a nullptr Pointer exception...
 	CombinerInfo & cmbInfo = CombinerInfo::get();
 	CombinerProgram * pCurrentCombiner = cmbInfo.getCurrent();
+	if ((gDP.changed & CHANGED_TMEM) != 0)
+		g_tmemTexture.invalidate();
 	if (pCurrentCombiner != nullptr) {
 		for (u32 t = 0; t < 2; ++t) {
 			if (pCurrentCombiner->usesTile(t))
@@ -705,7 +714,7 @@ void GraphicsDrawer::_updateStates(DrawingState _drawingState) const
 
 void GraphicsDrawer::_prepareDrawTriangle()
 {
-	m_texrectDrawer.draw();
+	flush();
 
 	if ((m_modifyVertices & MODIFY_XY) != 0)
 		gSP.changed &= ~CHANGED_VIEWPORT;
@@ -732,15 +741,240 @@ bool GraphicsDrawer::_canDraw() const
 	return config.frameBufferEmulation.enable == 0 || frameBufferList().getCurrent() != nullptr;
 }
 
+static_assert(sizeof(GraphicsDrawer::DrawParams) == DRAW_PARAMS_VEC4 * 4 * sizeof(f32), "DrawParams must be a whole number of vec4");
+
+void GraphicsDrawer::_fillDrawParams(DrawParams & _params) const
+{
+	memcpy(_params.primColor, &gDP.primColor.r, sizeof(_params.primColor));
+	memcpy(_params.envColor, &gDP.envColor.r, sizeof(_params.envColor));
+	memcpy(_params.fogColor, &gDP.fogColor.r, sizeof(_params.fogColor));
+	memcpy(_params.blendColor, &gDP.blendColor.r, sizeof(_params.blendColor));
+	_params.primLod = gDP.primColor.l;
+	_params.k4 = _FIXED2FLOATCOLOR(gDP.convert.k4, 8);
+	_params.k5 = _FIXED2FLOATCOLOR(gDP.convert.k5, 8);
+	// Same as the alpha test value of the combiner uniforms.
+	_params.alphaTestValue = gDP.otherMode.cycleType == G_CYC_COPY ? 0.5f : gDP.blendColor.a;
+}
+
+const GraphicsDrawer::DrawParams * GraphicsDrawer::getDrawParams(u32 & _count)
+{
+	if (m_mergedTriangles.draws == 0) {
+		_fillDrawParams(m_mergedTriangles.params[0]);
+		_count = 1;
+	} else
+		_count = m_mergedTriangles.draws;
+	return m_mergedTriangles.params.data();
+}
+
+bool GraphicsDrawer::canMergeTriangles() const
+{
+	// Hardware lighting passes the number of lights per draw.
+	return m_bDrawMerging && !isHWLightingAllowed();
+}
+
+// Colors which are merge safe but also feed state set once for the whole batch:
+// the minimum LOD uniform and the blend color of legacy blending.
+bool GraphicsDrawer::_isMergedStateChanged() const
+{
+	if (gDP.primColor.m != m_mergedTriangles.minLod)
+		return true;
+	if (config.generalEmulation.enableLegacyBlending != 0) {
+		const gDPInfo::Color & fogColor = m_mergedTriangles.fogColor;
+		return gDP.fogColor.r != fogColor.r || gDP.fogColor.g != fogColor.g ||
+			gDP.fogColor.b != fogColor.b || gDP.fogColor.a != fogColor.a;
+	}
+	return false;
+}
+
+void GraphicsDrawer::_mergeTriangles()
+{
+	const u32 verticesCount = static_cast<u32>(triangles.maxElement) + 1;
+	if (m_mergedTriangles.draws != 0 &&
+		(m_mergedTriangles.draws == MAX_MERGED_DRAWS ||
+		m_mergedTriangles.vertices.size() + verticesCount > MERGED_VERTBUFF_SIZE ||
+		(m_modifyVertices & MODIFY_XY) != 0 ||
+		_isMergedStateChanged()))
+		_flushMergedTriangles();
+
+	if (m_mergedTriangles.draws == 0) {
+		// The first draw sets up the state of the whole batch.
+		_prepareDrawTriangle();
+		m_mergedTriangles.flatColors = m_bFlatColors;
+		m_mergedTriangles.combiner = currentCombiner();
+		m_mergedTriangles.minLod = gDP.primColor.m;
+		m_mergedTriangles.fogColor = gDP.fogColor;
+	}
+	m_modifyVertices = 0;
+
+	const u16 base = static_cast<u16>(m_mergedTriangles.vertices.size());
+	const u8 drawId = static_cast<u8>(m_mergedTriangles.draws);
+	m_mergedTriangles.vertices.insert(m_mergedTriangles.vertices.end(),
+		triangles.vertices.begin(), triangles.vertices.begin() + verticesCount);
+	m_mergedTriangles.drawIds.insert(m_mergedTriangles.drawIds.end(), verticesCount, drawId);
+	for (u32 i = 0; i < triangles.num; ++i)
+		m_mergedTriangles.elements.push_back(static_cast<u16>(base + triangles.elements[i]));
+	_fillDrawParams(m_mergedTriangles.params[drawId]);
+	++m_mergedTriangles.draws;
+}
+
+void GraphicsDrawer::_flushMergedTriangles()
+{
+	DLC_PROFILE(stDraw);
+	Context::DrawTriangleParameters triParams;
+	triParams.mode = drawmode::TRIANGLES;
+	triParams.flatColors = m_mergedTriangles.flatColors;
+	triParams.elementsType = datatype::UNSIGNED_BYTE;
+	triParams.verticesCount = static_cast<u32>(m_mergedTriangles.vertices.size());
+	triParams.elementsCount = static_cast<u32>(m_mergedTriangles.elements.size());
+	triParams.vertices = m_mergedTriangles.vertices.data();
+	triParams.elements = m_mergedTriangles.elements.data();
+	triParams.drawIds = m_mergedTriangles.drawIds.data();
+	triParams.combiner = m_mergedTriangles.combiner;
+	// Upload the parameters of all merged draws.
+	m_mergedTriangles.combiner->update(false);
+	gfxContext.drawTriangles(triParams);
+	++m_drawMergingStats.submitted;
+
+	m_mergedTriangles.vertices.clear();
+	m_mergedTriangles.elements.clear();
+	m_mergedTriangles.drawIds.clear();
+	m_mergedTriangles.draws = 0;
+}
+
+static
+bool _isSameColor(const gDPInfo::Color & _c1, const gDPInfo::Color & _c2)
+{
+	return _c1.r == _c2.r && _c1.g == _c2.g && _c1.b == _c2.b && _c1.a == _c2.a;
+}
+
+bool GraphicsDrawer::TexrectBatchState::operator==(const TexrectBatchState & _other) const
+{
+	return pBuffer == _other.pBuffer &&
+		textureTile[0] == _other.textureTile[0] &&
+		textureTile[1] == _other.textureTile[1] &&
+		otherMode == _other.otherMode &&
+		mux == _other.mux &&
+		scissor.mode == _other.scissor.mode &&
+		scissor.ulx == _other.scissor.ulx && scissor.uly == _other.scissor.uly &&
+		scissor.lrx == _other.scissor.lrx && scissor.lry == _other.scissor.lry &&
+		scissor.xh == _other.scissor.xh && scissor.yh == _other.scissor.yh &&
+		scissor.xl == _other.scissor.xl && scissor.yl == _other.scissor.yl &&
+		_isSameColor(primColor, _other.primColor) &&
+		primColor.l == _other.primColor.l && primColor.m == _other.primColor.m &&
+		_isSameColor(envColor, _other.envColor) &&
+		_isSameColor(blendColor, _other.blendColor) &&
+		_isSameColor(fogColor, _other.fogColor) &&
+		primDepthZ == _other.primDepthZ &&
+		primDepthDeltaZ == _other.primDepthDeltaZ &&
+		std::equal(std::begin(convert), std::end(convert), std::begin(_other.convert)) &&
+		_isSameColor(keyCenter, _other.keyCenter) &&
+		_isSameColor(keyScale, _other.keyScale) &&
+		_isSameColor(keyWidth, _other.keyWidth) &&
+		bgMode == _other.bgMode;
+}
+
+void GraphicsDrawer::_getTexrectBatchState(TexrectBatchState & _state, const FrameBuffer * _pBuffer) const
+{
+	_state.pBuffer = _pBuffer;
+	_state.textureTile[0] = gSP.textureTile[0];
+	_state.textureTile[1] = gSP.textureTile[1];
+	_state.otherMode = gDP.otherMode._u64;
+	_state.mux = gDP.combine.mux;
+	_state.scissor = gDP.scissor;
+	_state.primColor = gDP.primColor;
+	_state.envColor = gDP.envColor;
+	_state.blendColor = gDP.blendColor;
+	_state.fogColor = gDP.fogColor;
+	_state.primDepthZ = gDP.primDepth.z;
+	_state.primDepthDeltaZ = gDP.primDepth.deltaZ;
+	_state.convert[0] = gDP.convert.k0;
+	_state.convert[1] = gDP.convert.k1;
+	_state.convert[2] = gDP.convert.k2;
+	_state.convert[3] = gDP.convert.k3;
+	_state.convert[4] = gDP.convert.k4;
+	_state.convert[5] = gDP.convert.k5;
+	_state.keyCenter = gDP.key.center;
+	_state.keyScale = gDP.key.scale;
+	_state.keyWidth = gDP.key.width;
+	_state.bgMode = m_bBGMode ? 1U : 0U;
+}
+
+bool GraphicsDrawer::_canContinueTexrectBatch(const TexturedRectParams & _params) const
+{
+	if (m_texrectBatch.rects == 0 || m_texrectBatch.rects == MAX_TEXRECT_BATCH)
+		return false;
+
+	if ((gDP.changed & (CHANGED_RENDERMODE | CHANGED_CYCLETYPE | CHANGED_SCISSOR | CHANGED_TMEM |
+		CHANGED_TILE | CHANGED_COMBINE | CHANGED_FB_TEXTURE)) != 0 ||
+		(gSP.changed & CHANGED_TEXTURE) != 0)
+		return false;
+
+	// Most RDP commands don't mark what they change, compare the values.
+	TexrectBatchState state;
+	_getTexrectBatchState(state, _params.pBuffer);
+	return state == m_texrectBatch.state;
+}
+
+void GraphicsDrawer::_addToTexrectBatch(const TexrectDrawer::iRect & _rect, const TexturedRectParams & _params, u32 _wrapClamp)
+{
+	if (m_texrectBatch.rects == 0)
+		_getTexrectBatchState(m_texrectBatch.state, _params.pBuffer);
+
+	std::vector<RectVertex> & vertices = m_texrectBatch.vertices;
+	vertices.push_back(m_rect[0]);
+	vertices.push_back(m_rect[1]);
+	vertices.push_back(m_rect[2]);
+	vertices.push_back(m_rect[2]);
+	vertices.push_back(m_rect[1]);
+	vertices.push_back(m_rect[3]);
+	m_texrectBatch.wrapClamp = _wrapClamp;
+	m_texrectBatch.lastRect = _rect;
+	++m_texrectBatch.rects;
+}
+
+void GraphicsDrawer::_flushTexrectBatch()
+{
+	if (m_texrectBatch.rects == 0)
+		return;
+
+	DLC_PROFILE(stDraw);
+	Context::DrawRectParameters rectParams;
+	rectParams.mode = drawmode::TRIANGLES;
+	rectParams.verticesCount = static_cast<u32>(m_texrectBatch.vertices.size());
+	rectParams.vertices = m_texrectBatch.vertices.data();
+	rectParams.combiner = currentCombiner();
+	gfxContext.drawRects(rectParams);
+	_clearTexrectBatch();
+}
+
+void GraphicsDrawer::_clearTexrectBatch()
+{
+	m_texrectBatch.vertices.clear();
+	m_texrectBatch.rects = 0;
+	m_texrectBatch.wrapClamp = 0;
+}
+
+void GraphicsDrawer::_endTexrectBatching()
+{
+	_flushTexrectBatch();
+	// Optimized mode composes rects only while they are batched.
+	if (config.graphics2D.enableNativeResTexrects == Config::NativeResTexrectsMode::ntOptimized)
+		m_texrectDrawer.draw();
+}
+
 void GraphicsDrawer::drawTriangles()
 {
+	DLC_PROFILE(stDraw);
 	if (triangles.num == 0 || !_canDraw()) {
 		triangles.num = 0;
 		triangles.maxElement = 0;
 		return;
 	}
 
-	_prepareDrawTriangle();
+	if (m_bMergeTriangles)
+		_mergeTriangles();
+	else
+		_prepareDrawTriangle();
 
 	Context::DrawTriangleParameters triParams;
 	triParams.mode = drawmode::TRIANGLES;
@@ -751,7 +985,11 @@ void GraphicsDrawer::drawTriangles()
 	triParams.vertices = triangles.vertices.data();
 	triParams.elements = triangles.elements.data();
 	triParams.combiner = currentCombiner();
-	gfxContext.drawTriangles(triParams);
+	if (!m_bMergeTriangles) {
+		gfxContext.drawTriangles(triParams);
+		++m_drawMergingStats.submitted;
+	}
+	++m_drawMergingStats.issued;
 	g_debugger.addTriangles(triParams);
 
 	if (config.frameBufferEmulation.enable != 0) {
@@ -771,6 +1009,7 @@ void GraphicsDrawer::drawTriangles()
 
 void GraphicsDrawer::drawScreenSpaceTriangle(u32 _numVtx, graphics::DrawModeParam _mode)
 {
+	DLC_PROFILE(stDraw);
 	if (_numVtx == 0 || !_canDraw())
 		return;
 
@@ -802,6 +1041,7 @@ void GraphicsDrawer::drawScreenSpaceTriangle(u32 _numVtx, graphics::DrawModePara
 
 void GraphicsDrawer::drawDMATriangles(u32 _numVtx)
 {
+	DLC_PROFILE(stDraw);
 	if (_numVtx == 0 || !_canDraw())
 		return;
 	_prepareDrawTriangle();
@@ -909,7 +1149,8 @@ void GraphicsDrawer::_drawThickLine(int _v0, int _v1, float _width)
 
 void GraphicsDrawer::drawLine(int _v0, int _v1, float _width)
 {
-	m_texrectDrawer.draw();
+	DLC_PROFILE(stDraw);
+	flush();
 
 	if (!_canDraw())
 		return;
@@ -940,7 +1181,8 @@ void GraphicsDrawer::drawLine(int _v0, int _v1, float _width)
 
 void GraphicsDrawer::drawRect(int _ulx, int _uly, int _lrx, int _lry)
 {
-	m_texrectDrawer.draw();
+	DLC_PROFILE(stDraw);
+	flush();
 
 	if (!_canDraw())
 		return;
@@ -1141,16 +1383,22 @@ bool(*texturedRectSpecial)(const GraphicsDrawer::TexturedRectParams & _params) =
 
 void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 {
+	DLC_PROFILE(stDraw);
 	gSP.changed &= ~CHANGED_GEOMETRYMODE; // Don't update cull mode
 	m_drawingState = DrawingState::TexRect;
 
-	if (m_texrectDrawer.canContinue()) {
+	const TexrectDrawer::iRect rect = TexrectDrawer::getiRect(RDP.w0, RDP.w1);
+	const bool bContinueBatch = _canContinueTexrectBatch(_params);
+	if (bContinueBatch) {
+		// Nothing the pending rects depend on has changed, so the states are up to date.
+	} else if (m_bBGMode ? m_texrectDrawer.canContinue() : m_texrectDrawer.canAddRect(rect)) {
 		CombinerInfo & cmbInfo = CombinerInfo::get();
 		cmbInfo.setPolygonMode(DrawingState::TexRect);
 		cmbInfo.update();
 		_updateTextures();
 		cmbInfo.updateParameters();
 	} else {
+		_flushTexrectBatch();
 		if (!m_texrectDrawer.isEmpty())
 			m_texrectDrawer.draw();
 		gSP.changed &= ~CHANGED_GEOMETRYMODE; // Don't update cull mode
@@ -1221,6 +1469,9 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 		offsetY = (_params.lry - _params.uly) * _params.dtdy;
 	}
 
+	// Clamp modes needed by this rect, two bits per tile.
+	u32 wrapClamp = 0;
+	Context::TexParameters clampParams[2];
 	for (u32 t = 0; t < 2; ++t) {
 		if (pCurrentCombiner->usesTile(t) && cache.current[t] && gSP.textureTile[t]) {
 			f32 shiftScaleS = 1.0f;
@@ -1274,7 +1525,7 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 			}
 
 			if (cache.current[t]->frameBufferTexture != CachedTexture::fbMultiSample) {
-				Context::TexParameters texParams;
+				Context::TexParameters & texParams = clampParams[t];
 
 				if ((cache.current[t]->mirrorS == 0 && cache.current[t]->maskS == 0 &&
 					(texST[t].s0 < texST[t].s1 ?
@@ -1290,10 +1541,10 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 					texParams.wrapT = textureParameters::WRAP_CLAMP_TO_EDGE;
 
 				if (texParams.wrapS.isValid() || texParams.wrapT.isValid()) {
+					wrapClamp |= ((texParams.wrapS.isValid() ? 1U : 0U) | (texParams.wrapT.isValid() ? 2U : 0U)) << (t * 2);
 					texParams.handle = cache.current[t]->name;
 					texParams.target = textureTarget::TEXTURE_2D;
 					texParams.textureUnitIndex = textureIndices::Tex[t];
-					gfxContext.setTextureParameters(texParams);
 				}
 			}
 
@@ -1304,6 +1555,16 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 		}
 	}
 
+	if (bContinueBatch && wrapClamp != m_texrectBatch.wrapClamp) {
+		// The pending rects were drawn with other wrap modes, and _updateTextures() restores the tile ones.
+		_flushTexrectBatch();
+		_updateTextures();
+	}
+	for (u32 t = 0; t < 2; ++t) {
+		if ((wrapClamp & (3U << (t * 2))) != 0)
+			gfxContext.setTextureParameters(clampParams[t]);
+	}
+
 	if (gDP.otherMode.cycleType == G_CYC_COPY && cache.current[0]->frameBufferTexture != CachedTexture::fbMultiSample) {
 		Context::TexParameters texParams;
 		texParams.handle = cache.current[0]->name;
@@ -1355,16 +1616,42 @@ void GraphicsDrawer::drawTexturedRect(const TexturedRectParams & _params)
 			m_rect[i].x *= scale;
 	}
 
+	const bool bBatch = m_bBatchTexrects && _params.texrectCmd && texturedRectSpecial == nullptr && !g_debugger.isCaptureMode();
+
 	if (bUseTexrectDrawer) {
 		if (m_bBGMode) {
 			m_texrectDrawer.addBackgroundRect();
 			return;
 		}
-		if (m_texrectDrawer.addRect())
+		if (config.graphics2D.enableNativeResTexrects != Config::NativeResTexrectsMode::ntOptimized ||
+			!m_texrectDrawer.isEmpty() || RSP.LLE ||
+			GBI.getMicrocodeType() == Turbo3D || GBI.getMicrocodeType() == T3DUX ||
+			GBI.getMicrocodeType() == F5Rogue || GBI.getMicrocodeType() == F5Indi_Naboo) {
+			// Compose every rect, unless texrects are batched in Optimized mode.
+			m_texrectDrawer.addRect(m_rect, rect);
 			return;
+		}
+		// Optimized mode composes only runs of side by side rects, starting with the pending one.
+		if (bBatch && bContinueBatch && m_texrectBatch.rects == 1 &&
+			TexrectDrawer::isSideBySide(m_texrectBatch.lastRect, rect)) {
+			const std::vector<RectVertex> & vertices = m_texrectBatch.vertices;
+			RectVertex pendingRect[4] = { vertices[0], vertices[1], vertices[2], vertices[5] };
+			const TexrectDrawer::iRect pendingiRect = m_texrectBatch.lastRect;
+			_clearTexrectBatch();
+			m_texrectDrawer.addRect(pendingRect, pendingiRect);
+			m_texrectDrawer.addRect(m_rect, rect);
+			return;
+		}
 	}
 
 	_updateScreenCoordsViewport(_params.pBuffer);
+
+	if (bBatch) {
+		_addToTexrectBatch(rect, _params, wrapClamp);
+		gSP.changed |= CHANGED_GEOMETRYMODE | CHANGED_VIEWPORT;
+		return;
+	}
+
 	Context::DrawRectParameters rectParams;
 	rectParams.mode = drawmode::TRIANGLE_STRIP;
 	rectParams.verticesCount = 4;
@@ -1675,10 +1962,22 @@ void GraphicsDrawer::_initData()
 	g_zlutTexture.init();
 	g_noiseTexture.init();
 	g_paletteTexture.init();
+	g_tmemTexture.init();
 	FBInfo::fbInfo.reset();
 	m_texrectDrawer.init();
 	m_drawingState = DrawingState::Non;
 	m_maxLineWidth = gfxContext.getMaxLineWidth();
+	m_bDrawMerging = Context::DrawMerging;
+	m_bMergeTriangles = false;
+	m_drawMergingStats = DrawMergingStats();
+	if (m_bDrawMerging) {
+		m_mergedTriangles.vertices.reserve(MERGED_VERTBUFF_SIZE);
+		m_mergedTriangles.drawIds.reserve(MERGED_VERTBUFF_SIZE);
+		m_mergedTriangles.elements.reserve(MERGED_VERTBUFF_SIZE * 3);
+	}
+	m_bBatchTexrects = false;
+	_clearTexrectBatch();
+	m_texrectBatch.vertices.reserve(MAX_TEXRECT_BATCH * 6);
 
 	gSP.changed = gDP.changed = 0xFFFFFFFF;
 
@@ -1692,8 +1991,12 @@ void GraphicsDrawer::_initData()
 
 void GraphicsDrawer::_destroyData()
 {
+	if (m_bDrawMerging)
+		LOG(LOG_VERBOSE, "Triangle draws: %llu issued, %llu submitted\n",
+			(unsigned long long)m_drawMergingStats.issued, (unsigned long long)m_drawMergingStats.submitted);
 	m_drawingState = DrawingState::Non;
 	m_texrectDrawer.destroy();
+	g_tmemTexture.destroy();
 	g_paletteTexture.destroy();
 	g_zlutTexture.destroy();
 	g_noiseTexture.destroy();
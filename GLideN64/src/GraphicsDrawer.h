@@ -19,6 +19,10 @@ struct FrameBuffer;
 
 #define VERTBUFF_SIZE 256U
 #define ELEMBUFF_SIZE 1024U
+#define MAX_MERGED_DRAWS 16U
+#define MERGED_VERTBUFF_SIZE 4096U
+#define DRAW_PARAMS_VEC4 5U
+#define MAX_TEXRECT_BATCH 256U
 
 enum class DrawingState
 {
@@ -151,12 +155,58 @@ public:
 
 	void dropRenderState() { m_drawingState = DrawingState::Non; }
 
-	void flush() { m_texrectDrawer.draw(); }
+	void flush() { _flushTexrectBatch(); m_texrectDrawer.draw(); }
 
 	bool isTexrectDrawerMode() const { return !m_texrectDrawer.isEmpty(); }
 
 	void setBackgroundDrawingMode(bool _mode) { m_bBGMode = _mode; }
 
+	// Combiner parameters, which may differ between merged triangle draws.
+	// Shaders read them as DRAW_PARAMS_VEC4 vec4s per draw.
+	struct DrawParams
+	{
+		f32 primColor[4];
+		f32 envColor[4];
+		f32 fogColor[4];
+		f32 blendColor[4];
+		f32 primLod, k4, k5, alphaTestValue;
+	};
+
+	// Parameters of the pending merged draws, or of the current state when none is pending.
+	const DrawParams * getDrawParams(u32 & _count);
+
+	bool canMergeTriangles() const;
+
+	// While enabled, drawTriangles() appends to a batch which is drawn with a single call
+	// once merging is disabled. The caller must disable merging before any state change
+	// other than the colors in DrawParams.
+	void setTriangleMerging(bool _merge)
+	{
+		if (!_merge && m_mergedTriangles.draws != 0)
+			_flushMergedTriangles();
+		m_bMergeTriangles = _merge;
+	}
+
+	struct DrawMergingStats
+	{
+		u64 issued = 0;		// triangle draws requested by the display lists
+		u64 submitted = 0;	// draw calls made for them
+	};
+
+	const DrawMergingStats & getDrawMergingStats() const { return m_drawMergingStats; }
+
+	// While enabled, texrects which share all RDP state are collected and drawn
+	// with a single call. The caller must disable batching before any command
+	// which is not an RDP state change or a texrect.
+	void setTexrectBatching(bool _batch)
+	{
+		if (_batch == m_bBatchTexrects)
+			return;
+		if (!_batch)
+			_endTexrectBatching();
+		m_bBatchTexrects = _batch;
+	}
+
 private:
 	friend class DisplayWindow;
 	friend TexrectDrawer;
@@ -184,6 +234,34 @@ private:
 	void _prepareDrawTriangle();
 	bool _canDraw() const;
 	void _drawThickLine(int _v0, int _v1, float _width);
+	void _fillDrawParams(DrawParams & _params) const;
+	bool _isMergedStateChanged() const;
+	void _mergeTriangles();
+	void _flushMergedTriangles();
+
+	// Everything the batched texrects are drawn with, except the texture wrap modes.
+	struct TexrectBatchState
+	{
+		const FrameBuffer * pBuffer;
+		const gDPTile * textureTile[2];
+		u64 otherMode;
+		u64 mux;
+		gDPScissor scissor;
+		gDPInfo::PrimColor primColor;
+		gDPInfo::Color envColor, blendColor, fogColor;
+		f32 primDepthZ, primDepthDeltaZ;
+		s32 convert[6];
+		gDPInfo::Color keyCenter, keyScale, keyWidth;
+		u32 bgMode;
+
+		bool operator==(const TexrectBatchState & _other) const;
+	};
+	void _getTexrectBatchState(TexrectBatchState & _state, const FrameBuffer * _pBuffer) const;
+	bool _canContinueTexrectBatch(const TexturedRectParams & _params) const;
+	void _addToTexrectBatch(const TexrectDrawer::iRect & _rect, const TexturedRectParams & _params, u32 _wrapClamp);
+	void _flushTexrectBatch();
+	void _clearTexrectBatch();
+	void _endTexrectBatching();
 
 	void _drawOSD(const char *_pText, float _x, float & _y);
 
@@ -200,6 +278,27 @@ private:
 		int maxElement = 0;
 	} triangles;
 
+	struct {
+		std::vector<SPVertex> vertices;
+		std::vector<u16> elements;
+		std::vector<u8> drawIds;
+		std::array<DrawParams, MAX_MERGED_DRAWS> params;
+		u32 draws = 0;
+		bool flatColors = false;
+		graphics::CombinerProgram * combiner = nullptr;
+		// State read by the first draw only, see _isMergedStateChanged().
+		f32 minLod = 0.0f;
+		gDPInfo::Color fogColor;
+	} m_mergedTriangles;
+
+	struct {
+		std::vector<RectVertex> vertices;
+		u32 rects = 0;
+		u32 wrapClamp = 0;	// clamp modes of the rects, two bits per tile, the same for all of them
+		TexrectDrawer::iRect lastRect;
+		TexrectBatchState state;
+	} m_texrectBatch;
+
 	std::vector<SPVertex> m_dmaVertices;
 	u32 m_dmaVerticesNum;
 
@@ -209,6 +308,10 @@ private:
 	f32 m_maxLineWidth;
 	bool m_bFlatColors;
 	bool m_bBGMode;
+	bool m_bDrawMerging;
+	bool m_bMergeTriangles;
+	bool m_bBatchTexrects;
+	DrawMergingStats m_drawMergingStats;
 	TexrectDrawer m_texrectDrawer;
 	OSDMessages m_osdMessages;
 };
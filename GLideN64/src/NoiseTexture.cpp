@@ -28,6 +28,7 @@ NoiseTexture::NoiseTexture()
 	: m_DList(0)
 	, m_currTex(0)
 	, m_prevTex(0)
+	, m_seed(0)
 {
 	for (u32 i = 0; i < NOISE_TEX_NUM; ++i)
 		m_pTexture[i] = nullptr;
@@ -72,6 +73,10 @@ void NoiseTexture::init()
 	if (config.generalEmulation.enableNoise == 0)
 		return;
 
+	// Noise is generated by the shaders.
+	if (Context::IntegerTextures)
+		return;
+
 	if (m_texData[0].empty())
 		_fillTextureData();
 
@@ -127,6 +132,12 @@ void NoiseTexture::update()
 	if (m_DList == dwnd().getBuffersSwapCount() || config.generalEmulation.enableNoise == 0)
 		return;
 
+	if (Context::IntegerTextures) {
+		m_seed = (irand() << 16) ^ irand();
+		m_DList = dwnd().getBuffersSwapCount();
+		return;
+	}
+
 	u32 rand_value(0U);
 	while (m_currTex == m_prevTex) {
 		rand_value = irand();
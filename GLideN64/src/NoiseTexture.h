@@ -9,6 +9,9 @@
 struct CachedTexture;
 typedef std::array<std::vector<u8>, NOISE_TEX_NUM> NoiseTexturesData;
 
+// Noise for the combiners and dithering. Shaders with integer support hash
+// the pixel position with a per-frame seed, GLSL ES 2 shaders sample one of
+// NOISE_TEX_NUM prerendered textures instead.
 class NoiseTexture
 {
 public:
@@ -18,12 +21,15 @@ public:
 	void destroy();
 	void update();
 
+	u32 getSeed() const { return m_seed; }
+
 private:
 	void _fillTextureData();
 
 	CachedTexture * m_pTexture[NOISE_TEX_NUM];
 	u32 m_DList;
 	u32 m_currTex, m_prevTex;
+	u32 m_seed;
 	NoiseTexturesData m_texData;
 };
 
@@ -9,6 +9,7 @@
 #include "gSP.h"
 #include "Config.h"
 #include "DisplayWindow.h"
+#include "BufferCopy/ReadbackWorker.h"
 
 void RDP_Unknown( u32 w0, u32 w1 )
 {
@@ -611,5 +612,7 @@ void RDP_ProcessRDPList()
 	gDP.changed |= CHANGED_COLORBUFFER;
 	gDP.changed &= ~CHANGED_CPU_FB_WRITE;
 
+	ReadbackWorker::get().finish();
+
 	dp_start = dp_current = dp_end;
 }
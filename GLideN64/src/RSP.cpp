@@ -16,6 +16,8 @@
 #include "Config.h"
 #include "TextureFilterHandler.h"
 #include "DisplayWindow.h"
+#include "BufferCopy/ReadbackWorker.h"
+#include <main/trace.h>
 
 using namespace std;
 
@@ -25,9 +27,66 @@ using namespace std;
 
 RSPInfo		RSP;
 
+// Commands which change nothing but the per draw parameters of merged triangles.
+static
+bool _isMergeSafe(u32 _cmd)
+{
+	switch (_cmd) {
+	case G_SETPRIMCOLOR:
+	case G_SETENVCOLOR:
+	case G_SETFOGCOLOR:
+	case G_SETBLENDCOLOR:
+	case G_RDPPIPESYNC:
+	case G_RDPTILESYNC:
+	case G_RDPLOADSYNC:
+		return true;
+	}
+	return _cmd == G_VTX || _cmd == G_TRI1 || _cmd == G_TRI2 || _cmd == G_TRIX || _cmd == G_QUAD ||
+		_cmd == G_MTX || _cmd == G_POPMTX || _cmd == G_DL || _cmd == G_ENDDL || _cmd == G_SPNOOP;
+}
+
+// RDP state changes and texrects. Batched texrects and rects composed in
+// native resolution can continue across them.
+static
+bool _isTexrectBatchSafe(u32 _cmd)
+{
+	switch (_cmd) {
+	case G_TEXRECT:
+	case G_TEXRECTFLIP:
+	case G_RDPPIPESYNC:
+	case G_RDPTILESYNC:
+	case G_RDPLOADSYNC:
+	case G_SETTIMG:
+	case G_SETTILE:
+	case G_SETTILESIZE:
+	case G_LOADTILE:
+	case G_LOADBLOCK:
+	case G_LOADTLUT:
+	case G_SETCOMBINE:
+	case G_SETPRIMCOLOR:
+	case G_SETENVCOLOR:
+	case G_SETFOGCOLOR:
+	case G_SETBLENDCOLOR:
+	case G_SETPRIMDEPTH:
+	case G_SETSCISSOR:
+	case G_RDPSETOTHERMODE:
+	case G_SETCONVERT:
+	case G_SETKEYR:
+	case G_SETKEYGB:
+		return true;
+	}
+	return _cmd == G_RDPHALF_1 || _cmd == G_RDPHALF_2 || _cmd == G_RDPHALF_CONT ||
+		_cmd == G_SETOTHERMODE_H || _cmd == G_SETOTHERMODE_L ||
+		_cmd == G_DL || _cmd == G_ENDDL || _cmd == G_SPNOOP;
+}
+
 static
 void _ProcessDList()
 {
+	GraphicsDrawer & drawer = dwnd().getDrawer();
+	const bool bDrawMerging = drawer.canMergeTriangles();
+	const bool bTexrectBatching = config.generalEmulation.enableTexrectBatching != 0;
+
 	while (!RSP.halt) {
 		if ((RSP.PC[RSP.PCi] + 8) > RDRAMSize) {
 			break;
@@ -43,9 +102,17 @@ void _ProcessDList()
 			--pci;
 		RSP.nextCmd = _SHIFTR(*(u32*)&RDRAM[RSP.PC[pci]], 24, 8);
 
+		// Anything else may change state shared by the whole batch, so draw it first.
+		if (bDrawMerging)
+			drawer.setTriangleMerging(_isMergeSafe(RSP.cmd));
+		if (bTexrectBatching)
+			drawer.setTexrectBatching(_isTexrectBatchSafe(RSP.cmd));
+
 		GBI.cmd[RSP.cmd](RSP.w0, RSP.w1);
 		RSP_CheckDLCounter();
 	}
+	drawer.setTriangleMerging(false);
+	drawer.setTexrectBatching(false);
 }
 
 static
@@ -91,6 +158,7 @@ void RSP_CheckDLCounter()
 
 void RSP_ProcessDList()
 {
+	TRACE_SCOPE("RSP_ProcessDList");
 	if (ConfigOpen || dwnd().isResizeWindow()) {
 		*REG.MI_INTR |= MI_INTR_DP;
 		CheckInterrupts();
@@ -163,6 +231,7 @@ void RSP_ProcessDList()
 
 	if (RSP.infloop && REG.SP_STATUS) {
 		*REG.SP_STATUS &= ~(SP_STATUS_TASKDONE | SP_STATUS_HALT | SP_STATUS_BROKE);
+		ReadbackWorker::get().finish();
 		return;
 	}
 
@@ -176,6 +245,9 @@ void RSP_ProcessDList()
 			FrameBuffer_CopyDepthBuffer(gDP.colorImage.address);
 	}
 
+	// Copies to RDRAM must land before the CPU runs again, or they overwrite its later stores.
+	ReadbackWorker::get().finish();
+
 	RSP.busy = false;
 	gDP.changed |= CHANGED_COLORBUFFER;
 }
@@ -0,0 +1,121 @@
+#include "Graphics/Context.h"
+#include "Graphics/Parameters.h"
+#include "N64.h"
+#include "GBI.h"
+#include "Textures.h"
+#include "TMEMTexture.h"
+
+using namespace graphics;
+
+TMEMTexture g_tmemTexture;
+
+TMEMTexture::TMEMTexture()
+: m_pTexture(nullptr)
+, m_bValid(false)
+{
+}
+
+void TMEMTexture::init()
+{
+	if (!Context::ShaderTMEM)
+		return;
+
+	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
+
+	m_bValid = false;
+	m_pTexture = textureCache().addFrameBufferTexture(textureTarget::TEXTURE_2D);
+	m_pTexture->format = G_IM_FMT_IA;
+	m_pTexture->clampS = 1;
+	m_pTexture->clampT = 1;
+	m_pTexture->frameBufferTexture = CachedTexture::fbOneSample;
+	m_pTexture->maskS = 0;
+	m_pTexture->maskT = 0;
+	m_pTexture->mirrorS = 0;
+	m_pTexture->mirrorT = 0;
+	// 4 KB of TMEM as 32-bit words, in memory order.
+	m_pTexture->width = 256;
+	m_pTexture->height = 4;
+	m_pTexture->textureBytes = m_pTexture->width * m_pTexture->height * fbTexFormats.lutFormatBytes;
+
+	Context::InitTextureParams initParams;
+	initParams.handle = m_pTexture->name;
+	initParams.width = m_pTexture->width;
+	initParams.height = m_pTexture->height;
+	initParams.internalFormat = fbTexFormats.lutInternalFormat;
+	initParams.format = fbTexFormats.lutFormat;
+	initParams.dataType = fbTexFormats.lutType;
+	gfxContext.init2DTexture(initParams);
+
+	Context::TexParameters setParams;
+	setParams.handle = m_pTexture->name;
+	setParams.target = textureTarget::TEXTURE_2D;
+	setParams.textureUnitIndex = textureIndices::TMEMTex;
+	setParams.minFilter = textureParameters::FILTER_NEAREST;
+	setParams.magFilter = textureParameters::FILTER_NEAREST;
+	setParams.wrapS = textureParameters::WRAP_CLAMP_TO_EDGE;
+	setParams.wrapT = textureParameters::WRAP_CLAMP_TO_EDGE;
+	gfxContext.setTextureParameters(setParams);
+}
+
+void TMEMTexture::destroy()
+{
+	if (!Context::ShaderTMEM)
+		return;
+
+	textureCache().removeFrameBufferTexture(m_pTexture);
+	m_pTexture = nullptr;
+}
+
+void TMEMTexture::update()
+{
+	if (m_pTexture == nullptr || m_bValid)
+		return;
+
+	m_bValid = true;
+
+	const FramebufferTextureFormats & fbTexFormats = gfxContext.getFramebufferTextureFormats();
+	Context::UpdateTextureDataParams params;
+	params.handle = m_pTexture->name;
+	params.textureUnitIndex = textureIndices::TMEMTex;
+	params.width = m_pTexture->width;
+	params.height = m_pTexture->height;
+	params.format = fbTexFormats.lutFormat;
+	params.internalFormat = fbTexFormats.lutInternalFormat;
+	params.dataType = fbTexFormats.lutType;
+	params.data = TMEM;
+	gfxContext.update2DTexture(params);
+}
+
+u32 TMEMTexture::getDecoder(u32 _tlut, u32 _size, u32 _format)
+{
+	// Same texel layouts as the CPU decoders of TextureCache select.
+	if (_format == G_IM_FMT_YUV)
+		return tmemNone;
+
+	if (_tlut != G_TT_NONE) {
+		const bool bIA = _tlut == G_TT_IA16;
+		switch (_size) {
+		case G_IM_SIZ_4b:
+			return bIA ? tmemCI4_IA16 : tmemCI4_RGBA16;
+		case G_IM_SIZ_8b:
+			return bIA ? tmemCI8_IA16 : tmemCI8_RGBA16;
+		}
+		return tmemNone;
+	}
+
+	switch (_size) {
+	case G_IM_SIZ_4b:
+		return _format == G_IM_FMT_IA ? tmemIA31 : tmemI4;
+	case G_IM_SIZ_8b:
+		return _format == G_IM_FMT_IA ? tmemIA44 : tmemI8;
+	case G_IM_SIZ_16b:
+		if (_format == G_IM_FMT_RGBA)
+			return tmemRGBA16;
+		if (_format == G_IM_FMT_CI || _format == G_IM_FMT_IA)
+			return tmemIA88;
+		return tmemNone;
+	case G_IM_SIZ_32b:
+		return _format == G_IM_FMT_RGBA ? tmemRGBA32 : tmemNone;
+	}
+	return tmemNone;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Types.h"
+
+struct CachedTexture;
+
+// Texel decoders of the shader TMEM path.
+// High nibble is the texel size, low nibble the format. Must match readTmem() in the combiner shader.
+enum TMEMDecoder {
+	tmemNone = 0x00,
+	tmemI4 = 0x01,
+	tmemIA31 = 0x02,
+	tmemCI4_RGBA16 = 0x04,
+	tmemCI4_IA16 = 0x05,
+	tmemI8 = 0x11,
+	tmemIA44 = 0x12,
+	tmemCI8_RGBA16 = 0x14,
+	tmemCI8_IA16 = 0x15,
+	tmemIA88 = 0x22,
+	tmemRGBA16 = 0x23,
+	tmemRGBA32 = 0x33
+};
+
+// Raw copy of TMEM, read by combiners which decode tiles themselves.
+// The palette lives in the upper half of TMEM, so it needs no texture of its own.
+class TMEMTexture
+{
+public:
+	TMEMTexture();
+
+	void init();
+	void destroy();
+	void invalidate() { m_bValid = false; }
+	void update();
+
+	static u32 getDecoder(u32 _tlut, u32 _size, u32 _format);
+
+private:
+	CachedTexture * m_pTexture;
+	bool m_bValid;
+};
+
+extern TMEMTexture g_tmemTexture;
@@ -0,0 +1,392 @@
+#ifndef TEXELDECODERS_H
+#define TEXELDECODERS_H
+
+// TMEM texel getters and the row decoders built from them.
+// Only depends on N64.h and convert.h, so it can be built without the rest of the plugin.
+
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include "Types.h"
+#include "N64.h"
+#include "convert.h"
+
+typedef u32 (*GetTexelFunc)( u64 *src, u16 x, u16 i, u8 palette );
+
+inline u32 GetNone( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return 0x00000000;
+}
+
+inline u32 GetCI4_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
+{
+	u8 color4B = ((u8*)src)[(x >> 1) ^ (i << 1)];
+
+	return CI4_RGBA8888((x & 1) ? (palette << 4) | (color4B & 0x0F) : (palette << 4) | (color4B >> 4));
+}
+
+inline u32 GetCI4_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
+{
+	u8 color4B = ((u8*)src)[(x >> 1) ^ (i << 1)];
+
+	return CI4_RGBA4444((x & 1) ? (palette << 4) | (color4B & 0x0F) : (palette << 4) | (color4B >> 4));
+}
+
+inline u32 GetCI4IA_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	if (x & 1)
+		return IA88_RGBA4444( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
+	else
+		return IA88_RGBA4444( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
+}
+
+inline u32 GetCI4IA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	if (x & 1)
+		return IA88_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
+	else
+		return IA88_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
+}
+
+inline u32 GetCI4RGBA_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	if (x & 1)
+		return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
+	else
+		return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
+}
+
+inline u32 GetCI4RGBA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	if (x & 1)
+		return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
+	else
+		return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
+}
+
+inline u32 GetIA31_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	return IA31_RGBA8888( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
+}
+
+inline u32 GetIA31_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	return IA31_RGBA4444( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
+}
+
+inline u32 GetI4_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	return I4_RGBA8888( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
+}
+
+inline u32 GetI4_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
+
+	return I4_RGBA4444( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
+}
+
+inline u32 GetCI8IA_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA88_RGBA4444( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
+}
+
+inline u32 GetCI8IA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA88_RGBA8888( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
+}
+
+inline u32 GetCI8RGBA_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
+}
+
+inline u32 GetCI8RGBA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
+}
+
+inline u32 GetIA44_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA44_RGBA8888(((u8*)src)[x^(i<<1)]);
+}
+
+inline u32 GetIA44_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA44_RGBA4444(((u8*)src)[x^(i<<1)]);
+}
+
+inline u32 GetI8_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return I8_RGBA8888(((u8*)src)[x^(i<<1)]);
+}
+
+inline u32 GetI8_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return I8_RGBA4444(((u8*)src)[x^(i<<1)]);
+}
+
+inline u32 GetCI16IA_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
+{
+	const u16 tex = ((u16*)src)[x^i];
+	const u16 col = (*(u16*)&TMEM[256 + (tex >> 8)]);
+	const u16 c = col >> 8;
+	const u16 a = col & 0xFF;
+	return (a << 24) | (c << 16) | (c << 8) | c;
+}
+
+inline u32 GetCI16IA_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
+{
+	const u16 tex = ((u16*)src)[x^i];
+	const u16 col = (*(u16*)&TMEM[256 + (tex >> 8)]);
+	const u16 c = col >> 12;
+	const u16 a = col & 0x0F;
+	return (a << 12) | (c << 8) | (c << 4) | c;
+}
+
+inline u32 GetCI16RGBA_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
+{
+	const u16 tex = (((u16*)src)[x^i])&0xFF;
+	return RGBA5551_RGBA8888(((u16*)&TMEM[256])[tex << 2]);
+}
+
+inline u32 GetCI16RGBA_RGBA5551(u64 *src, u16 x, u16 i, u8 palette)
+{
+	const u16 tex = (((u16*)src)[x^i]) & 0xFF;
+	return RGBA5551_RGBA5551(((u16*)&TMEM[256])[tex << 2]);
+}
+
+inline u32 GetRGBA5551_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
+{
+	u16 tex = ((u16*)src)[x^i];
+	return RGBA5551_RGBA8888(tex);
+}
+
+inline u32 GetRGBA5551_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
+{
+	u16 tex = ((u16*)src)[x^i];
+	return RGBA5551_RGBA5551(tex);
+}
+
+inline u32 GetIA88_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA88_RGBA8888(((u16*)src)[x^i]);
+}
+
+inline u32 GetIA88_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return IA88_RGBA4444(((u16*)src)[x^i]);
+}
+
+inline u32 GetRGBA8888_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return ((u32*)src)[x^i];
+}
+
+inline u32 GetRGBA8888_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
+{
+	return RGBA8888_RGBA4444(((u32*)src)[x^i]);
+}
+
+inline u32 YUV_RGBA8888(u8 y, u8 u, u8 v)
+{
+	return (0xff << 24) | (y << 16) | (v << 8) | u;
+}
+
+inline void GetYUV_RGBA8888(u64 * src, u32 * dst, u16 x)
+{
+	const u32 t = (((u32*)src)[x]);
+	u8 y1 = (u8)t & 0xFF;
+	u8 v = (u8)(t >> 8) & 0xFF;
+	u8 y0 = (u8)(t >> 16) & 0xFF;
+	u8 u = (u8)(t >> 24) & 0xFF;
+	u32 c = YUV_RGBA8888(y0, u, v);
+	*(dst++) = c;
+	c = YUV_RGBA8888(y1, u, v);
+	*(dst++) = c;
+}
+
+/*
+ * Row decoders.
+ * Every TMEM format is decoded by an instance of GetTexelRow specialized on its GetTexel function,
+ * so the per-texel conversion is inlined and the only indirect call is made once per row.
+ * Texels which precede the first clamped or masked coordinate map to themselves. This run is
+ * handed to TexelRun, which has SIMD specializations for the most common 16-bit formats.
+ */
+template <GetTexelFunc GetTexel, typename T>
+struct TexelRun
+{
+	// Returns number of texels decoded. Generic formats leave the whole run to the scalar loop.
+	static u16 decode(u64 *, T *, u16, u16, u8) { return 0; }
+};
+
+#if defined(__SSE2__)
+// Load 8 16-bit texels of a TMEM row and undo the odd row word swap and the byte swap.
+static inline __m128i LoadTexels16(const u64 *src, u16 x, u16 i)
+{
+	__m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(reinterpret_cast<const u16*>(src) + x));
+	if (i != 0)
+		texels = _mm_shuffle_epi32(texels, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_or_si128(_mm_slli_epi16(texels, 8), _mm_srli_epi16(texels, 8));
+}
+
+// Expand 5-bit channel to 8 bits with the same rounding as Five2Eight table.
+static inline __m128i Five2Eight16(__m128i c)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(c, _mm_set1_epi16(527)), _mm_set1_epi16(23)), 6);
+}
+
+template<>
+struct TexelRun<GetRGBA5551_RGBA5551, u16>
+{
+	static u16 decode(u64 *src, u16 *dst, u16 count, u16 i, u8)
+	{
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), LoadTexels16(src, x, i));
+		return x;
+	}
+};
+
+template<>
+struct TexelRun<GetRGBA5551_RGBA8888, u32>
+{
+	static u16 decode(u64 *src, u32 *dst, u16 count, u16 i, u8)
+	{
+		const __m128i mask5 = _mm_set1_epi16(0x1F);
+		const __m128i one = _mm_set1_epi16(1);
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8) {
+			const __m128i c = LoadTexels16(src, x, i);
+			const __m128i r = Five2Eight16(_mm_srli_epi16(c, 11));
+			const __m128i g = Five2Eight16(_mm_and_si128(_mm_srli_epi16(c, 6), mask5));
+			const __m128i b = Five2Eight16(_mm_and_si128(_mm_srli_epi16(c, 1), mask5));
+			const __m128i a = _mm_srli_epi16(_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(c, one)), 8);
+			const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+			const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi16(rg, ba));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), _mm_unpackhi_epi16(rg, ba));
+		}
+		return x;
+	}
+};
+
+template<>
+struct TexelRun<GetIA88_RGBA8888, u32>
+{
+	static u16 decode(u64 *src, u32 *dst, u16 count, u16 i, u8)
+	{
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8) {
+			// IA88_RGBA8888 expects the raw word, so swap the bytes back.
+			__m128i c = LoadTexels16(src, x, i);
+			c = _mm_or_si128(_mm_slli_epi16(c, 8), _mm_srli_epi16(c, 8));
+			const __m128i intensity = _mm_and_si128(c, _mm_set1_epi16(0xFF));
+			const __m128i ii = _mm_or_si128(intensity, _mm_slli_epi16(intensity, 8));
+			const __m128i ia = _mm_or_si128(intensity, _mm_slli_epi16(_mm_srli_epi16(c, 8), 8));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_unpacklo_epi16(ii, ia));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), _mm_unpackhi_epi16(ii, ia));
+		}
+		return x;
+	}
+};
+#elif defined(__ARM_NEON)
+// Load 8 16-bit texels of a TMEM row and undo the odd row word swap and the byte swap.
+static inline uint16x8_t LoadTexels16(const u64 *src, u16 x, u16 i)
+{
+	uint8x16_t texels = vld1q_u8(reinterpret_cast<const uint8_t*>(reinterpret_cast<const u16*>(src) + x));
+	if (i != 0)
+		texels = vreinterpretq_u8_u32(vrev64q_u32(vreinterpretq_u32_u8(texels)));
+	return vreinterpretq_u16_u8(vrev16q_u8(texels));
+}
+
+// Expand 5-bit channel to 8 bits with the same rounding as Five2Eight table.
+static inline uint16x8_t Five2Eight16(uint16x8_t c)
+{
+	return vshrq_n_u16(vmlaq_u16(vdupq_n_u16(23), c, vdupq_n_u16(527)), 6);
+}
+
+template<>
+struct TexelRun<GetRGBA5551_RGBA5551, u16>
+{
+	static u16 decode(u64 *src, u16 *dst, u16 count, u16 i, u8)
+	{
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8)
+			vst1q_u16(dst + x, LoadTexels16(src, x, i));
+		return x;
+	}
+};
+
+template<>
+struct TexelRun<GetRGBA5551_RGBA8888, u32>
+{
+	static u16 decode(u64 *src, u32 *dst, u16 count, u16 i, u8)
+	{
+		const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8) {
+			const uint16x8_t c = LoadTexels16(src, x, i);
+			const uint16x8_t r = Five2Eight16(vshrq_n_u16(c, 11));
+			const uint16x8_t g = Five2Eight16(vandq_u16(vshrq_n_u16(c, 6), mask5));
+			const uint16x8_t b = Five2Eight16(vandq_u16(vshrq_n_u16(c, 1), mask5));
+			const uint16x8_t a = vshrq_n_u16(vreinterpretq_u16_s16(vnegq_s16(vreinterpretq_s16_u16(vandq_u16(c, vdupq_n_u16(1))))), 8);
+			uint16x8x2_t rgba;
+			rgba.val[0] = vorrq_u16(r, vshlq_n_u16(g, 8));
+			rgba.val[1] = vorrq_u16(b, vshlq_n_u16(a, 8));
+			vst2q_u16(reinterpret_cast<uint16_t*>(dst + x), rgba);
+		}
+		return x;
+	}
+};
+
+template<>
+struct TexelRun<GetIA88_RGBA8888, u32>
+{
+	static u16 decode(u64 *src, u32 *dst, u16 count, u16 i, u8)
+	{
+		u16 x = 0;
+		for (; x + 8 <= count; x += 8) {
+			// IA88_RGBA8888 expects the raw word, so swap the bytes back.
+			const uint16x8_t c = vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(LoadTexels16(src, x, i))));
+			const uint16x8_t intensity = vandq_u16(c, vdupq_n_u16(0xFF));
+			uint16x8x2_t rgba;
+			rgba.val[0] = vorrq_u16(intensity, vshlq_n_u16(intensity, 8));
+			rgba.val[1] = vorrq_u16(intensity, vshlq_n_u16(vshrq_n_u16(c, 8), 8));
+			vst2q_u16(reinterpret_cast<uint16_t*>(dst + x), rgba);
+		}
+		return x;
+	}
+};
+#endif
+
+template <GetTexelFunc GetTexel, typename T>
+void GetTexelRow(u64 *src, void *dst, u16 width, u16 clampSClamp, u16 maskSMask, u16 i, u8 palette)
+{
+	T * pDst = static_cast<T*>(dst);
+	const u16 identity = static_cast<u16>(std::min<u32>(width, std::min<u32>(clampSClamp + 1U, maskSMask + 1U)));
+	u16 x = TexelRun<GetTexel, T>::decode(src, pDst, identity, i, palette);
+	for (; x < identity; ++x)
+		pDst[x] = static_cast<T>(GetTexel(src, x, i, palette));
+	for (; x < width; ++x)
+		pDst[x] = static_cast<T>(GetTexel(src, std::min(x, clampSClamp) & maskSMask, i, palette));
+}
+
+#endif // TEXELDECODERS_H
@@ -120,7 +120,7 @@ void TexrectDrawer::_setDrawBuffer()
 		frameBufferList().setCurrentDrawBuffer();
 }
 
-TexrectDrawer::iRect TexrectDrawer::_getiRect(u32 w0, u32 w1) const
+TexrectDrawer::iRect TexrectDrawer::getiRect(u32 w0, u32 w1)
 {
 	iRect rect;
 	rect.ulx = _SHIFTR(w1, 12, 12);
@@ -132,90 +132,45 @@ TexrectDrawer::iRect TexrectDrawer::_getiRect(u32 w0, u32 w1) const
 
 #define COMPARE_COORDS(a, b) std::abs(a - b) <= 4
 
-bool TexrectDrawer::_lookAhead(bool _checkCoordinates) const
+bool TexrectDrawer::isSideBySide(const iRect & _rect1, const iRect & _rect2)
 {
-	if (config.graphics2D.enableNativeResTexrects != Config::NativeResTexrectsMode::ntOptimized)
-		return true;
-	if (RSP.LLE)
-		return true;
-	switch (GBI.getMicrocodeType()) {
-	case Turbo3D:
-	case T3DUX:
-	case F5Rogue:
-	case F5Indi_Naboo:
-		return true;
+	if (COMPARE_COORDS(_rect1.ulx, _rect2.ulx)) {
+		bool sbs = COMPARE_COORDS(_rect1.lry, _rect2.uly);
+		sbs |= COMPARE_COORDS(_rect1.uly, _rect2.lry);
+		return sbs;
 	}
+	if (COMPARE_COORDS(_rect1.uly, _rect2.uly)) {
+		bool sbs = COMPARE_COORDS(_rect1.lrx, _rect2.ulx);
+		sbs |= COMPARE_COORDS(_rect1.ulx, _rect2.lrx);
+		return sbs;
+	}
+	return false;
+}
 
-	auto sideBySide = [&](u32 pc) ->bool {
-		const u32 w0 = *(u32*)&RDRAM[pc];
-		const u32 w1 = *(u32*)&RDRAM[pc + 4];
-		const iRect nextRect = _getiRect(w0, w1);
-
-		if (COMPARE_COORDS(m_curRect.ulx, nextRect.ulx)) {
-			bool sbs = COMPARE_COORDS(m_curRect.lry, nextRect.uly);
-			sbs |= COMPARE_COORDS(m_curRect.uly, nextRect.lry);
-			return sbs;
-		}
-		if (COMPARE_COORDS(m_curRect.uly, nextRect.uly)) {
-			bool sbs = COMPARE_COORDS(m_curRect.lrx, nextRect.ulx);
-			sbs |= COMPARE_COORDS(m_curRect.ulx, nextRect.lrx);
-			return sbs;
-		}
-		return false;
-	};
-
-	u32 pc = RSP.PC[RSP.PCi];
-	while (true) {
-		switch (_SHIFTR(*(u32*)&RDRAM[pc], 24, 8)) {
-		case G_RDPLOADSYNC:
-		case G_RDPPIPESYNC:
-		case G_RDPTILESYNC:
-		case G_LOADTLUT:
-		case G_SETTILESIZE:
-		case G_LOADBLOCK:
-		case G_LOADTILE:
-		case G_SETTILE:
-		case G_SETTIMG:
-			break;
-		case G_TEXRECT:
-		case G_TEXRECTFLIP:
-			if (_checkCoordinates)
-				return sideBySide(pc);
+bool TexrectDrawer::_isAdjacent(const iRect & _rect, bool & _bDownUp) const
+{
+	if (COMPARE_COORDS(m_ulx_i, _rect.ulx)) {
+		_bDownUp = COMPARE_COORDS(m_uly_i, _rect.lry);
+		return _bDownUp || COMPARE_COORDS(m_lry_i, _rect.uly);
+	}
+	for (auto iter = m_vecRectCoords.crbegin(); iter != m_vecRectCoords.crend(); ++iter) {
+		if (COMPARE_COORDS(iter->x, _rect.ulx) && COMPARE_COORDS(iter->y, _rect.uly))
 			return true;
-		default:
-			return false;
-		}
-		pc += 8;
 	}
 	return false;
 }
 
-bool TexrectDrawer::addRect()
+void TexrectDrawer::addRect(RectVertex * _pRect, const iRect & _rect)
 {
 	DisplayWindow & wnd = dwnd();
 	GraphicsDrawer &  drawer = wnd.getDrawer();
-	RectVertex * pRect = drawer.m_rect;
 
-	m_curRect = _getiRect(RDP.w0, RDP.w1);
+	m_curRect = _rect;
 
 	bool bDownUp = false;
 	if (m_numRects != 0) {
-		bool bContinue = false;
-		if (m_otherMode == gDP.otherMode._u64 && m_mux == gDP.combine.mux) {
-			if (COMPARE_COORDS(m_ulx_i, m_curRect.ulx)) {
-				bContinue = COMPARE_COORDS(m_lry_i, m_curRect.uly);
-				bDownUp = COMPARE_COORDS(m_uly_i, m_curRect.lry);
-				bContinue |= bDownUp;
-			}
-			else {
-				for (auto iter = m_vecRectCoords.crbegin(); iter != m_vecRectCoords.crend(); ++iter) {
-					if (COMPARE_COORDS(iter->x, m_curRect.ulx) && COMPARE_COORDS(iter->y, m_curRect.uly)) {
-						bContinue = true;
-						break;
-					}
-				}
-			}
-		}
+		const bool bContinue = m_otherMode == gDP.otherMode._u64 && m_mux == gDP.combine.mux &&
+			_isAdjacent(_rect, bDownUp);
 		if (!bContinue) {
 			draw();
 			drawer._updateStates(DrawingState::TexRect);
@@ -224,9 +179,6 @@ bool TexrectDrawer::addRect()
 	}
 
 	if (m_numRects == 0) {
-		if (!_lookAhead(true))
-			return false;
-
 		m_numRects = 1;
 		m_pBuffer = frameBufferList().getCurrent();
 		m_otherMode = gDP.otherMode._u64;
@@ -234,10 +186,10 @@ bool TexrectDrawer::addRect()
 		m_Z = (gDP.otherMode.depthSource == G_ZS_PRIM) ? gDP.primDepth.z : 0.0f;
 		m_scissor = gDP.scissor;
 
-		m_ulx = pRect[0].x;
-		m_uly = pRect[0].y;
-		m_lrx = m_max_lrx = pRect[3].x;
-		m_lry = m_max_lry = pRect[3].y;
+		m_ulx = _pRect[0].x;
+		m_uly = _pRect[0].y;
+		m_lrx = m_max_lrx = _pRect[3].x;
+		m_lry = m_max_lry = _pRect[3].y;
 
 		m_ulx_i = m_curRect.ulx;
 		m_uly_i = m_curRect.uly;
@@ -260,13 +212,13 @@ bool TexrectDrawer::addRect()
 	}
 
 	if (bDownUp) {
-		m_ulx = pRect[0].x;
-		m_uly = pRect[0].y;
+		m_ulx = _pRect[0].x;
+		m_uly = _pRect[0].y;
 		m_ulx_i = m_curRect.ulx;
 		m_uly_i = m_curRect.uly;
 	} else {
-		m_lrx = pRect[3].x;
-		m_lry = pRect[3].y;
+		m_lrx = _pRect[3].x;
+		m_lry = _pRect[3].y;
 		m_max_lrx = std::max(m_max_lrx, m_lrx);
 		m_max_lry = std::max(m_max_lry, m_lry);
 		m_lry_i = m_curRect.lry;
@@ -283,14 +235,9 @@ bool TexrectDrawer::addRect()
 	Context::DrawRectParameters rectParams;
 	rectParams.mode = drawmode::TRIANGLE_STRIP;
 	rectParams.verticesCount = 4;
-	rectParams.vertices = pRect;
+	rectParams.vertices = _pRect;
 	rectParams.combiner = currentCombiner();
 	gfxContext.drawRects(rectParams);
-
-	if (m_numRects > 1 && !_lookAhead(false))
-		draw();
-
-	return true;
 }
 
 void TexrectDrawer::addBackgroundRect()
@@ -483,5 +430,12 @@ bool TexrectDrawer::canContinue() const
 	return (m_numRects != 0 &&
 			m_otherMode == gDP.otherMode._u64 &&
 			m_mux == gDP.combine.mux &&
+			memcmp(&m_scissor, &gDP.scissor, sizeof(gDPScissor)) == 0 &&
 			m_pBuffer == frameBufferList().getCurrent());
 }
+
+bool TexrectDrawer::canAddRect(const iRect & _rect) const
+{
+	bool bDownUp = false;
+	return canContinue() && _isAdjacent(_rect, bDownUp);
+}
@@ -9,24 +9,36 @@
 
 struct CachedTexture;
 struct FrameBuffer;
+struct RectVertex;
 
 class TexrectDrawer
 {
 public:
 	TexrectDrawer();
 
+	// Rect coordinates in 10.2 fixed point, as in the texrect command
+	struct iRect {
+		s32 ulx = 0, uly = 0, lrx = 0, lry = 0;
+	};
+	static iRect getiRect(u32 w0, u32 w1);
+	static bool isSideBySide(const iRect & _rect1, const iRect & _rect2);
+
 	void init();
 	void destroy();
-	bool addRect();
+	// Draws the rect to the texture. Draws the current rects first
+	// when it does not continue them.
+	void addRect(RectVertex * _pRect, const iRect & _rect);
 	void addBackgroundRect();
 	bool draw();
 	bool isEmpty() const;
 	bool canContinue() const;
+	// Whether addRect() would draw the rect together with the current rects.
+	bool canAddRect(const iRect & _rect) const;
 
 private:
 	void _setViewport() const;
 	void _setDrawBuffer();
-	bool _lookAhead(bool _checkCoordinates) const;
+	bool _isAdjacent(const iRect & _rect, bool & _bDownUp) const;
 
 	u32 m_numRects;
 	u64 m_otherMode;
@@ -48,10 +60,6 @@ private:
 	};
 	std::vector<RectCoords> m_vecRectCoords;
 
-	struct iRect {
-		s32 ulx = 0, uly = 0, lrx = 0, lry = 0;
-	};
-	iRect _getiRect(u32 w0, u32 w1) const;
 	iRect m_curRect;
 };
 
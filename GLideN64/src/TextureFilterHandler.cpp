@@ -84,12 +84,17 @@ void TextureFilterHandler::init()
 		pTexCachePath, // path to store cache files
 		pTexPackPath, // path to texture packs folder
 		wRomName); // name of ROM. must be no longer than 256 characters
+
+	if (m_inited != 0 && config.textureFilter.txDeferredEnhancement != 0 &&
+		(config.textureFilter.txFilterMode | config.textureFilter.txEnhancementMode) != 0)
+		_startWorker();
 #endif
 }
 
 void TextureFilterHandler::shutdown()
 {
 #ifndef NODHQ
+	_stopWorker();
 	if (isInited()) {
 		txfilter_shutdown();
 		m_inited = m_options = 0;
@@ -97,4 +102,113 @@ void TextureFilterHandler::shutdown()
 #endif
 }
 
+void TextureFilterHandler::_startWorker()
+{
+	if (m_worker.joinable())
+		return;
+	m_stopWorker = false;
+	m_worker = std::thread(&TextureFilterHandler::_workerLoop, this);
+}
+
+void TextureFilterHandler::_stopWorker()
+{
+	if (!m_worker.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopWorker = true;
+		m_tasks.clear();
+	}
+	m_condition.notify_one();
+	m_worker.join();
+	m_enhanced.clear();
+	m_numEnhanced = 0;
+}
+
+bool TextureFilterHandler::enqueueDeferred(u32 _crc, const u32 * _pData, u16 _width, u16 _height, u32 _format)
+{
+	// Do not let the queue grow unbounded when the worker can't keep up.
+	static const size_t maxPendingTasks = 256;
+
+	const u32 sizeShift = _format == u32(graphics::internalcolorFormat::RGBA8) ? 2 : 1;
+	const u8 * pSrc = reinterpret_cast<const u8*>(_pData);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_tasks.size() >= maxPendingTasks)
+			return false;
+		m_tasks.emplace_back();
+		DeferredTask & task = m_tasks.back();
+		task.crc = _crc;
+		task.width = _width;
+		task.height = _height;
+		task.format = _format;
+		task.data.assign(pSrc, pSrc + ((_width * _height) << sizeShift));
+	}
+	m_condition.notify_one();
+	return true;
+}
+
+bool TextureFilterHandler::popEnhanced(EnhancedTexture & _texture)
+{
+	if (m_numEnhanced == 0)
+		return false;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_enhanced.empty())
+		return false;
+	_texture = std::move(m_enhanced.front());
+	m_enhanced.pop_front();
+	--m_numEnhanced;
+	return true;
+}
+
+void TextureFilterHandler::_workerLoop()
+{
+#ifndef NODHQ
+	while (true) {
+		DeferredTask task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_stopWorker || !m_tasks.empty(); });
+			if (m_stopWorker)
+				return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+
+		EnhancedTexture enhanced;
+		GHQTexInfo ghqTexInfo;
+		// Filter output lives in buffers shared with the render thread, copy it out under the filter lock.
+		txfilter_lock();
+		if (txfilter_filter(task.data.data(), task.width, task.height, (u16)task.format,
+							(uint64)task.crc, &ghqTexInfo) != 0 && ghqTexInfo.data != nullptr) {
+			graphics::Parameter format(ghqTexInfo.format);
+			const u32 sizeShift = (format == graphics::internalcolorFormat::RGB8 ||
+				format == graphics::internalcolorFormat::RGBA4 ||
+				format == graphics::internalcolorFormat::RGB5_A1) ? 1 : 2;
+			enhanced.data.assign(ghqTexInfo.data,
+				ghqTexInfo.data + ((ghqTexInfo.width * ghqTexInfo.height) << sizeShift));
+		}
+		txfilter_unlock();
+
+		if (enhanced.data.empty())
+			continue;
+
+		enhanced.crc = task.crc;
+		enhanced.width = task.width;
+		enhanced.height = task.height;
+		enhanced.enhancedWidth = ghqTexInfo.width;
+		enhanced.enhancedHeight = ghqTexInfo.height;
+		enhanced.format = ghqTexInfo.format;
+		enhanced.textureFormat = ghqTexInfo.texture_format;
+		enhanced.pixelType = ghqTexInfo.pixel_type;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_stopWorker)
+			return;
+		m_enhanced.push_back(std::move(enhanced));
+		++m_numEnhanced;
+	}
+#endif
+}
+
 TextureFilterHandler TFH;
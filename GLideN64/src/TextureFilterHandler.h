@@ -1,22 +1,66 @@
 #ifndef TEXTUREFILTERHANDLER_H
 #define TEXTUREFILTERHANDLER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "Types.h"
 
 class TextureFilterHandler
 {
 public:
-	TextureFilterHandler() : m_inited(0), m_options(0) {}
+	// Result of a deferred enhancement, ready to replace the unfiltered texture with the same crc.
+	struct EnhancedTexture
+	{
+		u32 crc = 0;
+		u16 width = 0, height = 0; // N64 width and height of the source texture
+		s32 enhancedWidth = 0, enhancedHeight = 0;
+		u32 format = 0;
+		u16 textureFormat = 0;
+		u16 pixelType = 0;
+		std::vector<u8> data;
+	};
+
+	TextureFilterHandler() : m_inited(0), m_options(0), m_numEnhanced(0), m_stopWorker(false) {}
 	// It's not safe to call shutdown() in destructor, because texture filter has its own static objects, which can be destroyed first.
 	~TextureFilterHandler() { shutdown(); }
 	void init();
 	void shutdown();
 	bool isInited() const { return m_inited != 0; }
 	bool optionsChanged() const { return _getConfigOptions() != m_options; }
+
+	bool isDeferred() const { return m_worker.joinable(); }
+	// Queue texture for enhancement on the worker thread. Returns false if the texture must be filtered in place.
+	bool enqueueDeferred(u32 _crc, const u32 * _pData, u16 _width, u16 _height, u32 _format);
+	bool popEnhanced(EnhancedTexture & _texture);
+
 private:
+	struct DeferredTask
+	{
+		u32 crc;
+		u16 width, height;
+		u32 format;
+		std::vector<u8> data;
+	};
+
 	u32 _getConfigOptions() const;
+	void _startWorker();
+	void _stopWorker();
+	void _workerLoop();
+
 	u32 m_inited;
 	u32 m_options;
+
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<DeferredTask> m_tasks;
+	std::deque<EnhancedTexture> m_enhanced;
+	std::atomic<u32> m_numEnhanced;
+	bool m_stopWorker;
 };
 
 extern TextureFilterHandler TFH;
@@ -3,8 +3,10 @@
 #include <algorithm>
 #include <thread>         // std::this_thread::sleep_for
 #include <chrono>         // std::chrono::seconds
+#include <new>
 #include "Platform.h"
 #include "Textures.h"
+#include "TexelDecoders.h"
 #include "GBI.h"
 #include "RSP.h"
 #include "RDP.h"
@@ -16,227 +18,40 @@
 #include "Config.h"
 #include "GLideNHQ/Ext_TxFilter.h"
 #include "TextureFilterHandler.h"
+#include "TMEMTexture.h"
 #include "Graphics/Context.h"
 #include "Graphics/Parameters.h"
 #include "DisplayWindow.h"
+#include "Log.h"
+#include "DisplayListCapture.h"
 #include <GLideN64/GLideN64_libretro.h>
+#include <main/trace.h>
 
 using namespace std;
 using namespace graphics;
 
-inline u32 GetNone( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return 0x00000000;
-}
-
-inline u32 GetCI4_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
-{
-	u8 color4B = ((u8*)src)[(x >> 1) ^ (i << 1)];
-
-	return CI4_RGBA8888((x & 1) ? (palette << 4) | (color4B & 0x0F) : (palette << 4) | (color4B >> 4));
-}
-
-inline u32 GetCI4_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
-{
-	u8 color4B = ((u8*)src)[(x >> 1) ^ (i << 1)];
-
-	return CI4_RGBA4444((x & 1) ? (palette << 4) | (color4B & 0x0F) : (palette << 4) | (color4B >> 4));
-}
+// Size of the ring texels are streamed through. Uploads larger than a quarter of it are done from system memory.
+static const size_t uploadBufferSize = 4 * 1024 * 1024;
 
-inline u32 GetCI4IA_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
+struct TexelDecoder
 {
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	if (x & 1)
-		return IA88_RGBA4444( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
-	else
-		return IA88_RGBA4444( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
-}
-
-inline u32 GetCI4IA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	if (x & 1)
-		return IA88_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
-	else
-		return IA88_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
-}
+	GetTexelRowFunc GetRow16;
+	GetTexelRowFunc GetRow32;
 
-inline u32 GetCI4RGBA_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	if (x & 1)
-		return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
-	else
-		return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
-}
-
-inline u32 GetCI4RGBA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	if (x & 1)
-		return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B & 0x0F)] );
-	else
-		return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + (palette << 4) + (color4B >> 4)] );
-}
-
-inline u32 GetIA31_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	return IA31_RGBA8888( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
-}
-
-inline u32 GetIA31_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	return IA31_RGBA4444( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
-}
-
-inline u32 GetI4_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	return I4_RGBA8888( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
-}
-
-inline u32 GetI4_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u8 color4B = ((u8*)src)[(x>>1)^(i<<1)];
-
-	return I4_RGBA4444( (x & 1) ? (color4B & 0x0F) : (color4B >> 4) );
-}
-
-inline u32 GetCI8IA_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA88_RGBA4444( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
-}
-
-inline u32 GetCI8IA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA88_RGBA8888( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
-}
-
-inline u32 GetCI8RGBA_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return RGBA5551_RGBA5551( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
-}
-
-inline u32 GetCI8RGBA_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return RGBA5551_RGBA8888( *(u16*)&TMEM[256 + ((u8*)src)[x^(i<<1)]] );
-}
-
-inline u32 GetIA44_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA44_RGBA8888(((u8*)src)[x^(i<<1)]);
-}
-
-inline u32 GetIA44_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA44_RGBA4444(((u8*)src)[x^(i<<1)]);
-}
-
-inline u32 GetI8_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return I8_RGBA8888(((u8*)src)[x^(i<<1)]);
-}
-
-inline u32 GetI8_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return I8_RGBA4444(((u8*)src)[x^(i<<1)]);
-}
-
-inline u32 GetCI16IA_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
-{
-	const u16 tex = ((u16*)src)[x^i];
-	const u16 col = (*(u16*)&TMEM[256 + (tex >> 8)]);
-	const u16 c = col >> 8;
-	const u16 a = col & 0xFF;
-	return (a << 24) | (c << 16) | (c << 8) | c;
-}
-
-inline u32 GetCI16IA_RGBA4444(u64 *src, u16 x, u16 i, u8 palette)
-{
-	const u16 tex = ((u16*)src)[x^i];
-	const u16 col = (*(u16*)&TMEM[256 + (tex >> 8)]);
-	const u16 c = col >> 12;
-	const u16 a = col & 0x0F;
-	return (a << 12) | (c << 8) | (c << 4) | c;
-}
-
-inline u32 GetCI16RGBA_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
-{
-	const u16 tex = (((u16*)src)[x^i])&0xFF;
-	return RGBA5551_RGBA8888(((u16*)&TMEM[256])[tex << 2]);
-}
-
-inline u32 GetCI16RGBA_RGBA5551(u64 *src, u16 x, u16 i, u8 palette)
-{
-	const u16 tex = (((u16*)src)[x^i]) & 0xFF;
-	return RGBA5551_RGBA5551(((u16*)&TMEM[256])[tex << 2]);
-}
-
-inline u32 GetRGBA5551_RGBA8888(u64 *src, u16 x, u16 i, u8 palette)
-{
-	u16 tex = ((u16*)src)[x^i];
-	return RGBA5551_RGBA8888(tex);
-}
-
-inline u32 GetRGBA5551_RGBA5551( u64 *src, u16 x, u16 i, u8 palette )
-{
-	u16 tex = ((u16*)src)[x^i];
-	return RGBA5551_RGBA5551(tex);
-}
-
-inline u32 GetIA88_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA88_RGBA8888(((u16*)src)[x^i]);
-}
-
-inline u32 GetIA88_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return IA88_RGBA4444(((u16*)src)[x^i]);
-}
-
-inline u32 GetRGBA8888_RGBA8888( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return ((u32*)src)[x^i];
-}
-
-inline u32 GetRGBA8888_RGBA4444( u64 *src, u16 x, u16 i, u8 palette )
-{
-	return RGBA8888_RGBA4444(((u32*)src)[x^i]);
-}
-
-inline u32 YUV_RGBA8888(u8 y, u8 u, u8 v)
-{
-	return (0xff << 24) | (y << 16) | (v << 8) | u;
-}
+	GetTexelRowFunc getRow(Parameter _glInternalFormat) const
+	{
+		return _glInternalFormat == internalcolorFormat::RGBA8 ? GetRow32 : GetRow16;
+	}
+};
 
-inline void GetYUV_RGBA8888(u64 * src, u32 * dst, u16 x)
-{
-	const u32 t = (((u32*)src)[x]);
-	u8 y1 = (u8)t & 0xFF;
-	u8 v = (u8)(t >> 8) & 0xFF;
-	u8 y0 = (u8)(t >> 16) & 0xFF;
-	u8 u = (u8)(t >> 24) & 0xFF;
-	u32 c = YUV_RGBA8888(y0, u, v);
-	*(dst++) = c;
-	c = YUV_RGBA8888(y1, u, v);
-	*(dst++) = c;
-}
+#define TEXEL_DECODER(GetTexel) { GetTexelRow<GetTexel, u16>, GetTexelRow<GetTexel, u32> }
 
 struct TextureLoadParameters
 {
-	GetTexelFunc				Get16;
+	TexelDecoder				Get16;
 	DatatypeParam				glType16;
 	InternalColorFormatParam	glInternalFormat16;
-	GetTexelFunc				Get32;
+	TexelDecoder				Get32;
 	DatatypeParam				glType32;
 	InternalColorFormatParam	glInternalFormat32;
 	InternalColorFormatParam	autoFormat;
@@ -261,125 +76,125 @@ ImageFormat::ImageFormat()
 	{ // G_TT_NONE
 		{ //		Get16					glType16	glInternalFormat16		Get32					glType32	glInternalFormat32	autoFormat
 			{ // 4-bit
-				{ GetI4_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetI4_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // RGBA as I
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
-				{ GetCI4_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI4_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // CI without palette
-				{ GetIA31_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetIA31_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // IA
-				{ GetI4_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetI4_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // I
+				{ TEXEL_DECODER(GetI4_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetI4_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // RGBA as I
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
+				{ TEXEL_DECODER(GetCI4_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI4_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // CI without palette
+				{ TEXEL_DECODER(GetIA31_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetIA31_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // IA
+				{ TEXEL_DECODER(GetI4_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetI4_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // I
 			},
 			{ // 8-bit
-				{ GetI8_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetI8_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // RGBA as I
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
-				{ GetI8_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetI8_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // CI without palette
-				{ GetIA44_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetIA44_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 3, 4096 }, // IA
-				{ GetI8_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetI8_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // I
+				{ TEXEL_DECODER(GetI8_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetI8_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // RGBA as I
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
+				{ TEXEL_DECODER(GetI8_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetI8_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // CI without palette
+				{ TEXEL_DECODER(GetIA44_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetIA44_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 3, 4096 }, // IA
+				{ TEXEL_DECODER(GetI8_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetI8_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 4096 }, // I
 			},
 			{ // 16-bit
-				{ GetRGBA5551_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetRGBA5551_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
-				{ GetIA88_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetIA88_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // CI as IA
-				{ GetIA88_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetIA88_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
+				{ TEXEL_DECODER(GetRGBA5551_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetRGBA5551_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
+				{ TEXEL_DECODER(GetIA88_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetIA88_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // CI as IA
+				{ TEXEL_DECODER(GetIA88_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetIA88_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
 			},
 			{ // 32-bit
-				{ GetRGBA8888_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetRGBA8888_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
+				{ TEXEL_DECODER(GetRGBA8888_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetRGBA8888_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
 			}
 		},
 			// DUMMY
 		{ //		Get16					glType16	glInternalFormat16			Get32				glType32	glInternalFormat32	autoFormat
 			{ // 4-bit
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI (Banjo-Kazooie uses this, doesn't make sense, but it works...)
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // IA as CI
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // I as CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI (Banjo-Kazooie uses this, doesn't make sense, but it works...)
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // IA as CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // I as CI
 			},
 			{ // 8-bit
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // CI
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // IA as CI
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // I as CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // IA as CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // I as CI
 			},
 			{ // 16-bit
-				{ GetCI16RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetRGBA5551_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // CI
-				{ GetCI16RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI16RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // IA as CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
+				{ TEXEL_DECODER(GetCI16RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetRGBA5551_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI16RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI16RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // IA as CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
 			},
 			{ // 32-bit
-				{ GetRGBA8888_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetRGBA8888_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
+				{ TEXEL_DECODER(GetRGBA8888_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetRGBA8888_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
 			}
 		},
 			// G_TT_RGBA16
 		{ //		Get16					glType16			glInternalFormat16	Get32				glType32	glInternalFormat32	autoFormat
 			{ // 4-bit
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI (Banjo-Kazooie uses this, doesn't make sense, but it works...)
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // IA as CI
-				{ GetCI4RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI4RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // I as CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI (Banjo-Kazooie uses this, doesn't make sense, but it works...)
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 4, 8192 }, // YUV
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // IA as CI
+				{ TEXEL_DECODER(GetCI4RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI4RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 4, 4096 }, // I as CI
 			},
 			{ // 8-bit
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // CI
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // IA as CI
-				{ GetCI8RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI8RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // I as CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 4096 }, // YUV
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // IA as CI
+				{ TEXEL_DECODER(GetCI8RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI8RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 3, 2048 }, // I as CI
 			},
 			{ // 16-bit
-				{ GetCI16RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetRGBA5551_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // CI
-				{ GetCI16RGBA_RGBA5551, datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, GetCI16RGBA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // IA as CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
+				{ TEXEL_DECODER(GetCI16RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetRGBA5551_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI16RGBA_RGBA5551), datatype::UNSIGNED_SHORT_5_5_5_1, internalcolorFormat::RGB5_A1, TEXEL_DECODER(GetCI16RGBA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGB5_A1, 2, 2048 }, // IA as CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 2048 }, // I
 			},
 			{ // 32-bit
-				{ GetRGBA8888_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetRGBA8888_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
+				{ TEXEL_DECODER(GetRGBA8888_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetRGBA8888_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA4, 0, 1024 }, // I
 			}
 		},
 			// G_TT_IA16
 		{ //		Get16					glType16			glInternalFormat16	Get32				glType32	glInternalFormat32	autoFormat
 			{ // 4-bit
-				{ GetCI4IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI4IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 8192 }, // YUV
-				{ GetCI4IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI4IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // CI
-				{ GetCI4IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI4IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // IA
-				{ GetCI4IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI4IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // I
+				{ TEXEL_DECODER(GetCI4IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI4IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 8192 }, // YUV
+				{ TEXEL_DECODER(GetCI4IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI4IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // CI
+				{ TEXEL_DECODER(GetCI4IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI4IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // IA
+				{ TEXEL_DECODER(GetCI4IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI4IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 4, 4096 }, // I
 			},
 			{ // 8-bit
-				{ GetCI8IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI8IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 4096 }, // YUV
-				{ GetCI8IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI8IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // CI
-				{ GetCI8IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI8IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // IA
-				{ GetCI8IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI8IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // I
+				{ TEXEL_DECODER(GetCI8IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI8IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 4096 }, // YUV
+				{ TEXEL_DECODER(GetCI8IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI8IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI8IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI8IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // IA
+				{ TEXEL_DECODER(GetCI8IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI8IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 3, 2048 }, // I
 			},
 			{ // 16-bit
-				{ GetCI16IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI16IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 2048 }, // CI
-				{ GetCI16IA_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetCI16IA_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 2048 }, // I
+				{ TEXEL_DECODER(GetCI16IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI16IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 2048 }, // CI
+				{ TEXEL_DECODER(GetCI16IA_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetCI16IA_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 2048 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 2048 }, // I
 			},
 			{ // 32-bit
-				{ GetRGBA8888_RGBA4444, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetRGBA8888_RGBA8888, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // YUV
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // CI
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // IA
-				{ GetNone, datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, GetNone, datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // I
+				{ TEXEL_DECODER(GetRGBA8888_RGBA4444), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetRGBA8888_RGBA8888), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 2, 1024 }, // RGBA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // YUV
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // CI
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // IA
+				{ TEXEL_DECODER(GetNone), datatype::UNSIGNED_SHORT_4_4_4_4, internalcolorFormat::RGBA4, TEXEL_DECODER(GetNone), datatype::UNSIGNED_BYTE, internalcolorFormat::RGBA8, internalcolorFormat::RGBA8, 0, 1024 }, // I
 			}
 		}
 	};
@@ -476,6 +291,9 @@ void TextureCache::init()
 	activateDummy(1);
 	current[0] = current[1] = nullptr;
 
+	m_pUploadBuffer.reset(gfxContext.createPixelWriteBuffer(uploadBufferSize));
+	m_lruTextureLocations.reserve(MaxTxCacheSize);
+
 
 	m_pMSDummy = nullptr;
 	if (config.video.multisampling != 0 && Context::Multisampling) {
@@ -497,46 +315,127 @@ void TextureCache::init()
 		activateMSDummy(1);
 	}
 
+	m_tmemTextures.clear();
+	if (Context::ShaderTMEM) {
+		m_tmemTextures.emplace_back(m_pDummy->name);
+		m_tmemTextures.emplace_back(m_pDummy->name);
+	}
+
 	assert(!gfxContext.isError());
 }
 
 void TextureCache::destroy()
 {
+	LOG(LOG_VERBOSE, "Texture cache: %u hits, %u misses, %u evictions, %u/%u BG band hits/misses, %u KB in use\n",
+		m_hits, m_misses, m_evictions, m_bgBandHits, m_bgBandMisses, u32(m_cachedBytes >> 10));
+
 	current[0] = current[1] = nullptr;
 
 	for (Textures::const_iterator cur = m_textures.cbegin(); cur != m_textures.cend(); ++cur)
 		gfxContext.deleteTexture(cur->name);
 	m_textures.clear();
+	m_freeTextures.clear();
 	m_lruTextureLocations.clear();
+	m_cachedBytes = 0;
 
 	for (FBTextures::const_iterator cur = m_fbTextures.cbegin(); cur != m_fbTextures.cend(); ++cur)
 		gfxContext.deleteTexture(cur->second.name);
 	m_fbTextures.clear();
+
+	for (auto & buffer : m_stagingBuffers)
+		std::vector<u64>().swap(buffer);
+	m_pUploadBuffer.reset();
+	m_tmemTextures.clear();
+	m_volatileTiles.clear();
+	m_backgrounds.clear();
+	m_bgBandCrcs.clear();
+}
+
+u8 * TextureCache::_getStagingBuffer(u32 _slot, u32 _bytes)
+{
+	std::vector<u64> & buffer = m_stagingBuffers[_slot];
+	const size_t size = (_bytes + sizeof(u64) - 1) / sizeof(u64);
+	if (buffer.size() < size) {
+		try {
+			buffer.resize(size);
+		} catch (const std::bad_alloc &) {
+			return nullptr;
+		}
+	}
+	return reinterpret_cast<u8*>(buffer.data());
+}
+
+u8 * TextureCache::_getUploadBuffer(u32 _bytes)
+{
+	// Texture enhancement and depth texture loading read decoded texels back,
+	// so they must be decoded to system memory.
+	if (!m_pUploadBuffer ||
+		(config.textureFilter.txEnhancementMode | config.textureFilter.txFilterMode) != 0 ||
+		((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress))
+		return nullptr;
+	return static_cast<u8*>(m_pUploadBuffer->getWriteBuffer(_bytes));
 }
 
 void TextureCache::_checkCacheSize()
 {
-	size_t m_maxCacheSize = MaxTxCacheSize;
-	if (m_textures.size() >= m_maxCacheSize) {
-		CachedTexture& clsTex = m_textures.back();
-		gfxContext.deleteTexture(clsTex.name);
-		m_lruTextureLocations.erase(clsTex.crc);
-		m_textures.pop_back();
+	// Make room for one more texture. The size of the new texture is not known yet,
+	// so the byte budget may be exceeded by the last loaded texture.
+	const size_t maxCacheSize = MaxTxCacheSize;
+	const size_t maxCacheBytes = size_t(TxCacheBudget) << 20;
+	Textures::iterator iter = m_textures.end();
+	while (iter != m_textures.begin() &&
+		(m_textures.size() >= maxCacheSize || (maxCacheBytes != 0 && m_cachedBytes > maxCacheBytes))) {
+		--iter;
+		// Never evict textures which are currently bound, take the next older one instead.
+		if (&(*iter) == current[0] || &(*iter) == current[1])
+			continue;
+		_removeTexture(iter++);
+		m_evictions++;
 	}
 }
 
+void TextureCache::_removeTexture(Textures::iterator _iter)
+{
+	gfxContext.deleteTexture(_iter->name);
+	m_cachedBytes -= _iter->textureBytes;
+	m_lruTextureLocations.erase(_iter->crc);
+	if (m_freeTextures.size() < MaxFreeTextures)
+		m_freeTextures.splice(m_freeTextures.begin(), m_textures, _iter);
+	else
+		m_textures.erase(_iter);
+}
+
 CachedTexture * TextureCache::_addTexture(u32 _crc32)
 {
 	if (m_curUnpackAlignment == 0)
 		m_curUnpackAlignment = gfxContext.getTextureUnpackAlignment();
 	_checkCacheSize();
-	m_textures.emplace_front(gfxContext.createTexture(textureTarget::TEXTURE_2D));
+	ObjectHandle name = gfxContext.createTexture(textureTarget::TEXTURE_2D);
+	if (m_freeTextures.empty()) {
+		m_textures.emplace_front(name);
+	} else {
+		m_textures.splice(m_textures.begin(), m_freeTextures, m_freeTextures.begin());
+		m_textures.front() = CachedTexture(name);
+	}
 	Textures::iterator new_iter = m_textures.begin();
 	new_iter->crc = _crc32;
 	m_lruTextureLocations.insert(std::pair<u32, Textures::iterator>(_crc32, new_iter));
 	return &(*new_iter);
 }
 
+TextureCache::Stats TextureCache::getStats() const
+{
+	Stats stats;
+	stats.hits = m_hits;
+	stats.misses = m_misses;
+	stats.evictions = m_evictions;
+	stats.bgBandHits = m_bgBandHits;
+	stats.bgBandMisses = m_bgBandMisses;
+	stats.textures = static_cast<u32>(m_textures.size());
+	stats.bytes = m_cachedBytes;
+	return stats;
+}
+
 void TextureCache::removeFrameBufferTexture(CachedTexture * _pTexture)
 {
 	if (_pTexture == nullptr)
@@ -738,10 +637,10 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 
 	u8 *pSwapped, *pSrc;
 	u32 numBytes, bpl;
-	u32 x, y, j, tx, ty;
+	u32 y, j, ty;
 	u16 clampSClamp;
 	u16 clampTClamp;
-	GetTexelFunc GetTexel;
+	GetTexelRowFunc GetTexelRow;
 	InternalColorFormatParam glInternalFormat;
 	DatatypeParam glType;
 
@@ -749,27 +648,26 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 			ImageFormat::get().tlp[pTexture->format == 2 ? G_TT_RGBA16 : G_TT_NONE][pTexture->size][pTexture->format];
 	if (loadParams.autoFormat == internalcolorFormat::RGBA8) {
 		pTexture->textureBytes = (pTexture->width * pTexture->height) << 2;
-		GetTexel = loadParams.Get32;
 		glInternalFormat = loadParams.glInternalFormat32;
 		glType = loadParams.glType32;
+		GetTexelRow = loadParams.Get32.getRow(glInternalFormat);
 	} else {
 		pTexture->textureBytes = (pTexture->width * pTexture->height) << 1;
-		GetTexel = loadParams.Get16;
 		glInternalFormat = loadParams.glInternalFormat16;
 		glType = loadParams.glType16;
+		GetTexelRow = loadParams.Get16.getRow(glInternalFormat);
 	}
 
 	bpl = gSP.bgImage.width << gSP.bgImage.size >> 1;
 	numBytes = bpl * gSP.bgImage.height;
-	pSwapped = (u8*)malloc(numBytes);
+	pSwapped = _getStagingBuffer(1, numBytes);
 	if (pSwapped == nullptr)
 		return;
 	UnswapCopyWrap(RDRAM, gSP.bgImage.address, pSwapped, 0, RDRAMSize, numBytes);
-	pDest = (u32*)malloc(pTexture->textureBytes);
-	if (pDest == nullptr) {
-		free(pSwapped);
+	u8 * pUpload = _getUploadBuffer(pTexture->textureBytes);
+	pDest = reinterpret_cast<u32*>(pUpload != nullptr ? pUpload : _getStagingBuffer(0, pTexture->textureBytes));
+	if (pDest == nullptr)
 		return;
-	}
 	pDest16 = reinterpret_cast<u16*>(pDest);
 
 	clampSClamp = pTexture->width - 1;
@@ -781,20 +679,15 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 
 		pSrc = &pSwapped[bpl * ty];
 
-		for (x = 0; x < pTexture->width; x++) {
-			tx = min(x, (u32)clampSClamp);
-
-			if (glInternalFormat == internalcolorFormat::RGBA8)
-				pDest[j++] = GetTexel((u64*)pSrc, tx, 0, pTexture->palette);
-			else
-				pDest16[j++] = static_cast<u16>(GetTexel((u64*)pSrc, tx, 0, pTexture->palette));
-		}
+		if (glInternalFormat == internalcolorFormat::RGBA8)
+			GetTexelRow((u64*)pSrc, pDest + j, pTexture->width, clampSClamp, 0xFFFF, 0, pTexture->palette);
+		else
+			GetTexelRow((u64*)pSrc, pDest16 + j, pTexture->width, clampSClamp, 0xFFFF, 0, pTexture->palette);
+		j += pTexture->width;
 	}
 
 	if ((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress) {
 		_loadDepthTexture(pTexture, (u16*)pDest);
-		free(pDest);
-		free(pSwapped);
 		return;
 	}
 
@@ -840,13 +733,17 @@ void TextureCache::_loadBackground(CachedTexture *pTexture)
 		params.format = colorFormat::RGBA;
 		params.internalFormat = gfxContext.convertInternalTextureFormat(u32(glInternalFormat));
 		params.dataType = glType;
-		params.data = pDest;
-		gfxContext.init2DTexture(params);
+		if (pUpload != nullptr) {
+			PixelBufferBinder<PixelWriteBuffer> binder(m_pUploadBuffer.get());
+			params.data = m_pUploadBuffer->closeWriteBuffer();
+			gfxContext.init2DTexture(params);
+		} else {
+			params.data = pDest;
+			gfxContext.init2DTexture(params);
+		}
 	}
 	if (m_curUnpackAlignment > 1)
 		gfxContext.setTextureUnpackAlignment(m_curUnpackAlignment);
-	free(pSwapped);
-	free(pDest);
 #endif
 }
 
@@ -973,10 +870,29 @@ void TextureCache::_loadDepthTexture(CachedTexture * _pTexture, u16* _pDest)
 /*
  * Worker function for _load
 */
+// Distance between rows of 32-bit texels in 16-bit TMEM words.
+static
+int _getLine32(u16 _clampWidth, u16 _line)
+{
+	int wid_64 = _clampWidth << 2;
+	if (wid_64 & 15) {
+		wid_64 += 16;
+	}
+	wid_64 &= 0xFFFFFFF0;
+	wid_64 >>= 3;
+	int line32 = _line << 1;
+	line32 = (line32 - wid_64) << 3;
+	if (wid_64 < 1) {
+		wid_64 = 1;
+	}
+	int width = wid_64 << 1;
+	return width + (line32 >> 2);
+}
+
 void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 						u32* pDest,
 						Parameter glInternalFormat,
-						GetTexelFunc GetTexel,
+						GetTexelRowFunc GetTexelRow,
 						u16* pLine)
 {
 	u16 maskSMask, clampSClamp;
@@ -1004,20 +920,7 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 	if (tmptex.size == G_IM_SIZ_32b) {
 		const u16 * tmem16 = (u16*)TMEM;
 		const u32 tbase = tmptex.tMem << 2;
-
-		int wid_64 = (tmptex.clampWidth) << 2;
-		if (wid_64 & 15) {
-			wid_64 += 16;
-		}
-		wid_64 &= 0xFFFFFFF0;
-		wid_64 >>= 3;
-		int line32 = tmptex.line << 1;
-		line32 = (line32 - wid_64) << 3;
-		if (wid_64 < 1) {
-			wid_64 = 1;
-		}
-		int width = wid_64 << 1;
-		line32 = width + (line32 >> 2);
+		const int line32 = _getLine32(tmptex.clampWidth, tmptex.line);
 
 		u16 gr, ab;
 
@@ -1056,19 +959,70 @@ void TextureCache::_getTextureDestData(CachedTexture& tmptex,
 			pSrc = &TMEM[(tmptex.tMem + *pLine * ty) & tMemMask];
 
 			i = (ty & 1) << 1;
-			for (x = 0; x < tmptex.width; ++x) {
-				tx = min(x, clampSClamp) & maskSMask;
-
-				if (glInternalFormat == internalcolorFormat::RGBA8) {
-					pDest[j++] = GetTexel(pSrc, tx, i, tmptex.palette);
-				} else {
-					((u16*)pDest)[j++] = GetTexel(pSrc, tx, i, tmptex.palette);
-				}
-			}
+			if (glInternalFormat == internalcolorFormat::RGBA8)
+				GetTexelRow(pSrc, pDest + j, tmptex.width, clampSClamp, maskSMask, i, tmptex.palette);
+			else
+				GetTexelRow(pSrc, (u16*)pDest + j, tmptex.width, clampSClamp, maskSMask, i, tmptex.palette);
+			j += tmptex.width;
 		}
 	}
 }
 
+void TextureCache::_loadEnhancedTexture(u32 _tile, GHQTexInfo & _info, CachedTexture *_pTexture, u16 _widthOrg, u16 _heightOrg)
+{
+	if (_info.width % 2 != 0 &&
+		_info.format != u32(internalcolorFormat::RGBA8) &&
+		m_curUnpackAlignment > 1)
+		gfxContext.setTextureUnpackAlignment(2);
+	_info.format = gfxContext.convertInternalTextureFormat(_info.format);
+	Context::InitTextureParams params;
+	params.handle = _pTexture->name;
+	params.textureUnitIndex = textureIndices::Tex[_tile];
+	params.mipMapLevel = 0;
+	params.msaaLevel = 0;
+	params.width = _info.width;
+	params.height = _info.height;
+	params.internalFormat = InternalColorFormatParam(_info.format);
+	params.format = ColorFormatParam(_info.texture_format);
+	params.dataType = DatatypeParam(_info.pixel_type);
+	params.data = _info.data;
+	gfxContext.init2DTexture(params);
+	_updateCachedTexture(_info, _pTexture, _widthOrg, _heightOrg);
+}
+
+void TextureCache::_applyDeferredEnhancements(u32 _tile)
+{
+#ifndef NODHQ
+	TextureFilterHandler::EnhancedTexture enhanced;
+	bool applied = false;
+	while (TFH.popEnhanced(enhanced)) {
+		Texture_Locations::iterator locations_iter = m_lruTextureLocations.find(enhanced.crc);
+		if (locations_iter == m_lruTextureLocations.end())
+			continue;
+
+		CachedTexture & texture = *locations_iter->second;
+		// Texture may have been replaced by a hires one or reloaded with other size meanwhile.
+		if (texture.bHDTexture || texture.max_level != 0 ||
+			texture.width != enhanced.width || texture.height != enhanced.height)
+			continue;
+
+		GHQTexInfo ghqTexInfo;
+		ghqTexInfo.data = enhanced.data.data();
+		ghqTexInfo.width = enhanced.enhancedWidth;
+		ghqTexInfo.height = enhanced.enhancedHeight;
+		ghqTexInfo.format = enhanced.format;
+		ghqTexInfo.texture_format = enhanced.textureFormat;
+		ghqTexInfo.pixel_type = enhanced.pixelType;
+		m_cachedBytes -= texture.textureBytes;
+		_loadEnhancedTexture(_tile, ghqTexInfo, &texture, texture.width, texture.height);
+		m_cachedBytes += texture.textureBytes;
+		applied = true;
+	}
+	if (applied && m_curUnpackAlignment > 1)
+		gfxContext.setTextureUnpackAlignment(m_curUnpackAlignment);
+#endif
+}
+
 void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 {
 	u64 ricecrc = 0;
@@ -1078,7 +1032,7 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 	u32 *pDest;
 
 	u16 line;
-	GetTexelFunc GetTexel;
+	GetTexelRowFunc GetTexelRow;
 	InternalColorFormatParam glInternalFormat;
 	DatatypeParam glType;
 	u32 sizeShift;
@@ -1088,19 +1042,20 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 	if (loadParams.autoFormat == internalcolorFormat::RGBA8) {
 		sizeShift = 2;
 		_pTexture->textureBytes = (_pTexture->width * _pTexture->height) << sizeShift;
-		GetTexel = loadParams.Get32;
 		glInternalFormat = loadParams.glInternalFormat32;
 		glType = loadParams.glType32;
+		GetTexelRow = loadParams.Get32.getRow(glInternalFormat);
 	} else {
 		sizeShift = 1;
 		_pTexture->textureBytes = (_pTexture->width * _pTexture->height) << sizeShift;
-		GetTexel = loadParams.Get16;
 		glInternalFormat = loadParams.glInternalFormat16;
 		glType = loadParams.glType16;
+		GetTexelRow = loadParams.Get16.getRow(glInternalFormat);
 	}
 
-	pDest = (u32*)malloc(_pTexture->textureBytes);
-	assert(pDest != nullptr);
+	pDest = reinterpret_cast<u32*>(_getStagingBuffer(0, _pTexture->textureBytes));
+	if (pDest == nullptr)
+		return;
 
 	s32 mipLevel = 0;
 	_pTexture->max_level = 0;
@@ -1123,11 +1078,11 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 	line = tmptex.line;
 
 	while (true) {
-		_getTextureDestData(tmptex, pDest, glInternalFormat, GetTexel, &line);
+		u32 * pUpload = reinterpret_cast<u32*>(_getUploadBuffer((tmptex.width * tmptex.height) << sizeShift));
+		_getTextureDestData(tmptex, pUpload != nullptr ? pUpload : pDest, glInternalFormat, GetTexelRow, &line);
 
 		if ((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress) {
 			_loadDepthTexture(_pTexture, (u16*)pDest);
-			free(pDest);
 			return;
 		}
 
@@ -1151,29 +1106,16 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 		}
 
 #ifndef NODHQ
+		if (needEnhance && TFH.isDeferred() &&
+			TFH.enqueueDeferred(_pTexture->crc, pDest, tmptex.width, tmptex.height, u32(glInternalFormat)))
+			needEnhance = false;
+
 		if (needEnhance) {
 			GHQTexInfo ghqTexInfo;
 			if (txfilter_filter((u8*)pDest, tmptex.width, tmptex.height,
 							(u16)u32(glInternalFormat), (uint64)_pTexture->crc,
 							&ghqTexInfo) != 0 && ghqTexInfo.data != nullptr) {
-				if (ghqTexInfo.width % 2 != 0 &&
-					ghqTexInfo.format != u32(internalcolorFormat::RGBA8) &&
-					m_curUnpackAlignment > 1)
-					gfxContext.setTextureUnpackAlignment(2);
-				ghqTexInfo.format = gfxContext.convertInternalTextureFormat(ghqTexInfo.format);
-				Context::InitTextureParams params;
-				params.handle = _pTexture->name;
-				params.textureUnitIndex = textureIndices::Tex[_tile];
-				params.mipMapLevel = 0;
-				params.msaaLevel = 0;
-				params.width = ghqTexInfo.width;
-				params.height = ghqTexInfo.height;
-				params.internalFormat = InternalColorFormatParam(ghqTexInfo.format);
-				params.format = ColorFormatParam(ghqTexInfo.texture_format);
-				params.dataType = DatatypeParam(ghqTexInfo.pixel_type);
-				params.data = ghqTexInfo.data;
-				gfxContext.init2DTexture(params);
-				_updateCachedTexture(ghqTexInfo, _pTexture, tmptex.width, tmptex.height);
+				_loadEnhancedTexture(_tile, ghqTexInfo, _pTexture, tmptex.width, tmptex.height);
 				bLoaded = true;
 			}
 		}
@@ -1194,8 +1136,14 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 			params.internalFormat = gfxContext.convertInternalTextureFormat(u32(glInternalFormat));
 			params.format = colorFormat::RGBA;
 			params.dataType = glType;
-			params.data = pDest;
-			gfxContext.init2DTexture(params);
+			if (pUpload != nullptr) {
+				PixelBufferBinder<PixelWriteBuffer> binder(m_pUploadBuffer.get());
+				params.data = m_pUploadBuffer->closeWriteBuffer();
+				gfxContext.init2DTexture(params);
+			} else {
+				params.data = pDest;
+				gfxContext.init2DTexture(params);
+			}
 		}
 		if (mipLevel == _pTexture->max_level)
 			break;
@@ -1220,7 +1168,6 @@ void TextureCache::_load(u32 _tile, CachedTexture *_pTexture)
 	}
 	if (m_curUnpackAlignment > 1)
 		gfxContext.setTextureUnpackAlignment(m_curUnpackAlignment);
-	free(pDest);
 }
 
 struct TextureParams
@@ -1337,18 +1284,132 @@ void TextureCache::activateMSDummy(u32 _t)
 	gfxContext.setTextureParameters(params);
 }
 
+// Rows of background image hashed and reloaded together
+static const u32 BgBandRows = 16;
+
+bool TextureCache::_useBackgroundBands() const
+{
+	// Enhanced, hires and depth backgrounds need the whole image at once.
+	if (TFH.isInited() && (config.textureFilter.txHiresEnable != 0 ||
+		((config.textureFilter.txEnhancementMode | config.textureFilter.txFilterMode) != 0 &&
+		 config.textureFilter.txFilterIgnoreBG == 0)))
+		return false;
+	if ((config.generalEmulation.hacks&hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress)
+		return false;
+	return true;
+}
+
+// Returns false if some changed bands could not be uploaded. Their CRCs in m_bgBandCrcs are
+// set back to _oldCrcs, so m_bgBandCrcs describes what the texture holds.
+bool TextureCache::_updateBackgroundBands(CachedTexture * _pTexture, const std::vector<u32> & _oldCrcs)
+{
+	const TextureLoadParameters & loadParams =
+			ImageFormat::get().tlp[_pTexture->format == 2 ? G_TT_RGBA16 : G_TT_NONE][_pTexture->size][_pTexture->format];
+	InternalColorFormatParam glInternalFormat;
+	DatatypeParam glType;
+	GetTexelRowFunc GetTexelRow;
+	u32 sizeShift;
+	if (loadParams.autoFormat == internalcolorFormat::RGBA8) {
+		glInternalFormat = loadParams.glInternalFormat32;
+		glType = loadParams.glType32;
+		GetTexelRow = loadParams.Get32.getRow(glInternalFormat);
+		sizeShift = 2;
+	} else {
+		glInternalFormat = loadParams.glInternalFormat16;
+		glType = loadParams.glType16;
+		GetTexelRow = loadParams.Get16.getRow(glInternalFormat);
+		sizeShift = 1;
+	}
+
+	if (_pTexture->width % 2 != 0 && glInternalFormat != internalcolorFormat::RGBA8)
+		gfxContext.setTextureUnpackAlignment(2);
+
+	const u32 bpl = gSP.bgImage.width << gSP.bgImage.size >> 1;
+	const u32 numBands = static_cast<u32>(m_bgBandCrcs.size());
+	const u16 clampSClamp = _pTexture->width - 1;
+	bool bUploaded = true;
+	u32 band = 0;
+	while (band < numBands) {
+		if (m_bgBandCrcs[band] == _oldCrcs[band]) {
+			++m_bgBandHits;
+			++band;
+			continue;
+		}
+
+		// Reload the run of changed bands with one upload.
+		u32 lastBand = band;
+		while (lastBand + 1 < numBands && m_bgBandCrcs[lastBand + 1] != _oldCrcs[lastBand + 1])
+			++lastBand;
+		m_bgBandMisses += lastBand - band + 1;
+
+		const u32 firstRow = band * BgBandRows;
+		const u32 numRows = min(u32(_pTexture->height), (lastBand + 1) * BgBandRows) - firstRow;
+		const u32 numBytes = bpl * numRows;
+		u8 * pSwapped = _getStagingBuffer(1, numBytes);
+		u8 * pDest = _getStagingBuffer(0, (_pTexture->width * numRows) << sizeShift);
+		if (pSwapped == nullptr || pDest == nullptr) {
+			std::copy(_oldCrcs.begin() + band, _oldCrcs.end(), m_bgBandCrcs.begin() + band);
+			bUploaded = false;
+			break;
+		}
+		UnswapCopyWrap(RDRAM, gSP.bgImage.address + bpl * firstRow, pSwapped, 0, RDRAMSize, numBytes);
+
+		for (u32 y = 0; y < numRows; ++y)
+			GetTexelRow((u64*)&pSwapped[bpl * y], pDest + ((_pTexture->width * y) << sizeShift),
+						_pTexture->width, clampSClamp, 0xFFFF, 0, _pTexture->palette);
+
+		Context::UpdateTextureDataParams params;
+		params.handle = _pTexture->name;
+		params.textureUnitIndex = textureIndices::Tex[0];
+		params.x = 0;
+		params.y = firstRow;
+		params.width = _pTexture->width;
+		params.height = numRows;
+		params.format = colorFormat::RGBA;
+		params.internalFormat = gfxContext.convertInternalTextureFormat(u32(glInternalFormat));
+		params.dataType = glType;
+		params.data = pDest;
+		gfxContext.update2DTexture(params);
+
+		band = lastBand + 1;
+	}
+
+	if (m_curUnpackAlignment > 1)
+		gfxContext.setTextureUnpackAlignment(m_curUnpackAlignment);
+
+	return bUploaded;
+}
+
 void TextureCache::_updateBackground()
 {
 	u32 numBytes = gSP.bgImage.width * gSP.bgImage.height << gSP.bgImage.size >> 1;
 	u32 crc;
 
-	crc = CRC_Calculate( 0xFFFFFFFF, &RDRAM[gSP.bgImage.address], numBytes );
+	const bool bBands = _useBackgroundBands();
+	if (bBands) {
+		const u32 bpl = gSP.bgImage.width << gSP.bgImage.size >> 1;
+		const u32 numBands = (gSP.bgImage.height + BgBandRows - 1) / BgBandRows;
+		m_bgBandCrcs.resize(numBands);
+		for (u32 band = 0; band < numBands; ++band) {
+			const u32 bandBytes = bpl * min(BgBandRows, u32(gSP.bgImage.height) - band * BgBandRows);
+			m_bgBandCrcs[band] = CRC_Calculate(0xFFFFFFFF, &RDRAM[gSP.bgImage.address + bpl * band * BgBandRows], bandBytes);
+		}
+		crc = CRC_Calculate(0xFFFFFFFF, m_bgBandCrcs.data(), numBands * sizeof(u32));
+	} else
+		crc = CRC_Calculate( 0xFFFFFFFF, &RDRAM[gSP.bgImage.address], numBytes );
 
+	u32 paletteCrc = 0;
+	bool bPaletteCrc = false;
 	if (gDP.otherMode.textureLUT != G_TT_NONE || gSP.bgImage.format == G_IM_FMT_CI) {
-		if (gSP.bgImage.size == G_IM_SIZ_4b)
+		if (gSP.bgImage.size == G_IM_SIZ_4b) {
 			crc = CRC_Calculate( crc, &gDP.paletteCRC16[gSP.bgImage.palette], 4 );
-		else if (gSP.bgImage.size == G_IM_SIZ_8b)
+			paletteCrc = gDP.paletteCRC16[gSP.bgImage.palette];
+			bPaletteCrc = true;
+		} else if (gSP.bgImage.size == G_IM_SIZ_8b) {
 			crc = CRC_Calculate( crc, &gDP.paletteCRC256, 4 );
+			paletteCrc = gDP.paletteCRC256;
+			bPaletteCrc = true;
+		}
 	}
 
 	u32 params[4] = {gSP.bgImage.width, gSP.bgImage.height, gSP.bgImage.format, gSP.bgImage.size};
@@ -1369,9 +1430,48 @@ void TextureCache::_updateBackground()
 
 		activateTexture(0, &currentTex);
 		m_hits++;
+		if (bBands)
+			m_bgBandHits += static_cast<u32>(m_bgBandCrcs.size());
 		return;
 	}
 
+	// Same image location and layout: reload only the bands which changed.
+	u32 bgKey = 0;
+	if (bBands) {
+		const u32 keyParams[6] = { gSP.bgImage.address, gSP.bgImage.width, gSP.bgImage.height,
+			gSP.bgImage.format, gSP.bgImage.size, paletteCrc };
+		bgKey = CRC_Calculate(0xFFFFFFFF, keyParams, sizeof(keyParams));
+		auto bgIter = m_backgrounds.find(bgKey);
+		if (bgIter != m_backgrounds.end()) {
+			BackgroundBands & bg = bgIter->second;
+			Texture_Locations::iterator bgLocation = m_lruTextureLocations.find(bg.crc);
+			if (bgLocation != m_lruTextureLocations.end() && bg.bandCrcs.size() == m_bgBandCrcs.size()) {
+				Textures::iterator iter = bgLocation->second;
+				CachedTexture & currentTex = *iter;
+				m_textures.splice(m_textures.begin(), m_textures, iter);
+				m_lruTextureLocations.erase(bgLocation);
+				currentTex.clampS = gSP.bgImage.clampS;
+				currentTex.clampT = gSP.bgImage.clampT;
+
+				if (!_updateBackgroundBands(&currentTex, bg.bandCrcs)) {
+					// Key the texture by the bands it holds, so the next update reloads the missing ones.
+					crc = CRC_Calculate(0xFFFFFFFF, m_bgBandCrcs.data(), static_cast<u32>(m_bgBandCrcs.size() * sizeof(u32)));
+					if (bPaletteCrc)
+						crc = CRC_Calculate(crc, &paletteCrc, 4);
+					crc = CRC_Calculate(crc, params, sizeof(u32)*4);
+				}
+				m_lruTextureLocations.insert(std::pair<u32, Textures::iterator>(crc, iter));
+				currentTex.crc = crc;
+				bg.crc = crc;
+				bg.bandCrcs.swap(m_bgBandCrcs);
+
+				activateTexture(0, &currentTex);
+				m_hits++;
+				return;
+			}
+		}
+	}
+
 	m_misses++;
 
 	CachedTexture * pCurrent = _addTexture(crc);
@@ -1407,9 +1507,19 @@ void TextureCache::_updateBackground()
 	pCurrent->offsetT = 0.0f;
 
 	_loadBackground(pCurrent);
+	m_cachedBytes += pCurrent->textureBytes;
 	activateTexture(0, pCurrent);
 
 	current[0] = pCurrent;
+
+	if (bBands) {
+		m_bgBandMisses += static_cast<u32>(m_bgBandCrcs.size());
+		if (m_backgrounds.size() >= MaxTxCacheSize)
+			m_backgrounds.clear();
+		BackgroundBands & bg = m_backgrounds[bgKey];
+		bg.crc = crc;
+		bg.bandCrcs = m_bgBandCrcs;
+	}
 }
 
 void TextureCache::_clear()
@@ -1419,12 +1529,89 @@ void TextureCache::_clear()
 	for (auto cur = m_textures.cbegin(); cur != m_textures.cend(); ++cur) {
 		gfxContext.deleteTexture(cur->name);
 	}
-	m_textures.clear();
+	m_freeTextures.splice(m_freeTextures.begin(), m_textures);
+	if (m_freeTextures.size() > MaxFreeTextures)
+		m_freeTextures.erase(std::next(m_freeTextures.begin(), MaxFreeTextures), m_freeTextures.end());
 	m_lruTextureLocations.clear();
+	m_backgrounds.clear();
+	m_cachedBytes = 0;
+}
+
+bool TextureCache::_isVolatile(u32 _key, u32 _crc)
+{
+	const u32 frame = dwnd().getBuffersSwapCount();
+	auto iter = m_volatileTiles.find(_key);
+	if (iter == m_volatileTiles.end()) {
+		if (m_volatileTiles.size() >= MaxTxCacheSize)
+			m_volatileTiles.clear();
+		m_volatileTiles.emplace(_key, VolatileTile{ _crc, frame });
+		return false;
+	}
+
+	// Streamed textures get new contents every frame or two.
+	VolatileTile & tile = iter->second;
+	const bool bVolatile = tile.crc != _crc && frame - tile.frame <= 1;
+	tile.crc = _crc;
+	tile.frame = frame;
+	return bVolatile;
+}
+
+bool TextureCache::_activateShaderTMEM(u32 _t, u32 _crc, u16 _width, u16 _height, u16 _clampWidth, u16 _clampHeight)
+{
+	const gDPTile * pTile = gSP.textureTile[_t];
+	const u32 decoder = TMEMTexture::getDecoder(gDP.otherMode.textureLUT, pTile->size, pTile->format);
+	if (decoder == tmemNone)
+		return false;
+
+	// The combiner decodes TMEM only where it would filter the texture itself.
+	if (gDP.otherMode.cycleType != G_CYC_COPY && (_t == 0 ? gDP.otherMode.bi_lerp0 : gDP.otherMode.bi_lerp1) == 0)
+		return false;
+	if (currentCombiner()->usesLOD())
+		return false;
+
+	// Hires textures, texture enhancement and depth texture loading need decoded texels.
+	if ((config.textureFilter.txHiresEnable != 0 && TFH.isInited()) ||
+		(config.textureFilter.txEnhancementMode | config.textureFilter.txFilterMode) != 0 ||
+		((config.generalEmulation.hacks & hack_LoadDepthTextures) != 0 && gDP.colorImage.address == gDP.depthImageAddress))
+		return false;
+
+	CachedTexture * pCurrent = &m_tmemTextures[_t];
+	pCurrent->crc = _crc;
+	pCurrent->address = gDP.loadInfo[pTile->tmem].texAddress;
+	pCurrent->format = pTile->format;
+	pCurrent->size = pTile->size;
+	pCurrent->width = _width;
+	pCurrent->height = _height;
+	pCurrent->clampWidth = _clampWidth;
+	pCurrent->clampHeight = _clampHeight;
+	pCurrent->palette = pTile->palette;
+	pCurrent->maskS = pTile->masks;
+	pCurrent->maskT = pTile->maskt;
+	pCurrent->mirrorS = pTile->mirrors;
+	pCurrent->mirrorT = pTile->mirrort;
+	pCurrent->clampS = pTile->clamps;
+	pCurrent->clampT = pTile->clampt;
+	pCurrent->line = pTile->line;
+	pCurrent->tMem = pTile->tmem;
+	pCurrent->frameBufferTexture = CachedTexture::fbNone;
+	pCurrent->scaleS = 1.0f / (pCurrent->maskS ? f32(pow2(pCurrent->width)) : f32(pCurrent->width));
+	pCurrent->scaleT = 1.0f / (pCurrent->maskT ? f32(pow2(pCurrent->height)) : f32(pCurrent->height));
+	pCurrent->offsetS = 0.0f;
+	pCurrent->offsetT = 0.0f;
+	pCurrent->tmemDecoder = u8(decoder);
+	pCurrent->tmemLine = decoder == tmemRGBA32 ? u16(_getLine32(_clampWidth, pTile->line)) : pTile->line;
+
+	if ((gDP.changed & CHANGED_TMEM) != 0)
+		g_tmemTexture.invalidate();
+	g_tmemTexture.update();
+	activateTexture(_t, pCurrent);
+	return true;
 }
 
 void TextureCache::update(u32 _t)
 {
+	DLC_PROFILE(stTextures);
+	TRACE_SCOPE("TextureCache::update");
 	const gDPTile * pTile = gSP.textureTile[_t];
 	switch (pTile->textureMode) {
 	case TEXTUREMODE_BGIMAGE:
@@ -1438,6 +1625,10 @@ void TextureCache::update(u32 _t)
 		return;
 	}
 
+	// Swap in textures enhanced by the deferred filter worker.
+	// Every path below re-activates texture unit _t, so uploading through it is safe.
+	_applyDeferredEnhancements(_t);
+
 	if (_t == 1 && needReplaceTex1ByTex0()) {
 		current[1] = current[0];
 		if (current[1] != nullptr) {
@@ -1473,8 +1664,12 @@ void TextureCache::update(u32 _t)
 	const u32 crc = _calculateCRC(_t, params, sizes.bytes);
 
 	if (current[_t] != nullptr && current[_t]->crc == crc) {
-		activateTexture(_t, current[_t]);
-		return;
+		if (current[_t]->tmemDecoder == tmemNone) {
+			activateTexture(_t, current[_t]);
+			return;
+		}
+		if (_activateShaderTMEM(_t, crc, sizes.width, sizes.height, sizes.clampWidth, sizes.clampHeight))
+			return;
 	}
 
 	Texture_Locations::iterator locations_iter = m_lruTextureLocations.find(crc);
@@ -1493,9 +1688,14 @@ void TextureCache::update(u32 _t)
 			return;
 		}
 
-		gfxContext.deleteTexture(currentTex.name);
-		m_lruTextureLocations.erase(locations_iter);
-		m_textures.erase(iter);
+		_removeTexture(iter);
+	}
+
+	if (!m_tmemTextures.empty()) {
+		const u32 key[4] = { gDP.loadInfo[pTile->tmem].texAddress, params.flags, (u32(params.height) << 16) | params.width, pTile->palette };
+		if (_isVolatile(CRC_Calculate(0xFFFFFFFF, key, sizeof(key)), crc) &&
+			_activateShaderTMEM(_t, crc, sizes.width, sizes.height, sizes.clampWidth, sizes.clampHeight))
+			return;
 	}
 
 	m_misses++;
@@ -1537,6 +1737,7 @@ void TextureCache::update(u32 _t)
 	pCurrent->offsetT = 0.0f;
 
 	_load(_t, pCurrent);
+	m_cachedBytes += pCurrent->textureBytes;
 	activateTexture( _t, pCurrent );
 
 	current[_t] = pCurrent;
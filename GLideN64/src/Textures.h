@@ -4,14 +4,19 @@
 #include <array>
 #include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "CRC.h"
 #include "convert.h"
 #include "Graphics/ObjectHandle.h"
 #include "Graphics/Parameter.h"
+#include "Graphics/PixelBuffer.h"
 
-typedef u32 (*GetTexelFunc)( u64 *src, u16 x, u16 i, u8 palette );
+typedef void (*GetTexelRowFunc)( u64 *src, void *dst, u16 width, u16 clampSClamp, u16 maskSMask, u16 i, u8 palette );
+
+struct GHQTexInfo;
 
 struct CachedTexture
 {
@@ -34,7 +39,7 @@ struct CachedTexture
 	u16		clampWidth, clampHeight;  // Size to clamp to
 	f32		scaleS, scaleT;			  // Scale to map to 0.0-1.0
 	f32		shiftScaleS, shiftScaleT; // Scale to shift
-	u32		textureBytes;
+	u32		textureBytes = 0;		  // GPU memory used, including mip levels
 
 	u32		address;
 	u8		max_level;
@@ -44,6 +49,8 @@ struct CachedTexture
 		fbMultiSample = 2
 	} frameBufferTexture;
 	bool bHDTexture;
+	u8		tmemDecoder = 0;		  // Non zero if the combiner decodes the tile from TMEM, see TMEMDecoder
+	u16		tmemLine = 0;			  // TMEM line used by the combiner decoder
 };
 
 
@@ -60,6 +67,17 @@ struct TextureCache
 	void activateMSDummy(u32 _t);
 	void update(u32 _t);
 
+	struct Stats {
+		u32 hits = 0;
+		u32 misses = 0;
+		u32 evictions = 0;
+		u32 bgBandHits = 0;
+		u32 bgBandMisses = 0;
+		u32 textures = 0;
+		size_t bytes = 0;
+	};
+	Stats getStats() const;
+
 	static TextureCache & get();
 
 private:
@@ -68,6 +86,10 @@ private:
 		, m_pMSDummy(nullptr)
 		, m_hits(0)
 		, m_misses(0)
+		, m_evictions(0)
+		, m_bgBandHits(0)
+		, m_bgBandMisses(0)
+		, m_cachedBytes(0)
 		, m_curUnpackAlignment(4)
 		, m_toggleDumpTex(false)
 	{
@@ -79,27 +101,61 @@ private:
 
 	void _checkCacheSize();
 	CachedTexture * _addTexture(u32 _crc32);
+	void _removeTexture(std::list<CachedTexture>::iterator _iter);
 	void _load(u32 _tile, CachedTexture *_pTexture);
+	void _loadEnhancedTexture(u32 _tile, GHQTexInfo & _info, CachedTexture *_pTexture, u16 _widthOrg, u16 _heightOrg);
+	void _applyDeferredEnhancements(u32 _tile);
 	bool _loadHiresTexture(u32 _tile, CachedTexture *_pTexture, u64 & _ricecrc);
 	void _loadBackground(CachedTexture *pTexture);
 	bool _loadHiresBackground(CachedTexture *_pTexture, u64 & _ricecrc);
 	void _loadDepthTexture(CachedTexture * _pTexture, u16* _pDest);
 	void _updateBackground();
+	bool _useBackgroundBands() const;
+	bool _updateBackgroundBands(CachedTexture * _pTexture, const std::vector<u32> & _oldCrcs);
 	void _clear();
 	void _initDummyTexture(CachedTexture * _pDummy);
-	void _getTextureDestData(CachedTexture& tmptex, u32* pDest, graphics::Parameter glInternalFormat, GetTexelFunc GetTexel, u16* pLine);
+	void _getTextureDestData(CachedTexture& tmptex, u32* pDest, graphics::Parameter glInternalFormat, GetTexelRowFunc GetTexelRow, u16* pLine);
+	u8 * _getStagingBuffer(u32 _slot, u32 _bytes);
+	u8 * _getUploadBuffer(u32 _bytes);
+	bool _isVolatile(u32 _key, u32 _crc);
+	bool _activateShaderTMEM(u32 _t, u32 _crc, u16 _width, u16 _height, u16 _clampWidth, u16 _clampHeight);
 
 	typedef std::list<CachedTexture> Textures;
 	typedef std::unordered_map<u32, Textures::iterator> Texture_Locations;
 	typedef std::unordered_map<u32, CachedTexture> FBTextures;
 	Textures m_textures;
+	// Nodes of removed textures, reused by _addTexture to avoid allocation per texture.
+	// Holds at most MaxFreeTextures nodes, enough for the textures loaded between evictions.
+	static const size_t MaxFreeTextures = 64;
+	Textures m_freeTextures;
 	Texture_Locations m_lruTextureLocations;
 	FBTextures m_fbTextures;
 	CachedTexture * m_pDummy;
 	CachedTexture * m_pMSDummy;
-	u32 m_hits, m_misses;
+	u32 m_hits, m_misses, m_evictions;
+	u32 m_bgBandHits, m_bgBandMisses;
+	size_t m_cachedBytes;
 	s32 m_curUnpackAlignment;
 	bool m_toggleDumpTex;
+	// Decode buffers reused between texture loads. u64 elements keep them aligned for TMEM reads.
+	std::array<std::vector<u64>, 2> m_stagingBuffers;
+	// Persistently mapped ring texels are decoded into when they can go to GPU without further processing.
+	std::unique_ptr<graphics::PixelWriteBuffer> m_pUploadBuffer;
+	// Textures of tiles decoded by the combiner. They are bound to the dummy texture name.
+	std::vector<CachedTexture> m_tmemTextures;
+	// Last crc and frame of the tiles loaded from each RDRAM location, to find tiles which change every frame.
+	struct VolatileTile {
+		u32 crc;
+		u32 frame;
+	};
+	std::unordered_map<u32, VolatileTile> m_volatileTiles;
+	// Background images are hashed in bands of rows, so a partially changed image reloads only the changed bands.
+	struct BackgroundBands {
+		u32 crc;
+		std::vector<u32> bandCrcs;
+	};
+	std::unordered_map<u32, BackgroundBands> m_backgrounds;
+	std::vector<u32> m_bgBandCrcs;
 };
 
 void getTextureShiftScale(u32 tile, const TextureCache & cache, f32 & shiftScaleS, f32 & shiftScaleT);
@@ -46,3 +46,11 @@ txfilter_reloadhirestex()
 TAPI void TAPIENTRY
 txfilter_dumpcache(void)
 {}
+
+TAPI void TAPIENTRY
+txfilter_lock(void)
+{}
+
+TAPI void TAPIENTRY
+txfilter_unlock(void)
+{}
@@ -12,6 +12,7 @@
 #include "Config.h"
 #include "Debugger.h"
 #include "DisplayWindow.h"
+#include "BufferCopy/ReadbackWorker.h"
 #include <Graphics/Context.h>
 
 using namespace std;
@@ -181,4 +182,6 @@ void VI_UpdateScreen()
 	if (VI.lastOrigin == -1) { // Workaround for Mupen64Plus issue with initialization
 		gfxContext.clearColorBuffer(0.0f, 0.0f, 0.0f, 0.0f);
 	}
+
+	ReadbackWorker::get().finish();
 }
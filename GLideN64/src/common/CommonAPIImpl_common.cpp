@@ -18,6 +18,7 @@
 #include <Log.h>
 #include "Graphics/Context.h"
 #include <DisplayWindow.h>
+#include <DisplayListCapture.h>
 
 PluginAPI & PluginAPI::get()
 {
@@ -153,6 +154,7 @@ private:
 void PluginAPI::ProcessDList()
 {
 	LOG(LOG_APIFUNC, "ProcessDList");
+	dlCapture().onProcessDList();
 #ifdef RSPTHREAD
 	_callAPICommand(ProcessDListCommand());
 #else
@@ -178,6 +180,7 @@ void PluginAPI::RomClosed()
 	m_bRomOpen = false;
 
 	LOG(LOG_APIFUNC, "RomClosed");
+	dlCapture().stop();
 #ifdef RSPTHREAD
 	_callAPICommand(RomClosedCommand(
 					&m_rspThreadMtx,
@@ -208,8 +211,18 @@ int PluginAPI::RomOpen()
 	Config_LoadConfig();
 	if (!dwnd().start())
 		return 0;
+	if (dlCapture().replayConfigured()) {
+		// Start the game from a clean plugin state.
+		dwnd().stop();
+		GBI.destroy();
+		RSP_Init();
+		GBI.init();
+		if (!dwnd().start())
+			return 0;
+	}
 #endif
 	m_bRomOpen = true;
+	dlCapture().start();
 
 	return 1;
 }
@@ -222,6 +235,7 @@ void PluginAPI::ShowCFB()
 void PluginAPI::UpdateScreen()
 {
 	LOG(LOG_APIFUNC, "UpdateScreen");
+	dlCapture().onUpdateScreen();
 #ifdef RSPTHREAD
 	_callAPICommand(ProcessUpdateScreenCommand());
 #else
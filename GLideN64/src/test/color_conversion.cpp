@@ -0,0 +1,226 @@
+// RDRAM color conversion benchmark
+//
+// Copies the same color buffers between RDRAM and ABGR32 pixels with the
+// scalar loops the buffer copiers used before, and with the run converters
+// from BufferCopy/ColorConverters.h. Fails if any output differs, then prints
+// the time of both per conversion.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "BufferCopy/ColorConverters.h"
+#include "BufferCopy/WriteToRDRAM.h"
+
+u8 *RDRAM = nullptr;
+u32 RDRAMSize = 0;
+
+static const u32 RDRAM_SIZE = 0x200000;
+static const u32 NUM_CASES = 3000;
+static const u32 NUM_PASSES = 200;
+static const u32 BENCH_WIDTH = 320;
+static const u32 BENCH_HEIGHT = 240;
+
+static u32 seed = 0x13579BDF;
+
+static
+u32 nextRandom()
+{
+	seed = seed * 1664525U + 1013904223U;
+	return seed >> 8;
+}
+
+// Colors with a share of zero pixels, which the RDRAM writers skip
+static
+void fillColors(u32 * _data, u32 _count)
+{
+	for (u32 i = 0; i < _count; ++i)
+		_data[i] = (nextRandom() & 3) == 0 ? 0 : (nextRandom() << 8) ^ nextRandom();
+}
+
+// _copyBufferFromRdram of RDRAMtoColorBuffer.cpp before run converters
+template <typename TSrc>
+bool copyBufferReference(u32 _address, u32* _dst, u32(*converter)(TSrc _c, bool _bCFB), u32 _xor, u32 _x0, u32 _y0, u32 _width, u32 _height, bool _fullAlpha)
+{
+	TSrc * src = reinterpret_cast<TSrc*>(RDRAM + _address);
+	const u32 bound = (RDRAMSize + 1 - _address) >> (sizeof(TSrc) / 2);
+	TSrc col;
+	u32 idx;
+	u32 summ = 0;
+	u32 dsty = 0;
+	const u32 y1 = _y0 + _height;
+	for (u32 y = _y0; y < y1; ++y) {
+		for (u32 x = _x0; x < _width; ++x) {
+			idx = (x + y *_width) ^ _xor;
+			if (idx >= bound)
+				break;
+			col = src[idx];
+			summ += col;
+			_dst[x + dsty*_width] = converter(col, _fullAlpha);
+		}
+		++dsty;
+	}
+
+	return summ != 0;
+}
+
+// Same as ColorBufferToRDRAM::_RGBAtoRGBA16
+static
+u16 RGBAtoRGBA16(u32 _c)
+{
+	const u32 r = _c & 0xFF, g = (_c >> 8) & 0xFF, b = (_c >> 16) & 0xFF, a = _c >> 24;
+	return static_cast<u16>(((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | (a == 0 ? 0 : 1));
+}
+
+// Same as ColorBufferToRDRAM::_RGBAtoRGBA32
+static
+u32 RGBAtoRGBA32(u32 _c)
+{
+	const u32 r = _c & 0xFF, g = (_c >> 8) & 0xFF, b = (_c >> 16) & 0xFF, a = _c >> 24;
+	return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static
+long long toMicroseconds(Clock::duration _d)
+{
+	return (long long)std::chrono::duration_cast<std::chrono::microseconds>(_d).count();
+}
+
+template <typename TSrc>
+bool checkFromRdram(const char * _name, u32(*converter)(TSrc _c, bool _bCFB),
+	u32(*runConverter)(const TSrc * _src, u32 * _dst, u32 _count, bool _fullAlpha, u32 & _summ), u32 _xor)
+{
+	std::vector<u32> refOut, newOut;
+	for (u32 n = 0; n < NUM_CASES; ++n) {
+		const u32 width = 1 + nextRandom() % 640;
+		const u32 height = 1 + nextRandom() % 64;
+		const u32 size = width * height * sizeof(TSrc);
+		u32 address;
+		switch (nextRandom() % 4) {
+		case 0: // cut by the end of RDRAM
+			address = (RDRAM_SIZE - nextRandom() % std::min(size + 64, RDRAM_SIZE)) & ~7U;
+			break;
+		case 1: // not 8-byte aligned
+			address = (nextRandom() % (RDRAM_SIZE - size)) & ~(u32)(sizeof(TSrc) - 1);
+			break;
+		default:
+			address = (nextRandom() % (RDRAM_SIZE - size)) & ~7U;
+			break;
+		}
+		const bool fullAlpha = (nextRandom() & 1) != 0;
+		const bool blank = nextRandom() % 16 == 0;
+
+		std::vector<u8> saved;
+		if (blank) {
+			const u32 end = std::min(address + size + 8, RDRAM_SIZE);
+			saved.assign(RDRAM + address, RDRAM + end);
+			std::fill(RDRAM + address, RDRAM + end, 0);
+		}
+
+		refOut.assign(width * height, 0xDEADBEEF);
+		newOut.assign(width * height, 0xDEADBEEF);
+		const bool refCopy = copyBufferReference<TSrc>(address, refOut.data(), converter, _xor, 0, 0, width, height, fullAlpha);
+		const bool newCopy = _copyBufferFromRdram<TSrc>(address, newOut.data(), converter, runConverter, _xor, 0, 0, width, height, fullAlpha);
+		if (refOut != newOut || refCopy != newCopy) {
+			printf("%s: buffer at %08x of %ux%u differs\n", _name, address, width, height);
+			return false;
+		}
+
+		if (blank)
+			std::copy(saved.begin(), saved.end(), RDRAM + address);
+	}
+
+	const u32 address = 0x100000;
+	refOut.resize(BENCH_WIDTH * BENCH_HEIGHT);
+	newOut.resize(BENCH_WIDTH * BENCH_HEIGHT);
+	volatile bool sink = false;
+
+	Clock::time_point start = Clock::now();
+	for (u32 pass = 0; pass < NUM_PASSES; ++pass)
+		sink = copyBufferReference<TSrc>(address, refOut.data(), converter, _xor, 0, 0, BENCH_WIDTH, BENCH_HEIGHT, true);
+	const Clock::duration refTime = Clock::now() - start;
+
+	start = Clock::now();
+	for (u32 pass = 0; pass < NUM_PASSES; ++pass)
+		sink = _copyBufferFromRdram<TSrc>(address, newOut.data(), converter, runConverter, _xor, 0, 0, BENCH_WIDTH, BENCH_HEIGHT, true);
+	const Clock::duration newTime = Clock::now() - start;
+	(void)sink;
+
+	printf("%-24s reference %7lld us, run converter %7lld us\n", _name, toMicroseconds(refTime), toMicroseconds(newTime));
+	return true;
+}
+
+template <typename TDst>
+bool checkToRdram(const char * _name, TDst(*converter)(u32 _c), u32(*runConverter)(const u32 * _src, TDst * _dst, u32 _count), u32 _xor)
+{
+	const u32 size = sizeof(TDst) == 2 ? 2 : 3;
+	std::vector<u32> src;
+	std::vector<TDst> refOut, newOut;
+	for (u32 n = 0; n < NUM_CASES; ++n) {
+		const u32 width = 1 + nextRandom() % 640;
+		const u32 height = 1 + nextRandom() % 64;
+		// Copies may start in the middle of a row, and end anywhere after it
+		const u32 chunkStart = (nextRandom() & 1) != 0 ? nextRandom() % width : 0;
+		const u32 numPixels = 1 + nextRandom() % (width * height - chunkStart);
+		const u32 bufferAddress = 0x100000;
+		const u32 startAddress = bufferAddress + ((nextRandom() % 16 * width + chunkStart) << (size - 1));
+
+		src.resize(width * height);
+		fillColors(src.data(), width * height);
+		// One element of slack on both sides, for the odd chunk start and the halfword swap
+		refOut.resize(numPixels + 2);
+		for (TDst & c : refOut)
+			c = static_cast<TDst>(nextRandom());
+		newOut = refOut;
+
+		writeToRdram<u32, TDst>(src.data(), refOut.data() + 1, converter, 0, _xor, width, height, numPixels, startAddress, bufferAddress, size);
+		writeToRdram<u32, TDst>(src.data(), newOut.data() + 1, converter, 0, _xor, width, height, numPixels, startAddress, bufferAddress, size, runConverter);
+		if (refOut != newOut) {
+			printf("%s: %u pixels of %ux%u from x %u differ\n", _name, numPixels, width, height, chunkStart);
+			return false;
+		}
+	}
+
+	const u32 numPixels = BENCH_WIDTH * BENCH_HEIGHT;
+	src.resize(numPixels);
+	fillColors(src.data(), numPixels);
+	refOut.resize(numPixels);
+	newOut.resize(numPixels);
+
+	Clock::time_point start = Clock::now();
+	for (u32 pass = 0; pass < NUM_PASSES; ++pass)
+		writeToRdram<u32, TDst>(src.data(), refOut.data(), converter, 0, _xor, BENCH_WIDTH, BENCH_HEIGHT, numPixels, 0, 0, size);
+	const Clock::duration refTime = Clock::now() - start;
+
+	start = Clock::now();
+	for (u32 pass = 0; pass < NUM_PASSES; ++pass)
+		writeToRdram<u32, TDst>(src.data(), newOut.data(), converter, 0, _xor, BENCH_WIDTH, BENCH_HEIGHT, numPixels, 0, 0, size, runConverter);
+	const Clock::duration newTime = Clock::now() - start;
+
+	if (refOut != newOut) {
+		printf("%s: benchmark output differs\n", _name);
+		return false;
+	}
+
+	printf("%-24s reference %7lld us, run converter %7lld us\n", _name, toMicroseconds(refTime), toMicroseconds(newTime));
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<u32> rdram(RDRAM_SIZE / 4);
+	fillColors(rdram.data(), RDRAM_SIZE / 4);
+	RDRAM = reinterpret_cast<u8*>(rdram.data());
+	RDRAMSize = RDRAM_SIZE - 1;
+
+	if (!checkFromRdram<u16>("RGBA16ToABGR32", RGBA16ToABGR32, RGBA16ToABGR32Run, 1) ||
+		!checkFromRdram<u32>("RGBA32ToABGR32", RGBA32ToABGR32, RGBA32ToABGR32Run, 0) ||
+		!checkToRdram<u16>("RGBAtoRGBA16", RGBAtoRGBA16, RGBAtoRGBA16Run, 1) ||
+		!checkToRdram<u32>("RGBAtoRGBA32", RGBAtoRGBA32, RGBAtoRGBA32Run, 0))
+		return 1;
+
+	printf("all conversions identical\n");
+	return 0;
+}
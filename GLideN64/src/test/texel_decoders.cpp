@@ -0,0 +1,191 @@
+// TMEM texel decoder benchmark
+//
+// Decodes the same TMEM rows with the per-texel loop the texture cache used
+// before row decoders, and with the GetTexelRow instances from TexelDecoders.h.
+// Fails if any output differs, then prints the time of both per format.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "TexelDecoders.h"
+
+u64 TMEM[512];
+
+typedef void (*GetTexelRowFunc)(u64 *src, void *dst, u16 width, u16 clampSClamp, u16 maskSMask, u16 i, u8 palette);
+
+struct Format
+{
+	const char * name;
+	GetTexelFunc GetTexel;
+	GetTexelRowFunc GetRow16;
+	GetTexelRowFunc GetRow32;
+};
+
+#define FORMAT(GetTexel) { #GetTexel, GetTexel, GetTexelRow<GetTexel, u16>, GetTexelRow<GetTexel, u32> }
+
+static const Format formats[] = {
+	FORMAT(GetCI4_RGBA4444),
+	FORMAT(GetCI4_RGBA8888),
+	FORMAT(GetCI4IA_RGBA8888),
+	FORMAT(GetCI4RGBA_RGBA5551),
+	FORMAT(GetCI4RGBA_RGBA8888),
+	FORMAT(GetIA31_RGBA8888),
+	FORMAT(GetI4_RGBA8888),
+	FORMAT(GetI4_RGBA4444),
+	FORMAT(GetCI8IA_RGBA8888),
+	FORMAT(GetCI8RGBA_RGBA5551),
+	FORMAT(GetCI8RGBA_RGBA8888),
+	FORMAT(GetIA44_RGBA8888),
+	FORMAT(GetI8_RGBA8888),
+	FORMAT(GetI8_RGBA4444),
+	FORMAT(GetCI16IA_RGBA8888),
+	FORMAT(GetCI16RGBA_RGBA5551),
+	FORMAT(GetRGBA5551_RGBA8888),
+	FORMAT(GetRGBA5551_RGBA5551),
+	FORMAT(GetIA88_RGBA8888),
+	FORMAT(GetIA88_RGBA4444),
+	FORMAT(GetRGBA8888_RGBA8888),
+	FORMAT(GetRGBA8888_RGBA4444),
+};
+
+struct Row
+{
+	u32 tmemOffset;
+	u16 width;
+	u16 clampSClamp;
+	u16 maskSMask;
+	u16 i;
+	u8 palette;
+};
+
+static const u32 NUM_ROWS = 4096;
+static const u32 NUM_PASSES = 20;
+static const u16 MAX_WIDTH = 256;
+
+static u32 seed = 0x2468ACE1;
+
+static
+u32 nextRandom()
+{
+	seed = seed * 1664525U + 1013904223U;
+	return seed >> 8;
+}
+
+// The loop of TextureCache::_getTextureDestData before row decoders:
+// one indirect call and one format test per texel.
+static
+void decodeReference(const Format & _format, bool _rgba8, const Row & _row, void * _dst)
+{
+	u64 * pSrc = &TMEM[_row.tmemOffset];
+	u32 * pDest = static_cast<u32*>(_dst);
+	const u32 rgba8 = _rgba8 ? 1 : 0;
+	GetTexelFunc GetTexel = _format.GetTexel;
+	for (u16 x = 0; x < _row.width; ++x) {
+		const u16 tx = std::min(x, _row.clampSClamp) & _row.maskSMask;
+		if (rgba8 != 0)
+			pDest[x] = GetTexel(pSrc, tx, _row.i, _row.palette);
+		else
+			((u16*)pDest)[x] = GetTexel(pSrc, tx, _row.i, _row.palette);
+	}
+}
+
+static
+void decodeRow(const Format & _format, bool _rgba8, const Row & _row, void * _dst)
+{
+	GetTexelRowFunc GetRow = _rgba8 ? _format.GetRow32 : _format.GetRow16;
+	GetRow(&TMEM[_row.tmemOffset], _dst, _row.width, _row.clampSClamp, _row.maskSMask, _row.i, _row.palette);
+}
+
+static
+Row makeRow()
+{
+	Row row;
+	// Rows of up to 256 32-bit texels starting in the lower half of TMEM
+	row.tmemOffset = nextRandom() % 128;
+	row.width = static_cast<u16>(1 + nextRandom() % MAX_WIDTH);
+	row.i = (nextRandom() & 1) << 1;
+	row.palette = static_cast<u8>(nextRandom() & 15);
+	switch (nextRandom() % 4) {
+	case 0: // no clamp, no mask
+		row.clampSClamp = row.width - 1;
+		row.maskSMask = 0xFFFF;
+		break;
+	case 1: // clamped
+		row.clampSClamp = static_cast<u16>(nextRandom() % row.width);
+		row.maskSMask = 0xFFFF;
+		break;
+	case 2: // masked
+		row.clampSClamp = row.width - 1;
+		row.maskSMask = static_cast<u16>((1 << (nextRandom() % 9)) - 1);
+		break;
+	default: // mirrored, the mask is twice the width
+		row.clampSClamp = static_cast<u16>((row.width << 1) - 1);
+		row.maskSMask = static_cast<u16>((1 << (nextRandom() % 9)) - 1);
+		break;
+	}
+	return row;
+}
+
+int main(int argc, char** argv)
+{
+	for (u32 i = 0; i < 512; ++i)
+		TMEM[i] = (u64(nextRandom()) << 40) ^ (u64(nextRandom()) << 16) ^ nextRandom();
+
+	std::vector<Row> rows(NUM_ROWS);
+	for (Row & row : rows)
+		row = makeRow();
+
+	std::vector<u32> refOut(MAX_WIDTH + 8);
+	std::vector<u32> newOut(MAX_WIDTH + 8);
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::duration refTotal(0), newTotal(0);
+	volatile u32 sink = 0;
+
+	for (const Format & format : formats) {
+		for (int rgba8 = 0; rgba8 < 2; ++rgba8) {
+			// Equality
+			for (const Row & row : rows) {
+				std::fill(refOut.begin(), refOut.end(), 0xDEADBEEF);
+				std::fill(newOut.begin(), newOut.end(), 0xDEADBEEF);
+				decodeReference(format, rgba8 != 0, row, refOut.data());
+				decodeRow(format, rgba8 != 0, row, newOut.data());
+				if (refOut != newOut) {
+					printf("%s (%s): row of width %u, clamp %u, mask %x, i %u differs\n",
+						format.name, rgba8 != 0 ? "RGBA8" : "16 bit",
+						row.width, row.clampSClamp, row.maskSMask, row.i);
+					return 1;
+				}
+			}
+
+			// Throughput
+			Clock::time_point start = Clock::now();
+			for (u32 pass = 0; pass < NUM_PASSES; ++pass) {
+				for (const Row & row : rows)
+					decodeReference(format, rgba8 != 0, row, refOut.data());
+				sink = sink + refOut[0];
+			}
+			const Clock::duration refTime = Clock::now() - start;
+
+			start = Clock::now();
+			for (u32 pass = 0; pass < NUM_PASSES; ++pass) {
+				for (const Row & row : rows)
+					decodeRow(format, rgba8 != 0, row, newOut.data());
+				sink = sink + newOut[0];
+			}
+			const Clock::duration newTime = Clock::now() - start;
+
+			refTotal += refTime;
+			newTotal += newTime;
+			printf("%-24s %-6s reference %7lld us, row decoder %7lld us\n",
+				format.name, rgba8 != 0 ? "RGBA8" : "16 bit",
+				(long long)std::chrono::duration_cast<std::chrono::microseconds>(refTime).count(),
+				(long long)std::chrono::duration_cast<std::chrono::microseconds>(newTime).count());
+		}
+	}
+
+	printf("all formats identical; total reference %lld us, row decoder %lld us\n",
+		(long long)std::chrono::duration_cast<std::chrono::microseconds>(refTotal).count(),
+		(long long)std::chrono::duration_cast<std::chrono::microseconds>(newTotal).count());
+	return 0;
+}
@@ -13,6 +13,7 @@ char customini[] =
 "[BIOFREAKS]\n"
 "Good_Name=Bio F.R.E.A.K.S. (E)(U)\n"
 "frameBufferEmulation\\copyToRDRAM=1\n"
+"frameBufferEmulation\\readbackLatency=0\n"
 "\n"
 "[52150A67]\n"
 "Good_Name=Bokujou Monogatari 2 (J)\n"
@@ -28,6 +29,7 @@ char customini[] =
 "[CASTLEVANIA2]\n"
 "Good_Name=Castlevania - Legacy Of Darkness (E)(U)\n"
 "frameBufferEmulation\\copyToRDRAM=1\n"
+"frameBufferEmulation\\readbackLatency=0\n"
 "\n"
 "[DMPJ]\n"
 "Good_Name=Mario Paint Studio (64dd disk)\n"
@@ -167,6 +169,7 @@ char customini[] =
 "Good_Name=Pokemon Snap (U)\n"
 "frameBufferEmulation\\copyAuxToRDRAM=1\n"
 "frameBufferEmulation\\copyToRDRAM=1\n"
+"frameBufferEmulation\\readbackLatency=0\n"
 "\n"
 "[POKEMON%20STADIUM%202]\n"
 "Good_Name=Pokemon Stadium 2 (E)(F)(G)(I)(J)(S)(U)\n"
@@ -45,18 +45,25 @@ extern uint32_t enableNativeResTexrects;
 extern uint32_t enableLegacyBlending;
 extern uint32_t EnableCopyColorToRDRAM;
 extern uint32_t EnableCopyDepthToRDRAM;
+extern uint32_t ReadbackLatency;
 extern uint32_t AspectRatio;
 extern uint32_t MaxTxCacheSize;
+extern uint32_t TxCacheBudget;
 extern uint32_t txFilterMode;
 extern uint32_t txEnhancementMode;
 extern uint32_t txHiresEnable;
 extern uint32_t txHiresFullAlphaChannel;
 extern uint32_t txFilterIgnoreBG;
+extern uint32_t txDeferredEnhancement;
 extern uint32_t EnableFXAA;
 extern uint32_t MultiSampling;
 extern uint32_t EnableFragmentDepthWrite;
 extern uint32_t EnableShadersStorage;
+extern uint32_t EnableDrawMerging;
+extern uint32_t EnableTexrectBatching;
+extern uint32_t EnableShaderTMEM;
 extern uint32_t EnableTextureCache;
+extern uint32_t DListCaptureMode;
 extern uint32_t EnableFBEmulation;
 extern uint32_t EnableFrameDuping;
 extern uint32_t EnableNoiseEmulation;
@@ -69,6 +76,9 @@ extern uint32_t EnableEnhancedTextureStorage;
 extern uint32_t EnableEnhancedHighResStorage;
 extern uint32_t EnableTxCacheCompression;
 extern uint32_t ForceDisableExtraMem;
+extern uint32_t EnableDynarecFastmem;
+extern uint32_t DynarecPerfMode;
+extern uint32_t EnableIdleLoopSkip;
 extern uint32_t EnableNativeResFactor;
 extern uint32_t EnableN64DepthCompare;
 
@@ -13,6 +13,7 @@
 #include "../Log.h"
 extern "C" {
 #include "main/util.h"
+const char* retro_get_system_directory(void);
 }
 
 Config config;
@@ -68,6 +69,8 @@ void LoadCustomSettings(void)
 						config.frameBufferEmulation.copyFromRDRAM = atoi(l.value);
 					else if (!strcmp(l.name, "frameBufferEmulation\\copyDepthToRDRAM"))
 						config.frameBufferEmulation.copyDepthToRDRAM = atoi(l.value);
+					else if (!strcmp(l.name, "frameBufferEmulation\\readbackLatency"))
+						config.frameBufferEmulation.readbackLatency = atoi(l.value);
 					else if (!strcmp(l.name, "frameBufferEmulation\\copyAuxToRDRAM"))
 						config.frameBufferEmulation.copyAuxToRDRAM = atoi(l.value);
 					else if (!strcmp(l.name, "frameBufferEmulation\\N64DepthCompare"))
@@ -103,12 +106,14 @@ extern "C" void Config_LoadConfig()
 	config.frameBufferEmulation.N64DepthCompare = EnableN64DepthCompare;
 
 	config.texture.bilinearMode = bilinearMode;
+	config.texture.enableShaderTMEM = EnableShaderTMEM;
 	config.generalEmulation.enableHWLighting = EnableHWLighting;
 	config.generalEmulation.enableLegacyBlending = enableLegacyBlending;
 	config.generalEmulation.enableNoise = EnableNoiseEmulation;
 	config.generalEmulation.enableLOD = EnableLODEmulation;
 
 	config.frameBufferEmulation.copyDepthToRDRAM = EnableCopyDepthToRDRAM;
+	config.frameBufferEmulation.readbackLatency = ReadbackLatency;
 #if defined(GLES2) && !defined(ANDROID)
 	config.frameBufferEmulation.copyToRDRAM = Config::ctDisable;
 #else
@@ -128,10 +133,13 @@ extern "C" void Config_LoadConfig()
 #else
 	config.generalEmulation.enableShadersStorage = EnableShadersStorage;
 #endif
+	config.generalEmulation.enableDrawMerging = EnableDrawMerging;
+	config.generalEmulation.enableTexrectBatching = EnableTexrectBatching;
 
 	config.textureFilter.txFilterMode = txFilterMode;
 	config.textureFilter.txEnhancementMode = txEnhancementMode;
 	config.textureFilter.txFilterIgnoreBG = txFilterIgnoreBG;
+	config.textureFilter.txDeferredEnhancement = txDeferredEnhancement;
 	config.textureFilter.txHiresEnable = txHiresEnable;
 	config.textureFilter.txHiresFullAlphaChannel = txHiresFullAlphaChannel;
 	config.video.fxaa = EnableFXAA;
@@ -143,6 +151,14 @@ extern "C" void Config_LoadConfig()
 
 	config.frameBufferEmulation.nativeResFactor = EnableNativeResFactor;
 
+	if (DListCaptureMode != 0) {
+		const std::string path = std::string(retro_get_system_directory()) + "/" + RSP.romname + ".gldc";
+		if (DListCaptureMode == 1)
+			config.debug.dlistCapturePath = path;
+		else
+			config.debug.dlistReplayPath = path;
+	}
+
 	config.generalEmulation.hacks = hacks;
 	LoadCustomSettings();
 }
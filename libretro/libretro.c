@@ -29,6 +29,7 @@
 #include "mupen64plus-next_common.h"
 
 #include <libco.h>
+#include <retro_miscellaneous.h>
 
 #ifdef HAVE_LIBNX
 #include <switch.h>
@@ -46,6 +47,7 @@
 #include "main/version.h"
 #include "main/util.h"
 #include "main/savestates.h"
+#include "main/trace.h"
 #include "api/m64p_config.h"
 #include "main/rom.h"
 #include "plugin/plugin.h"
@@ -86,6 +88,7 @@ save_memory_data saved_memory;
 
 static cothread_t game_thread;
 cothread_t retro_thread;
+static int game_thread_trace_track = -1;
 
 int r_cbutton = RETRO_DEVICE_ID_JOYPAD_A;
 int l_cbutton = RETRO_DEVICE_ID_JOYPAD_Y;
@@ -114,18 +117,25 @@ uint32_t enableNativeResTexrects = 0;
 uint32_t enableLegacyBlending = 0;
 uint32_t EnableCopyColorToRDRAM = 0;
 uint32_t EnableCopyDepthToRDRAM = 0;
+uint32_t ReadbackLatency = 0;
 uint32_t AspectRatio = 0;
 uint32_t MaxTxCacheSize = 4000;
+uint32_t TxCacheBudget = 0;
 uint32_t txFilterMode = 0;
 uint32_t txEnhancementMode = 0;
 uint32_t txHiresEnable = 0;
 uint32_t txHiresFullAlphaChannel = 0;
 uint32_t txFilterIgnoreBG = 0;
+uint32_t txDeferredEnhancement = 0;
 uint32_t EnableFXAA = 0;
 uint32_t MultiSampling = 0;
 uint32_t EnableFragmentDepthWrite = 1;
 uint32_t EnableShadersStorage = 0;
+uint32_t EnableDrawMerging = 0;
+uint32_t EnableTexrectBatching = 0;
+uint32_t EnableShaderTMEM = 0;
 uint32_t EnableTextureCache = 0;
+uint32_t DListCaptureMode = 0; // 0 is off, 1 captures, 2 replays
 uint32_t EnableFBEmulation = 1;
 uint32_t EnableFrameDuping = 1;
 uint32_t EnableNoiseEmulation = 1;
@@ -137,6 +147,9 @@ uint32_t BackgroundMode = 0; // 0 is bgOnePiece
 uint32_t EnableEnhancedTextureStorage;
 uint32_t EnableEnhancedHighResStorage;
 uint32_t ForceDisableExtraMem = 0;
+uint32_t EnableDynarecFastmem = 0;
+uint32_t DynarecPerfMode = 0;
+uint32_t EnableIdleLoopSkip = 0;
 uint32_t EnableNativeResFactor = 0;
 
 /* FIXME: Unset option. */
@@ -201,6 +214,16 @@ static void setup_variables(void)
 #else
             "CPU Core; cached_interpreter|pure_interpreter" },
 #endif
+#if defined(DYNAREC) && defined(__linux__)
+        { CORE_NAME "-DynarecFastmem",
+            "Dynarec fastmem (experimental); False|True" },
+        { CORE_NAME "-DynarecPerfMap",
+            "Dynarec symbols for perf (profiling); Off|perf map|jitdump" },
+#endif
+        { CORE_NAME "-IdleLoopSkip",
+            "Skip polling idle loops (experimental); False|True" },
+        { CORE_NAME "-EnableTracing",
+            "Record a trace (profiling); False|True" },
         { CORE_NAME "-43screensize",
             "4:3 Resolution; 640x480|320x240|960x720|1280x960|1440x1080|1600x1200|1920x1440|2240x1680|2560x1920|2880x2160|3200x2400|3520x2640|3840x2880" },
         { CORE_NAME "-169screensize",
@@ -236,6 +259,8 @@ static void setup_variables(void)
 #endif
         { CORE_NAME "-EnableCopyDepthToRDRAM",
             "Depth buffer to RDRAM; Software|FromMem|Off" },
+        { CORE_NAME "-ReadbackLatency",
+            "Async buffer to RDRAM latency (frames); Default|1|2" },
         { CORE_NAME "-BackgroundMode",
             "Background Mode; OnePiece|Stripped" },
         { CORE_NAME "-EnableHWLighting",
@@ -262,8 +287,16 @@ static void setup_variables(void)
         { CORE_NAME "-EnableShadersStorage",
             "Cache GPU Shaders; True|False" },
 #endif // !defined(VC) && !defined(HAVE_OPENGLES)
+        { CORE_NAME "-EnableDrawMerging",
+            "Merge draws across color changes; False|True" },
+        { CORE_NAME "-EnableTexrectBatching",
+            "Batch textured rectangles; False|True" },
+        { CORE_NAME "-EnableShaderTMEM",
+            "Decode streamed textures in shaders; False|True" },
         { CORE_NAME "-EnableTextureCache",
             "Cache Textures; True|False" },
+        { CORE_NAME "-DListCapture",
+            "Display list capture (benchmarking); Off|Capture|Replay" },
 
         { CORE_NAME "-MaxTxCacheSize",
 #if defined(VC)
@@ -273,12 +306,16 @@ static void setup_variables(void)
 #else
             "Max texture cache size; 8000|4000|1500" },
 #endif
+        { CORE_NAME "-TxCacheBudget",
+            "Texture cache VRAM budget (MB); Unlimited|64|128|256|512|1024" },
         { CORE_NAME "-txFilterMode",
             "Texture filter; None|Smooth filtering 1|Smooth filtering 2|Smooth filtering 3|Smooth filtering 4|Sharp filtering 1|Sharp filtering 2" },
         { CORE_NAME "-txEnhancementMode",
             "Texture Enhancement; None|As Is|X2|X2SAI|HQ2X|HQ2XS|LQ2X|LQ2XS|HQ4X|2xBRZ|3xBRZ|4xBRZ|5xBRZ|6xBRZ" },
         { CORE_NAME "-txFilterIgnoreBG",
             "Filter background textures; True|False" },
+        { CORE_NAME "-txDeferredEnhancement",
+            "Deferred texture enhancement; False|True" },
         { CORE_NAME "-txHiresEnable",
             "Use High-Res textures; False|True" },
         { CORE_NAME "-txCacheCompression",
@@ -585,6 +622,19 @@ void update_controllers()
     }
 }
 
+// Write the trace recorded since tracing was enabled next to the system files
+static void save_trace(void)
+{
+    char path[PATH_MAX_LENGTH];
+
+    if (!g_trace_enabled)
+        return;
+
+    snprintf(path, sizeof(path), "%s/%s.trace.json", retro_get_system_directory(),
+             ROM_PARAMS.headername[0] ? ROM_PARAMS.headername : "mupen64plus");
+    trace_stop(path);
+}
+
 // TODO: Only check for variables that actually change something during gameplay
 static void update_variables(void)
 {
@@ -684,6 +734,16 @@ static void update_variables(void)
             EnableCopyDepthToRDRAM = 0;
     }
 
+    var.key = CORE_NAME "-ReadbackLatency";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "Default"))
+            ReadbackLatency = 0;
+        else
+            ReadbackLatency = atoi(var.value);
+    }
+
     var.key = CORE_NAME "-EnableHWLighting";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -790,6 +850,13 @@ static void update_variables(void)
         txFilterIgnoreBG = !strcmp(var.value, "False") ? 1 : 0;
     }
 
+    var.key = CORE_NAME "-txDeferredEnhancement";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        txDeferredEnhancement = !strcmp(var.value, "False") ? 0 : 1;
+    }
+
     var.key = CORE_NAME "-txHiresEnable";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -811,6 +878,13 @@ static void update_variables(void)
         MaxTxCacheSize = atoi(var.value);
     }
 
+    var.key = CORE_NAME "-TxCacheBudget";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        TxCacheBudget = !strcmp(var.value, "Unlimited") ? 0 : atoi(var.value);
+    }
+
     var.key = CORE_NAME "-EnableLegacyBlending";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -832,6 +906,39 @@ static void update_variables(void)
         EnableShadersStorage = !strcmp(var.value, "False") ? 0 : 1;
     }
 
+    var.key = CORE_NAME "-EnableDrawMerging";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        EnableDrawMerging = !strcmp(var.value, "True") ? 1 : 0;
+    }
+
+    var.key = CORE_NAME "-EnableTexrectBatching";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        EnableTexrectBatching = !strcmp(var.value, "True") ? 1 : 0;
+    }
+
+    var.key = CORE_NAME "-EnableShaderTMEM";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        EnableShaderTMEM = !strcmp(var.value, "True") ? 1 : 0;
+    }
+
+    var.key = CORE_NAME "-DListCapture";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "Capture"))
+            DListCaptureMode = 1;
+        else if (!strcmp(var.value, "Replay"))
+            DListCaptureMode = 2;
+        else
+            DListCaptureMode = 0;
+    }
+
     var.key = CORE_NAME "-EnableTextureCache";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -865,6 +972,42 @@ static void update_variables(void)
             r4300_emumode = EMUMODE_DYNAREC;
     }
 
+    var.key = CORE_NAME "-DynarecFastmem";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        EnableDynarecFastmem = !strcmp(var.value, "False") ? 0 : 1;
+    }
+
+    var.key = CORE_NAME "-DynarecPerfMap";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "jitdump"))
+            DynarecPerfMode = 2;
+        else if (!strcmp(var.value, "perf map"))
+            DynarecPerfMode = 1;
+        else
+            DynarecPerfMode = 0;
+    }
+
+    var.key = CORE_NAME "-IdleLoopSkip";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        EnableIdleLoopSkip = !strcmp(var.value, "False") ? 0 : 1;
+    }
+
+    var.key = CORE_NAME "-EnableTracing";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (!strcmp(var.value, "True"))
+            trace_start();
+        else
+            save_trace();
+    }
+
     var.key = CORE_NAME "-aspect";
     var.value = NULL;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -1053,6 +1196,7 @@ bool retro_load_game(const struct retro_game_info *game)
 
 void retro_unload_game(void)
 {
+    save_trace();
     CoreDoCommand(M64CMD_ROM_CLOSE, 0, NULL);
     emu_initialized = false;
 }
@@ -1061,14 +1205,23 @@ void retro_run (void)
 {
     libretro_swap_buffer = false;
     static bool updated = false;
+    int trace_track;
 
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated) {
        update_variables();
        update_controllers();
     }
 
+    // The emulation runs in a cothread, give it its own track so that its
+    // events don't interleave with the frontend's
+    if (g_trace_enabled && game_thread_trace_track < 0)
+        game_thread_trace_track = trace_track_create("emulation");
+
+    TRACE_BEGIN("retro_run");
     glsm_ctl(GLSM_CTL_STATE_BIND, NULL);
+    trace_track = trace_track_swap(game_thread_trace_track);
     co_switch(game_thread);
+    trace_track_swap(trace_track);
     glsm_ctl(GLSM_CTL_STATE_UNBIND, NULL);
 
     if (libretro_swap_buffer)
@@ -1079,6 +1232,7 @@ void retro_run (void)
     {
         video_cb(NULL, retro_screen_width, retro_screen_height, 0);
     }
+    TRACE_END("retro_run");
 }
 
 void retro_reset (void)
@@ -137,7 +137,15 @@ typedef enum {
   M64CORE_AUDIO_MUTE,
   M64CORE_INPUT_GAMESHARK,
   M64CORE_STATE_LOADCOMPLETE,
-  M64CORE_STATE_SAVECOMPLETE
+  M64CORE_STATE_SAVECOMPLETE,
+  M64CORE_DYNAREC_BLOCKS_COMPILED,
+  M64CORE_DYNAREC_BYTES_EMITTED,       /* in KiB */
+  M64CORE_DYNAREC_COMPILE_TIME_AVG,    /* in ns per block */
+  M64CORE_DYNAREC_COMPILE_TIME_MAX,    /* in ns */
+  M64CORE_DYNAREC_ADDR_MISSES,
+  M64CORE_DYNAREC_DIRTY_RESTORES,
+  M64CORE_DYNAREC_CACHE_WRAPS,
+  M64CORE_DYNAREC_HELPER_INSTRUCTIONS
 } m64p_core_param;
 
 typedef enum {
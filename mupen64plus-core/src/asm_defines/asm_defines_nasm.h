@@ -0,0 +1,20 @@
+%define offsetof_struct_cached_interp_invalid_code (0x00000000)
+%define offsetof_struct_r4300_core_cached_interp (0x00000200)
+%define offsetof_struct_tlb_LUT_w (0x00400680)
+%define offsetof_struct_tlb_LUT_r (0x00000680)
+%define offsetof_struct_tlb_entries (0x00000000)
+%define offsetof_struct_cp0_tlb (0x000002ec)
+%define offsetof_struct_cp0_count_per_op (0x000002e8)
+%define offsetof_struct_cp0_last_addr (0x000002e4)
+%define offsetof_struct_cp0_next_interrupt (0x00000218)
+%define offsetof_struct_cp0_regs (0x00000000)
+%define offsetof_struct_r4300_core_cp0 (0x009004e8)
+%define offsetof_struct_recomp_return_address (0x00000178)
+%define offsetof_struct_recomp_save_rip (0x00000170)
+%define offsetof_struct_recomp_save_rsp (0x00000168)
+%define offsetof_struct_r4300_core_recomp (0x00900238)
+%define offsetof_struct_r4300_core_stop (0x00000128)
+%define offsetof_struct_r4300_core_lo (0x00000108)
+%define offsetof_struct_r4300_core_hi (0x00000100)
+%define offsetof_struct_r4300_core_regs (0x00000000)
+%define offsetof_struct_device_r4300 (0x00000000)
@@ -42,6 +42,17 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#if defined(NEW_DYNAREC) && defined(__linux__)
+#include <sys/mman.h>
+#include "../../../../custom/GLideN64/GLideN64_libretro.h"
+/* new_dynarec fastmem aliases RDRAM into its own address space reservation,
+ * which is only possible for shared mappings */
+#define MEM_BASE_MMAP
+
+/* mem base is a shared mapping rather than malloc'ed */
+static int mem_base_mmapped = 0;
+#endif
+
 #ifdef DBG
 enum
 {
@@ -230,15 +241,30 @@ enum {
 #define MEM_BASE_PTR(mem_base)  ((void*)((uintptr_t)(mem_base) & ~0x1))
 #define SET_MEM_BASE_MODE(mem_base) (mem_base = (void*)((uintptr_t)(mem_base) | 0x1))
 
+static void* alloc_mem_base(size_t size)
+{
+#ifdef MEM_BASE_MMAP
+    /* only fastmem needs the shared mapping, keep malloc otherwise */
+    if (EnableDynarecFastmem) {
+        void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        mem_base_mmapped = (mem != MAP_FAILED);
+        return mem_base_mmapped ? mem : NULL;
+    }
+    mem_base_mmapped = 0;
+#endif
+    return malloc(size);
+}
+
 void* init_mem_base(void)
 {
     void* mem_base;
 
     /* First try the full mem base alloc */
-    mem_base = malloc(MB_MAX_SIZE_FULL);
+    mem_base = alloc_mem_base(MB_MAX_SIZE_FULL);
     if (mem_base == NULL) {
         /* if it failed, try the compressed mem base alloc */
-        mem_base = malloc(MB_MAX_SIZE);
+        mem_base = alloc_mem_base(MB_MAX_SIZE);
         if (mem_base != NULL) {
             /* Compressed mem base mode has LSB = 1 */
             assert(MEM_BASE_MODE(mem_base) == 0);
@@ -257,6 +283,14 @@ void* init_mem_base(void)
 
 void release_mem_base(void* mem_base)
 {
+#ifdef MEM_BASE_MMAP
+    if (mem_base_mmapped) {
+        munmap(MEM_BASE_PTR(mem_base),
+               (MEM_BASE_MODE(mem_base) == 0) ? MB_MAX_SIZE_FULL : MB_MAX_SIZE);
+        mem_base_mmapped = 0;
+        return;
+    }
+#endif
     free(MEM_BASE_PTR(mem_base));
 }
 
@@ -133,18 +133,14 @@ void cached_interp_##name##_OUT(void) \
 void cached_interp_##name##_IDLE(void) \
 { \
     DECLARE_R4300 \
-    uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0); \
     const int take_jump = (condition); \
-    int skip; \
     if (cop1 && check_cop1_unusable(r4300)) return; \
     if (take_jump) \
     { \
         cp0_update_count(r4300); \
-        skip = *r4300_cp0_next_interrupt(&r4300->cp0) - cp0_regs[CP0_COUNT_REG]; \
-        if (skip > 3) cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC)); \
-        else cached_interp_##name(); \
+        if (!r4300_idle_jump(r4300)) return; \
     } \
-    else cached_interp_##name(); \
+    cached_interp_##name(); \
 }
 
 /* These macros allow direct access to parsed opcode fields. */
@@ -353,7 +349,7 @@ static void (*const ci_table[R4300_OPCODES_COUNT])(void) =
 #undef X
 
 /* return 0:normal, 1:idle, 2:out */
-static int infer_jump_sub_type(uint32_t target, uint32_t pc, uint32_t next_iw, const struct precomp_block* block)
+static int infer_jump_sub_type(struct r4300_core* r4300, uint32_t target, uint32_t pc, uint32_t next_iw, const struct precomp_block* block)
 {
     /* test if jumping to same location with empty delay slot */
     if (target == pc) {
@@ -368,6 +364,11 @@ static int infer_jump_sub_type(uint32_t target, uint32_t pc, uint32_t next_iw, c
         }
     }
 
+    /* test if jumping back over a loop which only polls memory */
+    if (r4300_idle_loop_skip && target <= pc && pc != (block->end - 4) && r4300_idle_loop_at(r4300, target, pc)) {
+        return 1;
+    }
+
     /* regular jump */
     return 0;
 }
@@ -405,7 +406,7 @@ enum r4300_opcode r4300_decode(struct precomp_instr* inst, struct r4300_core* r4
     case R4300_OP_JAL:
         inst->f.j.inst_index  = (iw & UINT32_C(0x3ffffff));
         /* select normal, idle or out jump type */
-        opcode += infer_jump_sub_type((inst->addr & ~0xfffffff) | (idec_imm(iw, idec) & 0xfffffff), inst->addr, next_iw, block);
+        opcode += infer_jump_sub_type(r4300, (inst->addr & ~0xfffffff) | (idec_imm(iw, idec) & 0xfffffff), inst->addr, next_iw, block);
         break;
 
     case R4300_OP_BC0F:
@@ -441,7 +442,7 @@ enum r4300_opcode r4300_decode(struct precomp_instr* inst, struct r4300_core* r4
         inst->f.i.immediate  = (int16_t)iw;
 
         /* select normal, idle or out branch type */
-        opcode += infer_jump_sub_type(inst->addr + inst->f.i.immediate*4 + 4, inst->addr, next_iw, block);
+        opcode += infer_jump_sub_type(r4300, inst->addr + inst->f.i.immediate*4 + 4, inst->addr, next_iw, block);
         break;
 
     case R4300_OP_ADD:
@@ -0,0 +1,333 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.c                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "idle_loop.h"
+
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+#include "device/r4300/r4300_core.h"
+#include "main/rom.h"
+
+int r4300_idle_loop_skip = 0;
+
+enum idle_iw_kind
+{
+    IDLE_IW_PLAIN,
+    IDLE_IW_BRANCH,
+    IDLE_IW_JUMP
+};
+
+/* GPR bit for the read/write masks, r0 is never tracked */
+#define GPR(r) ((UINT32_C(1) << (r)) & ~UINT32_C(1))
+
+/* Classify an instruction and report the GPRs it reads and writes.
+ * Returns 0 for anything that could have a side effect other than
+ * a load or a register write (stores, cop0, mult/div, calls...). */
+static int decode_idle_iw(uint32_t iw, uint32_t* reads, uint32_t* writes, enum idle_iw_kind* kind)
+{
+    unsigned int rs = (iw >> 21) & 0x1f;
+    unsigned int rt = (iw >> 16) & 0x1f;
+    unsigned int rd = (iw >> 11) & 0x1f;
+
+    *reads = 0;
+    *writes = 0;
+    *kind = IDLE_IW_PLAIN;
+
+    switch (iw >> 26)
+    {
+    case 0x00: /* SPECIAL */
+        switch (iw & 0x3f)
+        {
+        case 0x00: case 0x02: case 0x03: /* SLL, SRL, SRA */
+        case 0x38: case 0x3a: case 0x3b: /* DSLL, DSRL, DSRA */
+        case 0x3c: case 0x3e: case 0x3f: /* DSLL32, DSRL32, DSRA32 */
+            *reads = GPR(rt);
+            *writes = GPR(rd);
+            return 1;
+        case 0x04: case 0x06: case 0x07: /* SLLV, SRLV, SRAV */
+        case 0x14: case 0x16: case 0x17: /* DSLLV, DSRLV, DSRAV */
+        case 0x20: case 0x21: case 0x22: case 0x23: /* ADD, ADDU, SUB, SUBU */
+        case 0x24: case 0x25: case 0x26: case 0x27: /* AND, OR, XOR, NOR */
+        case 0x2a: case 0x2b: /* SLT, SLTU */
+        case 0x2c: case 0x2d: case 0x2e: case 0x2f: /* DADD, DADDU, DSUB, DSUBU */
+            *reads = GPR(rs) | GPR(rt);
+            *writes = GPR(rd);
+            return 1;
+        }
+        return 0;
+
+    case 0x01: /* REGIMM: BLTZ, BGEZ, BLTZL, BGEZL (not the linking ones) */
+        if (rt > 3)
+            return 0;
+        *reads = GPR(rs);
+        *kind = IDLE_IW_BRANCH;
+        return 1;
+
+    case 0x02: /* J */
+        *kind = IDLE_IW_JUMP;
+        return 1;
+
+    case 0x04: case 0x05: case 0x14: case 0x15: /* BEQ, BNE, BEQL, BNEL */
+        *reads = GPR(rs) | GPR(rt);
+        *kind = IDLE_IW_BRANCH;
+        return 1;
+
+    case 0x06: case 0x07: case 0x16: case 0x17: /* BLEZ, BGTZ, BLEZL, BGTZL */
+        *reads = GPR(rs);
+        *kind = IDLE_IW_BRANCH;
+        return 1;
+
+    case 0x08: case 0x09: case 0x0a: case 0x0b: /* ADDI, ADDIU, SLTI, SLTIU */
+    case 0x0c: case 0x0d: case 0x0e: /* ANDI, ORI, XORI */
+    case 0x18: case 0x19: /* DADDI, DADDIU */
+        *reads = GPR(rs);
+        *writes = GPR(rt);
+        return 1;
+
+    case 0x0f: /* LUI */
+        *writes = GPR(rt);
+        return 1;
+
+    case 0x11: /* COP1: only BC1F, BC1T, BC1FL, BC1TL */
+        if (rs != 0x08)
+            return 0;
+        *kind = IDLE_IW_BRANCH;
+        return 1;
+
+    case 0x20: case 0x21: case 0x23: /* LB, LH, LW */
+    case 0x24: case 0x25: case 0x27: /* LBU, LHU, LWU */
+    case 0x37: /* LD */
+        *reads = GPR(rs);
+        *writes = GPR(rt);
+        return 1;
+
+    case 0x22: case 0x26: /* LWL, LWR merge with rt */
+        *reads = GPR(rs) | GPR(rt);
+        *writes = GPR(rt);
+        return 1;
+    }
+
+    return 0;
+}
+
+int r4300_idle_loop(uint32_t start, const uint32_t* iw, size_t count)
+{
+    uint32_t reads[IDLE_LOOP_MAX_LENGTH + 1];
+    uint32_t writes[IDLE_LOOP_MAX_LENGTH + 1];
+    uint32_t loop_writes = 0;
+    uint32_t written = 0;
+    enum idle_iw_kind prev_kind = IDLE_IW_PLAIN;
+    size_t i;
+
+    if (count < 2 || count > IDLE_LOOP_MAX_LENGTH + 1)
+        return 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        enum idle_iw_kind kind;
+        uint32_t pc = start + (uint32_t)i * 4;
+        uint32_t target;
+
+        if (!decode_idle_iw(iw[i], &reads[i], &writes[i], &kind))
+            return 0;
+        loop_writes |= writes[i];
+
+        /* no branch in a delay slot */
+        if (kind != IDLE_IW_PLAIN && (prev_kind != IDLE_IW_PLAIN || i == count - 1))
+            return 0;
+        prev_kind = kind;
+
+        if (kind == IDLE_IW_PLAIN)
+        {
+            /* the loop must end with its branch and delay slot */
+            if (i == count - 2)
+                return 0;
+            continue;
+        }
+
+        target = (kind == IDLE_IW_JUMP)
+            ? ((pc + 4) & UINT32_C(0xf0000000)) | ((iw[i] & UINT32_C(0x3ffffff)) << 2)
+            : pc + 4 + (uint32_t)((int16_t)iw[i] * 4);
+
+        if (i == count - 2)
+        {
+            /* the loop branch */
+            if (target != start)
+                return 0;
+        }
+        else
+        {
+            /* earlier branches may only leave the loop or restart it */
+            if (kind == IDLE_IW_JUMP)
+                return 0;
+            if (target != start && target - start < (uint32_t)count * 4)
+                return 0;
+        }
+    }
+
+    /* every register the loop writes must be written before being read,
+     * so each iteration computes the same values from unchanged memory */
+    for (i = 0; i < count; ++i)
+    {
+        if (reads[i] & loop_writes & ~written)
+            return 0;
+        written |= writes[i];
+    }
+
+    return 1;
+}
+
+int r4300_idle_loop_at(struct r4300_core* r4300, uint32_t start, uint32_t branch)
+{
+    const uint32_t* iw;
+
+    if (branch < start || branch - start >= IDLE_LOOP_MAX_LENGTH * 4)
+        return 0;
+
+    /* keep the loop and its delay slot in a single page */
+    if ((start ^ (branch + 4)) & ~UINT32_C(0xfff))
+        return 0;
+
+    iw = fast_mem_access(r4300, start);
+    if (iw == NULL)
+        return 0;
+
+    return r4300_idle_loop(start, iw, (branch - start) / 4 + 2);
+}
+
+#define IDLE_CACHE_VALID UINT32_C(2)
+#define IDLE_CACHE_IDLE UINT32_C(1)
+
+/* kseg0 and kseg1 aliases of a page share their bit */
+#define IDLE_CACHE_PAGE_BIT(address) (UINT64_C(1) << (((address) >> 12) & 63))
+
+int r4300_idle_loop_cached(struct r4300_core* r4300, uint32_t start, uint32_t branch)
+{
+    struct r4300_idle* idle = &r4300->idle;
+    uint32_t* entry;
+    int result;
+
+    if ((branch & UINT32_C(0xc0000000)) != UINT32_C(0x80000000))
+        return r4300_idle_loop_at(r4300, start, branch);
+
+    /* the branch word fixes start, so the branch address is enough of a key */
+    entry = &idle->cache[(branch >> 2) & (IDLE_LOOP_CACHE_SIZE - 1)];
+    if ((*entry & ~IDLE_CACHE_IDLE) == (branch | IDLE_CACHE_VALID))
+        return (*entry & IDLE_CACHE_IDLE) != 0;
+
+    result = r4300_idle_loop_at(r4300, start, branch);
+    *entry = branch | IDLE_CACHE_VALID | (result ? IDLE_CACHE_IDLE : 0);
+    idle->cache_pages |= IDLE_CACHE_PAGE_BIT(branch);
+    return result;
+}
+
+void r4300_idle_invalidate(struct r4300_idle* idle, uint32_t address, size_t size)
+{
+    uint32_t first;
+    uint32_t last;
+    uint64_t pages = 0;
+    size_t i;
+
+    if (idle->cache_pages == 0)
+        return;
+
+    first = (address & UINT32_C(0x1fffffff)) >> 12;
+    last = ((address + (uint32_t)size - 1) & UINT32_C(0x1fffffff)) >> 12;
+    if (size == 0 || last < first || last - first >= 63)
+    {
+        memset(idle->cache, 0, sizeof(idle->cache));
+        idle->cache_pages = 0;
+        return;
+    }
+
+    for (i = first; i <= last; ++i)
+        pages |= IDLE_CACHE_PAGE_BIT(i << 12);
+    if ((idle->cache_pages & pages) == 0)
+        return;
+
+    /* loops never cross a page, see r4300_idle_loop_at */
+    for (i = 0; i < IDLE_LOOP_CACHE_SIZE; ++i)
+    {
+        uint32_t page = (idle->cache[i] & UINT32_C(0x1fffffff)) >> 12;
+        if ((idle->cache[i] & IDLE_CACHE_VALID) && page >= first && page <= last)
+            idle->cache[i] = 0;
+    }
+}
+
+int r4300_idle_skip(struct r4300_core* r4300)
+{
+    uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
+    int skip = *r4300_cp0_next_interrupt(&r4300->cp0) - cp0_regs[CP0_COUNT_REG];
+
+    if (r4300->idle.count_read)
+    {
+        /* the loop waits for the count itself, let it run */
+        r4300->idle.count_read = 0;
+        ++r4300->idle.vetoes;
+        return skip <= 0;
+    }
+
+    if (skip > 3)
+    {
+        cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC));
+        r4300->idle.skipped_cycles += (skip & UINT32_C(0xFFFFFFFC));
+        ++r4300->idle.skips;
+        skip &= 3;
+    }
+
+    return skip <= 0;
+}
+
+int r4300_idle_jump(struct r4300_core* r4300)
+{
+    uint32_t* cp0_regs;
+    int skip;
+
+    if (r4300_idle_loop_skip)
+    {
+        r4300_idle_skip(r4300);
+        return 1;
+    }
+
+    /* only branches to themselves are idle, see the IS_*_IDLE_LOOP macros */
+    cp0_regs = r4300_cp0_regs(&r4300->cp0);
+    skip = *r4300_cp0_next_interrupt(&r4300->cp0) - cp0_regs[CP0_COUNT_REG];
+    if (skip > 3)
+    {
+        cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC));
+        return 0;
+    }
+
+    return 1;
+}
+
+void r4300_idle_report(struct r4300_core* r4300)
+{
+    if (r4300->idle.skips == 0 && r4300->idle.vetoes == 0)
+        return;
+
+    DebugMessage(M64MSG_INFO, "%s: skipped %llu idle cycles in %u idle loops (%u not skipped)",
+                 ROM_PARAMS.headername,
+                 (unsigned long long)r4300->idle.skipped_cycles,
+                 r4300->idle.skips, r4300->idle.vetoes);
+}
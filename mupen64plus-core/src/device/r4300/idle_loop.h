@@ -0,0 +1,88 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - idle_loop.h                                             *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_DEVICE_R4300_IDLE_LOOP_H
+#define M64P_DEVICE_R4300_IDLE_LOOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct r4300_core;
+
+/* Non-zero to detect polling loops, not only branches to themselves.
+ * Set from the core options before the emulation starts, off by default. */
+extern int r4300_idle_loop_skip;
+
+/* Longest loop body (in instructions, delay slot excluded) considered */
+#define IDLE_LOOP_MAX_LENGTH 16
+
+/* Entries in the per-branch cache of r4300_idle_loop_cached, a power of two */
+#define IDLE_LOOP_CACHE_SIZE 64
+
+struct r4300_idle
+{
+    /* set when a register derived from the cycle count (VI_CURRENT, AI_LEN)
+     * is read, so that loops polling it are not fast-forwarded */
+    int count_read;
+
+    /* branch address | 2 (valid) | 1 (idle), indexed by branch address */
+    uint32_t cache[IDLE_LOOP_CACHE_SIZE];
+    /* bit (address >> 12) & 63 is set for the pages of cached branches */
+    uint64_t cache_pages;
+
+    uint64_t skipped_cycles;
+    unsigned int skips;
+    unsigned int vetoes;
+};
+
+/* Returns non-zero if the count instructions at iw, starting at guest address
+ * start, form a loop which can only exit after an external event:
+ * iw[count-2] branches back to iw[0] and iw[count-1] is its delay slot,
+ * nothing in the loop has side effects other than loads and register writes,
+ * and no register value is carried from one iteration to the next. */
+int r4300_idle_loop(uint32_t start, const uint32_t* iw, size_t count);
+
+/* Same as r4300_idle_loop for the loop between start and the branch at
+ * address branch, reading the instructions from guest memory. */
+int r4300_idle_loop_at(struct r4300_core* r4300, uint32_t start, uint32_t branch);
+
+/* Same as r4300_idle_loop_at with the result cached per branch address,
+ * for the pure interpreter which checks on every taken backward branch.
+ * TLB mapped code is not cached, as remapping does not invalidate it. */
+int r4300_idle_loop_cached(struct r4300_core* r4300, uint32_t start, uint32_t branch);
+
+/* Drop cached results for loops overlapping address .. address + size - 1,
+ * or all of them if size is 0. */
+void r4300_idle_invalidate(struct r4300_idle* idle, uint32_t address, size_t size);
+
+/* Called when an idle loop branches back: advance the count register to
+ * the next interrupt, unless the last iteration read a count-derived
+ * register. Returns non-zero if the next interrupt is due. */
+int r4300_idle_skip(struct r4300_core* r4300);
+
+/* Called by the interpreters when an idle branch is taken, after the count
+ * was updated. Returns non-zero if the branch should be executed now.
+ * Otherwise the count was advanced and the branch runs again. */
+int r4300_idle_jump(struct r4300_core* r4300);
+
+void r4300_idle_report(struct r4300_core* r4300);
+
+#endif /* M64P_DEVICE_R4300_IDLE_LOOP_H */
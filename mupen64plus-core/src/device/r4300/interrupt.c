@@ -45,6 +45,7 @@
 #include "device/rcp/vi/vi_controller.h"
 #include "main/main.h"
 #include "main/savestates.h"
+#include "main/trace.h"
 
 
 /***************************************************************************
@@ -501,7 +502,7 @@ static void call_interrupt_handler(const struct cp0* cp0, size_t index)
     handler->callback(handler->opaque);
 }
 
-void gen_interrupt(struct r4300_core* r4300)
+static void dispatch_interrupt(struct r4300_core* r4300)
 {
     uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0);
     unsigned int* cp0_next_interrupt = r4300_cp0_next_interrupt(&r4300->cp0);
@@ -623,3 +624,10 @@ void gen_interrupt(struct r4300_core* r4300)
     }
 }
 
+void gen_interrupt(struct r4300_core* r4300)
+{
+    TRACE_BEGIN("gen_interrupt");
+    dispatch_interrupt(r4300);
+    TRACE_END("gen_interrupt");
+}
+
@@ -59,7 +59,6 @@ void invalidate_addr_r12(void);
 
 static void *dyna_linker(void * src, u_int vaddr);
 static void *dyna_linker_ds(void * src, u_int vaddr);
-static void invalidate_addr(u_int addr);
 
 static u_int literals[1024][2];
 static unsigned int needs_clear_cache[1<<(TARGET_SIZE_2-17)];
@@ -4523,11 +4522,6 @@ static void do_clear_cache(void)
   }
 }
 
-static void invalidate_addr(u_int addr)
-{
-  invalidate_block(addr>>12);
-}
-
 // CPU-architecture-specific initialization
 static void arch_init(void) {
 
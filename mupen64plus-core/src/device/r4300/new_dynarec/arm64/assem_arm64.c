@@ -83,7 +83,6 @@ void breakpoint(void);
 
 static void *dyna_linker(void * src, u_int vaddr);
 static void *dyna_linker_ds(void * src, u_int vaddr);
-static void invalidate_addr(u_int addr);
 
 static uintptr_t literals[1024][2];
 static unsigned int needs_clear_cache[1<<(TARGET_SIZE_2-17)];
@@ -3151,7 +3150,7 @@ static void do_readstub(int n)
 {
   assem_debug("do_readstub %x",start+stubs[n][3]*4);
   literal_pool(256);
-  set_jump_target(stubs[n][1],(intptr_t)out);
+  if(stubs[n][1]) set_jump_target(stubs[n][1],(intptr_t)out);
   int type=stubs[n][0];
   int i=stubs[n][3];
   int addr=stubs[n][4];
@@ -3303,7 +3302,7 @@ static void do_writestub(int n)
 {
   assem_debug("do_writestub %x",start+stubs[n][3]*4);
   literal_pool(256);
-  set_jump_target(stubs[n][1],(intptr_t)out);
+  if(stubs[n][1]) set_jump_target(stubs[n][1],(intptr_t)out);
   int type=stubs[n][0];
   int i=stubs[n][3];
   int addr=stubs[n][4];
@@ -5137,11 +5136,31 @@ static void do_clear_cache(void)
   }
 }
 
-static void invalidate_addr(u_int addr)
+#ifdef HAVE_FASTMEM
+static void emit_fastmem_padding(intptr_t site)
 {
-  invalidate_block(addr>>12);
+  // Every instruction is large enough for the b written over the site
+  (void)site;
 }
 
+static void fastmem_patch_jump(uint8_t *site,intptr_t stub)
+{
+  intptr_t site_rx=((intptr_t)site-(intptr_t)base_addr)+(intptr_t)base_addr_rx;
+  *(u_int *)site=0x14000000|(((stub-(intptr_t)site)>>2)&0x3ffffff);
+  cache_flush((char *)site_rx,(char *)site_rx+4);
+}
+
+static uintptr_t *fastmem_context_pc(void *context)
+{
+  return (uintptr_t *)&((ucontext_t *)context)->uc_mcontext.pc;
+}
+
+static uintptr_t *fastmem_context_reg(void *context,int r)
+{
+  return (uintptr_t *)&((ucontext_t *)context)->uc_mcontext.regs[r];
+}
+#endif
+
 // CPU-architecture-specific initialization
 static void arch_init(void) {
 
@@ -5153,6 +5172,10 @@ static void arch_init(void) {
 
   #ifdef RAM_OFFSET
   g_dev.r4300.new_dynarec_hot_state.ram_offset=((intptr_t)g_dev.rdram.dram-(intptr_t)0x80000000)>>2;
+  #ifdef HAVE_FASTMEM
+  // RDRAM is also mapped at fastmem_arena+0x80000000
+  if(fastmem_arena) g_dev.r4300.new_dynarec_hot_state.ram_offset=(intptr_t)fastmem_arena>>2;
+  #endif
   #endif
 
   jump_table_symbols[0] = (intptr_t)cached_interp_TLBR;
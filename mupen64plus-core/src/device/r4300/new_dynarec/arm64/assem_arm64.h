@@ -15,6 +15,10 @@
 //#define HAVE_CONDITIONAL_CALL 1
 #define RAM_OFFSET 1
 #define USE_MINI_HT 1
+#if defined(__linux__) && !defined(RECOMP_DBG)
+#define HAVE_FASTMEM 1
+#define FASTMEM_PATCH_SIZE 4 // b imm26
+#endif
 //#define INTERPRETED_MULT64 1
 //#define INTERPRETED_DIV64 1
 
@@ -34,6 +34,7 @@
 #include "api/callbacks.h"
 #include "main/main.h"
 #include "main/rom.h"
+#include "main/trace.h"
 #include "device/memory/memory.h"
 #include "device/r4300/cached_interp.h"
 #include "device/r4300/cp0.h"
@@ -41,6 +42,7 @@
 #include "device/r4300/interrupt.h"
 #include "device/r4300/tlb.h"
 #include "device/r4300/fpu.h"
+#include "device/r4300/idle_loop.h"
 #include "device/rcp/mi/mi_controller.h"
 #include "device/rcp/rsp/rsp_core.h"
 
@@ -73,6 +75,24 @@ void recomp_dbg_block(int addr);
 #error Unsupported dynarec architecture
 #endif
 
+#ifdef HAVE_FASTMEM
+#include <signal.h>
+#include <ucontext.h>
+#endif
+
+#if !defined(WIN32)
+#include <time.h>
+#endif
+
+#if defined(__linux__) && !defined(RECOMP_DBG)
+#define HAVE_PERF_JIT 1
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 /* debug */
 #define ASSEM_DEBUG 0
 #define INV_DEBUG 0
@@ -222,6 +242,7 @@ static void write_dword_new(int pcaddr, int count, int diff);
 
 int new_recompile_block(int addr);
 void invalidate_block(uint32_t block);
+void invalidate_addr(uint32_t addr);
 void *get_addr_ht(uint32_t vaddr);
 
 static void wb_register(signed char r,signed char regmap[],uint64_t dirty,uint64_t is32);
@@ -234,6 +255,8 @@ void *base_addr_rx;
 uint8_t *out;
 unsigned int using_tlb;
 unsigned int stop_after_jal;
+int new_dynarec_fastmem;
+int new_dynarec_perf_mode;
 
 static uint32_t start;
 static uint32_t *source;
@@ -290,6 +313,31 @@ static struct ll_entry* hash_table[65536][2];
 static struct ll_entry *jump_in[4096];
 static struct ll_entry *jump_dirty[4096];
 static struct ll_entry *jump_out[4096];
+static uint64_t code_lines[2048]; // 64-byte lines of each RDRAM page that back a block in jump_in
+static uint32_t page_invalidations[4096];
+static uint32_t page_recompilations[4096];
+static uint32_t page_ignored_writes[2048];
+static struct new_dynarec_stats stats;
+
+#ifdef HAVE_FASTMEM
+// A guest load/store emitted without the RDRAM range check. When it faults,
+// the site is overwritten with a jump to its stub and execution restarts there.
+struct fastmem_site
+{
+  uint32_t start;   // Offset of the site in the code cache
+  uint32_t stub;    // Offset of the slow path stub
+  uint8_t len;      // Zero if the stub has no fastmem site
+  int8_t undo_reg;  // Host register xored in place inside the site, or -1
+  uint8_t undo_xor;
+};
+static struct fastmem_site fastmem_next;
+static struct fastmem_site fastmem_stub[MAXBLOCK*3];
+static struct fastmem_site *fastmem_sites[8]; // One sorted list per 1/8 of the cache
+static int fastmem_count[8];
+static int fastmem_alloc[8];
+static uint8_t *fastmem_arena;
+static struct sigaction fastmem_old_action;
+#endif
 
 #if COUNT_NOTCOMPILEDS
 static int notcompiledCount = 0;
@@ -300,8 +348,38 @@ static signed char regmap[MAXBLOCK][HOST_REGS];
 static signed char regmap_entry[MAXBLOCK][HOST_REGS];
 #endif
 
+/* Loop starts whose idle skip was vetoed, indexed by address (see is_idle_loop) */
+#define IDLE_VETO_SIZE 64
+static uint32_t idle_vetoed[IDLE_VETO_SIZE];
+static uint32_t idle_veto_pending;
+
 void dynarec_gen_interrupt(void)
 {
+    if (g_dev.r4300.new_dynarec_hot_state.idle_cc < 0)
+    {
+        /* called from an idle loop before the next event is due,
+         * pcaddr is the start of the loop */
+        uint32_t addr = g_dev.r4300.new_dynarec_hot_state.pcaddr;
+        g_dev.r4300.new_dynarec_hot_state.idle_cc = 0;
+        if (g_dev.r4300.idle.count_read)
+        {
+            /* Vetoed on two iterations in a row, so the loop itself polls
+             * a count-derived register. Recompile it as a plain loop. */
+            if (idle_veto_pending == addr)
+            {
+                idle_vetoed[(addr >> 2) & (IDLE_VETO_SIZE - 1)] = addr;
+                invalidate_block(addr >> 12);
+                g_dev.r4300.new_dynarec_hot_state.pending_exception = 1;
+            }
+            idle_veto_pending = addr;
+        }
+        else
+        {
+            idle_veto_pending = 0;
+        }
+        if (!r4300_idle_skip(&g_dev.r4300))
+            return;
+    }
     gen_interrupt(&g_dev.r4300);
 }
 
@@ -1687,6 +1765,14 @@ static void add_stub(int type,intptr_t addr,intptr_t retaddr,int a,intptr_t b,in
   stubs[stubcount][5]=c;
   stubs[stubcount][6]=d;
   stubs[stubcount][7]=e;
+#ifdef HAVE_FASTMEM
+  // The stub of a fastmem site is entered through backpatching, not a branch
+  if(fastmem_next.len&&addr==(intptr_t)base_addr+fastmem_next.start) {
+    fastmem_stub[stubcount]=fastmem_next;
+    fastmem_next.len=0;
+  }
+  else fastmem_stub[stubcount].len=0;
+#endif
   stubcount++;
 }
 
@@ -1715,6 +1801,293 @@ static void remove_hash(uint32_t vaddr)
 #error Unsupported dynarec architecture
 #endif
 
+#ifdef HAVE_FASTMEM
+#define FASTMEM_ARENA_SIZE (((size_t)1<<32)+0x10000)
+
+// Called once the access of a fastmem site has been emitted, before the
+// stub for 'site' is added.
+static void fastmem_end_site(intptr_t site,int undo_reg,int undo_xor)
+{
+  emit_fastmem_padding(site);
+  fastmem_next.start=site-(intptr_t)base_addr;
+  fastmem_next.len=(intptr_t)out-site;
+  fastmem_next.undo_reg=undo_reg;
+  fastmem_next.undo_xor=undo_xor;
+}
+
+// Register the site of stub n, which is about to be emitted at 'out'
+static void fastmem_add_site(int n)
+{
+  struct fastmem_site site=fastmem_stub[n];
+  int b=site.start>>(TARGET_SIZE_2-3);
+  int pos;
+  site.stub=(intptr_t)out-(intptr_t)base_addr;
+  stubs[n][1]=0;
+  if(fastmem_count[b]==fastmem_alloc[b]) {
+    int alloc=fastmem_alloc[b]?fastmem_alloc[b]*2:4096;
+    struct fastmem_site *sites=realloc(fastmem_sites[b],alloc*sizeof(struct fastmem_site));
+    if(sites==NULL) {
+      // Can't track it, so always take the slow path
+      fastmem_patch_jump((uint8_t *)base_addr+site.start,(intptr_t)out);
+      return;
+    }
+    fastmem_sites[b]=sites;
+    fastmem_alloc[b]=alloc;
+  }
+  pos=fastmem_count[b];
+  while(pos>0&&fastmem_sites[b][pos-1].start>site.start) {
+    fastmem_sites[b][pos]=fastmem_sites[b][pos-1];
+    pos--;
+  }
+  fastmem_sites[b][pos]=site;
+  fastmem_count[b]++;
+}
+
+static struct fastmem_site *fastmem_find_site(uint32_t offset)
+{
+  int b=offset>>(TARGET_SIZE_2-3);
+  int lo=0,hi=fastmem_count[b];
+  struct fastmem_site *sites=fastmem_sites[b];
+  while(lo<hi) {
+    int mid=(lo+hi)>>1;
+    if(sites[mid].start<=offset) lo=mid+1;
+    else hi=mid;
+  }
+  if(lo>0&&offset-sites[lo-1].start<sites[lo-1].len) return &sites[lo-1];
+  return NULL;
+}
+
+static void fastmem_handler(int sig,siginfo_t *info,void *context)
+{
+  uintptr_t *pc=fastmem_context_pc(context);
+  uintptr_t fault=(uintptr_t)info->si_addr-(uintptr_t)fastmem_arena;
+  uintptr_t offset=*pc-(uintptr_t)base_addr_rx;
+  if(fault<FASTMEM_ARENA_SIZE&&offset<((uintptr_t)1<<TARGET_SIZE_2)) {
+    struct fastmem_site *site=fastmem_find_site(offset);
+    if(site) {
+      fastmem_patch_jump((uint8_t *)base_addr+site->start,(intptr_t)base_addr+site->stub);
+      if(site->undo_reg>=0) *fastmem_context_reg(context,site->undo_reg)^=site->undo_xor;
+      *pc=(uintptr_t)base_addr_rx+site->start;
+      return;
+    }
+  }
+  // Not a guest memory access, pass it on
+  if(fastmem_old_action.sa_flags&SA_SIGINFO)
+    fastmem_old_action.sa_sigaction(sig,info,context);
+  else if(fastmem_old_action.sa_handler!=SIG_DFL&&fastmem_old_action.sa_handler!=SIG_IGN)
+    fastmem_old_action.sa_handler(sig);
+  else
+    sigaction(sig,&fastmem_old_action,NULL); // The access faults again and is fatal
+}
+
+// Reserve 4GB of address space so that ram_offset+addr is mapped for RDRAM
+// and faults for every other 32-bit guest address.
+// TODO: RDRAM pages holding translated code or a protected frame buffer are
+// not made PROT_NONE, so stores to them do not fault either. Stores keep the
+// inline invalid_code check for now; dropping it needs those pages protected
+// and unprotected as blocks are compiled and invalidated.
+static void fastmem_init(void)
+{
+  struct sigaction action;
+  uint8_t *arena;
+  int b;
+  for(b=0;b<8;b++) fastmem_count[b]=0;
+  fastmem_next.len=0;
+  if(!new_dynarec_fastmem) return;
+  arena=mmap(NULL,FASTMEM_ARENA_SIZE,PROT_NONE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+  if(arena==MAP_FAILED) {
+    DebugMessage(M64MSG_WARNING, "fastmem: could not reserve address space");
+    return;
+  }
+  // Needs RDRAM to be a shared mapping, which init_mem_base only makes
+  // when the option was already on at core startup
+  if(mremap(g_dev.rdram.dram,0,RDRAM_MAX_SIZE,MREMAP_MAYMOVE|MREMAP_FIXED,arena+0x80000000)==MAP_FAILED) {
+    DebugMessage(M64MSG_WARNING, "fastmem: could not map RDRAM");
+    munmap(arena,FASTMEM_ARENA_SIZE);
+    return;
+  }
+  memset(&action,0,sizeof(action));
+  action.sa_sigaction=fastmem_handler;
+  action.sa_flags=SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  if(sigaction(SIGSEGV,&action,&fastmem_old_action)!=0) {
+    DebugMessage(M64MSG_WARNING, "fastmem: could not install fault handler");
+    munmap(arena,FASTMEM_ARENA_SIZE);
+    return;
+  }
+  fastmem_arena=arena;
+  DebugMessage(M64MSG_INFO, "fastmem enabled");
+}
+
+static void fastmem_cleanup(void)
+{
+  int b;
+  if(fastmem_arena) {
+    sigaction(SIGSEGV,&fastmem_old_action,NULL);
+    munmap(fastmem_arena,FASTMEM_ARENA_SIZE);
+    fastmem_arena=NULL;
+  }
+  for(b=0;b<8;b++) {
+    free(fastmem_sites[b]);
+    fastmem_sites[b]=NULL;
+    fastmem_count[b]=fastmem_alloc[b]=0;
+  }
+}
+#else
+#define fastmem_end_site(site,undo_reg,undo_xor) ((void)0)
+#endif
+
+#ifdef HAVE_PERF_JIT
+// Describe the generated code to perf, either as /tmp/perf-<pid>.map
+// lines or as a jitdump file (see tools/perf/Documentation/jitdump-specification.txt
+// in the kernel tree). Symbols are named after the guest address and the ROM CRC.
+// A perf map is only accurate until the code buffer wraps; jitdump records
+// are timestamped so perf attributes reused host addresses to the newest block.
+#define JITDUMP_MAGIC 0x4A695444
+#define JITDUMP_CODE_LOAD 0
+#define JITDUMP_CODE_CLOSE 3
+
+struct jitdump_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+
+struct jitdump_record {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+struct jitdump_code_load {
+  struct jitdump_record p;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+
+static FILE *perf_file;
+static void *perf_marker;
+static uint64_t perf_code_index;
+
+static uint64_t perf_timestamp(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+
+// The files live in /tmp under a predictable name: never reuse an existing
+// file or follow a symlink planted there, and keep them private to the user.
+static int perf_create(const char *path)
+{
+  int fd=open(path,O_CREAT|O_EXCL|O_NOFOLLOW|O_RDWR,0600);
+  if(fd<0) DebugMessage(M64MSG_WARNING, "Could not create %s: %s", path, strerror(errno));
+  return fd;
+}
+
+static void perf_init(void)
+{
+  char path[64];
+  perf_code_index=0;
+  if(new_dynarec_perf_mode==NEW_DYNAREC_PERF_MAP) {
+    snprintf(path,sizeof(path),"/tmp/perf-%d.map",(int)getpid());
+    int fd=perf_create(path);
+    if(fd<0) return;
+    perf_file=fdopen(fd,"w");
+    if(!perf_file) {
+      close(fd);
+      return;
+    }
+  }
+  else if(new_dynarec_perf_mode==NEW_DYNAREC_PERF_JITDUMP) {
+    struct jitdump_header header;
+    snprintf(path,sizeof(path),"/tmp/jit-%d.dump",(int)getpid());
+    int fd=perf_create(path);
+    if(fd<0) return;
+    // perf record finds the dump through this executable mapping
+    perf_marker=mmap(NULL,sysconf(_SC_PAGESIZE),PROT_READ|PROT_EXEC,MAP_PRIVATE,fd,0);
+    if(perf_marker==MAP_FAILED) perf_marker=NULL;
+    perf_file=fdopen(fd,"wb");
+    if(!perf_file) {
+      close(fd);
+      return;
+    }
+    memset(&header,0,sizeof(header));
+    header.magic=JITDUMP_MAGIC;
+    header.version=1;
+    header.total_size=sizeof(header);
+    #if NEW_DYNAREC == NEW_DYNAREC_X86
+    header.elf_mach=3; // EM_386
+    #elif NEW_DYNAREC == NEW_DYNAREC_X64
+    header.elf_mach=62; // EM_X86_64
+    #elif NEW_DYNAREC == NEW_DYNAREC_ARM
+    header.elf_mach=40; // EM_ARM
+    #else
+    header.elf_mach=183; // EM_AARCH64
+    #endif
+    header.pid=getpid();
+    header.timestamp=perf_timestamp();
+    fwrite(&header,sizeof(header),1,perf_file);
+  }
+  else
+    return;
+  if(perf_file) DebugMessage(M64MSG_INFO, "Writing dynarec symbols to %s", path);
+}
+
+// Describe the code generated for the block at guest address vaddr
+static void perf_block(uint32_t vaddr,uintptr_t begin,uintptr_t end)
+{
+  char name[48];
+  uintptr_t begin_rx=(begin-(uintptr_t)base_addr)+(uintptr_t)base_addr_rx;
+  if(!perf_file||end<=begin) return;
+  snprintf(name,sizeof(name),"n64_%08x_%08X-%08X",vaddr,tohl(ROM_HEADER.CRC1),tohl(ROM_HEADER.CRC2));
+  if(new_dynarec_perf_mode==NEW_DYNAREC_PERF_MAP) {
+    fprintf(perf_file,"%" PRIxPTR " %" PRIxPTR " %s\n",begin_rx,end-begin,name);
+  }
+  else {
+    struct jitdump_code_load rec;
+    size_t name_len=strlen(name)+1;
+    rec.p.id=JITDUMP_CODE_LOAD;
+    rec.p.total_size=sizeof(rec)+name_len+(end-begin);
+    rec.p.timestamp=perf_timestamp();
+    rec.pid=rec.tid=getpid();
+    rec.vma=rec.code_addr=begin_rx;
+    rec.code_size=end-begin;
+    rec.code_index=perf_code_index++;
+    fwrite(&rec,sizeof(rec),1,perf_file);
+    fwrite(name,name_len,1,perf_file);
+    fwrite((void *)begin,end-begin,1,perf_file);
+  }
+  fflush(perf_file);
+}
+
+static void perf_cleanup(void)
+{
+  if(perf_file&&new_dynarec_perf_mode==NEW_DYNAREC_PERF_JITDUMP) {
+    struct jitdump_record rec;
+    rec.id=JITDUMP_CODE_CLOSE;
+    rec.total_size=sizeof(rec);
+    rec.timestamp=perf_timestamp();
+    fwrite(&rec,sizeof(rec),1,perf_file);
+  }
+  if(perf_file) fclose(perf_file);
+  perf_file=NULL;
+  if(perf_marker) munmap(perf_marker,sysconf(_SC_PAGESIZE));
+  perf_marker=NULL;
+}
+#else
+#define perf_block(vaddr,begin,end) ((void)0)
+#endif
+
 static void tlb_speed_hacks()
 {
   // Goldeneye hack
@@ -2083,6 +2456,7 @@ void *get_addr(uint32_t vaddr)
   struct ll_entry *head;
   struct ll_entry **ht_bin=hash_table[((vaddr>>16)^vaddr)&0xFFFF];
 
+  stats.addr_misses++;
   head=get_clean(r4300,vaddr,~0);
   if(head!=NULL){
     ht_bin[1]=ht_bin[0];
@@ -2129,6 +2503,7 @@ void *get_addr_32(uint32_t vaddr,uint32_t flags)
 
   struct r4300_core* r4300 = &g_dev.r4300;
   struct ll_entry *head;
+  stats.addr_misses++;
   head=get_clean(r4300,vaddr,flags);
   if(head!=NULL){
     if(head->reg32==0) {
@@ -2205,6 +2580,133 @@ static void *check_addr(uint32_t vaddr)
   return NULL;
 }
 
+// Index into jump_in of a 4K block of the address space
+static uint32_t get_page(uint32_t block)
+{
+  uint32_t page=block^0x80000;
+  if(page>262143&&g_dev.r4300.cp0.tlb.LUT_r[block]) page=(g_dev.r4300.cp0.tlb.LUT_r[block]^0x80000000)>>12;
+  if(page>2048) page=2048+(page&2047);
+  return page;
+}
+
+// Mark the RDRAM lines backing a block found in jump_in[page]
+static void mark_code_lines(struct ll_entry *head,uint32_t page)
+{
+  uint32_t first,last,addr;
+  if(page>=2048) return;
+  if((signed int)head->vaddr<0x80000000||(signed int)head->vaddr>=0x80800000) {
+    // TLB-mapped blocks never cross a page but their mapping may change,
+    // so they are tracked at page granularity
+    code_lines[page]=~(uint64_t)0;
+    return;
+  }
+  first=head->start^0x80000000;
+  last=(head->start+head->length-1)^0x80000000;
+  for(addr=first&~63;addr<=last;addr+=64)
+    code_lines[addr>>12]|=(uint64_t)1<<((addr>>6)&63);
+}
+
+// Rebuild the line bitmaps of pages first..last from the blocks still in
+// jump_in. A block spans at most 5 pages, so only the 4 preceding pages
+// can contribute lines besides the pages themselves.
+static void update_code_lines(uint32_t first,uint32_t last)
+{
+  struct ll_entry *head;
+  uint32_t page;
+  if(last>=2048) return;
+  for(page=first;page<=last;page++) code_lines[page]=0;
+  for(page=first>4?first-4:0;page<=last;page++)
+    for(head=jump_in[page];head!=NULL;head=head->next)
+      mark_code_lines(head,page);
+}
+
+// Returns 0 if a write of size bytes at offset in 'block' can't modify any
+// compiled code, i.e. it doesn't hit a line backing a block
+static int writes_code(uint32_t block,uint32_t offset,uint32_t size)
+{
+  uint32_t page=get_page(block);
+  uint32_t first=offset>>6;
+  uint32_t last=(offset+size-1)>>6;
+  uint64_t lines;
+  if(page>=2048) return 1; // Not tracked below page granularity
+  if(last>63) last=63;
+  lines=(~(uint64_t)0>>(63-last))&(~(uint64_t)0<<first);
+  if(code_lines[page]&lines) return 1;
+  page_ignored_writes[page]++;
+  return 0;
+}
+
+// Called from do_invstub and the invalidate_addr_* trampolines with the full address of the store
+void invalidate_addr(uint32_t addr)
+{
+  if(writes_code(addr>>12,addr&0xff8,8))
+    invalidate_block(addr>>12);
+}
+
+void new_dynarec_get_page_stats(uint32_t page, uint32_t* invalidations, uint32_t* recompilations, uint32_t* ignored_writes)
+{
+  page&=4095;
+  if(invalidations) *invalidations=page_invalidations[page];
+  if(recompilations) *recompilations=page_recompilations[page];
+  if(ignored_writes) *ignored_writes=(page<2048)?page_ignored_writes[page]:0;
+}
+
+static uint64_t stats_time_ns(void)
+{
+#if defined(WIN32)
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER counter;
+  if(freq.QuadPart==0) QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)(counter.QuadPart/freq.QuadPart)*1000000000ULL+
+         (uint64_t)(counter.QuadPart%freq.QuadPart)*1000000000ULL/freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+#endif
+}
+
+void new_dynarec_get_stats(struct new_dynarec_stats* out_stats)
+{
+  *out_stats=stats;
+}
+
+void new_dynarec_print_stats(void)
+{
+  DebugMessage(M64MSG_INFO, "dynarec: %llu blocks, %llu KiB emitted, compile avg=%lluns max=%lluns",
+               (unsigned long long)stats.blocks_compiled,
+               (unsigned long long)(stats.bytes_emitted>>10),
+               (unsigned long long)(stats.blocks_compiled?stats.compile_ns/stats.blocks_compiled:0),
+               (unsigned long long)stats.compile_ns_max);
+  DebugMessage(M64MSG_INFO, "dynarec: %llu lookup misses, %llu dirty restores, %llu cache wraps, %llu helper instructions",
+               (unsigned long long)stats.addr_misses,
+               (unsigned long long)stats.dirty_restores,
+               (unsigned long long)stats.cache_wraps,
+               (unsigned long long)stats.helper_instructions);
+}
+
+// Log the pages that were invalidated the most, to spot self-modifying code
+static void report_page_stats(void)
+{
+  uint32_t top[8]={0};
+  int n,i,count=0;
+  for(n=0;n<4096;n++) {
+    if(!page_invalidations[n]) continue;
+    if(count<8) i=count++;
+    else if(page_invalidations[top[7]]>=page_invalidations[n]) continue;
+    else i=7;
+    for(;i>0&&page_invalidations[top[i-1]]<page_invalidations[n];i--)
+      top[i]=top[i-1];
+    top[i]=n;
+  }
+  for(i=0;i<count;i++) {
+    n=top[i];
+    DebugMessage(M64MSG_VERBOSE, "page %4d: %u invalidations, %u recompilations, %u writes ignored",
+                 n,page_invalidations[n],page_recompilations[n],(n<2048)?page_ignored_writes[n]:0);
+  }
+}
+
 // This is called when we write to a compiled block (see do_invstub)
 static void invalidate_page(uint32_t page)
 {
@@ -2238,10 +2740,9 @@ static void invalidate_page(uint32_t page)
 void invalidate_block(uint32_t block)
 {
   uint32_t page;
-  page=block^0x80000;
-  if(page>262143&&g_dev.r4300.cp0.tlb.LUT_r[block]) page=(g_dev.r4300.cp0.tlb.LUT_r[block]^0x80000000)>>12;
-  if(page>2048) page=2048+(page&2047);
+  page=get_page(block);
   inv_debug("INVALIDATE: %x (%d)\n",block<<12,page);
+  page_invalidations[page]++;
   uint32_t first,last;
   first=last=page;
   struct ll_entry *head;
@@ -2290,6 +2791,7 @@ void invalidate_block(uint32_t block)
   for(first=page+1;first<last;first++) {
     invalidate_page(first);
   }
+  update_code_lines(page>4?page-4:0,last);
   #if NEW_DYNAREC >= NEW_DYNAREC_ARM
     do_clear_cache();
   #endif
@@ -2317,6 +2819,7 @@ static void invalidate_all_pages(void)
   uint32_t page;
   for(page=0;page<4096;page++)
     invalidate_page(page);
+  memset(code_lines,0,sizeof(code_lines));
   for(page=0;page<1048576;page++)
   {
     if(!g_dev.r4300.cached_interp.invalid_code[page]) {
@@ -2360,7 +2863,10 @@ void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t addre
 
         for(i = begin; i <= end; ++i) {
             if(r4300->cached_interp.invalid_code[i] == 0) {
-                invalidate_block(i);
+                uint32_t first = (i == begin) ? (address & 0xfff) : 0;
+                uint32_t last = (i == end) ? ((address+size-1) & 0xfff) : 0xfff;
+                if(writes_code(i, first, last-first+1))
+                    invalidate_block(i);
             }
         }
     }
@@ -2414,6 +2920,8 @@ void clean_blocks(uint32_t page)
               //DebugMessage(M64MSG_VERBOSE, "page=%x, addr=%x",page,head->vaddr);
               //assert(head->vaddr>>12==(page|0x80000));
               struct ll_entry *clean_head=ll_add_32(jump_in+ppage,head->vaddr,head->reg32,head->clean_addr,head->clean_addr,head->start,head->copy,head->length);
+              mark_code_lines(clean_head,ppage);
+              stats.dirty_restores++;
               struct ll_entry **ht_bin=hash_table[((head->vaddr>>16)^head->vaddr)&0xFFFF];
               if(!head->reg32) {
                 if(ht_bin[0]&&ht_bin[0]->vaddr==head->vaddr) {
@@ -3880,8 +4388,14 @@ static void load_assemble(int i,struct regstat *i_regs)
   if(offset||s<0||c) addr=temp;
   else addr=s;
   assert(tl>=0); // Even if the load is a NOP, we must check for pagefaults and I/O
+  int dummy=(rt1[i]==0)||(tl!=get_reg(i_regs->regmap,rt1[i])); // ignore loads to r0 and unneeded reg
+  int fastmem=0;
+  #if defined(HAVE_FASTMEM) && !defined(INTERPRET_LOAD)
+  // Dummy loads don't touch memory, so they keep the explicit range check
+  fastmem=fastmem_arena&&!using_tlb&&!c&&!dummy;
+  #endif
   if(!using_tlb) {
-    if(!c) {
+    if(!c&&!fastmem) {
 //#define R29_HACK 1
       #ifdef R29_HACK
       // Strmnnrmn's speed hack
@@ -3928,7 +4442,7 @@ static void load_assemble(int i,struct regstat *i_regs)
     do_tlb_r_branch_debug(map,c,constmap[i][s]+offset,&jaddr);
 #endif
   }
-  int dummy=(rt1[i]==0)||(tl!=get_reg(i_regs->regmap,rt1[i])); // ignore loads to r0 and unneeded reg
+  if(fastmem) jaddr=(intptr_t)out;
   if (opcode[i]==0x20) { // LB
     if(!c||memtarget) {
       if(!dummy) {
@@ -3944,8 +4458,10 @@ static void load_assemble(int i,struct regstat *i_regs)
           emit_movsbl_indexed_tlb(x,temp,map,tl);
         }
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,temp==addr?addr:-1,3);
         add_stub(LOADB_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADB_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -3965,8 +4481,10 @@ static void load_assemble(int i,struct regstat *i_regs)
           emit_movswl_indexed_tlb(x,temp,map,tl);
         }
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,temp==addr?addr:-1,2);
         add_stub(LOADH_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADH_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -3981,8 +4499,10 @@ static void load_assemble(int i,struct regstat *i_regs)
         #endif
         emit_readword_indexed_tlb(0,addr,map,tl);
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,-1,0);
         add_stub(LOADW_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADW_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -4002,8 +4522,10 @@ static void load_assemble(int i,struct regstat *i_regs)
           emit_movzbl_indexed_tlb(x,temp,map,tl);
         }
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,temp==addr?addr:-1,3);
         add_stub(LOADBU_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADBU_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -4023,8 +4545,10 @@ static void load_assemble(int i,struct regstat *i_regs)
           emit_movzwl_indexed_tlb(x,temp,map,tl);
         }
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,temp==addr?addr:-1,2);
         add_stub(LOADHU_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADHU_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -4040,8 +4564,10 @@ static void load_assemble(int i,struct regstat *i_regs)
         #endif
         emit_readword_indexed_tlb(0,addr,map,tl);
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,-1,0);
         add_stub(LOADW_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else {
       inline_readstub(LOADW_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -4058,8 +4584,10 @@ static void load_assemble(int i,struct regstat *i_regs)
         #endif
         emit_readdword_indexed_tlb(0,addr,map,th,tl);
       }
-      if(jaddr)
+      if(jaddr) {
+        if(fastmem) fastmem_end_site(jaddr,-1,0);
         add_stub(LOADD_STUB,jaddr,(intptr_t)out,i,addr,(intptr_t)i_regs,ccadj[i],reglist);
+      }
     }
     else
       inline_readstub(LOADD_STUB,i,constmap[i][s]+offset,i_regs->regmap,rt1[i],ccadj[i],reglist);
@@ -4107,6 +4635,10 @@ static void store_assemble(int i,struct regstat *i_regs)
   if(i_regs->regmap[HOST_CCREG]==CCREG) reglist&=~(1<<HOST_CCREG);
   if(offset||s<0||c) addr=temp;
   else addr=s;
+  int fastmem=0;
+  #if defined(HAVE_FASTMEM) && !defined(INTERPRET_STORE)
+  fastmem=fastmem_arena&&!using_tlb&&!c;
+  #endif
   if(!using_tlb) {
     if(!c) {
       #ifdef R29_HACK
@@ -4114,6 +4646,7 @@ static void store_assemble(int i,struct regstat *i_regs)
       memtarget=1;
       if(rs1[i]!=29||start<0x80001000||start>=0x80800000)
       #endif
+      if(!fastmem)
       emit_cmpimm(addr,0x800000);
       #ifdef DESTRUCTIVE_SHIFT
       if(s==addr) emit_mov(s,temp);
@@ -4121,6 +4654,7 @@ static void store_assemble(int i,struct regstat *i_regs)
       #ifdef R29_HACK
       if(rs1[i]!=29||start<0x80001000||start>=0x80800000)
       #endif
+      if(!fastmem)
       {
 #ifndef INTERPRET_STORE
         jaddr=(intptr_t)out;
@@ -4157,6 +4691,7 @@ static void store_assemble(int i,struct regstat *i_regs)
 #endif
   }
 
+  if(fastmem) jaddr=(intptr_t)out;
   if (opcode[i]==0x28) { // SB
     if(!c||memtarget) {
       int x=0;
@@ -4192,6 +4727,18 @@ static void store_assemble(int i,struct regstat *i_regs)
     }
     type=STORED_STUB;
   }
+  if(fastmem) {
+    // SB/SH xor the address in place when it is also the stub's address register
+    #ifdef DESTRUCTIVE_SHIFT
+    int stub_addr=temp;
+    #else
+    int stub_addr=addr;
+    #endif
+    if((type==STOREB_STUB||type==STOREH_STUB)&&temp==stub_addr)
+      fastmem_end_site(jaddr,temp,type==STOREB_STUB?3:2);
+    else
+      fastmem_end_site(jaddr,-1,0);
+  }
   if(!using_tlb) {
     if(!c||memtarget) {
       #ifdef DESTRUCTIVE_SHIFT
@@ -5643,6 +6190,26 @@ static void ds_assemble_entry(int i)
   emit_jmp(0);
 }
 
+// Branch back over a loop which only polls memory (see idle_loop.c)
+static int is_idle_loop(int i)
+{
+  #ifdef CORTEX_A8_BRANCH_PREDICTION_HACK
+  // Backward branches are always inverted there and the inverted path
+  // links them directly, leaving no place for the idle_cc exit. Not supported.
+  (void)i;
+  return 0;
+  #else
+  int t;
+  if(!r4300_idle_loop_skip) return 0;
+  if(!internal_branch(branch_regs[i].is32,ba[i])) return 0;
+  if(ba[i]<start||i+1>=slen) return 0;
+  t=(ba[i]-start)>>2;
+  if(t>i||is_ds[t]) return 0;
+  if(idle_vetoed[(ba[i]>>2)&(IDLE_VETO_SIZE-1)]==ba[i]) return 0;
+  return r4300_idle_loop(start+t*4,source+t,i-t+2);
+  #endif
+}
+
 static void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int invert)
 {
   int count;
@@ -5673,6 +6240,13 @@ static void do_cc(int i,signed char i_regmap[],int *adj,int addr,int taken,int i
     jaddr=(intptr_t)out;
     emit_jmp(0);
   }
+  else if(taken==TAKEN && !invert && is_idle_loop(i)) {
+    // Polling loop, let cc_interrupt skip ahead to the next event
+    if(*adj==0) emit_addimm(HOST_CCREG,CLOCK_DIVIDER*(count+2),HOST_CCREG);
+    emit_writeword(HOST_CCREG,(intptr_t)&g_dev.r4300.new_dynarec_hot_state.idle_cc);
+    jaddr=(intptr_t)out;
+    emit_jmp(0);
+  }
   else if(*adj==0||invert) {
     emit_addimm_and_set_flags(CLOCK_DIVIDER*(count+2),HOST_CCREG);
     jaddr=(intptr_t)out;
@@ -6174,9 +6748,11 @@ static void cjump_assemble(int i,struct regstat *i_regs)
   int unconditional=0,nop=0;
   int only32=0;
   int invert=0;
+  int idle=0;
   int branch_internal=internal_branch(branch_regs[i].is32,ba[i]);
   if(i==(ba[i]-start)>>2) assem_debug("idle loop");
   if(!match) invert=1;
+  if(ooo[i]&&is_idle_loop(i)) idle=invert=1;
   #ifdef CORTEX_A8_BRANCH_PREDICTION_HACK
   if(i>(ba[i]-start)>>2) invert=1;
   #endif
@@ -6377,6 +6953,13 @@ static void cjump_assemble(int i,struct regstat *i_regs)
         {
           if(adj) emit_addimm(cc,-(int)CLOCK_DIVIDER*adj,cc);
           store_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
+          if(idle) {
+            // Polling loop, let cc_interrupt skip ahead to the next event
+            emit_writeword(cc,(intptr_t)&g_dev.r4300.new_dynarec_hot_state.idle_cc);
+            intptr_t jaddr=(intptr_t)out;
+            emit_jmp(0);
+            add_stub(CC_STUB,jaddr,(intptr_t)out,adj,i,ba[i],TAKEN,0);
+          }
           load_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
           if(branch_internal)
             assem_debug("branch: internal");
@@ -6563,9 +7146,11 @@ static void sjump_assemble(int i,struct regstat *i_regs)
   int unconditional=0,nevertaken=0;
   int only32=0;
   int invert=0;
+  int idle=0;
   int branch_internal=internal_branch(branch_regs[i].is32,ba[i]);
   if(i==(ba[i]-start)>>2) assem_debug("idle loop");
   if(!match) invert=1;
+  if(ooo[i]&&is_idle_loop(i)) idle=invert=1;
   #ifdef CORTEX_A8_BRANCH_PREDICTION_HACK
   if(i>(ba[i]-start)>>2) invert=1;
   #endif
@@ -6732,6 +7317,13 @@ static void sjump_assemble(int i,struct regstat *i_regs)
         {
           if(adj) emit_addimm(cc,-(int)CLOCK_DIVIDER*adj,cc);
           store_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
+          if(idle) {
+            // Polling loop, let cc_interrupt skip ahead to the next event
+            emit_writeword(cc,(intptr_t)&g_dev.r4300.new_dynarec_hot_state.idle_cc);
+            intptr_t jaddr=(intptr_t)out;
+            emit_jmp(0);
+            add_stub(CC_STUB,jaddr,(intptr_t)out,adj,i,ba[i],TAKEN,0);
+          }
           load_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
           if(branch_internal)
             assem_debug("branch: internal");
@@ -6879,9 +7471,11 @@ static void fjump_assemble(int i,struct regstat *i_regs)
   int fs,cs;
   intptr_t eaddr;
   int invert=0;
+  int idle=0;
   int branch_internal=internal_branch(branch_regs[i].is32,ba[i]);
   if(i==(ba[i]-start)>>2) assem_debug("idle loop");
   if(!match) invert=1;
+  if(ooo[i]&&is_idle_loop(i)) idle=invert=1;
   #ifdef CORTEX_A8_BRANCH_PREDICTION_HACK
   if(i>(ba[i]-start)>>2) invert=1;
   #endif
@@ -6958,6 +7552,13 @@ static void fjump_assemble(int i,struct regstat *i_regs)
         else if(match) emit_addnop(13);
         #endif
         store_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
+        if(idle) {
+          // Polling loop, let cc_interrupt skip ahead to the next event
+          emit_writeword(cc,(intptr_t)&g_dev.r4300.new_dynarec_hot_state.idle_cc);
+          intptr_t jaddr=(intptr_t)out;
+          emit_jmp(0);
+          add_stub(CC_STUB,jaddr,(intptr_t)out,adj,i,ba[i],TAKEN,0);
+        }
         load_regs_bt(branch_regs[i].regmap,branch_regs[i].is32,branch_regs[i].dirty,ba[i]);
         if(branch_internal)
           assem_debug("branch: internal");
@@ -7359,7 +7960,7 @@ static void pagespan_ds(void)
   dirty_entry_count++;
   do_dirty_stub_ds(head);
   head->clean_addr=(void *)out;
-  (void)ll_add(jump_in+page,vaddr,(void *)out,(void *)out,start,copy,slen*4);
+  mark_code_lines(ll_add(jump_in+page,vaddr,(void *)out,(void *)out,start,copy,slen*4),page);
   assert(regs[0].regmap_entry[HOST_CCREG]==CCREG);
   if(regs[0].regmap[HOST_CCREG]!=CCREG)
     wb_register(CCREG,regs[0].regmap_entry,regs[0].wasdirty,regs[0].was32);
@@ -7619,6 +8220,11 @@ void new_dynarec_init(void)
     hash_table[n][0]=hash_table[n][1]=NULL;
   memset(g_dev.r4300.new_dynarec_hot_state.mini_ht,-1,sizeof(g_dev.r4300.new_dynarec_hot_state.mini_ht));
   memset(g_dev.r4300.new_dynarec_hot_state.restore_candidate,0,sizeof(g_dev.r4300.new_dynarec_hot_state.restore_candidate));
+  memset(code_lines,0,sizeof(code_lines));
+  memset(page_invalidations,0,sizeof(page_invalidations));
+  memset(page_recompilations,0,sizeof(page_recompilations));
+  memset(page_ignored_writes,0,sizeof(page_ignored_writes));
+  memset(&stats,0,sizeof(stats));
   copy_size=0;
   expirep=16384; // Expiry pointer, +2 blocks
   g_dev.r4300.new_dynarec_hot_state.pending_exception=0;
@@ -7642,6 +8248,14 @@ void new_dynarec_init(void)
     g_dev.r4300.new_dynarec_hot_state.memory_map[n]=(uintptr_t)-1;
 
   tlb_speed_hacks();
+  memset(idle_vetoed,0,sizeof(idle_vetoed));
+  idle_veto_pending=0;
+#ifdef HAVE_FASTMEM
+  fastmem_init();
+#endif
+#ifdef HAVE_PERF_JIT
+  perf_init();
+#endif
   arch_init();
 }
 
@@ -7651,11 +8265,19 @@ void new_dynarec_cleanup(void)
   recomp_dbg_cleanup();
 #endif
 
+  new_dynarec_print_stats();
+  report_page_stats();
   int n;
   for(n=0;n<4096;n++) ll_clear(jump_in+n);
   for(n=0;n<4096;n++) ll_clear(jump_out+n);
   for(n=0;n<4096;n++) ll_clear(jump_dirty+n);
   assert(copy_size==0);
+#ifdef HAVE_FASTMEM
+  fastmem_cleanup();
+#endif
+#ifdef HAVE_PERF_JIT
+  perf_cleanup();
+#endif
 #if !defined(RECOMP_DBG)
 #if defined(WIN32)
   VirtualFree(base_addr, 0, MEM_RELEASE);
@@ -7674,6 +8296,7 @@ int new_recompile_block(int addr)
   recomp_dbg_block(addr);
 #endif
 
+  uint64_t compile_start=stats_time_ns();
   assem_debug("NOTCOMPILED: addr = %x -> %x", (int)addr, (intptr_t)out);
 #if COUNT_NOTCOMPILEDS
   notcompiledCount++;
@@ -7733,6 +8356,8 @@ int new_recompile_block(int addr)
   /* Pass 9: linker */
   /* Pass 10: garbage collection / free memory */
 
+  TRACE_BEGIN("new_recompile_block");
+
   int i,j;
   int done=0;
   unsigned int type,op,op2;
@@ -10690,6 +11315,7 @@ int new_recompile_block(int addr)
         case STORELR:
           storelr_assemble(i,&regs[i]);break;
         case COP0:
+          stats.helper_instructions++;
           cop0_assemble(i,&regs[i]);break;
         case COP1:
           cop1_assemble(i,&regs[i]);break;
@@ -10777,11 +11403,17 @@ int new_recompile_block(int addr)
       case LOADD_STUB:
       case LOADBU_STUB:
       case LOADHU_STUB:
+        #ifdef HAVE_FASTMEM
+        if(fastmem_stub[i].len) fastmem_add_site(i);
+        #endif
         do_readstub(i);break;
       case STOREB_STUB:
       case STOREH_STUB:
       case STOREW_STUB:
       case STORED_STUB:
+        #ifdef HAVE_FASTMEM
+        if(fastmem_stub[i].len) fastmem_add_site(i);
+        #endif
         do_writestub(i);break;
       case CC_STUB:
         do_ccstub(i);break;
@@ -10857,6 +11489,7 @@ int new_recompile_block(int addr)
           intptr_t entry_point=do_dirty_stub(i,head);
           head->clean_addr=(void*)entry_point;
           head=ll_add(jump_in+page,vaddr,(void *)entry_point,(void *)entry_point,start,copy,slen*4);
+          mark_code_lines(head,page);
           // If there was an existing entry in the hash table,
           // replace it with the new address.
           // Don't add new entries.  We'll insert the
@@ -10886,7 +11519,8 @@ int new_recompile_block(int addr)
           dirty_entry_count++;
           intptr_t entry_point=do_dirty_stub(i,head);
           head->clean_addr=(void*)entry_point;
-          (void)ll_add_32(jump_in+page,vaddr,r,(void *)entry_point,(void *)entry_point,start,copy,slen*4);
+          head=ll_add_32(jump_in+page,vaddr,r,(void *)entry_point,(void *)entry_point,start,copy,slen*4);
+          mark_code_lines(head,page);
         }
       }
     }
@@ -10907,11 +11541,19 @@ int new_recompile_block(int addr)
   intptr_t out_rx=((intptr_t)out-(intptr_t)base_addr)+(intptr_t)base_addr_rx;
   cache_flush((char *)beginning_rx,(char *)out_rx);
   #endif
+  perf_block(start,beginning,(uintptr_t)out);
+
+  stats.blocks_compiled++;
+  stats.bytes_emitted+=(uintptr_t)out-beginning;
 
   // If we're within 256K of the end of the buffer,
   // start over from the beginning. (Is 256K enough?)
-  if(out > (uint8_t *)((uint8_t *)base_addr+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE-JUMP_TABLE_SIZE))
+  if(out > (uint8_t *)((uint8_t *)base_addr+(1<<TARGET_SIZE_2)-MAX_OUTPUT_BLOCK_SIZE-JUMP_TABLE_SIZE)) {
     out=(uint8_t *)base_addr;
+    stats.cache_wraps++;
+  }
+
+  page_recompilations[get_page(start>>12)]++;
 
   // Trap writes to any of the pages we compiled
   for(i=start>>12;i<=(int)((start+slen*4-4)>>12);i++) {
@@ -10974,6 +11616,12 @@ int new_recompile_block(int addr)
         #endif
         ll_remove_matching_addrs(jump_out+(expirep&2047),base,shift);
         ll_remove_matching_addrs(jump_out+2048+(expirep&2047),base,shift);
+        #ifdef HAVE_FASTMEM
+        // Blocks of this eighth are unreachable only once all its phases are done.
+        // Expiry stays ahead of out, so no new site has been added here yet.
+        if((expirep&2047)==2047)
+          fastmem_count[expirep>>13]=0;
+        #endif
         break;
     }
     expirep=(expirep+1)&65535;
@@ -10981,6 +11629,13 @@ int new_recompile_block(int addr)
 
   //recompile_end
 
+  uint64_t compile_ns=stats_time_ns()-compile_start;
+  stats.compile_ns+=compile_ns;
+  if(compile_ns>stats.compile_ns_max) stats.compile_ns_max=compile_ns;
+
+  TRACE_END("new_recompile_block");
+  TRACE_COUNTER("dynarec blocks", stats.blocks_compiled);
+
   return 0;
 }
 
@@ -32,6 +32,11 @@
 #define NEW_DYNAREC_ARM 3
 #define NEW_DYNAREC_ARM64 4
 
+/* new_dynarec_perf_mode values */
+#define NEW_DYNAREC_PERF_OFF 0
+#define NEW_DYNAREC_PERF_MAP 1
+#define NEW_DYNAREC_PERF_JITDUMP 2
+
 #define WRITE_PROTECT ((uintptr_t)1<<((sizeof(uintptr_t)<<3)-2))
 
 struct r4300_core;
@@ -57,6 +62,7 @@ struct new_dynarec_hot_state
     int pending_exception;
     int pcaddr;
     int stop;
+    int idle_cc;
     char* invc_ptr;
     uint32_t address;
     uint64_t rdword;
@@ -86,10 +92,28 @@ struct new_dynarec_hot_state
 #endif
 };
 
+/* Recompiler activity since new_dynarec_init */
+struct new_dynarec_stats
+{
+    uint64_t blocks_compiled;
+    uint64_t bytes_emitted;
+    uint64_t compile_ns;           /* total time spent in new_recompile_block */
+    uint64_t compile_ns_max;       /* slowest single block */
+    uint64_t addr_misses;          /* lookups that missed the hash table */
+    uint64_t dirty_restores;       /* dirty blocks moved back to the clean list */
+    uint64_t cache_wraps;          /* times the code cache restarted from its beginning */
+    uint64_t helper_instructions;  /* instructions compiled as calls to C handlers */
+};
+
 extern unsigned int stop_after_jal;
 extern unsigned int using_tlb;
+extern int new_dynarec_fastmem;
+extern int new_dynarec_perf_mode;
 
 void invalidate_cached_code_new_dynarec(struct r4300_core* r4300, uint32_t address, size_t size);
+void new_dynarec_get_page_stats(uint32_t page, uint32_t* invalidations, uint32_t* recompilations, uint32_t* ignored_writes);
+void new_dynarec_get_stats(struct new_dynarec_stats* stats);
+void new_dynarec_print_stats(void);
 void new_dynarec_init(void);
 void new_dyna_start(void);
 void new_dynarec_cleanup(void);
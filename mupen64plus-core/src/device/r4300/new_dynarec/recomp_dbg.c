@@ -360,7 +360,7 @@ static Function_t func[] = {
   {(intptr_t)cached_interp_DMULTU, "DMULTU"},
   {(intptr_t)cached_interp_DDIV, "DDIV"},
   {(intptr_t)cached_interp_DDIVU, "DDIVU"},
-#if RECOMPILER_DEBUG == NEW_DYNAREC_X86 || RECOMPILER_DEBUG == NEW_DYNAREC_X64
+#if RECOMPILER_DEBUG == NEW_DYNAREC_X86
   {(intptr_t)jump_vaddr_eax, "jump_vaddr_eax"},
   {(intptr_t)jump_vaddr_ecx, "jump_vaddr_ecx"},
   {(intptr_t)jump_vaddr_edx, "jump_vaddr_edx"},
@@ -374,6 +374,20 @@ static Function_t func[] = {
   {(intptr_t)invalidate_block_ebp, "invalidate_block_ebp"},
   {(intptr_t)invalidate_block_esi, "invalidate_block_esi"},
   {(intptr_t)invalidate_block_edi, "invalidate_block_edi"},
+#elif RECOMPILER_DEBUG == NEW_DYNAREC_X64
+  {(intptr_t)jump_vaddr_eax, "jump_vaddr_eax"},
+  {(intptr_t)jump_vaddr_ecx, "jump_vaddr_ecx"},
+  {(intptr_t)jump_vaddr_edx, "jump_vaddr_edx"},
+  {(intptr_t)jump_vaddr_ebx, "jump_vaddr_ebx"},
+  {(intptr_t)jump_vaddr_ebp, "jump_vaddr_ebp"},
+  {(intptr_t)jump_vaddr_edi, "jump_vaddr_edi"},
+  {(intptr_t)invalidate_addr_eax, "invalidate_addr_eax"},
+  {(intptr_t)invalidate_addr_ecx, "invalidate_addr_ecx"},
+  {(intptr_t)invalidate_addr_edx, "invalidate_addr_edx"},
+  {(intptr_t)invalidate_addr_ebx, "invalidate_addr_ebx"},
+  {(intptr_t)invalidate_addr_ebp, "invalidate_addr_ebp"},
+  {(intptr_t)invalidate_addr_esi, "invalidate_addr_esi"},
+  {(intptr_t)invalidate_addr_edi, "invalidate_addr_edi"},
 #elif RECOMPILER_DEBUG == NEW_DYNAREC_ARM
   {(intptr_t)invalidate_addr, "invalidate_addr"},
   {(intptr_t)jump_vaddr_r0, "jump_vaddr_r0"},
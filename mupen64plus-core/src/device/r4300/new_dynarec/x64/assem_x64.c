@@ -25,13 +25,13 @@ void jump_vaddr_ebx(void);
 void jump_vaddr_ebp(void);
 void jump_vaddr_esi(void);
 void jump_vaddr_edi(void);
-void invalidate_block_eax(void);
-void invalidate_block_ecx(void);
-void invalidate_block_edx(void);
-void invalidate_block_ebx(void);
-void invalidate_block_ebp(void);
-void invalidate_block_esi(void);
-void invalidate_block_edi(void);
+void invalidate_addr_eax(void);
+void invalidate_addr_ecx(void);
+void invalidate_addr_edx(void);
+void invalidate_addr_ebx(void);
+void invalidate_addr_ebp(void);
+void invalidate_addr_esi(void);
+void invalidate_addr_edi(void);
 
 // We need these for cmovcc instructions on x64
 static const uint32_t const_zero=0;
@@ -55,15 +55,15 @@ static const uintptr_t jump_vaddr_reg[8] = {
 #endif
   (uintptr_t)jump_vaddr_edi };
 
-static const uintptr_t invalidate_block_reg[8] = {
-  (uintptr_t)invalidate_block_eax,
-  (uintptr_t)invalidate_block_ecx,
-  (uintptr_t)invalidate_block_edx,
-  (uintptr_t)invalidate_block_ebx,
+static const uintptr_t invalidate_addr_reg[8] = {
+  (uintptr_t)invalidate_addr_eax,
+  (uintptr_t)invalidate_addr_ecx,
+  (uintptr_t)invalidate_addr_edx,
+  (uintptr_t)invalidate_addr_ebx,
   0,
-  (uintptr_t)invalidate_block_ebp,
-  (uintptr_t)invalidate_block_esi,
-  (uintptr_t)invalidate_block_edi };
+  (uintptr_t)invalidate_addr_ebp,
+  (uintptr_t)invalidate_addr_esi,
+  (uintptr_t)invalidate_addr_edi };
 
 /* Linker */
 
@@ -2590,15 +2590,24 @@ static void emit_cmpmem_indexedsr12_reg(int base,int r,int imm)
 {
   assert(imm<128&&imm>=-127);
   assert(r>=0&&r<8);
-  emit_shrimm(r,12,r);
-  assem_debug("cmp $%d,(%%%s,%%%s)",imm,regname[r],regname[base]);
+  assert(base>=0&&base<8);
+  // Shift a copy so r still holds the full address for invalidate_addr
+  emit_mov(r,HOST_TEMPREG);
+  assem_debug("shr %%%s,12",regname[HOST_TEMPREG]);
+  output_rex(0,0,0,HOST_TEMPREG>>3);
+  output_byte(0xC1);
+  output_modrm(3,HOST_TEMPREG&7,5);
+  output_byte(12);
+  assem_debug("cmp $%d,(%%%s,%%%s)",imm,regname[base],regname[HOST_TEMPREG]);
+  output_rex(0,0,HOST_TEMPREG>>3,0);
   output_byte(0x80);
-  output_modrm(0,4,7);
-  assert(r!=base);
-  if(r!=EBP) {
-    output_sib(0,base,r);
+  if(base!=EBP) {
+    output_modrm(0,4,7);
+    output_sib(0,HOST_TEMPREG&7,base);
   }else{
-    output_sib(0,r,base);
+    output_modrm(1,4,7);
+    output_sib(0,HOST_TEMPREG&7,base);
+    output_byte(0);
   }
   output_byte(imm);
 }
@@ -3031,7 +3040,7 @@ static void emit_extjump2(intptr_t addr, int target, intptr_t linker)
 static void do_readstub(int n)
 {
   assem_debug("do_readstub %x",start+stubs[n][3]*4);
-  set_jump_target(stubs[n][1],(intptr_t)out);
+  if(stubs[n][1]) set_jump_target(stubs[n][1],(intptr_t)out);
   int type=stubs[n][0];
   int i=stubs[n][3];
   int addr=stubs[n][4];
@@ -3183,7 +3192,7 @@ static void inline_readstub(int type, int i, uint32_t addr, signed char regmap[]
 static void do_writestub(int n)
 {
   assem_debug("do_writestub %x",start+stubs[n][3]*4);
-  set_jump_target(stubs[n][1],(intptr_t)out);
+  if(stubs[n][1]) set_jump_target(stubs[n][1],(intptr_t)out);
   int type=stubs[n][0];
   int i=stubs[n][3];
   int addr=stubs[n][4];
@@ -3337,7 +3346,7 @@ static void do_invstub(int n)
   uint32_t reglist=stubs[n][3];
   set_jump_target(stubs[n][1],(intptr_t)out);
   save_caller_regs(reglist);
-  emit_call((intptr_t)invalidate_block_reg[stubs[n][4]]);
+  emit_call((intptr_t)invalidate_addr_reg[stubs[n][4]]);
   restore_caller_regs(reglist);
   emit_jmp(stubs[n][2]); // return address
 }
@@ -4808,6 +4817,36 @@ static void wb_valid(signed char pre[],signed char entry[],uint32_t dirty_pre,ui
 static void literal_pool(int n) {}
 static void literal_pool_jumpover(int n) {}
 
+#ifdef HAVE_FASTMEM
+static void emit_fastmem_padding(intptr_t site)
+{
+  // Leave room for the jmp written over the site when it faults
+  while((intptr_t)out-site<FASTMEM_PATCH_SIZE) {
+    assem_debug("nop");
+    output_byte(0x90);
+  }
+}
+
+static void fastmem_patch_jump(uint8_t *site,intptr_t stub)
+{
+  int32_t rel=stub-((intptr_t)site+5);
+  site[0]=0xe9;
+  memcpy(site+1,&rel,4);
+}
+
+static uintptr_t *fastmem_context_pc(void *context)
+{
+  return (uintptr_t *)&((ucontext_t *)context)->uc_mcontext.gregs[REG_RIP];
+}
+
+static uintptr_t *fastmem_context_reg(void *context,int r)
+{
+  static const int gregs[16]={REG_RAX,REG_RCX,REG_RDX,REG_RBX,REG_RSP,REG_RBP,REG_RSI,REG_RDI,
+                              REG_R8,REG_R9,REG_R10,REG_R11,REG_R12,REG_R13,REG_R14,REG_R15};
+  return (uintptr_t *)&((ucontext_t *)context)->uc_mcontext.gregs[gregs[r]];
+}
+#endif
+
 // CPU-architecture-specific initialization
 static void arch_init()
 {
@@ -4817,4 +4856,8 @@ static void arch_init()
   g_dev.r4300.new_dynarec_hot_state.rounding_modes[3]=0x73F; // floor
 
   g_dev.r4300.new_dynarec_hot_state.ram_offset=(intptr_t)g_dev.rdram.dram-(intptr_t)0x80000000LL;
+#ifdef HAVE_FASTMEM
+  // RDRAM is also mapped at fastmem_arena+0x80000000
+  if(fastmem_arena) g_dev.r4300.new_dynarec_hot_state.ram_offset=(intptr_t)fastmem_arena;
+#endif
 }
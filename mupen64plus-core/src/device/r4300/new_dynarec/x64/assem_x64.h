@@ -40,6 +40,10 @@
 //#define DESTRUCTIVE_WRITEBACK 1
 #define DESTRUCTIVE_SHIFT 1
 #define USE_MINI_HT 1
+#if defined(__linux__) && !defined(RECOMP_DBG)
+#define HAVE_FASTMEM 1
+#define FASTMEM_PATCH_SIZE 5 // jmp rel32
+#endif
 
 #define TARGET_SIZE_2 25 // 2^25 = 32 megabytes
 #define JUMP_TABLE_SIZE 0 // Not needed for x86
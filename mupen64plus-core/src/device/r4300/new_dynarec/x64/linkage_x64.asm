@@ -101,13 +101,13 @@ cglobal fp_exception_ds
 cglobal jump_syscall
 cglobal jump_eret
 cglobal new_dyna_start
-cglobal invalidate_block_eax
-cglobal invalidate_block_ecx
-cglobal invalidate_block_edx
-cglobal invalidate_block_ebx
-cglobal invalidate_block_ebp
-cglobal invalidate_block_esi
-cglobal invalidate_block_edi
+cglobal invalidate_addr_eax
+cglobal invalidate_addr_ecx
+cglobal invalidate_addr_edx
+cglobal invalidate_addr_ebx
+cglobal invalidate_addr_ebp
+cglobal invalidate_addr_esi
+cglobal invalidate_addr_edi
 cglobal breakpoint
 
 cextern base_addr
@@ -116,7 +116,7 @@ cextern get_addr_ht
 cextern get_addr
 cextern dynarec_gen_interrupt
 cextern clean_blocks
-cextern invalidate_block
+cextern invalidate_addr
 cextern new_dynarec_check_interrupt
 cextern get_addr_32
 cextern g_dev
@@ -349,36 +349,36 @@ new_dyna_start:
     mov     rax,    QWORD[rel base_addr]
     jmp     rax
     
-invalidate_block_eax:
+invalidate_addr_eax:
     mov     ARG1_REG,    eax
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_edi:
+invalidate_addr_edi:
     mov     ARG1_REG,    edi
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_edx:
+invalidate_addr_edx:
     mov     ARG1_REG,    edx
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_ebx:
+invalidate_addr_ebx:
     mov     ARG1_REG,    ebx
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_ebp:
+invalidate_addr_ebp:
     mov     ARG1_REG,    ebp
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_esi:
+invalidate_addr_esi:
     mov     ARG1_REG,    esi
-    jmp     invalidate_block_call
+    jmp     invalidate_addr_call
 
-invalidate_block_ecx:
+invalidate_addr_ecx:
     mov     ARG1_REG,    ecx
 
-invalidate_block_call:
+invalidate_addr_call:
     add     rsp,    -8
-    call    invalidate_block
+    call    invalidate_addr
     add     rsp,    8
     ret
 
@@ -76,18 +76,14 @@ static void InterpretOpcode(struct r4300_core* r4300);
    } \
    static void name##_IDLE(struct r4300_core* r4300, uint32_t op) \
    { \
-      uint32_t* cp0_regs = r4300_cp0_regs(&r4300->cp0); \
       const int take_jump = (condition); \
-      int skip; \
       if (cop1 && check_cop1_unusable(r4300)) return; \
       if (take_jump) \
       { \
          cp0_update_count(r4300); \
-         skip = *r4300_cp0_next_interrupt(&r4300->cp0) - cp0_regs[CP0_COUNT_REG]; \
-         if (skip > 3) cp0_regs[CP0_COUNT_REG] += (skip & UINT32_C(0xFFFFFFFC)); \
-         else name(r4300, op); \
+         if (!r4300_idle_jump(r4300)) return; \
       } \
-      else name(r4300, op); \
+      name(r4300, op); \
    }
 
 #define RD_OF(op)      (((op) >> 11) & 0x1F)
@@ -102,20 +98,25 @@ static void InterpretOpcode(struct r4300_core* r4300);
 #define JUMP_OF(op)    ((op) & UINT32_C(0x3FFFFFF))
 
 /* Determines whether a relative jump in a 16-bit immediate goes back to the
- * same instruction without doing any work in its delay slot. The jump is
- * relative to the instruction in the delay slot, so 1 instruction backwards
- * (-1) goes back to the jump. */
+ * same instruction without doing any work in its delay slot, or, with
+ * r4300_idle_loop_skip, back over a loop which only polls memory (see
+ * idle_loop.c). The jump is relative to the instruction in the delay slot,
+ * so 1 instruction backwards (-1) goes back to the jump. */
 #define IS_RELATIVE_IDLE_LOOP(r4300, op, addr) \
-	(IMM16S_OF(op) == -1 && *fast_mem_access((r4300), (addr) + 4) == 0)
+	(r4300_idle_loop_skip \
+	 ? (IMM16S_OF(op) < 0 && IMM16S_OF(op) >= -IDLE_LOOP_MAX_LENGTH \
+	    && r4300_idle_loop_cached((r4300), (addr) + 4 + IMM16S_OF(op) * 4, (addr))) \
+	 : (IMM16S_OF(op) == -1 && *fast_mem_access((r4300), (addr) + 4) == 0))
 
-/* Determines whether an absolute jump in a 26-bit immediate goes back to the
- * same instruction without doing any work in its delay slot. The jump is
- * in the same 256 MiB segment as the delay slot, so if the jump instruction
- * is at the last address in its segment, it does not jump back to itself. */
+/* Same for an absolute jump in a 26-bit immediate. The jump is in the same
+ * 256 MiB segment as the delay slot, so if the jump instruction is at the
+ * last address in its segment, it does not jump back into its own loop. */
 #define IS_ABSOLUTE_IDLE_LOOP(r4300, op, addr) \
-	(JUMP_OF(op) == ((addr) & UINT32_C(0x0FFFFFFF)) >> 2 \
-	 && ((addr) & UINT32_C(0x0FFFFFFF)) != UINT32_C(0x0FFFFFFC) \
-	 && *fast_mem_access((r4300), (addr) + 4) == 0)
+	(((addr) & UINT32_C(0x0FFFFFFF)) != UINT32_C(0x0FFFFFFC) \
+	 && (r4300_idle_loop_skip \
+	     ? r4300_idle_loop_cached((r4300), ((addr) & UINT32_C(0xF0000000)) | (JUMP_OF(op) << 2), (addr)) \
+	     : (JUMP_OF(op) == ((addr) & UINT32_C(0x0FFFFFFF)) >> 2 \
+	        && *fast_mem_access((r4300), (addr) + 4) == 0)))
 
 /* These macros parse opcode fields. */
 #define rrt r4300_regs(r4300)[RT_OF(op)]
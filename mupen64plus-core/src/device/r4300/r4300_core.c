@@ -116,6 +116,8 @@ void poweron_r4300(struct r4300_core* r4300)
 
     /* setup CP1 registers */
     poweron_cp1(&r4300->cp1);
+
+    memset(&r4300->idle, 0, sizeof(r4300->idle));
 }
 
 
@@ -190,6 +192,7 @@ void run_r4300(struct r4300_core* r4300)
 #endif
 
     DebugMessage(M64MSG_INFO, "R4300 emulator finished.");
+    r4300_idle_report(r4300);
 
     /* print instruction counts */
 #if defined(COUNT_INSTR)
@@ -401,6 +404,10 @@ void invalidate_r4300_cached_code(struct r4300_core* r4300, uint32_t address, si
             invalidate_cached_code_hacktarux(r4300, address, size);
         }
     }
+    else
+    {
+        r4300_idle_invalidate(&r4300->idle, address, size);
+    }
 }
 
 
@@ -31,6 +31,7 @@
 
 #include "cp0.h"
 #include "cp1.h"
+#include "idle_loop.h"
 
 #include "recomp_types.h" /* for precomp_instr, regcache_state */
 
@@ -188,6 +189,8 @@ struct r4300_core
 
     struct cp0 cp0;
 
+    struct r4300_idle idle;
+
     struct cp1 cp1;
 
     struct memory* mem;
@@ -173,6 +173,9 @@ void read_ai_regs(void* opaque, uint32_t address, uint32_t* value)
 
     if (reg == AI_LEN_REG)
     {
+        /* derived from the count, don't skip loops polling it */
+        ai->mi->r4300->idle.count_read = 1;
+
         *value = get_remaining_dma_length(ai);
         if (*value < ai->last_read)
         {
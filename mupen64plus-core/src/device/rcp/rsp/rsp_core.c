@@ -33,6 +33,7 @@
 #if defined(PROFILE)
 #include "main/profile.h"
 #endif
+#include "main/trace.h"
 #include "plugin/plugin.h"
 
 static void dma_sp_write(struct rsp_core* sp)
@@ -266,6 +267,8 @@ void do_SP_Task(struct rsp_core* sp)
 
     uint32_t sp_delay_time;
 
+    TRACE_BEGIN("do_SP_Task");
+
     if (sp->mem[0xfc0/4] == 1)
     {
         unprotect_framebuffers(&sp->dp->fb);
@@ -337,6 +340,8 @@ void do_SP_Task(struct rsp_core* sp)
 
     sp->regs[SP_STATUS_REG] &=
         ~(SP_STATUS_TASKDONE | SP_STATUS_BROKE | SP_STATUS_HALT);
+
+    TRACE_END("do_SP_Task");
 }
 
 void rsp_interrupt_event(void* opaque)
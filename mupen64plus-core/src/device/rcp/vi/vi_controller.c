@@ -92,6 +92,9 @@ void read_vi_regs(void* opaque, uint32_t address, uint32_t* value)
         /* XXX: update current line number */
         cp0_update_count(vi->mi->r4300);
 
+        /* derived from the count, don't skip loops polling it */
+        vi->mi->r4300->idle.count_read = 1;
+
         if (vi->regs[VI_V_SYNC_REG] != 0)
             vi->regs[VI_CURRENT_REG] = (vi->delay - (vi->next_vi - cp0_regs[CP0_COUNT_REG])) / vi->count_per_scanline;
 
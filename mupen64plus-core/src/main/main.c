@@ -29,6 +29,7 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -329,6 +330,54 @@ void main_state_save(int format, const char *filename)
         savestates_set_job(savestates_job_save, (savestates_type)format, filename);
 }
 
+static m64p_error main_dynarec_stats_query(m64p_core_param param, int *rval)
+{
+#ifdef NEW_DYNAREC
+    struct new_dynarec_stats stats;
+    uint64_t value;
+
+    if (!g_EmulatorRunning)
+        return M64ERR_INVALID_STATE;
+    if (get_r4300_emumode(&g_dev.r4300) != EMUMODE_DYNAREC)
+        return M64ERR_UNSUPPORTED;
+
+    new_dynarec_get_stats(&stats);
+    switch (param)
+    {
+        case M64CORE_DYNAREC_BLOCKS_COMPILED:
+            value = stats.blocks_compiled;
+            break;
+        case M64CORE_DYNAREC_BYTES_EMITTED:
+            value = stats.bytes_emitted >> 10;
+            break;
+        case M64CORE_DYNAREC_COMPILE_TIME_AVG:
+            value = stats.blocks_compiled ? stats.compile_ns / stats.blocks_compiled : 0;
+            break;
+        case M64CORE_DYNAREC_COMPILE_TIME_MAX:
+            value = stats.compile_ns_max;
+            break;
+        case M64CORE_DYNAREC_ADDR_MISSES:
+            value = stats.addr_misses;
+            break;
+        case M64CORE_DYNAREC_DIRTY_RESTORES:
+            value = stats.dirty_restores;
+            break;
+        case M64CORE_DYNAREC_CACHE_WRAPS:
+            value = stats.cache_wraps;
+            break;
+        default:
+            value = stats.helper_instructions;
+            break;
+    }
+
+    /* the query API only returns an int, saturate long running counters */
+    *rval = (value > INT_MAX) ? INT_MAX : (int)value;
+    return M64ERR_SUCCESS;
+#else
+    return M64ERR_UNSUPPORTED;
+#endif
+}
+
 m64p_error main_core_state_query(m64p_core_param param, int *rval)
 {
     switch (param)
@@ -378,6 +427,15 @@ m64p_error main_core_state_query(m64p_core_param param, int *rval)
         case M64CORE_STATE_LOADCOMPLETE:
         case M64CORE_STATE_SAVECOMPLETE:
             return M64ERR_INPUT_INVALID;
+        case M64CORE_DYNAREC_BLOCKS_COMPILED:
+        case M64CORE_DYNAREC_BYTES_EMITTED:
+        case M64CORE_DYNAREC_COMPILE_TIME_AVG:
+        case M64CORE_DYNAREC_COMPILE_TIME_MAX:
+        case M64CORE_DYNAREC_ADDR_MISSES:
+        case M64CORE_DYNAREC_DIRTY_RESTORES:
+        case M64CORE_DYNAREC_CACHE_WRAPS:
+        case M64CORE_DYNAREC_HELPER_INSTRUCTIONS:
+            return main_dynarec_stats_query(param, rval);
         default:
             return M64ERR_INPUT_INVALID;
     }
@@ -852,6 +910,13 @@ m64p_error main_run(void)
     if (ForceDisableExtraMem == 1)
         disable_extra_mem = 1;
 
+    r4300_idle_loop_skip = EnableIdleLoopSkip;
+
+#ifdef NEW_DYNAREC
+    new_dynarec_fastmem = EnableDynarecFastmem;
+    new_dynarec_perf_mode = DynarecPerfMode;
+#endif
+
     rdram_size = (disable_extra_mem == 0) ? 0x800000 : 0x400000;
 
     if (count_per_op <= 0)
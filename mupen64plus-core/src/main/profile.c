@@ -25,6 +25,9 @@
 
 #include "api/callbacks.h"
 #include "api/m64p_types.h"
+#if defined(NEW_DYNAREC)
+#include "device/r4300/new_dynarec/new_dynarec.h"
+#endif
 
 static long long int time_in_section[NUM_TIMED_SECTIONS];
 static long long int last_start[NUM_TIMED_SECTIONS];
@@ -95,5 +98,8 @@ void timed_sections_refresh()
       time_in_section[TIMED_SECTION_COMPILER] = 0;
       time_in_section[TIMED_SECTION_IDLE] = 0;
       last_start[TIMED_SECTION_ALL] = curr_time;
+#if defined(NEW_DYNAREC)
+      new_dynarec_print_stats();
+#endif
    }
 }
@@ -0,0 +1,237 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.c                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "trace.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "api/callbacks.h"
+#include "api/m64p_types.h"
+
+#if !defined(WIN32)
+#include <time.h>
+#endif
+
+/* events per track, must be a power of two */
+#define TRACE_RING_SIZE 65536
+#define TRACE_MAX_TRACKS 16
+
+/* sentinel for threads which found no free track */
+#define TRACE_NO_TRACK (-2)
+
+struct trace_event
+{
+    uint64_t time;
+    const char* name;
+    int64_t value;
+    enum trace_event_type type;
+};
+
+struct trace_track
+{
+    char name[32];
+    /* number of events recorded, only written by the track owner */
+    atomic_uint_fast64_t head;
+    /* set once the track is ready to be read */
+    _Atomic(struct trace_event*) events;
+};
+
+int g_trace_enabled;
+
+static struct trace_track l_tracks[TRACE_MAX_TRACKS];
+static atomic_int l_track_count;
+static uint64_t l_start_time;
+static _Thread_local int l_current_track = -1;
+
+static uint64_t get_time(void)
+{
+#if defined(WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER counter;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / freq.QuadPart) * 1000000000 +
+           (uint64_t)(counter.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+int trace_track_create(const char* name)
+{
+    struct trace_track* track;
+    struct trace_event* events;
+    int index;
+
+    /* claim the slot first, so that tracks never need a lock */
+    index = atomic_fetch_add(&l_track_count, 1);
+    if (index >= TRACE_MAX_TRACKS)
+        return -1;
+
+    events = malloc(TRACE_RING_SIZE * sizeof(*events));
+    if (events == NULL)
+        return -1;
+
+    track = &l_tracks[index];
+    if (name != NULL)
+        snprintf(track->name, sizeof(track->name), "%s", name);
+    else
+        snprintf(track->name, sizeof(track->name), "thread %d", index);
+    atomic_store_explicit(&track->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&track->events, events, memory_order_release);
+
+    return index;
+}
+
+int trace_track_swap(int track)
+{
+    int previous = l_current_track;
+    l_current_track = track;
+    return previous;
+}
+
+void trace_record(enum trace_event_type type, const char* name, int64_t value)
+{
+    struct trace_track* track;
+    struct trace_event* event;
+    uint_fast64_t head;
+
+    if (l_current_track < 0)
+    {
+        if (l_current_track == TRACE_NO_TRACK)
+            return;
+        l_current_track = trace_track_create(NULL);
+        if (l_current_track < 0)
+        {
+            l_current_track = TRACE_NO_TRACK;
+            return;
+        }
+    }
+
+    track = &l_tracks[l_current_track];
+    head = atomic_load_explicit(&track->head, memory_order_relaxed);
+    event = &atomic_load_explicit(&track->events, memory_order_relaxed)[head & (TRACE_RING_SIZE - 1)];
+    event->time = get_time();
+    event->name = name;
+    event->value = value;
+    event->type = type;
+
+    /* publish the event to trace_stop */
+    atomic_store_explicit(&track->head, head + 1, memory_order_release);
+}
+
+void trace_start(void)
+{
+    int count = atomic_load(&l_track_count);
+    int i;
+
+    if (g_trace_enabled)
+        return;
+
+    if (count > TRACE_MAX_TRACKS)
+        count = TRACE_MAX_TRACKS;
+    for (i = 0; i < count; ++i)
+        atomic_store_explicit(&l_tracks[i].head, 0, memory_order_relaxed);
+
+    l_start_time = get_time();
+    g_trace_enabled = 1;
+    DebugMessage(M64MSG_INFO, "Tracing started");
+}
+
+static void write_track(FILE* f, int index, int* first)
+{
+    static const char phases[] = { 'B', 'E', 'C' };
+    struct trace_track* track = &l_tracks[index];
+    struct trace_event* events = atomic_load_explicit(&track->events, memory_order_acquire);
+    uint_fast64_t head, i;
+
+    /* the slot was claimed but the track is not ready yet */
+    if (events == NULL)
+        return;
+
+    fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            *first ? "" : ",", index, track->name);
+    *first = 0;
+
+    head = atomic_load_explicit(&track->head, memory_order_acquire);
+    for (i = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0; i < head; ++i)
+    {
+        const struct trace_event* event = &events[i & (TRACE_RING_SIZE - 1)];
+        uint64_t ts;
+
+        if (event->time < l_start_time)
+            continue;
+
+        ts = event->time - l_start_time;
+        fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%d",
+                event->name, phases[event->type],
+                (unsigned long long)(ts / 1000), (unsigned int)(ts % 1000), index);
+        if (event->type == TRACE_EVENT_COUNTER)
+            fprintf(f, ",\"args\":{\"value\":%lld}", (long long)event->value);
+        fputc('}', f);
+    }
+}
+
+int trace_stop(const char* path)
+{
+    FILE* f;
+    int count;
+    int first = 1;
+    int i;
+
+    if (!g_trace_enabled)
+        return 0;
+    g_trace_enabled = 0;
+
+    if (path == NULL)
+        return 0;
+
+    f = fopen(path, "w");
+    if (f == NULL)
+    {
+        DebugMessage(M64MSG_ERROR, "Couldn't open trace file %s", path);
+        return -1;
+    }
+
+    count = atomic_load(&l_track_count);
+    if (count > TRACE_MAX_TRACKS)
+        count = TRACE_MAX_TRACKS;
+
+    fputs("{\"traceEvents\":[", f);
+    for (i = 0; i < count; ++i)
+        write_track(f, i, &first);
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", f);
+
+    if (fclose(f) != 0)
+    {
+        DebugMessage(M64MSG_ERROR, "Couldn't write trace file %s", path);
+        return -1;
+    }
+
+    DebugMessage(M64MSG_INFO, "Trace written to %s", path);
+    return 0;
+}
@@ -0,0 +1,93 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus - trace.h                                                 *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *   Copyright (C) 2026 Mupen64plus development team                       *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef M64P_MAIN_TRACE_H
+#define M64P_MAIN_TRACE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Event tracing shared by the core, the RSP and the video plugin.
+ *
+ * Each track (by default one per thread) records to its own ring buffer,
+ * so recording takes no lock. When the ring is full the oldest events are
+ * overwritten. While tracing is off, an instrumented point costs a single
+ * test of g_trace_enabled.
+ *
+ * Event names must be string literals: only the pointer is recorded. */
+
+enum trace_event_type
+{
+    TRACE_EVENT_BEGIN,
+    TRACE_EVENT_END,
+    TRACE_EVENT_COUNTER
+};
+
+extern int g_trace_enabled;
+
+#if defined(__GNUC__)
+#define TRACE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define TRACE_UNLIKELY(x) (x)
+#endif
+
+#define TRACE_BEGIN(name) \
+    do { if (TRACE_UNLIKELY(g_trace_enabled)) trace_record(TRACE_EVENT_BEGIN, (name), 0); } while (0)
+#define TRACE_END(name) \
+    do { if (TRACE_UNLIKELY(g_trace_enabled)) trace_record(TRACE_EVENT_END, (name), 0); } while (0)
+#define TRACE_COUNTER(name, value) \
+    do { if (TRACE_UNLIKELY(g_trace_enabled)) trace_record(TRACE_EVENT_COUNTER, (name), (int64_t)(value)); } while (0)
+
+void trace_record(enum trace_event_type type, const char* name, int64_t value);
+
+/* Clear all tracks and start recording. */
+void trace_start(void);
+
+/* Stop recording. If path is not NULL, write the recorded events there
+ * in the Chrome trace event format (chrome://tracing, Perfetto UI).
+ * Returns 0 on success. */
+int trace_stop(const char* path);
+
+/* Create a named track, returns -1 when all tracks are used. */
+int trace_track_create(const char* name);
+
+/* Record the following events of this thread to track and return the
+ * previous one. Used for cooperative threads, which share an OS thread
+ * but must not interleave their events. */
+int trace_track_swap(int track);
+
+#ifdef __cplusplus
+}
+
+struct TraceScope
+{
+    TraceScope(const char* _name) : m_name(_name) { TRACE_BEGIN(m_name); }
+    ~TraceScope() { TRACE_END(m_name); }
+    const char* m_name;
+};
+
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+#endif
+
+#endif /* M64P_MAIN_TRACE_H */
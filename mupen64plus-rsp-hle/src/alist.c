@@ -32,6 +32,7 @@
 #include "hle_external.h"
 #include "hle_internal.h"
 #include "memory.h"
+#include "main/trace.h"
 
 struct ramp_t
 {
@@ -105,6 +106,8 @@ void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int
     const uint32_t *alist = dram_u32(hle, *dmem_u32(hle, TASK_DATA_PTR));
     const uint32_t *const alist_end = alist + (*dmem_u32(hle, TASK_DATA_SIZE) >> 2);
 
+    TRACE_BEGIN("alist_process");
+
     while (alist != alist_end) {
         w1 = *(alist++);
         w2 = *(alist++);
@@ -116,6 +119,8 @@ void alist_process(struct hle_t* hle, const acmd_callback_t abi[], unsigned int
         else
             HleWarnMessage(hle->user_defined, "Invalid ABI command %u", acmd);
     }
+
+    TRACE_END("alist_process");
 }
 
 uint32_t alist_get_address(struct hle_t* hle, uint32_t so, const uint32_t *segments, size_t n)
@@ -146,6 +151,21 @@ void alist_set_address(struct hle_t* hle, uint32_t so, uint32_t *segments, size_
 
 void alist_clear(struct hle_t* hle, uint16_t dmem, uint16_t count)
 {
+    uint16_t bytes;
+
+    while(count != 0 && (dmem & 3) != 0) {
+        *alist_u8(hle, dmem++) = 0;
+        --count;
+    }
+
+    /* whole words which do not wrap around the buffer are cleared at once */
+    bytes = count & ~3;
+    if ((dmem & 0xfff) + bytes <= 0x1000) {
+        memset(hle->alist_buffer + (dmem & 0xfff), 0, bytes);
+        dmem  += bytes;
+        count -= bytes;
+    }
+
     while(count != 0) {
         *alist_u8(hle, dmem++) = 0;
         --count;
@@ -172,6 +192,28 @@ void alist_save(struct hle_t* hle, uint16_t dmem, uint32_t address, uint16_t cou
 
 void alist_move(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
 {
+    /* with the same word alignment on both sides, whole words can be moved
+     * at once as long as the byte by byte forward copy semantic is kept */
+    if (((dmemo ^ dmemi) & 3) == 0) {
+        unsigned o, i;
+        uint16_t bytes;
+
+        while (count != 0 && (dmemi & 3) != 0) {
+            *alist_u8(hle, dmemo++) = *alist_u8(hle, dmemi++);
+            --count;
+        }
+
+        o = dmemo & 0xfff;
+        i = dmemi & 0xfff;
+        bytes = count & ~3;
+        if (o + bytes <= 0x1000 && i + bytes <= 0x1000 && (o <= i || o >= i + bytes)) {
+            memmove(hle->alist_buffer + o, hle->alist_buffer + i, bytes);
+            dmemo += bytes;
+            dmemi += bytes;
+            count -= bytes;
+        }
+    }
+
     while (count != 0) {
         *alist_u8(hle, dmemo++) = *alist_u8(hle, dmemi++);
         --count;
@@ -56,6 +56,9 @@ static void dump_binary(struct hle_t* hle, const char *const filename,
 static void dump_task(struct hle_t* hle, const char *const filename);
 static void dump_unknown_task(struct hle_t* hle, unsigned int sum);
 static void dump_unknown_non_task(struct hle_t* hle, unsigned int sum);
+static void dump_replay_task(struct hle_t* hle, const char *const name);
+#else
+#define dump_replay_task(hle, name)
 #endif
 
 /* Global functions */
@@ -224,6 +227,7 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             case 0x1eac11b8: /* AnimalCrossing */
                 alist_process_nead_ac(hle); return true;
             case 0x00010010: /* MusyX v2 (IndianaJones, BattleForNaboo) */
+                dump_replay_task(hle, "musyx_v2");
                 musyx_v2_task(hle); return true;
             case 0x1f701238: /* Mario Artist Talent Studio */
                 alist_process_nead_mats(hle); return true;
@@ -241,6 +245,7 @@ static bool try_fast_audio_dispatching(struct hle_t* hle)
             RogueSquadron, ResidentEvil2, PolarisSnoCross,
             TheWorldIsNotEnough, RugratsInParis, NBAShowTime,
             HydroThunder, Tarzan, GauntletLegend, Rush2049 */
+            dump_replay_task(hle, "musyx_v1");
             musyx_v1_task(hle); return true;
         case 0x0000127c: /* naudio (many games) */
             alist_process_naudio(hle); return true;
@@ -273,6 +278,7 @@ static bool try_fast_task_dispatching(struct hle_t* hle)
 
         /* Yakouchuu II - Satsujin Kouro */
         if ((hle->product_code == 0x4e594b4a) && sum_bytes((void*)dram_u32(hle, *dmem_u32(hle, TASK_UCODE)), 1488) == 0x19495) {
+            dump_replay_task(hle, "hvqm2");
             hvqm2_decode_sp1_task(hle);
             return true;
         }
@@ -292,6 +298,7 @@ static bool try_fast_task_dispatching(struct hle_t* hle)
         break;
 
     case 7:
+        dump_replay_task(hle, "hvqm2");
         hvqm2_decode_sp1_task(hle);
         return true;
     }
@@ -321,17 +328,20 @@ static void normal_task_dispatching(struct hle_t* hle)
 
     /* JPEG: found in Pokemon Stadium J */
     case 0x2c85a:
+        dump_replay_task(hle, "jpeg_ps0");
         jpeg_decode_PS0(hle);
         return;
 
     /* JPEG: found in Zelda Ocarina of Time, Pokemon Stadium 1, Pokemon Stadium 2 */
     case 0x2caa6:
+        dump_replay_task(hle, "jpeg_ps");
         jpeg_decode_PS(hle);
         return;
 
     /* JPEG: found in Ogre Battle, Bottom of the 9th */
     case 0x130de:
     case 0x278b0:
+        dump_replay_task(hle, "jpeg_ob");
         jpeg_decode_OB(hle);
         return;
     }
@@ -381,14 +391,17 @@ static bool try_re2_task_dispatching(struct hle_t* hle)
     switch (sum) {
 
     case 0x450f:
+        dump_replay_task(hle, "re2_resize");
         resize_bilinear_task(hle);
         return true;
 
     case 0x3b44:
+        dump_replay_task(hle, "re2_decode");
         decode_video_frame_task(hle);
         return true;
 
     case 0x3d84:
+        dump_replay_task(hle, "re2_fill");
         fill_video_double_buffer_task(hle);
         return true;
     }
@@ -442,6 +455,25 @@ static void dump_unknown_non_task(struct hle_t* hle, unsigned int sum)
     dump_binary(hle, filename, hle->dmem, 0x1000);
 }
 
+/* the core always allocates this much RDRAM, whatever the emulated size */
+#define TASK_DUMP_DRAM_SIZE 0x800000
+
+/* dump the task header, DMEM and RDRAM before a task runs,
+ * these can be replayed by mupen64plus-rsp-hle/test/replay_task */
+static void dump_replay_task(struct hle_t* hle, const char *const name)
+{
+    char filename[256];
+
+    sprintf(&filename[0], "task_%s.log", name);
+    dump_task(hle, filename);
+
+    sprintf(&filename[0], "dmem_%s.bin", name);
+    dump_binary(hle, filename, hle->dmem, 0x1000);
+
+    sprintf(&filename[0], "dram_%s.bin", name);
+    dump_binary(hle, filename, hle->dram, TASK_DUMP_DRAM_SIZE);
+}
+
 static void dump_binary(struct hle_t* hle, const char *const filename,
                         const unsigned char *const bytes, unsigned int size)
 {
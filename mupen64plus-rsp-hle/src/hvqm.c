@@ -205,9 +205,13 @@ static uint16_t YCbCr_to_BGRA5551(int16_t Y, int16_t Cb, int16_t Cr, uint8_t alp
     int r, g, b;
 
     //Format S7.9
-    r = (int)(((double)Y * 0.125 + 0.0625) + (0.220703125 * (double)(Cr - 128)));
-    g = (int)(((double)Y * 0.125 + 0.0625) - (0.04296875 * (double)(Cr - 128)) - (0.08984375 * (double)(Cb - 128)));
-    b = (int)(((double)Y * 0.125 + 0.0625) + (0.17578125 * (double)(Cb - 128)));
+    //All coefficients are multiples of 1/512, so the conversion is exact in
+    //fixed point. Results below zero saturate to 0 whether they were
+    //truncated or floored, hence the arithmetic shift.
+    const int y = (int)Y * 64 + 32;
+    r = (y + 113 * (Cr - 128)) >> 9;
+    g = (y - 22 * (Cr - 128) - 46 * (Cb - 128)) >> 9;
+    b = (y + 90 * (Cb - 128)) >> 9;
 
     r = SATURATE(r);
     g = SATURATE(g);
@@ -297,19 +301,12 @@ void hvqm2_decode_sp1_task(struct hle_t* hle)
             {
                 for (int m = 0; m < arg.chroma_step_v; m++)
                 {
-                    uint32_t addr = out_buf;
+                    uint16_t line[8];
                     for (int l = 0; l < 4; l++)
-                    {
-                        uint16_t pixel = YCbCr_to_BGRA5551(pY1[l], pCb[l >> 1], pCr[l >> 1], arg.alpha);
-                        dram_store_u16(hle, &pixel, addr, 1);
-                        addr += 2;
-                    }
+                        line[l] = YCbCr_to_BGRA5551(pY1[l], pCb[l >> 1], pCr[l >> 1], arg.alpha);
                     for (int l = 0; l < 4; l++)
-                    {
-                        uint16_t pixel = YCbCr_to_BGRA5551(pY2[l], pCb[(l + 4) >> 1], pCr[(l + 4) >> 1], arg.alpha);
-                        dram_store_u16(hle, &pixel, addr, 1);
-                        addr += 2;
-                    }
+                        line[l + 4] = YCbCr_to_BGRA5551(pY2[l], pCb[(l + 4) >> 1], pCr[(l + 4) >> 1], arg.alpha);
+                    dram_store_u16(hle, line, out_buf, 8);
                     out_buf += skip;
                     pY1 += 4;
                     pY2 += 4;
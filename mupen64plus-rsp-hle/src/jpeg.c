@@ -25,6 +25,13 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "arithmetics.h"
 #include "hle_external.h"
 #include "hle_internal.h"
@@ -72,7 +79,9 @@ static void ReorderSubBlock(int16_t *dst, const int16_t *src, const unsigned int
 static void MultSubBlocks(int16_t *dst, const int16_t *src1, const int16_t *src2, unsigned int shift);
 static void ScaleSubBlock(int16_t *dst, const int16_t *src, int16_t scale);
 static void RShiftSubBlock(int16_t *dst, const int16_t *src, unsigned int shift);
+#if !defined(__SSE2__) && !defined(__ARM_NEON)
 static void InverseDCT1D(const float *const x, float *dst, unsigned int stride);
+#endif
 static void InverseDCTSubBlock(int16_t *dst, const int16_t *src);
 static void RescaleYSubBlock(int16_t *dst, const int16_t *src);
 static void RescaleUVSubBlock(int16_t *dst, const int16_t *src);
@@ -509,6 +518,138 @@ static void RShiftSubBlock(int16_t *dst, const int16_t *src, unsigned int shift)
         dst[i] = src[i] >> shift;
 }
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+/***************************************************************************
+ * Same IDCT evaluated on 4 rows (or columns) at once.
+ * Every lane performs exactly the operations of InverseDCT1D in the same
+ * order, so results are bit identical to the scalar path.
+ **************************************************************************/
+#if defined(__SSE2__)
+typedef __m128 idct_v4f;
+#define idct_add(a, b) _mm_add_ps(a, b)
+#define idct_sub(a, b) _mm_sub_ps(a, b)
+#define idct_mul(a, b) _mm_mul_ps(a, b)
+#define idct_set1(a)   _mm_set1_ps(a)
+#else
+typedef float32x4_t idct_v4f;
+#define idct_add(a, b) vaddq_f32(a, b)
+#define idct_sub(a, b) vsubq_f32(a, b)
+#define idct_mul(a, b) vmulq_f32(a, b)
+#define idct_set1(a)   vdupq_n_f32(a)
+#endif
+
+static void InverseDCT1Dx4(const idct_v4f *const x, idct_v4f *dst)
+{
+    idct_v4f e[4];
+    idct_v4f f[4];
+    idct_v4f x26, x1357, x15, x37, x17, x35;
+
+    x15   = idct_mul(idct_set1(IDCT_K[2]), idct_add(x[1], x[5]));
+    x37   = idct_mul(idct_set1(IDCT_K[3]), idct_add(x[3], x[7]));
+    x17   = idct_mul(idct_set1(IDCT_K[8]), idct_add(x[1], x[7]));
+    x35   = idct_mul(idct_set1(IDCT_K[9]), idct_add(x[3], x[5]));
+    x1357 = idct_mul(idct_set1(IDCT_C3),
+                     idct_add(idct_add(idct_add(x[1], x[3]), x[5]), x[7]));
+    x26   = idct_mul(idct_set1(IDCT_C6), idct_add(x[2], x[6]));
+
+    f[0] = idct_add(x[0], x[4]);
+    f[1] = idct_sub(x[0], x[4]);
+    f[2] = idct_add(x26, idct_mul(idct_set1(IDCT_K[0]), x[2]));
+    f[3] = idct_add(x26, idct_mul(idct_set1(IDCT_K[1]), x[6]));
+
+    e[0] = idct_add(idct_add(idct_add(x1357, x15), idct_mul(idct_set1(IDCT_K[4]), x[1])), x17);
+    e[1] = idct_add(idct_add(idct_add(x1357, x37), idct_mul(idct_set1(IDCT_K[6]), x[3])), x35);
+    e[2] = idct_add(idct_add(idct_add(x1357, x15), idct_mul(idct_set1(IDCT_K[5]), x[5])), x35);
+    e[3] = idct_add(idct_add(idct_add(x1357, x37), idct_mul(idct_set1(IDCT_K[7]), x[7])), x17);
+
+    dst[0] = idct_add(idct_add(f[0], f[2]), e[0]);
+    dst[1] = idct_add(idct_add(f[1], f[3]), e[1]);
+    dst[2] = idct_add(idct_sub(f[1], f[3]), e[2]);
+    dst[3] = idct_add(idct_sub(f[0], f[2]), e[3]);
+    dst[4] = idct_sub(idct_sub(f[0], f[2]), e[3]);
+    dst[5] = idct_sub(idct_sub(f[1], f[3]), e[2]);
+    dst[6] = idct_sub(idct_add(f[1], f[3]), e[1]);
+    dst[7] = idct_sub(idct_add(f[0], f[2]), e[0]);
+}
+
+/* x[j] lane l = rows[l * 8 + j] */
+static void LoadTransposedx4(const float *rows, idct_v4f *x)
+{
+#if defined(__SSE2__)
+    __m128 r0 = _mm_loadu_ps(rows +  0), r1 = _mm_loadu_ps(rows +  8);
+    __m128 r2 = _mm_loadu_ps(rows + 16), r3 = _mm_loadu_ps(rows + 24);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    x[0] = r0; x[1] = r1; x[2] = r2; x[3] = r3;
+
+    r0 = _mm_loadu_ps(rows +  4); r1 = _mm_loadu_ps(rows + 12);
+    r2 = _mm_loadu_ps(rows + 20); r3 = _mm_loadu_ps(rows + 28);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    x[4] = r0; x[5] = r1; x[6] = r2; x[7] = r3;
+#else
+    unsigned int h;
+
+    for (h = 0; h < 8; h += 4) {
+        float32x4x2_t t01 = vtrnq_f32(vld1q_f32(rows +  0 + h), vld1q_f32(rows +  8 + h));
+        float32x4x2_t t23 = vtrnq_f32(vld1q_f32(rows + 16 + h), vld1q_f32(rows + 24 + h));
+        x[h + 0] = vcombine_f32(vget_low_f32(t01.val[0]),  vget_low_f32(t23.val[0]));
+        x[h + 1] = vcombine_f32(vget_low_f32(t01.val[1]),  vget_low_f32(t23.val[1]));
+        x[h + 2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        x[h + 3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+#endif
+}
+
+/* dst[l] = (int16_t)x[l] >> 3 */
+static void StoreNormalizedx4(int16_t *dst, idct_v4f x)
+{
+#if defined(__SSE2__)
+    __m128i v = _mm_cvttps_epi32(x);
+    v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    v = _mm_srai_epi32(v, 3);
+    _mm_storel_epi64((__m128i *)dst, _mm_packs_epi32(v, v));
+#else
+    int32x4_t v = vcvtq_s32_f32(x);
+    v = vshrq_n_s32(vshlq_n_s32(v, 16), 16);
+    vst1_s16(dst, vmovn_s32(vshrq_n_s32(v, 3)));
+#endif
+}
+
+static void InverseDCTSubBlock(int16_t *dst, const int16_t *src)
+{
+    idct_v4f x[8];
+    idct_v4f y[8];
+    float in[SUBBLOCK_SIZE];
+    float block[SUBBLOCK_SIZE];
+    unsigned int i, k;
+
+    for (i = 0; i < SUBBLOCK_SIZE; ++i)
+        in[i] = (float)src[i];
+
+    /* idct 1d on rows (+transposition) */
+    for (i = 0; i < 8; i += 4) {
+        LoadTransposedx4(&in[i * 8], x);
+        InverseDCT1Dx4(x, y);
+
+        for (k = 0; k < 8; ++k) {
+#if defined(__SSE2__)
+            _mm_storeu_ps(&block[k * 8 + i], y[k]);
+#else
+            vst1q_f32(&block[k * 8 + i], y[k]);
+#endif
+        }
+    }
+
+    /* idct 1d on columns (thanks to previous transposition) */
+    for (i = 0; i < 8; i += 4) {
+        LoadTransposedx4(&block[i * 8], x);
+        InverseDCT1Dx4(x, y);
+
+        /* C4 = 1 normalization implies a division by 8 */
+        for (k = 0; k < 8; ++k)
+            StoreNormalizedx4(&dst[i + k * 8], y[k]);
+    }
+}
+#else
 /***************************************************************************
  * Fast 2D IDCT using separable formulation and normalization
  * Computations use single precision floats
@@ -578,6 +719,7 @@ static void InverseDCTSubBlock(int16_t *dst, const int16_t *src)
             dst[i + j * 8] = (int16_t)x[j] >> 3;
     }
 }
+#endif
 
 static void RescaleYSubBlock(int16_t *dst, const int16_t *src)
 {
@@ -21,25 +21,117 @@
 
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "memory.h"
 
+/* Local functions */
+#ifndef M64P_BIG_ENDIAN
+/* RSP memories are stored as native 32-bit words, so on little endian hosts
+ * a run of whole words is converted by reversing the bytes (u8 access) or
+ * swapping the halfwords (u16 access) of each word. Both are involutions,
+ * hence the same routines serve loads and stores. */
+static void swap_u8_words(unsigned char* dst, const unsigned char* src, size_t words)
+{
+#if defined(__SSE2__)
+    for (; words >= 4; words -= 4, src += 16, dst += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i*)dst, v);
+    }
+#elif defined(__ARM_NEON)
+    for (; words >= 4; words -= 4, src += 16, dst += 16)
+        vst1q_u8(dst, vrev32q_u8(vld1q_u8(src)));
+#endif
+
+    for (; words != 0; --words, src += 4, dst += 4) {
+        dst[0] = src[3];
+        dst[1] = src[2];
+        dst[2] = src[1];
+        dst[3] = src[0];
+    }
+}
+
+static void swap_u16_words(unsigned char* dst, const unsigned char* src, size_t words)
+{
+#if defined(__SSE2__)
+    for (; words >= 4; words -= 4, src += 16, dst += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i*)dst, v);
+    }
+#elif defined(__ARM_NEON)
+    for (; words >= 4; words -= 4, src += 16, dst += 16)
+        vst1q_u16((uint16_t*)dst, vrev32q_u16(vld1q_u16((const uint16_t*)src)));
+#endif
+
+    for (; words != 0; --words, src += 4, dst += 4) {
+        uint16_t lo, hi;
+        memcpy(&lo, src, 2);
+        memcpy(&hi, src + 2, 2);
+        memcpy(dst, &hi, 2);
+        memcpy(dst + 2, &lo, 2);
+    }
+}
+#endif
+
 /* Global functions */
 void load_u8(uint8_t* dst, const unsigned char* buffer, unsigned address, size_t count)
 {
+#ifdef M64P_BIG_ENDIAN
+    memcpy(dst, u8(buffer, address), count);
+#else
+    size_t words;
+
+    /* unaligned head, whole words, then tail */
+    while (count != 0 && (address & 3) != 0) {
+        *(dst++) = *u8(buffer, address);
+        address += 1;
+        --count;
+    }
+
+    words = count >> 2;
+    swap_u8_words(dst, buffer + address, words);
+    dst += words << 2;
+    address += words << 2;
+    count &= 3;
+
     while (count != 0) {
         *(dst++) = *u8(buffer, address);
         address += 1;
         --count;
     }
+#endif
 }
 
 void load_u16(uint16_t* dst, const unsigned char* buffer, unsigned address, size_t count)
 {
-    while (count != 0) {
+#ifdef M64P_BIG_ENDIAN
+    memcpy(dst, u16(buffer, address), count * sizeof(uint16_t));
+#else
+    size_t words;
+
+    if (count != 0 && (address & 3) != 0) {
         *(dst++) = *u16(buffer, address);
         address += 2;
         --count;
     }
+
+    words = count >> 1;
+    swap_u16_words((unsigned char*)dst, buffer + address, words);
+    dst += words << 1;
+    address += words << 2;
+
+    if ((count & 1) != 0)
+        *dst = *u16(buffer, address);
+#endif
 }
 
 void load_u32(uint32_t* dst, const unsigned char* buffer, unsigned address, size_t count)
@@ -50,20 +142,52 @@ void load_u32(uint32_t* dst, const unsigned char* buffer, unsigned address, size
 
 void store_u8(unsigned char* buffer, unsigned address, const uint8_t* src, size_t count)
 {
+#ifdef M64P_BIG_ENDIAN
+    memcpy(u8(buffer, address), src, count);
+#else
+    size_t words;
+
+    while (count != 0 && (address & 3) != 0) {
+        *u8(buffer, address) = *(src++);
+        address += 1;
+        --count;
+    }
+
+    words = count >> 2;
+    swap_u8_words(buffer + address, src, words);
+    src += words << 2;
+    address += words << 2;
+    count &= 3;
+
     while (count != 0) {
         *u8(buffer, address) = *(src++);
         address += 1;
         --count;
     }
+#endif
 }
 
 void store_u16(unsigned char* buffer, unsigned address, const uint16_t* src, size_t count)
 {
-    while (count != 0) {
+#ifdef M64P_BIG_ENDIAN
+    memcpy(u16(buffer, address), src, count * sizeof(uint16_t));
+#else
+    size_t words;
+
+    if (count != 0 && (address & 3) != 0) {
         *u16(buffer, address) = *(src++);
         address += 2;
         --count;
     }
+
+    words = count >> 1;
+    swap_u16_words(buffer + address, (const unsigned char*)src, words);
+    src += words << 1;
+    address += words << 2;
+
+    if ((count & 1) != 0)
+        *u16(buffer, address) = *src;
+#endif
 }
 
 void store_u32(unsigned char* buffer, unsigned address, const uint32_t* src, size_t count)
@@ -71,4 +195,3 @@ void store_u32(unsigned char* buffer, unsigned address, const uint32_t* src, siz
     /* Optimization for uint32_t */
     memcpy(u32(buffer, address), src, count * sizeof(uint32_t));
 }
-
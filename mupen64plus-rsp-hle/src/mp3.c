@@ -24,6 +24,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "arithmetics.h"
 #include "hle_internal.h"
 #include "memory.h"
@@ -203,6 +209,59 @@ static void MP3AB0(int32_t* v)
     }
 }
 
+/* Sum of 16 rounded Q15 products of consecutive samples and window
+ * coefficients. When alternate is set, odd taps are subtracted. */
+static int32_t DeWindowTaps(const uint8_t *samples, const uint16_t *lut, int alternate)
+{
+    int32_t sum = 0;
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i round = _mm_set1_epi32(0x4000);
+    const __m128i sign = alternate ? _mm_set_epi32(-1, 0, -1, 0) : _mm_setzero_si128();
+    __m128i accu = _mm_setzero_si128();
+
+    for (; i < 16; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(samples + 2 * i));
+        __m128i c = _mm_loadu_si128((const __m128i *)(lut + i));
+        __m128i lo = _mm_mullo_epi16(x, c);
+        __m128i hi = _mm_mulhi_epi16(x, c);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+        p0 = _mm_sub_epi32(_mm_xor_si128(p0, sign), sign);
+        p1 = _mm_sub_epi32(_mm_xor_si128(p1, sign), sign);
+        accu = _mm_add_epi32(accu, _mm_add_epi32(p0, p1));
+    }
+    accu = _mm_add_epi32(accu, _mm_shuffle_epi32(accu, _MM_SHUFFLE(1, 0, 3, 2)));
+    accu = _mm_add_epi32(accu, _mm_shuffle_epi32(accu, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_cvtsi128_si32(accu);
+#elif defined(__ARM_NEON)
+    static const int32_t signs[2][4] = { { 1, 1, 1, 1 }, { 1, -1, 1, -1 } };
+    const int32x4_t round = vdupq_n_s32(0x4000);
+    const int32x4_t sign = vld1q_s32(signs[alternate ? 1 : 0]);
+    int32x4_t accu = vdupq_n_s32(0);
+    int32x2_t half;
+
+    for (; i < 16; i += 4) {
+        int16x4_t x;
+        int32x4_t p;
+
+        memcpy(&x, samples + 2 * i, sizeof(x));
+        p = vmull_s16(x, vreinterpret_s16_u16(vld1_u16(lut + i)));
+        accu = vmlaq_s32(accu, vshrq_n_s32(vaddq_s32(p, round), 15), sign);
+    }
+    half = vadd_s32(vget_low_s32(accu), vget_high_s32(accu));
+    sum = vget_lane_s32(vpadd_s32(half, half), 0);
+#endif
+
+    for (; i < 16; ++i) {
+        int32_t v = ((int)*(int16_t *)(samples + 2 * i) * (short)lut[i] + 0x4000) >> 0xF;
+        sum += (alternate && (i & 1)) ? -v : v;
+    }
+
+    return sum;
+}
+
 void mp3_task(struct hle_t* hle, unsigned int index, uint32_t address)
 {
     uint32_t inPtr, outPtr;
@@ -579,26 +638,18 @@ static void InnerLoop(struct hle_t* hle,
     for (x = 0; x < 8; x++) {
         int32_t v0;
         int32_t v18;
-        v2 = v4 = v6 = v8 = 0;
 
-        for (i = 7; i >= 0; i--) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            addptr += 2;
-            offset++;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+        /* 4 x 8 taps: samples [0x00, 0x20) and [0x20, 0x40) of the row */
+        v0  = DeWindowTaps(hle->mp3_buffer + addptr, &DeWindowLUT[offset], 0);
+        v18 = DeWindowTaps(hle->mp3_buffer + addptr + 0x20, &DeWindowLUT[offset + 0x20], 0);
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
         *(int16_t *)(hle->mp3_buffer + (outPtr ^ S16)) = v0;
         *(int16_t *)(hle->mp3_buffer + ((outPtr + 2)^S16)) = v18;
         outPtr += 4;
-        addptr += 0x30;
-        offset += 0x38;
+        addptr += 0x40;
+        offset += 0x40;
     }
 
     offset = 0x10 - (t4 >> 1) + 8 * 0x40;
@@ -632,20 +683,10 @@ static void InnerLoop(struct hle_t* hle,
 
         offset = (0x22F - (t4 >> 1) + x * 0x40);
 
-        for (i = 0; i < 4; i++) {
-            v2 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x20) * (short)DeWindowLUT[offset + 0x00] + 0x4000) >> 0xF;
-            v2 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x20) * (short)DeWindowLUT[offset + 0x01] + 0x4000) >> 0xF;
-            v4 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x30) * (short)DeWindowLUT[offset + 0x08] + 0x4000) >> 0xF;
-            v4 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x30) * (short)DeWindowLUT[offset + 0x09] + 0x4000) >> 0xF;
-            v6 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x00) * (short)DeWindowLUT[offset + 0x20] + 0x4000) >> 0xF;
-            v6 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x00) * (short)DeWindowLUT[offset + 0x21] + 0x4000) >> 0xF;
-            v8 += ((int) * (int16_t *)(hle->mp3_buffer + (addptr) + 0x10) * (short)DeWindowLUT[offset + 0x28] + 0x4000) >> 0xF;
-            v8 -= ((int) * (int16_t *)(hle->mp3_buffer + ((addptr + 2)) + 0x10) * (short)DeWindowLUT[offset + 0x29] + 0x4000) >> 0xF;
-            addptr += 4;
-            offset += 2;
-        }
-        v0  = v2 + v4;
-        v18 = v6 + v8;
+        /* same taps with alternating signs, both halves of the row swapped */
+        v0  = DeWindowTaps(hle->mp3_buffer + addptr + 0x20, &DeWindowLUT[offset], 1);
+        v18 = DeWindowTaps(hle->mp3_buffer + addptr, &DeWindowLUT[offset + 0x20], 1);
+        addptr += 0x10;
         /* Clamp(v0); */
         /* Clamp(v18); */
         /* clamp??? */
@@ -24,6 +24,12 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "arithmetics.h"
 #include "audio.h"
 #include "common.h"
@@ -854,9 +860,25 @@ static void sfx_stage(struct hle_t* hle, mix_sfx_with_main_subframes_t mix_sfx_w
 static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* UNUSED(gains))
 {
-    unsigned i;
+    unsigned i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 8 <= SUBFRAME_SIZE; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&subframe[i]);
+        __m128i l = _mm_loadu_si128((const __m128i *)&musyx->left[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&musyx->right[i]);
+        _mm_storeu_si128((__m128i *)&musyx->left[i],  _mm_adds_epi16(l, v));
+        _mm_storeu_si128((__m128i *)&musyx->right[i], _mm_adds_epi16(r, v));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= SUBFRAME_SIZE; i += 8) {
+        int16x8_t v = vld1q_s16(&subframe[i]);
+        vst1q_s16(&musyx->left[i],  vqaddq_s16(vld1q_s16(&musyx->left[i]),  v));
+        vst1q_s16(&musyx->right[i], vqaddq_s16(vld1q_s16(&musyx->right[i]), v));
+    }
+#endif
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+    for (; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         musyx->left[i]  = clamp_s16(musyx->left[i]  + v);
         musyx->right[i] = clamp_s16(musyx->right[i] + v);
@@ -866,9 +888,37 @@ static void mix_sfx_with_main_subframes_v1(musyx_t *musyx, const int16_t *subfra
 static void mix_sfx_with_main_subframes_v2(musyx_t *musyx, const int16_t *subframe,
                                            const uint16_t* gains)
 {
-    unsigned i;
+    unsigned i = 0;
+
+#if defined(__SSE2__)
+    /* signed x unsigned high product: correct the unsigned one for negative samples */
+    const __m128i g0 = _mm_set1_epi16((int16_t)gains[0]);
+    const __m128i g1 = _mm_set1_epi16((int16_t)gains[1]);
+
+    for (; i + 8 <= SUBFRAME_SIZE; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&subframe[i]);
+        __m128i neg = _mm_srai_epi16(v, 15);
+        __m128i v1 = _mm_sub_epi16(_mm_mulhi_epu16(v, g0), _mm_and_si128(neg, g0));
+        __m128i v2 = _mm_sub_epi16(_mm_mulhi_epu16(v, g1), _mm_and_si128(neg, g1));
+        __m128i l = _mm_loadu_si128((const __m128i *)&musyx->left[i]);
+        __m128i r = _mm_loadu_si128((const __m128i *)&musyx->right[i]);
+        __m128i c = _mm_loadu_si128((const __m128i *)&musyx->cc0[i]);
+        _mm_storeu_si128((__m128i *)&musyx->left[i],  _mm_adds_epi16(l, v1));
+        _mm_storeu_si128((__m128i *)&musyx->right[i], _mm_adds_epi16(r, v1));
+        _mm_storeu_si128((__m128i *)&musyx->cc0[i],   _mm_adds_epi16(c, v2));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= SUBFRAME_SIZE; i += 4) {
+        int32x4_t v = vmovl_s16(vld1_s16(&subframe[i]));
+        int16x4_t v1 = vmovn_s32(vshrq_n_s32(vmulq_n_s32(v, gains[0]), 16));
+        int16x4_t v2 = vmovn_s32(vshrq_n_s32(vmulq_n_s32(v, gains[1]), 16));
+        vst1_s16(&musyx->left[i],  vqadd_s16(vld1_s16(&musyx->left[i]),  v1));
+        vst1_s16(&musyx->right[i], vqadd_s16(vld1_s16(&musyx->right[i]), v1));
+        vst1_s16(&musyx->cc0[i],   vqadd_s16(vld1_s16(&musyx->cc0[i]),   v2));
+    }
+#endif
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+    for (; i < SUBFRAME_SIZE; ++i) {
         int16_t v = subframe[i];
         int16_t v1 = (int32_t)(v * gains[0]) >> 16;
         int16_t v2 = (int32_t)(v * gains[1]) >> 16;
@@ -886,15 +936,40 @@ static void mix_samples(int16_t *y, int16_t x, int16_t hgain)
 
 static void mix_subframes(int16_t *y, const int16_t *x, int16_t hgain)
 {
-    unsigned int i;
+    unsigned int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i h = _mm_set1_epi16(hgain);
+    const __m128i round = _mm_set1_epi32(0x4000);
+
+    for (; i + 8 <= SUBFRAME_SIZE; i += 8) {
+        __m128i xv = _mm_loadu_si128((const __m128i *)&x[i]);
+        __m128i yv = _mm_loadu_si128((const __m128i *)&y[i]);
+        __m128i lo = _mm_mullo_epi16(xv, h);
+        __m128i hi = _mm_mulhi_epi16(xv, h);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+        __m128i y0 = _mm_srai_epi32(_mm_unpacklo_epi16(yv, yv), 16);
+        __m128i y1 = _mm_srai_epi32(_mm_unpackhi_epi16(yv, yv), 16);
+        _mm_storeu_si128((__m128i *)&y[i],
+                         _mm_packs_epi32(_mm_add_epi32(y0, p0), _mm_add_epi32(y1, p1)));
+    }
+#elif defined(__ARM_NEON)
+    const int32x4_t round = vdupq_n_s32(0x4000);
+
+    for (; i + 4 <= SUBFRAME_SIZE; i += 4) {
+        int32x4_t p = vshrq_n_s32(vaddq_s32(vmull_n_s16(vld1_s16(&x[i]), hgain), round), 15);
+        vst1_s16(&y[i], vqmovn_s32(vaddq_s32(vmovl_s16(vld1_s16(&y[i])), p)));
+    }
+#endif
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i)
+    for (; i < SUBFRAME_SIZE; ++i)
         mix_samples(&y[i], x[i], hgain);
 }
 
 static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t *hcoeffs)
 {
-    unsigned int i;
+    unsigned int i = 0;
     int32_t h[4];
 
     h[0] = (hgain * hcoeffs[0]) >> 15;
@@ -902,7 +977,38 @@ static void mix_fir4(int16_t *y, const int16_t *x, int16_t hgain, const int16_t
     h[2] = (hgain * hcoeffs[2]) >> 15;
     h[3] = (hgain * hcoeffs[3]) >> 15;
 
-    for (i = 0; i < SUBFRAME_SIZE; ++i) {
+#if defined(__SSE2__)
+    /* pairwise madd needs 16-bit taps, only -32768 * -32768 gains overflow */
+    if (h[0] != 0x8000 && h[1] != 0x8000 && h[2] != 0x8000 && h[3] != 0x8000) {
+        const __m128i h01 = _mm_set1_epi32((int32_t)(((uint32_t)h[1] << 16) | (uint16_t)h[0]));
+        const __m128i h23 = _mm_set1_epi32((int32_t)(((uint32_t)h[3] << 16) | (uint16_t)h[2]));
+
+        for (; i + 8 <= SUBFRAME_SIZE; i += 8) {
+            __m128i x0 = _mm_loadu_si128((const __m128i *)&x[i]);
+            __m128i x1 = _mm_loadu_si128((const __m128i *)&x[i + 1]);
+            __m128i x2 = _mm_loadu_si128((const __m128i *)&x[i + 2]);
+            __m128i x3 = _mm_loadu_si128((const __m128i *)&x[i + 3]);
+            __m128i yv = _mm_loadu_si128((const __m128i *)&y[i]);
+            __m128i v0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(x2, x3), h23));
+            __m128i v1 = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(x0, x1), h01),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(x2, x3), h23));
+            v0 = _mm_add_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(yv, yv), 16), _mm_srai_epi32(v0, 15));
+            v1 = _mm_add_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(yv, yv), 16), _mm_srai_epi32(v1, 15));
+            _mm_storeu_si128((__m128i *)&y[i], _mm_packs_epi32(v0, v1));
+        }
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 4 <= SUBFRAME_SIZE; i += 4) {
+        int32x4_t v = vmulq_n_s32(vmovl_s16(vld1_s16(&x[i])), h[0]);
+        v = vmlaq_n_s32(v, vmovl_s16(vld1_s16(&x[i + 1])), h[1]);
+        v = vmlaq_n_s32(v, vmovl_s16(vld1_s16(&x[i + 2])), h[2]);
+        v = vmlaq_n_s32(v, vmovl_s16(vld1_s16(&x[i + 3])), h[3]);
+        vst1_s16(&y[i], vqmovn_s32(vaddq_s32(vmovl_s16(vld1_s16(&y[i])), vshrq_n_s32(v, 15))));
+    }
+#endif
+
+    for (; i < SUBFRAME_SIZE; ++i) {
         int32_t v = (h[0] * x[i] + h[1] * x[i + 1] + h[2] * x[i + 2] + h[3] * x[i + 3]) >> 15;
         y[i] = clamp_s16(y[i] + v);
     }
@@ -942,6 +1048,7 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
 {
     unsigned i, k;
     int16_t subframe[SUBFRAME_SIZE];
+    int16_t samples[3*SUBFRAME_SIZE];
     uint32_t *dst;
     uint16_t mask;
 
@@ -968,11 +1075,10 @@ static void interleave_stage_v2(struct hle_t* hle, musyx_t *musyx,
         address = *dram_u32(hle, ptr_18);
         hgain   = *dram_u16(hle, ptr_18 + 4);
 
-        for(i = 0; i < SUBFRAME_SIZE; ++i, address += 2) {
-            mix_samples(&musyx->left[i],  *dram_u16(hle, address), hgain);
-            mix_samples(&musyx->right[i], *dram_u16(hle, address + 2*SUBFRAME_SIZE), hgain);
-            mix_samples(&subframe[i],     *dram_u16(hle, address + 4*SUBFRAME_SIZE), hgain);
-        }
+        dram_load_u16(hle, (uint16_t *)samples, address, 3*SUBFRAME_SIZE);
+        mix_subframes(musyx->left,  samples, hgain);
+        mix_subframes(musyx->right, samples + SUBFRAME_SIZE, hgain);
+        mix_subframes(subframe,     samples + 2*SUBFRAME_SIZE, hgain);
     }
 
     /* interleave L_total and R_total */
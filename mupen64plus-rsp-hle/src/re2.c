@@ -29,6 +29,31 @@
 
 #define SATURATE8(x) ((unsigned int) x <= 255 ? x : (x < 0 ? 0: 255))
 
+/* DRAM accesses are batched by runs of this many pixels */
+#define RE2_RUN_LENGTH 64
+
+static uint16_t bilinear_BGR_to_RGBA5551(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d,
+                                         long long x_diff, long long y_diff)
+{
+    int blue, green, red;
+    long long one_min_x_diff = 65536 - x_diff;
+    long long one_min_y_diff = 65536 - y_diff;
+
+    blue = (int)((a[0]*one_min_x_diff*one_min_y_diff + b[0]*x_diff*one_min_y_diff +
+                  c[0]*y_diff*one_min_x_diff         + d[0]*x_diff*y_diff) >> 32);
+
+    green = (int)((a[1]*one_min_x_diff*one_min_y_diff + b[1]*x_diff*one_min_y_diff +
+                   c[1]*y_diff*one_min_x_diff         + d[1]*x_diff*y_diff) >> 32);
+
+    red = (int)((a[2]*one_min_x_diff*one_min_y_diff + b[2]*x_diff*one_min_y_diff +
+                 c[2]*y_diff*one_min_x_diff         + d[2]*x_diff*y_diff) >> 32);
+
+    blue = (blue >> 3) & 0x001f;
+    green = (green >> 3) & 0x001f;
+    red = (red >> 3) & 0x001f;
+    return (red << 11) | (green << 6) | (blue << 1) | 1;
+}
+
 /**************************************************************************
  * Resident evil 2 ucodes
  **************************************************************************/
@@ -47,53 +72,68 @@ void resize_bilinear_task(struct hle_t* hle)
 #endif
     int src_offset = *dram_u32(hle, data_ptr + 36);
 
-    int a, b, c ,d, index, y_index, xr, yr, blue, green, red, addr, i, j;
-    long long x, y, x_diff, y_diff, one_min_x_diff, one_min_y_diff;
-    unsigned short pixel;
+    int y_index, xr, yr, addr, i, j, n;
+    long long x, y, x_diff, y_diff, span;
+    uint8_t a[3], b[3], c[3], d[3];
+    /* two source lines plus the overrun of the last pixel pair */
+    uint8_t rows[3 * 320 * 3];
+    uint16_t line[RE2_RUN_LENGTH];
 
     src_addr += (src_offset >> 16) * (320 * 3);
     x = y = 0;
 
+    /* source pixels touched on each line, when both lines fit in rows[] the
+     * whole span is fetched at once instead of four loads per pixel */
+    span = (dst_width > 0 && x_ratio >= 0)
+        ? ((((long long)(dst_width - 1) * x_ratio) >> 16) + 2) * 3 + (320 * 3)
+        : (long long)sizeof(rows) + 1;
+
     for(i = 0; i < dst_height; i++)
     {
         yr = (int)(y >> 16);
         y_diff = y - (yr << 16);
-        one_min_y_diff = 65536 - y_diff;
         y_index = yr * 320;
         x = 0;
 
-        for(j = 0; j < dst_width; j++)
+        if (span <= (long long)sizeof(rows))
+            dram_load_u8(hle, rows, src_addr + (y_index * 3), (size_t)span);
+
+        for(j = 0, n = 0; j < dst_width; j++)
         {
             xr = (int)(x >> 16);
             x_diff = x - (xr << 16);
-            one_min_x_diff = 65536 - x_diff;
-            index = y_index + xr;
-            addr = src_addr + (index * 3);
 
-            dram_load_u8(hle, (uint8_t*)&a, addr, 3);
-            dram_load_u8(hle, (uint8_t*)&b, (addr + 3), 3);
-            dram_load_u8(hle, (uint8_t*)&c, (addr + (320 * 3)), 3);
-            dram_load_u8(hle, (uint8_t*)&d, (addr + (320 * 3) + 3), 3);
-
-            blue = (int)(((a&0xff)*one_min_x_diff*one_min_y_diff + (b&0xff)*x_diff*one_min_y_diff +
-                          (c&0xff)*y_diff*one_min_x_diff         + (d&0xff)*x_diff*y_diff) >> 32);
-
-            green = (int)((((a>>8)&0xff)*one_min_x_diff*one_min_y_diff + ((b>>8)&0xff)*x_diff*one_min_y_diff +
-                           ((c>>8)&0xff)*y_diff*one_min_x_diff         + ((d>>8)&0xff)*x_diff*y_diff) >> 32);
-
-            red = (int)((((a>>16)&0xff)*one_min_x_diff*one_min_y_diff + ((b>>16)&0xff)*x_diff*one_min_y_diff +
-                         ((c>>16)&0xff)*y_diff*one_min_x_diff         + ((d>>16)&0xff)*x_diff*y_diff) >> 32);
-
-            blue = (blue >> 3) & 0x001f;
-            green = (green >> 3) & 0x001f;
-            red = (red >> 3) & 0x001f;
-            pixel = (red << 11) | (green << 6) | (blue << 1) | 1;
-
-            dram_store_u16(hle, &pixel, dst_addr, 1);
-            dst_addr += 2;
+            if (span <= (long long)sizeof(rows))
+            {
+                const uint8_t* p = &rows[xr * 3];
+                line[n++] = bilinear_BGR_to_RGBA5551(p, p + 3, p + (320 * 3), p + (320 * 3) + 3, x_diff, y_diff);
+            }
+            else
+            {
+                addr = src_addr + ((y_index + xr) * 3);
+
+                dram_load_u8(hle, a, addr, 3);
+                dram_load_u8(hle, b, (addr + 3), 3);
+                dram_load_u8(hle, c, (addr + (320 * 3)), 3);
+                dram_load_u8(hle, d, (addr + (320 * 3) + 3), 3);
+                line[n++] = bilinear_BGR_to_RGBA5551(a, b, c, d, x_diff, y_diff);
+            }
+
+            if (n == RE2_RUN_LENGTH)
+            {
+                dram_store_u16(hle, line, dst_addr, n);
+                dst_addr += 2 * n;
+                n = 0;
+            }
 
             x += x_ratio;
         }
+
+        if (n != 0)
+        {
+            dram_store_u16(hle, line, dst_addr, n);
+            dst_addr += 2 * n;
+        }
         y += y_ratio;
     }
 
@@ -132,10 +172,14 @@ void decode_video_frame_task(struct hle_t* hle)
 #endif
     int nScreenDMAIncrement = *dram_u32(hle, data_ptr + 36);
 
-    int i, j;
-    uint8_t Y, Cb, Cr;
-    uint32_t pixel;
+    int i, j, k, count;
+    uint8_t Y1[2 * RE2_RUN_LENGTH], Y2[2 * RE2_RUN_LENGTH];
+    uint8_t Cb[RE2_RUN_LENGTH], Cr[RE2_RUN_LENGTH];
+    uint32_t row1[2 * RE2_RUN_LENGTH], row2[2 * RE2_RUN_LENGTH];
     int pY_1st_row, pY_2nd_row, pDest_1st_row, pDest_2nd_row;
+    /* bytes written to each destination row, odd widths write one more pixel */
+    const int row_size = 8 * ((nMovieWidth + 1) >> 1);
+    int rows_overlap;
 
     for (i = 0; i < nMovieHeight; i += 2)
     {
@@ -143,33 +187,48 @@ void decode_video_frame_task(struct hle_t* hle)
         pY_2nd_row = pLuminance + nMovieWidth;
         pDest_1st_row = pDestination;
         pDest_2nd_row = pDestination + (nScreenDMAIncrement >> 1);
+        rows_overlap = abs(pDest_2nd_row - pDest_1st_row) < row_size;
 
-        for (j = 0; j < nMovieWidth; j += 2)
+        /* each chroma sample covers a 2x2 block of luma samples */
+        for (j = 0; j < nMovieWidth; j += 2 * count)
         {
-            dram_load_u8(hle, (uint8_t*)&Cb, pCb++, 1);
-            dram_load_u8(hle, (uint8_t*)&Cr, pCr++, 1);
-
-            /*1st row*/
-            dram_load_u8(hle, (uint8_t*)&Y, pY_1st_row++, 1);
-            pixel = YCbCr_to_RGBA(Y, Cb, Cr);
-            dram_store_u32(hle, &pixel, pDest_1st_row, 1);
-            pDest_1st_row += 4;
-
-            dram_load_u8(hle, (uint8_t*)&Y, pY_1st_row++, 1);
-            pixel = YCbCr_to_RGBA(Y, Cb, Cr);
-            dram_store_u32(hle, &pixel, pDest_1st_row, 1);
-            pDest_1st_row += 4;
-
-            /*2nd row*/
-            dram_load_u8(hle, (uint8_t*)&Y, pY_2nd_row++, 1);
-            pixel = YCbCr_to_RGBA(Y, Cb, Cr);
-            dram_store_u32(hle, &pixel, pDest_2nd_row, 1);
-            pDest_2nd_row += 4;
-
-            dram_load_u8(hle, (uint8_t*)&Y, pY_2nd_row++, 1);
-            pixel = YCbCr_to_RGBA(Y, Cb, Cr);
-            dram_store_u32(hle, &pixel, pDest_2nd_row, 1);
-            pDest_2nd_row += 4;
+            count = (nMovieWidth - j + 1) >> 1;
+            if (count > RE2_RUN_LENGTH)
+                count = RE2_RUN_LENGTH;
+
+            dram_load_u8(hle, Cb, pCb, count);
+            dram_load_u8(hle, Cr, pCr, count);
+            dram_load_u8(hle, Y1, pY_1st_row, 2 * count);
+            dram_load_u8(hle, Y2, pY_2nd_row, 2 * count);
+            pCb += count;
+            pCr += count;
+            pY_1st_row += 2 * count;
+            pY_2nd_row += 2 * count;
+
+            for (k = 0; k < count; k++)
+            {
+                row1[2 * k]     = YCbCr_to_RGBA(Y1[2 * k],     Cb[k], Cr[k]);
+                row1[2 * k + 1] = YCbCr_to_RGBA(Y1[2 * k + 1], Cb[k], Cr[k]);
+                row2[2 * k]     = YCbCr_to_RGBA(Y2[2 * k],     Cb[k], Cr[k]);
+                row2[2 * k + 1] = YCbCr_to_RGBA(Y2[2 * k + 1], Cb[k], Cr[k]);
+            }
+
+            if (rows_overlap)
+            {
+                /* keep the pixel pair order, the last store wins */
+                for (k = 0; k < count; k++)
+                {
+                    dram_store_u32(hle, &row1[2 * k], pDest_1st_row + 8 * k, 2);
+                    dram_store_u32(hle, &row2[2 * k], pDest_2nd_row + 8 * k, 2);
+                }
+            }
+            else
+            {
+                dram_store_u32(hle, row1, pDest_1st_row, 2 * count);
+                dram_store_u32(hle, row2, pDest_2nd_row, 2 * count);
+            }
+            pDest_1st_row += 8 * count;
+            pDest_2nd_row += 8 * count;
         }
 
         pLuminance += (nMovieWidth << 1);
@@ -0,0 +1,354 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - dma_helpers.c                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* DMA helper benchmark
+ *
+ * Runs the same transfers through the per-element loops memory.c and
+ * alist.c used before whole word copies, and through the current
+ * load/store helpers and alist_clear/alist_move. Fails if any output
+ * differs, then prints the throughput of both and of a plain memcpy of
+ * the same size, for each transfer size.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alist.h"
+#include "hle_internal.h"
+#include "memory.h"
+
+#if defined(M64P_BIG_ENDIAN)
+#define HELPERS_PATH "big endian memcpy"
+#elif defined(__SSE2__)
+#define HELPERS_PATH "SSE2"
+#elif defined(__ARM_NEON)
+#define HELPERS_PATH "NEON"
+#else
+#define HELPERS_PATH "scalar words"
+#endif
+
+#define BUFFER_SIZE     0x1000
+#define CASES_PER_CHECK 20000
+#define BENCH_BYTES     (64 * 1024 * 1024)
+
+typedef void (*transfer_t)(unsigned char* buffer, unsigned char* data, unsigned address, size_t count);
+
+struct helper_t
+{
+    const char* name;
+    unsigned element_size;
+    int is_store;
+    transfer_t reference;
+    transfer_t current;
+};
+
+static uint32_t seed = 0x2545F491;
+
+static uint32_t next_random(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void fill_random(unsigned char* buffer, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; ++i)
+        buffer[i] = (unsigned char)next_random();
+}
+
+/* load_u8/load_u16/store_u8/store_u16 of memory.c before whole word copies */
+static void reference_load_u8(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    uint8_t* dst = (uint8_t*)data;
+    while (count != 0) {
+        *(dst++) = *u8(buffer, address);
+        address += 1;
+        --count;
+    }
+}
+
+static void reference_load_u16(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    uint16_t* dst = (uint16_t*)data;
+    while (count != 0) {
+        *(dst++) = *u16(buffer, address);
+        address += 2;
+        --count;
+    }
+}
+
+static void reference_store_u8(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    const uint8_t* src = (const uint8_t*)data;
+    while (count != 0) {
+        *u8(buffer, address) = *(src++);
+        address += 1;
+        --count;
+    }
+}
+
+static void reference_store_u16(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    const uint16_t* src = (const uint16_t*)data;
+    while (count != 0) {
+        *u16(buffer, address) = *(src++);
+        address += 2;
+        --count;
+    }
+}
+
+static void current_load_u8(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    load_u8((uint8_t*)data, buffer, address, count);
+}
+
+static void current_load_u16(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    load_u16((uint16_t*)data, buffer, address, count);
+}
+
+static void current_store_u8(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    store_u8(buffer, address, (const uint8_t*)data, count);
+}
+
+static void current_store_u16(unsigned char* buffer, unsigned char* data, unsigned address, size_t count)
+{
+    store_u16(buffer, address, (const uint16_t*)data, count);
+}
+
+static const struct helper_t helpers[] = {
+    { "load_u8",   1, 0, reference_load_u8,   current_load_u8 },
+    { "load_u16",  2, 0, reference_load_u16,  current_load_u16 },
+    { "store_u8",  1, 1, reference_store_u8,  current_store_u8 },
+    { "store_u16", 2, 1, reference_store_u16, current_store_u16 }
+};
+
+#define HELPER_COUNT (sizeof(helpers) / sizeof(helpers[0]))
+
+/* alist_clear/alist_move of alist.c before whole word copies */
+static uint8_t* reference_alist_u8(struct hle_t* hle, uint16_t dmem)
+{
+    return (uint8_t*)(hle->alist_buffer + ((dmem ^ S8) & 0xfff));
+}
+
+static void reference_alist_clear(struct hle_t* hle, uint16_t dmem, uint16_t count)
+{
+    while(count != 0) {
+        *reference_alist_u8(hle, dmem++) = 0;
+        --count;
+    }
+}
+
+static void reference_alist_move(struct hle_t* hle, uint16_t dmemo, uint16_t dmemi, uint16_t count)
+{
+    while (count != 0) {
+        *reference_alist_u8(hle, dmemo++) = *reference_alist_u8(hle, dmemi++);
+        --count;
+    }
+}
+
+static const unsigned bench_sizes[] = { 16, 64, 320, 1024, 4096 };
+
+#define BENCH_SIZE_COUNT (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+
+static double mb_per_s(size_t bytes, double us)
+{
+    return us > 0 ? bytes / us : 0;
+}
+
+static void print_throughput(const char* name, unsigned size, double ref_us, double cur_us, double memcpy_us)
+{
+    printf("%-12s %5u bytes: reference %8.0f MB/s, current %8.0f MB/s, memcpy %8.0f MB/s\n",
+           name, size,
+           mb_per_s(BENCH_BYTES, ref_us), mb_per_s(BENCH_BYTES, cur_us), mb_per_s(BENCH_BYTES, memcpy_us));
+}
+
+static double time_memcpy(unsigned char* dst, const unsigned char* src, unsigned size)
+{
+    const size_t passes = BENCH_BYTES / size;
+    double start = now_us();
+    size_t n;
+
+    for (n = 0; n < passes; ++n) {
+        memcpy(dst, src, size);
+        /* keep the copies from being merged */
+        __asm__ __volatile__("" : : "r"(dst), "r"(src) : "memory");
+    }
+
+    return now_us() - start;
+}
+
+/* Loads and stores between a buffer and an element array, with random
+ * addresses, counts and element alignments. Stores also check the bytes
+ * around the transfer are left alone. */
+static int check_helper(const struct helper_t* helper)
+{
+    unsigned char ref_buffer[BUFFER_SIZE], cur_buffer[BUFFER_SIZE];
+    unsigned char ref_data[BUFFER_SIZE], cur_data[BUFFER_SIZE];
+    unsigned n, k;
+
+    for (n = 0; n < CASES_PER_CHECK; ++n) {
+        const size_t count = next_random() % (BUFFER_SIZE / 2 / helper->element_size + 1);
+        const unsigned address = (next_random() % (BUFFER_SIZE - count * helper->element_size + 1))
+                               & ~(helper->element_size - 1);
+
+        fill_random(ref_buffer, BUFFER_SIZE);
+        fill_random(ref_data, BUFFER_SIZE);
+        memcpy(cur_buffer, ref_buffer, BUFFER_SIZE);
+        memcpy(cur_data, ref_data, BUFFER_SIZE);
+
+        helper->reference(ref_buffer, ref_data, address, count);
+        helper->current(cur_buffer, cur_data, address, count);
+
+        if (memcmp(ref_buffer, cur_buffer, BUFFER_SIZE) != 0 ||
+            memcmp(ref_data, cur_data, BUFFER_SIZE) != 0) {
+            printf("%s: %u elements at %03x differ\n", helper->name, (unsigned)count, address);
+            return 0;
+        }
+    }
+
+    for (k = 0; k < BENCH_SIZE_COUNT; ++k) {
+        const unsigned size = bench_sizes[k];
+        const size_t count = size / helper->element_size;
+        const size_t passes = BENCH_BYTES / size;
+        double start, ref_us, cur_us;
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            helper->reference(ref_buffer, ref_data, 0, count);
+        ref_us = now_us() - start;
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            helper->current(cur_buffer, cur_data, 0, count);
+        cur_us = now_us() - start;
+
+        if (memcmp(ref_buffer, cur_buffer, BUFFER_SIZE) != 0 ||
+            memcmp(ref_data, cur_data, BUFFER_SIZE) != 0) {
+            printf("%s: %u bytes benchmark output differs\n", helper->name, size);
+            return 0;
+        }
+
+        print_throughput(helper->name, size, ref_us, cur_us,
+                         helper->is_store ? time_memcpy(cur_buffer, cur_data, size)
+                                          : time_memcpy(cur_data, cur_buffer, size));
+    }
+
+    return 1;
+}
+
+/* Clears and moves within the audio buffer, including transfers which wrap
+ * around its end and overlapping moves in both directions */
+static int check_alist(struct hle_t* ref, struct hle_t* cur)
+{
+    unsigned n, k;
+
+    for (n = 0; n < CASES_PER_CHECK; ++n) {
+        const int move = next_random() & 1;
+        const uint16_t count = (uint16_t)(next_random() % 0x1000);
+        const uint16_t dmemi = (uint16_t)next_random();
+        /* moves between nearby addresses overlap */
+        const uint16_t dmemo = (next_random() & 1)
+                             ? (uint16_t)(dmemi + (int)(next_random() % 64) - 32)
+                             : (uint16_t)next_random();
+
+        fill_random(ref->alist_buffer, sizeof(ref->alist_buffer));
+        memcpy(cur->alist_buffer, ref->alist_buffer, sizeof(ref->alist_buffer));
+
+        if (move) {
+            reference_alist_move(ref, dmemo, dmemi, count);
+            alist_move(cur, dmemo, dmemi, count);
+        }
+        else {
+            reference_alist_clear(ref, dmemo, count);
+            alist_clear(cur, dmemo, count);
+        }
+
+        if (memcmp(ref->alist_buffer, cur->alist_buffer, sizeof(ref->alist_buffer)) != 0) {
+            printf("%s: %u bytes from %04x to %04x differ\n",
+                   move ? "alist_move" : "alist_clear", count, dmemi, dmemo);
+            return 0;
+        }
+    }
+
+    for (k = 0; k < BENCH_SIZE_COUNT && bench_sizes[k] <= 0x800; ++k) {
+        const uint16_t size = (uint16_t)bench_sizes[k];
+        const size_t passes = BENCH_BYTES / size;
+        double start, ref_us, cur_us;
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            reference_alist_clear(ref, 0, size);
+        ref_us = now_us() - start;
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            alist_clear(cur, 0, size);
+        cur_us = now_us() - start;
+
+        print_throughput("alist_clear", size, ref_us, cur_us,
+                         time_memcpy(cur->alist_buffer, cur->alist_buffer + 0x800, size));
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            reference_alist_move(ref, 0, 0x800, size);
+        ref_us = now_us() - start;
+
+        start = now_us();
+        for (n = 0; n < passes; ++n)
+            alist_move(cur, 0, 0x800, size);
+        cur_us = now_us() - start;
+
+        print_throughput("alist_move", size, ref_us, cur_us,
+                         time_memcpy(cur->alist_buffer, cur->alist_buffer + 0x800, size));
+    }
+
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    static struct hle_t ref_hle, cur_hle;
+    unsigned i;
+
+    printf("helpers built with the %s path\n", HELPERS_PATH);
+
+    for (i = 0; i < HELPER_COUNT; ++i)
+        if (!check_helper(&helpers[i]))
+            return 1;
+
+    if (!check_alist(&ref_hle, &cur_hle))
+        return 1;
+
+    printf("all transfers identical\n");
+    return 0;
+}
@@ -0,0 +1,18 @@
+/* Forced into the reference/ sources, which are the task implementations
+ * before they were optimized, so they link next to the current ones. */
+
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#define jpeg_decode_PS0                 reference_jpeg_decode_PS0
+#define jpeg_decode_PS                  reference_jpeg_decode_PS
+#define jpeg_decode_OB                  reference_jpeg_decode_OB
+#define resize_bilinear_task            reference_resize_bilinear_task
+#define decode_video_frame_task         reference_decode_video_frame_task
+#define fill_video_double_buffer_task   reference_fill_video_double_buffer_task
+#define hvqm2_decode_sp1_task           reference_hvqm2_decode_sp1_task
+#define mp3_task                        reference_mp3_task
+#define musyx_v1_task                   reference_musyx_v1_task
+#define musyx_v2_task                   reference_musyx_v2_task
+
+#endif
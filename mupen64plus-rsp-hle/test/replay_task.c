@@ -0,0 +1,492 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - replay_task.c                                   *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Task replay test
+ *
+ * Runs a task through the current video or MusyX/MP3 audio implementation
+ * and through the one in reference/, each on its own copy of DMEM, RDRAM
+ * and hle buffers, then compares the memory both leave behind.
+ *
+ * replay_task.exe
+ *      replays generated JPEG, RE2, MP3 and MusyX tasks.
+ * replay_task.exe <kind> <dmem file> <dram file>
+ *      replays a task dumped by a DUMP=1 build of the plugin, which writes
+ *      dmem_<kind>.bin and dram_<kind>.bin before each kind of video and
+ *      MusyX task.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hle.h"
+#include "memory.h"
+#include "ucodes.h"
+
+void reference_jpeg_decode_PS0(struct hle_t* hle);
+void reference_jpeg_decode_PS(struct hle_t* hle);
+void reference_jpeg_decode_OB(struct hle_t* hle);
+void reference_resize_bilinear_task(struct hle_t* hle);
+void reference_decode_video_frame_task(struct hle_t* hle);
+void reference_fill_video_double_buffer_task(struct hle_t* hle);
+void reference_hvqm2_decode_sp1_task(struct hle_t* hle);
+void reference_mp3_task(struct hle_t* hle, unsigned int index, uint32_t address);
+void reference_musyx_v1_task(struct hle_t* hle);
+void reference_musyx_v2_task(struct hle_t* hle);
+
+/* RDRAM addresses are masked to 24 bits, plus room for the last accesses */
+#define DRAM_SIZE   (0x1000000 + 0x10000)
+#define DMEM_SIZE   0x1000
+#define IMEM_SIZE   0x1000
+
+#define TASKS_PER_KIND 24
+
+typedef void (*task_func_t)(struct hle_t* hle);
+typedef void (*task_generator_t)(struct hle_t* hle);
+
+struct machine_t
+{
+    unsigned char* dram;
+    unsigned char dmem[DMEM_SIZE];
+    unsigned char imem[IMEM_SIZE];
+    unsigned int regs[18];
+    struct hle_t hle;
+};
+
+struct task_kind_t
+{
+    const char* name;
+    task_func_t run;
+    task_func_t reference;
+    task_generator_t generate;
+};
+
+static void generate_jpeg_ps(struct hle_t* hle);
+static void generate_jpeg_ob(struct hle_t* hle);
+static void generate_re2_resize(struct hle_t* hle);
+static void generate_re2_decode(struct hle_t* hle);
+static void generate_re2_fill(struct hle_t* hle);
+static void generate_mp3(struct hle_t* hle);
+static void generate_musyx_v1(struct hle_t* hle);
+static void generate_musyx_v2(struct hle_t* hle);
+
+/* mp3_task runs from an audio list, generated tasks pass its
+ * index in TASK_DATA_SIZE and its address in TASK_DATA_PTR */
+static void run_mp3(struct hle_t* hle)
+{
+    mp3_task(hle, *dmem_u32(hle, TASK_DATA_SIZE), *dmem_u32(hle, TASK_DATA_PTR));
+}
+
+static void run_reference_mp3(struct hle_t* hle)
+{
+    reference_mp3_task(hle, *dmem_u32(hle, TASK_DATA_SIZE), *dmem_u32(hle, TASK_DATA_PTR));
+}
+
+static const struct task_kind_t task_kinds[] = {
+    { "jpeg_ps0",   jpeg_decode_PS0,               reference_jpeg_decode_PS0,               generate_jpeg_ps },
+    { "jpeg_ps",    jpeg_decode_PS,                reference_jpeg_decode_PS,                generate_jpeg_ps },
+    { "jpeg_ob",    jpeg_decode_OB,                reference_jpeg_decode_OB,                generate_jpeg_ob },
+    { "re2_resize", resize_bilinear_task,          reference_resize_bilinear_task,          generate_re2_resize },
+    { "re2_decode", decode_video_frame_task,       reference_decode_video_frame_task,       generate_re2_decode },
+    { "re2_fill",   fill_video_double_buffer_task, reference_fill_video_double_buffer_task, generate_re2_fill },
+    /* hvqm2 streams are only replayed from dumps */
+    { "hvqm2",      hvqm2_decode_sp1_task,         reference_hvqm2_decode_sp1_task,         NULL },
+    { "mp3",        run_mp3,                       run_reference_mp3,                       generate_mp3 },
+    { "musyx_v1",   musyx_v1_task,                 reference_musyx_v1_task,                 generate_musyx_v1 },
+    { "musyx_v2",   musyx_v2_task,                 reference_musyx_v2_task,                 generate_musyx_v2 }
+};
+
+#define TASK_KIND_COUNT (sizeof(task_kinds) / sizeof(task_kinds[0]))
+
+static uint32_t seed = 0x9E3779B9;
+
+static uint32_t next_random(void)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+static int random_range(int min, int max)
+{
+    return min + (int)(next_random() % (uint32_t)(max - min + 1));
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void init_machine(struct machine_t* m)
+{
+    m->dram = malloc(DRAM_SIZE);
+    if (m->dram == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    memset(m->regs, 0, sizeof(m->regs));
+    hle_init(&m->hle, m->dram, m->dmem, m->imem,
+             &m->regs[0], &m->regs[1], &m->regs[2], &m->regs[3], &m->regs[4],
+             &m->regs[5], &m->regs[6], &m->regs[7], &m->regs[8], &m->regs[9],
+             &m->regs[10], &m->regs[11], &m->regs[12], &m->regs[13], &m->regs[14],
+             &m->regs[15], &m->regs[16], &m->regs[17], NULL);
+}
+
+static void copy_machine(struct machine_t* dst, const struct machine_t* src)
+{
+    memcpy(dst->dram, src->dram, DRAM_SIZE);
+    memcpy(dst->dmem, src->dmem, DMEM_SIZE);
+    memcpy(dst->imem, src->imem, IMEM_SIZE);
+    memcpy(dst->regs, src->regs, sizeof(dst->regs));
+    memcpy(dst->hle.alist_buffer, src->hle.alist_buffer, sizeof(dst->hle.alist_buffer));
+    memcpy(dst->hle.mp3_buffer, src->hle.mp3_buffer, sizeof(dst->hle.mp3_buffer));
+}
+
+static void fill_random(unsigned char* buffer, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; ++i)
+        buffer[i] = (unsigned char)next_random();
+}
+
+/* Runs the task of src on both implementations, returns 0 when they differ */
+static int replay(const struct task_kind_t* kind, const struct machine_t* src,
+                  struct machine_t* ref, struct machine_t* cur,
+                  double* ref_time, double* cur_time)
+{
+    size_t i;
+    double start;
+
+    copy_machine(ref, src);
+    copy_machine(cur, src);
+
+    start = now_us();
+    kind->reference(&ref->hle);
+    *ref_time += now_us() - start;
+
+    start = now_us();
+    kind->run(&cur->hle);
+    *cur_time += now_us() - start;
+
+    if (memcmp(ref->dram, cur->dram, DRAM_SIZE) != 0) {
+        for (i = 0; ref->dram[i] == cur->dram[i]; ++i) {}
+        printf("%s: RDRAM differs from %06x: reference %02x, current %02x\n",
+               kind->name, (unsigned int)i, ref->dram[i], cur->dram[i]);
+        return 0;
+    }
+
+    if (memcmp(ref->dmem, cur->dmem, DMEM_SIZE) != 0) {
+        printf("%s: DMEM differs\n", kind->name);
+        return 0;
+    }
+
+    if (memcmp(ref->regs, cur->regs, sizeof(ref->regs)) != 0) {
+        printf("%s: RSP registers differ\n", kind->name);
+        return 0;
+    }
+
+    if (memcmp(ref->hle.alist_buffer, cur->hle.alist_buffer, sizeof(ref->hle.alist_buffer)) != 0 ||
+        memcmp(ref->hle.mp3_buffer, cur->hle.mp3_buffer, sizeof(ref->hle.mp3_buffer)) != 0) {
+        printf("%s: hle buffers differ\n", kind->name);
+        return 0;
+    }
+
+    return 1;
+}
+
+static size_t load_file(const char* filename, unsigned char* buffer, size_t size)
+{
+    size_t read;
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "can't open %s\n", filename);
+        exit(1);
+    }
+    read = fread(buffer, 1, size, f);
+    fclose(f);
+    return read;
+}
+
+static int replay_dump(struct machine_t machines[3], const char* kind_name,
+                       const char* dmem_file, const char* dram_file)
+{
+    const struct task_kind_t* kind = NULL;
+    double ref_time = 0, cur_time = 0;
+    size_t i;
+
+    for (i = 0; i < TASK_KIND_COUNT; ++i)
+        if (strcmp(task_kinds[i].name, kind_name) == 0)
+            kind = &task_kinds[i];
+
+    if (kind == NULL) {
+        fprintf(stderr, "unknown task kind %s\n", kind_name);
+        return 1;
+    }
+
+    memset(machines[0].dram, 0, DRAM_SIZE);
+    if (load_file(dmem_file, machines[0].dmem, DMEM_SIZE) != DMEM_SIZE) {
+        fprintf(stderr, "%s is not a DMEM dump\n", dmem_file);
+        return 1;
+    }
+    load_file(dram_file, machines[0].dram, DRAM_SIZE);
+
+    if (!replay(kind, &machines[0], &machines[1], &machines[2], &ref_time, &cur_time))
+        return 1;
+
+    printf("%s: identical, reference %.0f us, current %.0f us\n", kind->name, ref_time, cur_time);
+    return 0;
+}
+
+static int replay_generated(struct machine_t machines[3])
+{
+    size_t k;
+    unsigned int n;
+
+    fill_random(machines[0].dram, DRAM_SIZE);
+
+    for (k = 0; k < TASK_KIND_COUNT; ++k) {
+        const struct task_kind_t* kind = &task_kinds[k];
+        double ref_time = 0, cur_time = 0;
+
+        if (kind->generate == NULL)
+            continue;
+
+        for (n = 0; n < TASKS_PER_KIND; ++n) {
+            fill_random(machines[0].dmem, DMEM_SIZE);
+            fill_random(machines[0].hle.mp3_buffer, sizeof(machines[0].hle.mp3_buffer));
+            kind->generate(&machines[0].hle);
+            if (!replay(kind, &machines[0], &machines[1], &machines[2], &ref_time, &cur_time))
+                return 1;
+        }
+
+        printf("%-12s %u tasks identical, reference %8.0f us, current %8.0f us\n",
+               kind->name, TASKS_PER_KIND, ref_time, cur_time);
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    struct machine_t machines[3];
+    int result;
+
+    if (argc != 1 && argc != 4) {
+        fprintf(stderr, "usage: %s [<kind> <dmem file> <dram file>]\n", argv[0]);
+        return 1;
+    }
+
+    init_machine(&machines[0]);
+    init_machine(&machines[1]);
+    init_machine(&machines[2]);
+
+    result = (argc == 4)
+        ? replay_dump(machines, argv[1], argv[2], argv[3])
+        : replay_generated(machines);
+
+    free(machines[0].dram);
+    free(machines[1].dram);
+    free(machines[2].dram);
+    return result;
+}
+
+/* Task generators, they set up the task header and its data in RDRAM */
+
+static void set_task(struct hle_t* hle, uint32_t type, uint32_t ucode_data,
+                     uint32_t data_ptr, uint32_t data_size, uint32_t yield_data_size)
+{
+    *dmem_u32(hle, TASK_TYPE) = type;
+    *dmem_u32(hle, TASK_FLAGS) = 0;
+    *dmem_u32(hle, TASK_UCODE_DATA) = ucode_data;
+    *dmem_u32(hle, TASK_DATA_PTR) = data_ptr;
+    *dmem_u32(hle, TASK_DATA_SIZE) = data_size;
+    *dmem_u32(hle, TASK_YIELD_DATA_SIZE) = yield_data_size;
+}
+
+static void generate_coefficients(struct hle_t* hle, uint32_t address, unsigned int count)
+{
+    unsigned int i;
+    for (i = 0; i < count; ++i) {
+        /* DC terms first in each subblock, mostly small AC terms */
+        int16_t c = (i % 64 == 0)
+            ? (int16_t)random_range(-1024, 1023)
+            : (int16_t)((next_random() & 3) == 0 ? random_range(-256, 255) : random_range(-8, 7));
+        *dram_u16(hle, address + 2 * i) = (uint16_t)c;
+    }
+}
+
+static void generate_jpeg_ps(struct hle_t* hle)
+{
+    const uint32_t data_ptr = 0x1000;
+    const uint32_t qtables = 0x2000;
+    const uint32_t macroblocks = 0x10000;
+    const uint32_t mode = (next_random() & 1) ? 2 : 0;
+    const uint32_t count = random_range(1, 300);
+    unsigned int i;
+
+    set_task(hle, 4, 0, data_ptr, 0, 0);
+
+    *dram_u32(hle, data_ptr) = macroblocks;
+    *dram_u32(hle, data_ptr + 4) = count;
+    *dram_u32(hle, data_ptr + 8) = mode;
+    *dram_u32(hle, data_ptr + 12) = qtables;
+    *dram_u32(hle, data_ptr + 16) = qtables + 0x80;
+    *dram_u32(hle, data_ptr + 20) = qtables + 0x100;
+
+    for (i = 0; i < 3 * 64; ++i)
+        *dram_u16(hle, qtables + 2 * i) = (uint16_t)random_range(1, 64);
+
+    generate_coefficients(hle, macroblocks, count * (mode + 4) * 64);
+}
+
+static void generate_jpeg_ob(struct hle_t* hle)
+{
+    const uint32_t macroblocks = 0x10000;
+    const uint32_t count = random_range(1, 300);
+    const int qscale = random_range(-3, 3);
+
+    set_task(hle, 4, 0, macroblocks, count, (uint32_t)qscale);
+    generate_coefficients(hle, macroblocks, count * 6 * 64);
+}
+
+static void generate_re2_resize(struct hle_t* hle)
+{
+    const uint32_t data_ptr = 0x1000;
+    const int dst_width = random_range(1, 320);
+    const int dst_height = random_range(1, 240);
+
+    set_task(hle, 1, data_ptr, 0, 0, 0);
+
+    *dram_u32(hle, data_ptr) = 0x100000;
+    *dram_u32(hle, data_ptr + 4) = 0x400000;
+    *dram_u32(hle, data_ptr + 8) = dst_width;
+    *dram_u32(hle, data_ptr + 12) = dst_height;
+    *dram_u32(hle, data_ptr + 16) = (319 << 16) / dst_width;
+    *dram_u32(hle, data_ptr + 20) = (239 << 16) / dst_height;
+    *dram_u32(hle, data_ptr + 24) = dst_width * 2;
+    *dram_u32(hle, data_ptr + 36) = random_range(0, 8) << 16;
+}
+
+static void generate_re2_decode(struct hle_t* hle)
+{
+    const uint32_t data_ptr = 0x1000;
+    const int width = random_range(1, 320);
+    const int height = 2 * random_range(1, 120);
+
+    set_task(hle, 1, data_ptr, 0, 0, 0);
+
+    *dram_u32(hle, data_ptr) = 0x100000;
+    *dram_u32(hle, data_ptr + 4) = 0x200000;
+    *dram_u32(hle, data_ptr + 8) = 0x280000;
+    *dram_u32(hle, data_ptr + 12) = 0x400000;
+    *dram_u32(hle, data_ptr + 16) = width;
+    *dram_u32(hle, data_ptr + 20) = height;
+    /* the second row may overlap the first one */
+    *dram_u32(hle, data_ptr + 36) = (next_random() & 3) == 0
+        ? 2 * 4 * random_range(0, width)
+        : 2 * 4 * (width + random_range(0, 16));
+}
+
+static void generate_re2_fill(struct hle_t* hle)
+{
+    const uint32_t data_ptr = 0x1000;
+    const int width = 4 * random_range(1, 320);
+
+    set_task(hle, 1, data_ptr, 0, 0, 0);
+
+    *dram_u32(hle, data_ptr) = 0x100000;
+    *dram_u32(hle, data_ptr + 4) = 0x400000;
+    *dram_u32(hle, data_ptr + 8) = width << 1;
+    *dram_u32(hle, data_ptr + 0x10) = random_range(1, 120);
+    *dram_u32(hle, data_ptr + 0x1c) = (width + 4 * random_range(0, 16)) << 1;
+    *dram_u32(hle, data_ptr + 0x28) = 0x80000000;
+}
+
+static void generate_mp3(struct hle_t* hle)
+{
+    /* mp3_task reads 8 + 0x480 bytes, then writes 0x480 back in place */
+    set_task(hle, 2, 0, 0x100000 + 8 * random_range(0, 0x1000), 2 * random_range(0, 15), 0);
+}
+
+/* SFD structures with the voice stage skipped, as the mixes which were
+ * vectorized are all in the sfx and interleave stages */
+static void generate_musyx(struct hle_t* hle, int v2)
+{
+    const uint32_t sfd_ptr = 0x10000;
+    const uint32_t sfd_size = (v2 ? 0x28 : 0x10) + 32 * 0x50;
+    const uint32_t sfd_count = random_range(1, 3);
+    uint32_t s, k;
+
+    set_task(hle, 2, 0, sfd_ptr, sfd_count, 0);
+
+    for (s = 0; s < sfd_count; ++s) {
+        const uint32_t sfd = sfd_ptr + s * sfd_size;
+        const uint32_t voice_ptr = sfd + (v2 ? 0x28 : 0x10);
+        const uint32_t sfx_ptr = 0x110000 + s * 0x100;
+        const uint32_t cbuffer_length = 192 * random_range(2, 16);
+        const uint16_t sfx_index = (uint16_t)random_range(0, cbuffer_length / 192 - 1);
+
+        *dram_u16(hle, sfd + 0x2) = sfx_index;
+        *dram_u32(hle, sfd + 0x4) = next_random() << 8;
+        *dram_u32(hle, sfd + 0x8) = 0x100000 + s * 0x1000;
+        *dram_u32(hle, sfd + 0xc) = (next_random() & 7) == 0 ? 0 : sfx_ptr;
+
+        /* first voice without samples, it holds the output pointer */
+        *dram_u16(hle, voice_ptr + 0x24 + 0x8) = 0;
+        *dram_u32(hle, voice_ptr + 0x44) = 0x200000 + s * 0x1000;
+
+        /* circular buffer, taps and FIR4 filter */
+        *dram_u32(hle, sfx_ptr + 0x00) = 0x400000 + s * 0x10000;
+        *dram_u32(hle, sfx_ptr + 0x04) = cbuffer_length;
+        *dram_u16(hle, sfx_ptr + 0x08) = (uint16_t)random_range(0, 8);
+        /* 0x8000 is the gain the vector FIR4 can't handle */
+        *dram_u16(hle, sfx_ptr + 0x0a) = (next_random() & 3) == 0 ? 0x8000 : (uint16_t)next_random();
+        for (k = 0; k < 8; ++k)
+            *dram_u32(hle, sfx_ptr + 0x0c + 4 * k) = random_range(1, cbuffer_length - 1);
+
+        if (v2) {
+            const uint32_t ptr_18 = 0x120000 + s * 0x100;
+
+            *dram_u32(hle, sfd + 0x10) = 0;
+            *dram_u16(hle, sfd + 0x16) = (next_random() & 3) == 0 ? 0 : (uint16_t)next_random();
+            *dram_u32(hle, sfd + 0x18) = ptr_18;
+            *dram_u32(hle, sfd + 0x1c) = 0x130000 + s * 0x400;
+            *dram_u32(hle, sfd + 0x20) = 0x140000 + s * 0x1000;
+            *dram_u32(hle, sfd + 0x24) = 0x150000 + s * 0x100;
+
+            for (k = 0; k < 8; ++k)
+                *dram_u32(hle, ptr_18 + 8 * k) = 0x300000 + (s * 8 + k) * 0x400;
+        }
+    }
+}
+
+static void generate_musyx_v1(struct hle_t* hle)
+{
+    generate_musyx(hle, 0);
+}
+
+static void generate_musyx_v2(struct hle_t* hle)
+{
+    generate_musyx(hle, 1);
+}
@@ -0,0 +1,90 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *   Mupen64plus-rsp-hle - stubs.c                                         *
+ *   Mupen64Plus homepage: https://mupen64plus.org/                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.          *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/* Stand-ins for the functions plugin.c and the core provide to the hle core.
+ * Only errors and warnings are printed, tasks log too much otherwise. */
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "hle_external.h"
+#include "main/trace.h"
+
+int g_trace_enabled = 0;
+
+void trace_record(enum trace_event_type type, const char* name, int64_t value)
+{
+}
+
+static void print_message(const char* prefix, const char* message, va_list args)
+{
+    fputs(prefix, stdout);
+    vprintf(message, args);
+    fputc('\n', stdout);
+}
+
+void HleVerboseMessage(void* user_defined, const char *message, ...)
+{
+}
+
+void HleInfoMessage(void* user_defined, const char *message, ...)
+{
+}
+
+void HleErrorMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    print_message("error: ", message, args);
+    va_end(args);
+}
+
+void HleWarnMessage(void* user_defined, const char *message, ...)
+{
+    va_list args;
+    va_start(args, message);
+    print_message("warning: ", message, args);
+    va_end(args);
+}
+
+void HleCheckInterrupts(void* user_defined)
+{
+}
+
+void HleProcessDlistList(void* user_defined)
+{
+}
+
+void HleProcessAlistList(void* user_defined)
+{
+}
+
+void HleProcessRdpList(void* user_defined)
+{
+}
+
+void HleShowCFB(void* user_defined)
+{
+}
+
+int HleForwardTask(void* user_defined)
+{
+    return -1;
+}